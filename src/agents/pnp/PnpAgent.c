@@ -16,6 +16,7 @@
 // The local Desired Configuration (DC) and Reported Configuration (RC) files
 #define DC_FILE "/etc/osconfig/osconfig_desired.json"
 #define RC_FILE "/etc/osconfig/osconfig_reported.json"
+#define RC_TEMP_FILE "/etc/osconfig/osconfig_reported.json.tmp"
 
 // The configuration file for OSConfig
 #define CONFIG_FILE "/etc/osconfig/osconfig.json"
@@ -107,9 +108,11 @@ static const char g_productInfoTemplate[] = "Azure OSConfig %d;%s "
     "\"product_vendor\"=\"%s\"&\"product_name\"=\"%s\")";
 static char g_productInfo[DEVICE_PRODUCT_INFO_SIZE] = {0};
 
-static size_t g_reportedHash = 0;
 static size_t g_desiredHash = 0;
 
+// The version of the reported configuration last saved to the RC file as returned by the platform, 0 for none
+static unsigned long long g_reportedVersion = 0;
+
 static int g_localManagement = 0;
 
 OSCONFIG_LOG_HANDLE GetLog()
@@ -395,6 +398,9 @@ static bool InitializeAgent(void)
 
 void CloseAgent(void)
 {
+    // Completes the MPI calls still in flight while what they complete into is still around
+    CancelMpiAsyncCalls(GetLog());
+
     IotHubDeInitialize();
 
     if (NULL != g_mpiHandle)
@@ -408,35 +414,389 @@ void CloseAgent(void)
     OsConfigLogInfo(GetLog(), "OSConfig PnP Agent terminated");
 }
 
+static int WriteReportedConfigurationToFile(const char* data, const int dataSizeBytes, void* context)
+{
+    return ((size_t)dataSizeBytes == fwrite(data, 1, dataSizeBytes, (FILE*)context)) ? MPI_OK : EIO;
+}
+
+// Replaces the RC file with the temporary file written when that succeeded, the temporary file is removed either way
+static int ReplaceReportedConfigurationFile(int status)
+{
+    if ((0 == status) && (0 != rename(RC_TEMP_FILE, RC_FILE)))
+    {
+        status = errno;
+        OsConfigLogError(GetLog(), "Failed to replace %s with %s (%d)", RC_FILE, RC_TEMP_FILE, status);
+    }
+
+    remove(RC_TEMP_FILE);
+
+    return status;
+}
+
+static int StreamReportedConfigurationToFile(void)
+{
+    FILE* file = NULL;
+    int status = 0;
+
+    if (NULL == (file = fopen(RC_TEMP_FILE, "w")))
+    {
+        status = errno;
+        OsConfigLogError(GetLog(), "Failed to create %s (%d)", RC_TEMP_FILE, status);
+        return status;
+    }
+
+    RestrictFileAccessToCurrentAccountOnly(RC_TEMP_FILE);
+
+    status = CallMpiGetReportedStream(WriteReportedConfigurationToFile, file, GetLog());
+
+    if ((0 != fclose(file)) && (MPI_OK == status))
+    {
+        status = EIO;
+    }
+
+    return ReplaceReportedConfigurationFile(status);
+}
+
+static bool IsJsonWhitespace(int c)
+{
+    return (' ' == c) || ('\t' == c) || ('\r' == c) || ('\n' == c);
+}
+
+static int GetNextJsonCharacter(FILE* file)
+{
+    int c = 0;
+
+    while ((EOF != (c = getc(file))) && IsJsonWhitespace(c))
+    {
+    }
+
+    return c;
+}
+
+// Copies the JSON value that starts with the character first from input to output, or skips it when output is NULL. Only the nesting
+// is followed, the value is not validated. The character that ends a number or a literal is put back into input
+static int CopyJsonValueFromFile(FILE* input, int first, FILE* output)
+{
+    bool inString = false;
+    bool escaped = false;
+    int depth = 0;
+    int c = first;
+
+    while (EOF != c)
+    {
+        if (inString)
+        {
+            if (escaped)
+            {
+                escaped = false;
+            }
+            else if ('\\' == c)
+            {
+                escaped = true;
+            }
+            else if ('"' == c)
+            {
+                inString = false;
+            }
+        }
+        else if ('"' == c)
+        {
+            inString = true;
+        }
+        else if (('{' == c) || ('[' == c))
+        {
+            depth += 1;
+        }
+        else if ((0 == depth) && (('}' == c) || (']' == c) || (',' == c) || IsJsonWhitespace(c)))
+        {
+            ungetc(c, input);
+            return 0;
+        }
+        else if (('}' == c) || (']' == c))
+        {
+            depth -= 1;
+        }
+
+        if ((NULL != output) && (EOF == putc(c, output)))
+        {
+            return EIO;
+        }
+
+        if ((0 == depth) && (!inString) && (('"' == c) || ('}' == c) || (']' == c)))
+        {
+            return 0;
+        }
+
+        c = getc(input);
+    }
+
+    return EINVAL;
+}
+
+// Reads the JSON string that starts with the quote already read from the file, returns its text decoded (to be freed by the caller) or NULL
+static char* ReadJsonStringFromFile(FILE* file)
+{
+    FILE* stream = NULL;
+    JSON_SPAN span = {0};
+    char* text = NULL;
+    char* value = NULL;
+    int status = 0;
+
+    if (NULL == (stream = open_memstream(&text, &span.length)))
+    {
+        return NULL;
+    }
+
+    status = CopyJsonValueFromFile(file, '"', stream);
+
+    if ((0 == fclose(stream)) && (0 == status))
+    {
+        span.data = text;
+        value = CopyJsonString(&span);
+    }
+
+    FREE_MEMORY(text);
+
+    return value;
+}
+
+static int WriteJsonMemberToFile(FILE* file, bool first, const char* name, const JSON_Value* value)
+{
+    JSON_Value* nameValue = NULL;
+    char* serializedName = NULL;
+    char* serializedValue = NULL;
+    int status = 0;
+
+    if ((NULL == (nameValue = json_value_init_string(name))) || (NULL == (serializedName = json_serialize_to_string(nameValue))) ||
+        ((NULL != value) && (NULL == (serializedValue = json_serialize_to_string(value)))))
+    {
+        status = ENOMEM;
+    }
+    else if (0 > fprintf(file, "%s%s:%s", first ? "" : ",", serializedName, (NULL != serializedValue) ? serializedValue : ""))
+    {
+        status = EIO;
+    }
+
+    json_free_serialized_string(serializedValue);
+    json_free_serialized_string(serializedName);
+    json_value_free(nameValue);
+
+    return status;
+}
+
+static bool IsReportedObjectRemoved(const JSON_Array* removedArray, const char* componentName, const char* objectName)
+{
+    JSON_Object* removedObject = NULL;
+    const char* removedComponentName = NULL;
+    const char* removedObjectName = NULL;
+    size_t i = 0;
+
+    for (i = 0; i < json_array_get_count(removedArray); i++)
+    {
+        if ((NULL != (removedObject = json_array_get_object(removedArray, i))) &&
+            (NULL != (removedComponentName = json_object_get_string(removedObject, "ComponentName"))) &&
+            (NULL != (removedObjectName = json_object_get_string(removedObject, "ObjectName"))) &&
+            (0 == strcmp(componentName, removedComponentName)) && (0 == strcmp(objectName, removedObjectName)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Copies the JSON object that starts at the next character of input to output one member at a time, replacing the members found in changes
+// (which are taken out of it) and adding the rest of them at the end. At the top level (without a component name) the members are components
+// merged the same way with the objects that changed in them and the removed objects are left out of them, "TimedOut" is replaced
+static int MergeJsonObjectFromFile(FILE* input, FILE* output, JSON_Object* changes, const JSON_Array* removedArray, const char* componentName, const JSON_Value* timedOutValue)
+{
+    JSON_Value* changedValue = NULL;
+    char* name = NULL;
+    bool firstRead = true;
+    bool first = true;
+    size_t i = 0;
+    int status = 0;
+    int c = 0;
+
+    if (('{' != GetNextJsonCharacter(input)) || (EOF == putc('{', output)))
+    {
+        return EINVAL;
+    }
+
+    for (c = GetNextJsonCharacter(input); (0 == status) && ('}' != c); c = GetNextJsonCharacter(input))
+    {
+        if ((!firstRead) && (',' == c))
+        {
+            c = GetNextJsonCharacter(input);
+        }
+
+        firstRead = false;
+
+        if (('"' != c) || (NULL == (name = ReadJsonStringFromFile(input))) || (':' != GetNextJsonCharacter(input)) || (EOF == (c = GetNextJsonCharacter(input))))
+        {
+            status = EINVAL;
+        }
+        else if (NULL == componentName)
+        {
+            if (0 == strcmp(name, "TimedOut"))
+            {
+                status = CopyJsonValueFromFile(input, c, NULL);
+            }
+            else if ('{' == c)
+            {
+                if ((0 == (status = WriteJsonMemberToFile(output, first, name, NULL))) && (EOF != ungetc(c, input)))
+                {
+                    status = MergeJsonObjectFromFile(input, output, json_object_get_object(changes, name), removedArray, name, NULL);
+                    json_object_remove(changes, name);
+                }
+                first = false;
+            }
+            else if (0 == (status = WriteJsonMemberToFile(output, first, name, NULL)))
+            {
+                status = CopyJsonValueFromFile(input, c, output);
+                first = false;
+            }
+        }
+        else if (IsReportedObjectRemoved(removedArray, componentName, name))
+        {
+            status = CopyJsonValueFromFile(input, c, NULL);
+        }
+        else if (NULL != (changedValue = json_object_get_value(changes, name)))
+        {
+            if ((0 == (status = CopyJsonValueFromFile(input, c, NULL))) && (0 == (status = WriteJsonMemberToFile(output, first, name, changedValue))))
+            {
+                json_object_remove(changes, name);
+            }
+            first = false;
+        }
+        else if (0 == (status = WriteJsonMemberToFile(output, first, name, NULL)))
+        {
+            status = CopyJsonValueFromFile(input, c, output);
+            first = false;
+        }
+
+        FREE_MEMORY(name);
+    }
+
+    // What is left of the changes was not in the file
+    for (i = 0; (0 == status) && (i < json_object_get_count(changes)); i++)
+    {
+        status = WriteJsonMemberToFile(output, first, json_object_get_name(changes, i), json_object_get_value_at(changes, i));
+        first = false;
+    }
+
+    if ((0 == status) && (0 < json_array_get_count(json_value_get_array(timedOutValue))))
+    {
+        status = WriteJsonMemberToFile(output, first, "TimedOut", timedOutValue);
+    }
+
+    if ((0 == status) && (EOF == putc('}', output)))
+    {
+        status = EIO;
+    }
+
+    return status;
+}
+
+// Merges the changes into the RC file without holding the whole reported configuration in memory, only the changes are
+static int MergeReportedConfigurationFile(JSON_Object* reportedObject, const JSON_Array* removedArray, const JSON_Value* timedOutValue)
+{
+    FILE* input = NULL;
+    FILE* output = NULL;
+    int status = 0;
+
+    if (NULL == (input = fopen(RC_FILE, "r")))
+    {
+        status = errno;
+        OsConfigLogError(GetLog(), "Failed to open %s (%d)", RC_FILE, status);
+        return status;
+    }
+
+    if (NULL == (output = fopen(RC_TEMP_FILE, "w")))
+    {
+        status = errno;
+        OsConfigLogError(GetLog(), "Failed to create %s (%d)", RC_TEMP_FILE, status);
+        fclose(input);
+        return status;
+    }
+
+    RestrictFileAccessToCurrentAccountOnly(RC_TEMP_FILE);
+
+    if (0 != (status = MergeJsonObjectFromFile(input, output, reportedObject, removedArray, NULL, timedOutValue)))
+    {
+        OsConfigLogError(GetLog(), "Failed to merge the reported configuration changes into %s (%d)", RC_FILE, status);
+    }
+
+    fclose(input);
+
+    if ((0 != fclose(output)) && (0 == status))
+    {
+        status = EIO;
+    }
+
+    return ReplaceReportedConfigurationFile(status);
+}
+
+// A full resync streams the whole reported configuration into the RC file, other changes are merged into it. When the RC file
+// could not be updated the next call asks for a full resync
+static void SaveReportedConfigurationChanges(const char* payload)
+{
+    JSON_Value* changesValue = NULL;
+    JSON_Object* changesObject = NULL;
+    JSON_Object* reportedObject = NULL;
+    JSON_Array* removedArray = NULL;
+    int status = 0;
+
+    if ((NULL == (changesValue = json_parse_string(payload))) || (NULL == (changesObject = json_value_get_object(changesValue))) ||
+        (NULL == (reportedObject = json_object_get_object(changesObject, "Reported"))) ||
+        (JSONNumber != json_value_get_type(json_object_get_value(changesObject, "Version"))))
+    {
+        OsConfigLogError(GetLog(), "MpiGetReportedChanges returned an invalid payload");
+        g_reportedVersion = 0;
+    }
+    else
+    {
+        removedArray = json_object_get_array(changesObject, "Removed");
+
+        if (1 == json_object_get_boolean(changesObject, "Full"))
+        {
+            status = StreamReportedConfigurationToFile();
+        }
+        else if ((0 < json_object_get_count(reportedObject)) || (0 < json_array_get_count(removedArray)))
+        {
+            status = MergeReportedConfigurationFile(reportedObject, removedArray, json_object_get_value(changesObject, "TimedOut"));
+        }
+
+        g_reportedVersion = (0 == status) ? (unsigned long long)json_object_get_number(changesObject, "Version") : 0;
+    }
+
+    json_value_free(changesValue);
+}
+
 static void SaveReportedConfigurationToFile()
 {
-    char* payload = NULL;
+    MPI_JSON_STRING payload = NULL;
     int payloadSizeBytes = 0;
-    size_t payloadHash = 0;
     bool platformAlreadyRunning = true;
     int mpiResult = MPI_OK;
+
     if (g_localManagement)
     {
-        mpiResult = CallMpiGetReported((MPI_JSON_STRING*)&payload, &payloadSizeBytes, GetLog());
+        // Only the objects changed since the last call come back, the RC file is updated when there are any
+        mpiResult = CallMpiGetReportedChanges(g_reportedVersion, &payload, &payloadSizeBytes, GetLog());
         if ((MPI_OK != mpiResult) && RefreshMpiClientSession(&platformAlreadyRunning) && (false == platformAlreadyRunning))
         {
             CallMpiFree(payload);
+            payload = NULL;
 
-            mpiResult = CallMpiGetReported((MPI_JSON_STRING*)&payload, &payloadSizeBytes, GetLog());
+            mpiResult = CallMpiGetReportedChanges(g_reportedVersion, &payload, &payloadSizeBytes, GetLog());
         }
-        
+
         if ((MPI_OK == mpiResult) && (NULL != payload) && (0 < payloadSizeBytes))
         {
-            if (g_reportedHash != (payloadHash = HashString(payload)))
-            {
-                if (SavePayloadToFile(RC_FILE, payload, payloadSizeBytes, GetLog()))
-                {
-                    RestrictFileAccessToCurrentAccountOnly(RC_FILE);
-                    g_reportedHash = payloadHash;
-                }
-            }
+            SaveReportedConfigurationChanges(payload);
         }
-        
+
         CallMpiFree(payload);
     }
 }
@@ -449,23 +809,62 @@ static void ReportProperties()
         return;
     }
 
-    for (int i = 0; i < g_numReportedProperties; i++)
+    // All reported properties are read from the platform in one batched MpiGetMany call
+    ReportPropertiesToIotHub(g_reportedProperties, g_numReportedProperties);
+}
+
+// An MpiSetDesired call in flight for the DC file
+typedef struct DESIRED_CONFIGURATION_APPLY
+{
+    char* payload;
+    int payloadSizeBytes;
+    size_t payloadHash;
+    bool retried;
+} DESIRED_CONFIGURATION_APPLY;
+
+static DESIRED_CONFIGURATION_APPLY* g_desiredConfigurationApply = NULL;
+
+static void DesiredConfigurationApplyComplete(int mpiResult, MPI_JSON_STRING response, int responseSizeBytes, void* context)
+{
+    DESIRED_CONFIGURATION_APPLY* apply = (DESIRED_CONFIGURATION_APPLY*)context;
+    bool platformAlreadyRunning = true;
+
+    UNUSED(response);
+    UNUSED(responseSizeBytes);
+
+    if (MPI_OK == mpiResult)
     {
-        if ((strlen(g_reportedProperties[i].componentName) > 0) && (strlen(g_reportedProperties[i].propertyName) > 0))
+        g_desiredHash = apply->payloadHash;
+    }
+    else if ((ECANCELED != mpiResult) && (!apply->retried) && RefreshMpiClientSession(&platformAlreadyRunning) && (false == platformAlreadyRunning))
+    {
+        apply->retried = true;
+
+        if (MPI_OK == CallMpiSetDesiredAsync((MPI_JSON_STRING)apply->payload, apply->payloadSizeBytes, DesiredConfigurationApplyComplete, apply, GetLog()))
         {
-            ReportPropertyToIotHub(g_reportedProperties[i].componentName, g_reportedProperties[i].propertyName, &(g_reportedProperties[i].lastPayloadHash));
+            return;
         }
     }
+
+    FREE_MEMORY(apply->payload);
+    FREE_MEMORY(apply);
+    g_desiredConfigurationApply = NULL;
 }
 
 static void LoadDesiredConfigurationFromFile()
 {
+    DESIRED_CONFIGURATION_APPLY* apply = NULL;
     size_t payloadHash = 0;
     int payloadSizeBytes = 0;
     char* payload = NULL; 
-    bool platformAlreadyRunning = true;
     int mpiResult = MPI_OK;
 
+    if (NULL != g_desiredConfigurationApply)
+    {
+        // The previous DC payload is still being applied, the file is checked again next time
+        return;
+    }
+
     RestrictFileAccessToCurrentAccountOnly(DC_FILE);
 
     payload = LoadStringFromFile(DC_FILE, false, GetLog());
@@ -475,16 +874,24 @@ static void LoadDesiredConfigurationFromFile()
         if (g_desiredHash != (payloadHash = HashString(payload)))
         {
             OsConfigLogInfo(GetLog(), "Processing DC payload from %s", DC_FILE);
-            
-            mpiResult = CallMpiSetDesired((MPI_JSON_STRING)payload, payloadSizeBytes, GetLog());
-            if ((MPI_OK != mpiResult) && RefreshMpiClientSession(&platformAlreadyRunning) && (false == platformAlreadyRunning))
+
+            if (NULL == (apply = (DESIRED_CONFIGURATION_APPLY*)calloc(1, sizeof(DESIRED_CONFIGURATION_APPLY))))
             {
-                mpiResult = CallMpiSetDesired((MPI_JSON_STRING)payload, payloadSizeBytes, GetLog());
+                OsConfigLogError(GetLog(), "LoadDesiredConfigurationFromFile: out of memory");
             }
-            
-            if (MPI_OK == mpiResult)
+            else
             {
-                g_desiredHash = payloadHash;
+                // The DC payload is applied asynchronously, concurrently with the reported configuration being read
+                apply->payload = payload;
+                apply->payloadSizeBytes = payloadSizeBytes;
+                apply->payloadHash = payloadHash;
+                g_desiredConfigurationApply = apply;
+                payload = NULL;
+
+                if (MPI_OK != (mpiResult = CallMpiSetDesiredAsync((MPI_JSON_STRING)apply->payload, apply->payloadSizeBytes, DesiredConfigurationApplyComplete, apply, GetLog())))
+                {
+                    DesiredConfigurationApplyComplete(mpiResult, NULL, 0, apply);
+                }
             }
         }
     }
@@ -769,8 +1176,12 @@ int main(int argc, char *argv[])
     while (0 == g_stopSignal)
     {
         AgentDoWork();
-        
-        SleepMilliseconds(DOWORK_SLEEP);
+
+        // While MPI calls are in flight their completions are picked up instead of sleeping
+        if (0 == CallMpiDoWork(DOWORK_SLEEP, GetLog()))
+        {
+            SleepMilliseconds(DOWORK_SLEEP);
+        }
 
         if (0 != g_refreshSignal)
         {
@@ -519,15 +519,82 @@ static void ReadReportedStateCallback(int statusCode, void* userContextCallback)
     }
 }
 
-IOTHUB_CLIENT_RESULT ReportPropertyToIotHub(const char* componentName, const char* propertyName, size_t* lastPayloadHash)
+static IOTHUB_CLIENT_RESULT ReportPropertyValueToIotHub(const char* componentName, const char* propertyName, const char* valuePayload, int valueLength, size_t* lastPayloadHash)
 {
     IOTHUB_CLIENT_RESULT result = IOTHUB_CLIENT_OK;
-    char* valuePayload = NULL;
-    int valueLength = 0;
     char* decoratedPayload = NULL;
     int decoratedLength = 0;
     size_t hashPayload = 0;
     bool reportProperty = true;
+
+    decoratedLength = strlen(componentName) + strlen(propertyName) + valueLength + EXTRA_PROP_PAYLOAD_ESTIMATE;
+    decoratedPayload = (char*)malloc(decoratedLength);
+    if (NULL != decoratedPayload)
+    {
+        snprintf(decoratedPayload, decoratedLength, g_propertyReadTemplate, componentName, propertyName, valueLength, valuePayload);
+
+        LogAssert(GetLog(), decoratedLength >= (int)strlen(decoratedPayload));
+        decoratedLength = strlen(decoratedPayload);
+
+        if (NULL != lastPayloadHash)
+        {
+            hashPayload = HashString(decoratedPayload);
+            if (hashPayload == *lastPayloadHash)
+            {
+                reportProperty = false;
+            }
+            else
+            {
+                *lastPayloadHash = hashPayload;
+            }
+        }
+
+        if (reportProperty)
+        {
+            result = IoTHubDeviceClient_LL_SendReportedState(g_moduleHandle, (const unsigned char*)decoratedPayload, decoratedLength, ReadReportedStateCallback, (void*)propertyName);
+
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogInfo(GetLog(), "%s.%s: reported %.*s (%d bytes), result: %d", componentName, propertyName, decoratedLength, decoratedPayload, decoratedLength, result);
+            }
+
+            if (IOTHUB_CLIENT_OK != result)
+            {
+                OsConfigLogError(GetLog(), "%s.%s: IoTHubDeviceClient_LL_SendReportedState failed with %d", componentName, propertyName, result);
+            }
+        }
+    }
+    else
+    {
+        OsConfigLogError(GetLog(), "%s: out of memory allocating %u bytes to report property %s", componentName, decoratedLength, propertyName);
+    }
+
+    FREE_MEMORY(decoratedPayload);
+
+    return result;
+}
+
+static void LogPropertyNotReported(const char* componentName, const char* propertyName, int mpiResult)
+{
+    // Avoid log abuse when a component specified in configuration is not active
+    if (IsFullLoggingEnabled())
+    {
+        if (MPI_OK == mpiResult)
+        {
+            OsConfigLogError(GetLog(), "%s.%s: MpiGet returned MMI_OK with no payload", componentName, propertyName);
+        }
+        else
+        {
+            OsConfigLogError(GetLog(), "%s.%s: MpiGet failed with %d", componentName, propertyName, mpiResult);
+        }
+    }
+}
+
+IOTHUB_CLIENT_RESULT ReportPropertyToIotHub(const char* componentName, const char* propertyName, size_t* lastPayloadHash)
+{
+    IOTHUB_CLIENT_RESULT result = IOTHUB_CLIENT_OK;
+    char* valuePayload = NULL;
+    int valueLength = 0;
     bool platformAlreadyRunning = true;
     int mpiResult = MPI_OK;
 
@@ -550,70 +617,208 @@ IOTHUB_CLIENT_RESULT ReportPropertyToIotHub(const char* componentName, const cha
         
     if ((MPI_OK == mpiResult) && (valueLength > 0) && (NULL != valuePayload))
     {
-        decoratedLength = strlen(componentName) + strlen(propertyName) + valueLength + EXTRA_PROP_PAYLOAD_ESTIMATE;
-        decoratedPayload = (char*)malloc(decoratedLength);
-        if (NULL != decoratedPayload)
-        {
-            snprintf(decoratedPayload, decoratedLength, g_propertyReadTemplate, componentName, propertyName, valueLength, valuePayload);
+        result = ReportPropertyValueToIotHub(componentName, propertyName, valuePayload, valueLength, lastPayloadHash);
+    }
+    else
+    {
+        LogPropertyNotReported(componentName, propertyName, mpiResult);
+        result = IOTHUB_CLIENT_ERROR;
+    }
 
-            LogAssert(GetLog(), decoratedLength >= (int)strlen(decoratedPayload));
-            decoratedLength = strlen(decoratedPayload);
+    CallMpiFree(valuePayload);
 
-            if (NULL != lastPayloadHash)
-            {
-                hashPayload = HashString(decoratedPayload);
-                if (hashPayload == *lastPayloadHash)
-                {
-                    reportProperty = false;
-                }
-                else
-                {
-                    *lastPayloadHash = hashPayload;
-                }
-            }
+    return result;
+}
 
-            if (reportProperty)
-            {
-                result = IoTHubDeviceClient_LL_SendReportedState(g_moduleHandle, (const unsigned char*)decoratedPayload, decoratedLength, ReadReportedStateCallback, (void*)propertyName);
+static char* SerializeReportedObjects(const REPORTED_PROPERTY* reportedProperties, int numReportedProperties)
+{
+    JSON_Value* objectsValue = NULL;
+    JSON_Array* objectsArray = NULL;
+    JSON_Value* objectValue = NULL;
+    JSON_Object* objectObject = NULL;
+    char* serializedObjects = NULL;
+    char* objects = NULL;
+    bool success = true;
 
-                if (IsFullLoggingEnabled())
-                {
-                    OsConfigLogInfo(GetLog(), "%s.%s: reported %.*s (%d bytes), result: %d", componentName, propertyName, decoratedLength, decoratedPayload, decoratedLength, result);
-                }
+    if ((NULL == (objectsValue = json_value_init_array())) || (NULL == (objectsArray = json_value_get_array(objectsValue))))
+    {
+        json_value_free(objectsValue);
+        return NULL;
+    }
 
-                if (IOTHUB_CLIENT_OK != result)
-                {
-                    OsConfigLogError(GetLog(), "%s.%s: IoTHubDeviceClient_LL_SendReportedState failed with %d", componentName, propertyName, result);
-                }
+    for (int i = 0; (i < numReportedProperties) && success; i++)
+    {
+        if ((strlen(reportedProperties[i].componentName) > 0) && (strlen(reportedProperties[i].propertyName) > 0))
+        {
+            if ((NULL == (objectValue = json_value_init_object())) || (NULL == (objectObject = json_value_get_object(objectValue))) ||
+                (JSONSuccess != json_object_set_string(objectObject, "ComponentName", reportedProperties[i].componentName)) ||
+                (JSONSuccess != json_object_set_string(objectObject, "ObjectName", reportedProperties[i].propertyName)) ||
+                (JSONSuccess != json_array_append_value(objectsArray, objectValue)))
+            {
+                json_value_free(objectValue);
+                success = false;
             }
         }
-        else
+    }
+
+    if (success && (NULL != (serializedObjects = json_serialize_to_string(objectsValue))))
+    {
+        objects = strdup(serializedObjects);
+        json_free_serialized_string(serializedObjects);
+    }
+
+    json_value_free(objectsValue);
+
+    return objects;
+}
+
+// An MpiGetMany call in flight for ReportPropertiesToIotHub
+typedef struct REPORTED_PROPERTIES_READ
+{
+    REPORTED_PROPERTY* reportedProperties;
+    int numReportedProperties;
+    char* objects;
+    bool retried;
+} REPORTED_PROPERTIES_READ;
+
+static REPORTED_PROPERTIES_READ* g_reportedPropertiesRead = NULL;
+
+static void ReportMpiGetManyResultsToIotHub(REPORTED_PROPERTY* reportedProperties, int numReportedProperties, int mpiResult, const char* payload)
+{
+    JSON_Value* resultsValue = NULL;
+    JSON_Array* resultsArray = NULL;
+    JSON_Object* resultObject = NULL;
+    JSON_Value* valueValue = NULL;
+    char* value = NULL;
+    size_t numResults = 0;
+    size_t j = 0;
+
+    if ((MPI_OK != mpiResult) || (NULL == payload) || (NULL == (resultsValue = json_parse_string(payload))) || (NULL == (resultsArray = json_value_get_array(resultsValue))))
+    {
+        OsConfigLogError(GetLog(), "ReportPropertiesToIotHub: MpiGetMany failed with %d, reporting one property at a time", mpiResult);
+
+        for (int i = 0; i < numReportedProperties; i++)
         {
-            OsConfigLogError(GetLog(), "%s: out of memory allocating %u bytes to report property %s", componentName, decoratedLength, propertyName);
+            if ((strlen(reportedProperties[i].componentName) > 0) && (strlen(reportedProperties[i].propertyName) > 0))
+            {
+                ReportPropertyToIotHub(reportedProperties[i].componentName, reportedProperties[i].propertyName, &(reportedProperties[i].lastPayloadHash));
+            }
         }
     }
     else
     {
-        // Avoid log abuse when a component specified in configuration is not active
-        if (IsFullLoggingEnabled())
+        // The results come back in the order the properties were requested
+        numResults = json_array_get_count(resultsArray);
+
+        for (int i = 0; i < numReportedProperties; i++)
         {
-            if (MPI_OK == mpiResult)
+            if ((0 == strlen(reportedProperties[i].componentName)) || (0 == strlen(reportedProperties[i].propertyName)))
+            {
+                continue;
+            }
+
+            if (j >= numResults)
+            {
+                OsConfigLogError(GetLog(), "ReportPropertiesToIotHub: MpiGetMany returned %u results, fewer than requested", (unsigned int)numResults);
+                break;
+            }
+
+            resultObject = json_array_get_object(resultsArray, j++);
+            mpiResult = resultObject ? (int)json_object_get_number(resultObject, "Status") : EINVAL;
+
+            if ((MPI_OK == mpiResult) && (NULL != (valueValue = json_object_get_value(resultObject, "Payload"))) && (NULL != (value = json_serialize_to_string(valueValue))))
             {
-                OsConfigLogError(GetLog(), "%s.%s: MpiGet returned MMI_OK with no payload", componentName, propertyName);
+                ReportPropertyValueToIotHub(reportedProperties[i].componentName, reportedProperties[i].propertyName, value, (int)strlen(value), &(reportedProperties[i].lastPayloadHash));
+                json_free_serialized_string(value);
             }
             else
             {
-                OsConfigLogError(GetLog(), "%s.%s: MpiGet failed with %d", componentName, propertyName, mpiResult);
+                LogPropertyNotReported(reportedProperties[i].componentName, reportedProperties[i].propertyName, mpiResult);
             }
         }
-        result = IOTHUB_CLIENT_ERROR;
     }
 
-    CallMpiFree(valuePayload);
+    json_value_free(resultsValue);
+}
 
-    FREE_MEMORY(decoratedPayload);
+static void ReportedPropertiesReadComplete(int mpiResult, MPI_JSON_STRING payload, int payloadSizeBytes, void* context)
+{
+    REPORTED_PROPERTIES_READ* reportedPropertiesRead = (REPORTED_PROPERTIES_READ*)context;
+    bool platformAlreadyRunning = true;
 
-    return result;
+    UNUSED(payloadSizeBytes);
+
+    // Cancelled when the agent is closing, the properties are not reported then
+    if (ECANCELED != mpiResult)
+    {
+        if ((MPI_OK != mpiResult) && (!reportedPropertiesRead->retried) && RefreshMpiClientSession(&platformAlreadyRunning) && (false == platformAlreadyRunning))
+        {
+            reportedPropertiesRead->retried = true;
+
+            if (MPI_OK == CallMpiGetManyAsync(reportedPropertiesRead->objects, ReportedPropertiesReadComplete, reportedPropertiesRead, GetLog()))
+            {
+                return;
+            }
+        }
+
+        if (NULL != g_moduleHandle)
+        {
+            ReportMpiGetManyResultsToIotHub(reportedPropertiesRead->reportedProperties, reportedPropertiesRead->numReportedProperties, mpiResult, payload);
+        }
+    }
+
+    FREE_MEMORY(reportedPropertiesRead->objects);
+    FREE_MEMORY(reportedPropertiesRead);
+    g_reportedPropertiesRead = NULL;
+}
+
+IOTHUB_CLIENT_RESULT ReportPropertiesToIotHub(REPORTED_PROPERTY* reportedProperties, int numReportedProperties)
+{
+    REPORTED_PROPERTIES_READ* reportedPropertiesRead = NULL;
+    int mpiResult = MPI_OK;
+
+    if ((NULL == reportedProperties) || (numReportedProperties <= 0))
+    {
+        return IOTHUB_CLIENT_INVALID_ARG;
+    }
+
+    if (NULL == g_moduleHandle)
+    {
+        OsConfigLogError(GetLog(), "ReportPropertiesToIotHub: the component needs to be initialized before reporting properties");
+        return IOTHUB_CLIENT_ERROR;
+    }
+
+    if (NULL != g_reportedPropertiesRead)
+    {
+        // The properties read for the previous report are still on their way, this report is skipped
+        OsConfigLogInfo(GetLog(), "ReportPropertiesToIotHub: the previous report is still in progress");
+        return IOTHUB_CLIENT_OK;
+    }
+
+    if (NULL == (reportedPropertiesRead = (REPORTED_PROPERTIES_READ*)calloc(1, sizeof(REPORTED_PROPERTIES_READ))))
+    {
+        OsConfigLogError(GetLog(), "ReportPropertiesToIotHub: out of memory");
+        return IOTHUB_CLIENT_ERROR;
+    }
+
+    if (NULL == (reportedPropertiesRead->objects = SerializeReportedObjects(reportedProperties, numReportedProperties)))
+    {
+        OsConfigLogError(GetLog(), "ReportPropertiesToIotHub: failed to serialize the list of reported properties");
+        FREE_MEMORY(reportedPropertiesRead);
+        return IOTHUB_CLIENT_ERROR;
+    }
+
+    reportedPropertiesRead->reportedProperties = reportedProperties;
+    reportedPropertiesRead->numReportedProperties = numReportedProperties;
+    g_reportedPropertiesRead = reportedPropertiesRead;
+
+    if (MPI_OK != (mpiResult = CallMpiGetManyAsync(reportedPropertiesRead->objects, ReportedPropertiesReadComplete, reportedPropertiesRead, GetLog())))
+    {
+        // Not submitted, so completed here the same way
+        ReportedPropertiesReadComplete(mpiResult, NULL, 0, reportedPropertiesRead);
+    }
+
+    return IOTHUB_CLIENT_OK;
 }
 
 IOTHUB_CLIENT_RESULT UpdatePropertyFromIotHub(const char* componentName, const char* propertyName, const JSON_Value* propertyValue, int version)
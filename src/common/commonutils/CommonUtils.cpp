@@ -87,154 +87,155 @@ bool IsValidClientName(const char* name)
     return isValid;
 }
 
-bool IsValidMimObjectPayload(const char* payload, const int payloadSizeBytes, void* log)
+// Validates a MIM object payload against the generic MIM object schema while the payload is parsed (SAX), without building a document.
+// The payload is one of: string, integer, boolean, object, array of objects, string array, integer array, string map or integer map.
+// Object values are string, integer, boolean, string or integer array, string or integer map, and only map values can be null
+class MimObjectPayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, MimObjectPayloadHandler>
 {
-    if ((0 == payloadSizeBytes) || (nullptr == payload))
+public:
+    enum Kind
     {
-      return false;
-    }
+        StringKind = 0x01,
+        IntegerKind = 0x02,
+        BooleanKind = 0x04,
+        NullKind = 0x08,
+        ArrayKind = 0x10,
+        ObjectKind = 0x20
+    };
+
+    MimObjectPayloadHandler() : m_invalid(false) {}
+
+    bool IsInvalid() const { return m_invalid; }
+
+    bool Null() { return Value(NullKind); }
+    bool Bool(bool) { return Value(BooleanKind); }
+    bool Int(int) { return Value(IntegerKind); }
+    bool Uint(unsigned) { return Value(IntegerKind); }
+    bool Int64(int64_t) { return Value(IntegerKind); }
+    bool Uint64(uint64_t) { return Value(IntegerKind); }
+    bool Double(double) { return Invalid(); }
+    bool RawNumber(const char*, rapidjson::SizeType, bool) { return Invalid(); }
+    bool String(const char*, rapidjson::SizeType, bool) { return Value(StringKind); }
+    bool Key(const char*, rapidjson::SizeType, bool) { return true; }
+    bool StartObject() { return Start(ObjectKind); }
+    bool EndObject(rapidjson::SizeType) { return End(); }
+    bool StartArray() { return Start(ArrayKind); }
+    bool EndArray(rapidjson::SizeType) { return End(); }
+
+private:
+    struct Container
+    {
+        Kind kind;
+        int allowed;
+        int found;
+    };
 
-    bool isValid = true;
+    std::vector<Container> m_containers;
+    bool m_invalid;
 
-    const char schemaJson[] = R"""({
-      "$schema": "http://json-schema.org/draft-04/schema#",
-      "description": "MIM object JSON payload schema",
-      "definitions": {
-        "string": {
-          "type": "string"
-        },
-        "integer": {
-          "type": "integer"
-        },
-        "boolean": {
-          "type": "boolean"
-        },
-        "integerEnumeration": {
-          "type": "integer"
-        },
-        "stringEnumeration": {
-          "type": "string"
-        },
-        "stringArray": {
-          "type": "array",
-          "items": {
-            "type": "string"
-          }
-        },
-        "integerArray": {
-          "type": "array",
-          "items": {
-            "type": "integer"
-          }
-        },
-        "stringMap": {
-          "type": "object",
-          "additionalProperties": {
-            "type": ["string", "null"]
-          }
-        },
-        "integerMap": {
-          "type": "object",
-          "additionalProperties": {
-            "type": ["integer", "null"]
-          }
-        },
-        "object": {
-          "type": "object",
-          "additionalProperties": {
-            "anyOf": [
-              {
-                "$ref": "#/definitions/string"
-              },
-              {
-                "$ref": "#/definitions/integer"
-              },
-              {
-                "$ref": "#/definitions/boolean"
-              },
-              {
-                "$ref": "#/definitions/integerEnumeration"
-              },
-              {
-                "$ref": "#/definitions/stringEnumeration"
-              },
-              {
-                "$ref": "#/definitions/stringArray"
-              },
-              {
-                "$ref": "#/definitions/integerArray"
-              },
-              {
-                "$ref": "#/definitions/stringMap"
-              },
-              {
-                "$ref": "#/definitions/integerMap"
-              }
-            ]
-          }
-        },
-        "objectArray": {
-          "type": "array",
-          "items": {
-            "$ref": "#/definitions/object"
-          }
-        }
-      },
-      "anyOf": [
-        {
-          "$ref": "#/definitions/string"
-        },
-        {
-          "$ref": "#/definitions/integer"
-        },
-        {
-          "$ref": "#/definitions/boolean"
-        },
+    bool Invalid()
+    {
+        m_invalid = true;
+        return false;
+    }
+
+    bool Value(Kind kind)
+    {
+        if (m_containers.empty())
         {
-          "$ref": "#/definitions/object"
-        },
+            return ((StringKind == kind) || (IntegerKind == kind) || (BooleanKind == kind)) ? true : Invalid();
+        }
+
+        Container& parent = m_containers.back();
+
+        if (0 == (parent.allowed & kind))
         {
-          "$ref": "#/definitions/objectArray"
-        },
+            return Invalid();
+        }
+
+        parent.found |= kind;
+        return true;
+    }
+
+    bool Start(Kind kind)
+    {
+        int allowed = 0;
+
+        if (m_containers.empty())
         {
-          "$ref": "#/definitions/stringArray"
-        },
+            // Object: an object, string map or integer map. Array: an array of objects, string array or integer array
+            allowed = (ObjectKind == kind) ? (StringKind | IntegerKind | BooleanKind | NullKind | ArrayKind | ObjectKind) : (StringKind | IntegerKind | ObjectKind);
+        }
+        else if (!Value(kind))
         {
-          "$ref": "#/definitions/integerArray"
-        },
+            return false;
+        }
+        else if ((1 == m_containers.size()) && (ArrayKind == m_containers.back().kind))
         {
-          "$ref": "#/definitions/stringMap"
-        },
+            // The objects of an array of objects
+            allowed = StringKind | IntegerKind | BooleanKind | ArrayKind | ObjectKind;
+        }
+        else
         {
-          "$ref": "#/definitions/integerMap"
+            // The arrays and maps that are object values
+            allowed = (ObjectKind == kind) ? (StringKind | IntegerKind | NullKind) : (StringKind | IntegerKind);
         }
-      ]
-    })""";
 
-    rapidjson::Document sd;
-    sd.Parse(schemaJson);
-    rapidjson::SchemaDocument schema(sd);
-    rapidjson::Document document;
+        m_containers.push_back({kind, allowed, 0});
+        return true;
+    }
 
-    if (document.Parse(payload, payloadSizeBytes).HasParseError())
+    bool End()
     {
-        if (IsFullLoggingEnabled())
+        Container container = m_containers.back();
+        int found = container.found & ~NullKind;
+        bool isMap = (ObjectKind == container.kind) && ((0 != (container.found & NullKind)) || (0 == (container.allowed & BooleanKind)));
+
+        m_containers.pop_back();
+
+        if (ArrayKind == container.kind)
         {
-            OsConfigLogError(log, "MIM object JSON payload pcannot be parsed");
+            // The elements of an array are all of one kind
+            return (0 == (found & (found - 1))) ? true : Invalid();
         }
-        isValid = false;
+        else if (isMap)
+        {
+            // The values of a map are all strings or all integers, or null
+            return ((0 == (found & ~StringKind)) || (0 == (found & ~IntegerKind))) ? true : Invalid();
+        }
+
+        return true;
     }
-    else
+};
+
+bool IsValidMimObjectPayload(const char* payload, const int payloadSizeBytes, void* log)
+{
+    if ((0 >= payloadSizeBytes) || (nullptr == payload))
     {
-        rapidjson::SchemaValidator validator(schema);
-        if (!document.Accept(validator))
+        return false;
+    }
+
+    bool isValid = true;
+
+    rapidjson::MemoryStream memoryStream(payload, payloadSizeBytes);
+    rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> stream(memoryStream);
+    rapidjson::Reader reader;
+    MimObjectPayloadHandler handler;
+
+    if (reader.Parse(stream, handler).IsError())
+    {
+        if (IsFullLoggingEnabled())
         {
-            if (IsFullLoggingEnabled())
+            if (handler.IsInvalid())
             {
                 OsConfigLogError(log, "MIM object JSON payload is invalid according to the schema");
             }
-            isValid = false;
+            else
+            {
+                OsConfigLogError(log, "MIM object JSON payload cannot be parsed");
+            }
         }
+        isValid = false;
     }
 
     if (IsFullLoggingEnabled() && (false == isValid))
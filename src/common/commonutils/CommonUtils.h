@@ -101,6 +101,99 @@ char* ReadUriFromSocket(int socketHandle, void* log);
 int ReadHttpStatusFromSocket(int socketHandle, void* log);
 int ReadHttpContentLengthFromSocket(int socketHandle, void* log);
 
+#define HTTP_MAX_URI_LENGTH 32
+#define HTTP_MAX_HEADER_LENGTH 8192
+
+// Of all the header lines of a message together (and of the trailer lines of a chunked body), from the start of the message.
+// Longer headers, as a longer header line, fail with EMSGSIZE
+#define HTTP_MAX_HEADERS_SIZE 65536
+
+// 16 MB
+#define HTTP_DEFAULT_MAX_CONTENT_LENGTH 16777216
+
+// Buffered reader for one HTTP request or response at a time from a socket
+typedef struct HTTP_PARSER
+{
+    char* buffer;
+    size_t bufferSize;
+    size_t received;
+    size_t lineStart;
+    size_t headerLength;
+    size_t contentLength;
+    size_t maxContentLength;
+    char uri[HTTP_MAX_URI_LENGTH + 1];
+    size_t chunkLength;
+    int httpStatus;
+    bool keepAlive;
+    bool chunked;
+    bool lastChunk;
+    bool startLineParsed;
+    bool complete;
+    char savedByte;
+} HTTP_PARSER;
+
+void InitHttpParser(HTTP_PARSER* parser, size_t maxContentLength);
+void FreeHttpParser(HTTP_PARSER* parser);
+int ParseHttpMessage(HTTP_PARSER* parser, void* log);
+int ReadHttpMessageFromSocket(int socketHandle, HTTP_PARSER* parser, void* log);
+char* GetHttpBody(HTTP_PARSER* parser);
+void ConsumeHttpMessage(HTTP_PARSER* parser);
+char* DetachHttpBody(HTTP_PARSER* parser, int* bodySize);
+int ReadHttpChunkFromSocket(int socketHandle, HTTP_PARSER* parser, char** chunk, size_t* chunkSize, void* log);
+
+// A piece of JSON text inside a larger buffer, not null terminated
+typedef struct JSON_SPAN
+{
+    const char* data;
+    size_t length;
+} JSON_SPAN;
+
+// Validates and skips over one JSON value starting at *offset (leading whitespace allowed), without building a document
+int SkipJsonValue(const char* json, size_t length, size_t* offset);
+
+// Iterates the members of a JSON object, start with *offset at 0; returns 0 with the next member, ENOENT past the last
+// member or EINVAL for invalid JSON. Member names are returned as they appear in the text, without the quotes
+int GetNextJsonObjectMember(const char* json, size_t length, size_t* offset, JSON_SPAN* name, JSON_SPAN* value);
+int FindJsonObjectMember(const char* json, size_t length, const char* name, JSON_SPAN* value);
+
+// Iterates the elements of a JSON array the same way, ENOENT past the last element
+int GetNextJsonArrayElement(const char* json, size_t length, size_t* offset, JSON_SPAN* value);
+
+// Returns the text of a JSON string value with its escapes decoded, null terminated, to be freed by the caller; NULL when the value is not a
+// JSON string or holds a null character
+char* CopyJsonString(const JSON_SPAN* value);
+
+// Request and response transport over memory shared between two local processes, with an eventfd waking up each side. The
+// memory holds one request and one response, the requester waits for the response before posting its next request.
+// Handed over as the memory, request event and response event descriptors, in this order
+#define SHARED_MEMORY_CHANNEL_DESCRIPTORS 3
+
+typedef struct SHARED_MEMORY_CHANNEL
+{
+    int memoryHandle;
+    int requestEvent;
+    int responseEvent;
+    void* memory;
+    size_t mappedSize;
+    size_t requestCapacity;
+    size_t responseCapacity;
+    unsigned int lastRequest;
+    unsigned int lastResponse;
+} SHARED_MEMORY_CHANNEL;
+
+// The responder creates the channel and hands the three descriptors to the requester, which opens the channel with them
+int CreateSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel, size_t requestCapacity, size_t responseCapacity, void* log);
+int OpenSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel, int memoryHandle, int requestEvent, int responseEvent, void* log);
+void CloseSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel);
+bool IsSharedMemoryChannelOpen(const SHARED_MEMORY_CHANNEL* channel);
+
+// Posting fails with E2BIG when the message does not fit, receiving returns EAGAIN when no new message was posted and
+// otherwise a null terminated copy of the message that the caller frees
+int PostSharedMemoryRequest(SHARED_MEMORY_CHANNEL* channel, const char* name, const char* request, size_t requestSize);
+int ReceiveSharedMemoryRequest(SHARED_MEMORY_CHANNEL* channel, char name[HTTP_MAX_URI_LENGTH + 1], char** request, size_t* requestSize);
+int PostSharedMemoryResponse(SHARED_MEMORY_CHANNEL* channel, int responseStatus, const char* response, size_t responseSize);
+int ReceiveSharedMemoryResponse(SHARED_MEMORY_CHANNEL* channel, int* responseStatus, char** response, size_t* responseSize);
+
 int SleepMilliseconds(long milliseconds);
 
 bool IsDaemonActive(const char* name, void* log);
@@ -123,6 +216,15 @@ int GetReportingIntervalFromJsonConfig(const char* jsonString, void* log);
 int GetModelVersionFromJsonConfig(const char* jsonString, void* log);
 int GetLocalManagementFromJsonConfig(const char* jsonString, void* log);
 int GetIotHubProtocolFromJsonConfig(const char* jsonString, void* log);
+int GetMpiServerWorkersFromJsonConfig(const char* jsonString, void* log);
+int GetMaxHttpContentLengthFromJsonConfig(const char* jsonString, void* log);
+int GetSharedMemoryTransportFromJsonConfig(const char* jsonString, void* log);
+int GetModuleIdleUnloadSecondsFromJsonConfig(const char* jsonString, void* log);
+int GetReportedObjectTimeoutFromJsonConfig(const char* jsonString, void* log);
+int GetModuleCallTimeoutFromJsonConfig(const char* jsonString, void* log);
+int GetPrettyPrintReportedFromJsonConfig(const char* jsonString, void* log);
+int GetParallelDesiredFromJsonConfig(const char* jsonString, void* log);
+int GetModuleHostFromJsonConfig(const char* jsonString, void* log);
 int LoadReportedFromJsonConfig(const char* jsonString, REPORTED_PROPERTY** reportedProperties, void* log);
 
 #ifdef __cplusplus
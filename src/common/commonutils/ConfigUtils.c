@@ -21,6 +21,31 @@
 
 #define PROTOCOL "IotHubProtocol"
 
+#define MPI_SERVER_WORKERS "MpiServerWorkers"
+#define MIN_MPI_SERVER_WORKERS 1
+#define MAX_MPI_SERVER_WORKERS 64
+
+#define MAX_HTTP_CONTENT_LENGTH "MaxHttpContentLength"
+#define MIN_MAX_HTTP_CONTENT_LENGTH 1024
+#define MAX_MAX_HTTP_CONTENT_LENGTH 268435456
+
+#define SHARED_MEMORY_TRANSPORT "SharedMemoryTransport"
+
+#define MODULE_IDLE_UNLOAD_SECONDS "ModuleIdleUnloadSeconds"
+#define MAX_MODULE_IDLE_UNLOAD_SECONDS 86400
+
+#define REPORTED_OBJECT_TIMEOUT_MILLISECONDS "ReportedObjectTimeoutMilliseconds"
+#define MAX_REPORTED_OBJECT_TIMEOUT_MILLISECONDS 3600000
+
+#define MODULE_CALL_TIMEOUT_MILLISECONDS "ModuleCallTimeoutMilliseconds"
+#define MAX_MODULE_CALL_TIMEOUT_MILLISECONDS 3600000
+
+#define PRETTY_PRINT_REPORTED "PrettyPrintReported"
+
+#define PARALLEL_DESIRED "ParallelDesired"
+
+#define MODULE_HOST "ModuleHost"
+
 #define MIN_DEVICE_MODEL_ID 7
 #define MAX_DEVICE_MODEL_ID 999
 
@@ -154,6 +179,59 @@ int GetIotHubProtocolFromJsonConfig(const char* jsonString, void* log)
     return GetIntegerFromJsonConfig(PROTOCOL, jsonString, PROTOCOL_AUTO, PROTOCOL_AUTO, PROTOCOL_MQTT_WS, log);
 }
 
+int GetMpiServerWorkersFromJsonConfig(const char* jsonString, void* log)
+{
+    // By default one MPI request worker per online processor
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int defaultWorkers = (processors < MIN_MPI_SERVER_WORKERS) ? MIN_MPI_SERVER_WORKERS : ((processors > MAX_MPI_SERVER_WORKERS) ? MAX_MPI_SERVER_WORKERS : (int)processors);
+
+    return GetIntegerFromJsonConfig(MPI_SERVER_WORKERS, jsonString, defaultWorkers, MIN_MPI_SERVER_WORKERS, MAX_MPI_SERVER_WORKERS, log);
+}
+
+int GetMaxHttpContentLengthFromJsonConfig(const char* jsonString, void* log)
+{
+    return GetIntegerFromJsonConfig(MAX_HTTP_CONTENT_LENGTH, jsonString, HTTP_DEFAULT_MAX_CONTENT_LENGTH, MIN_MAX_HTTP_CONTENT_LENGTH, MAX_MAX_HTTP_CONTENT_LENGTH, log);
+}
+
+int GetSharedMemoryTransportFromJsonConfig(const char* jsonString, void* log)
+{
+    return GetIntegerFromJsonConfig(SHARED_MEMORY_TRANSPORT, jsonString, 0, 0, 1, log);
+}
+
+int GetModuleIdleUnloadSecondsFromJsonConfig(const char* jsonString, void* log)
+{
+    // By default modules stay loaded
+    return GetIntegerFromJsonConfig(MODULE_IDLE_UNLOAD_SECONDS, jsonString, 0, 0, MAX_MODULE_IDLE_UNLOAD_SECONDS, log);
+}
+
+int GetReportedObjectTimeoutFromJsonConfig(const char* jsonString, void* log)
+{
+    // By default there is no time limit
+    return GetIntegerFromJsonConfig(REPORTED_OBJECT_TIMEOUT_MILLISECONDS, jsonString, 0, 0, MAX_REPORTED_OBJECT_TIMEOUT_MILLISECONDS, log);
+}
+
+int GetModuleCallTimeoutFromJsonConfig(const char* jsonString, void* log)
+{
+    // By default MMI calls run on the calling thread with no time limit
+    return GetIntegerFromJsonConfig(MODULE_CALL_TIMEOUT_MILLISECONDS, jsonString, 0, 0, MAX_MODULE_CALL_TIMEOUT_MILLISECONDS, log);
+}
+
+int GetPrettyPrintReportedFromJsonConfig(const char* jsonString, void* log)
+{
+    return GetIntegerFromJsonConfig(PRETTY_PRINT_REPORTED, jsonString, 0, 0, 1, log);
+}
+
+int GetParallelDesiredFromJsonConfig(const char* jsonString, void* log)
+{
+    return GetIntegerFromJsonConfig(PARALLEL_DESIRED, jsonString, 0, 0, 1, log);
+}
+
+int GetModuleHostFromJsonConfig(const char* jsonString, void* log)
+{
+    // By default modules are loaded into the platform process
+    return GetIntegerFromJsonConfig(MODULE_HOST, jsonString, 0, 0, 1, log);
+}
+
 int LoadReportedFromJsonConfig(const char* jsonString, REPORTED_PROPERTY** reportedProperties, void* log)
 {
     JSON_Value* rootValue = NULL;
@@ -38,7 +38,9 @@
 #include <string>
 #include <regex>
 #include <rapidjson/document.h>
-#include <rapidjson/schema.h>
+#include <rapidjson/encodedstream.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 
 #endif //__cplusplus
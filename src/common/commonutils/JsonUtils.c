@@ -0,0 +1,519 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Internal.h"
+
+// Deeper documents are rejected instead of risking the stack while skipping over them
+#define MAX_JSON_NESTING_DEPTH 512
+
+static bool IsJsonWhitespace(char c)
+{
+    return ((' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c));
+}
+
+static bool IsJsonDigit(char c)
+{
+    return (('0' <= c) && ('9' >= c));
+}
+
+static bool IsJsonHexDigit(char c)
+{
+    return (IsJsonDigit(c) || (('a' <= c) && ('f' >= c)) || (('A' <= c) && ('F' >= c)));
+}
+
+static size_t SkipJsonWhitespace(const char* json, size_t length, size_t offset)
+{
+    while ((offset < length) && IsJsonWhitespace(json[offset]))
+    {
+        offset += 1;
+    }
+
+    return offset;
+}
+
+// On entry json[*offset] is the opening quote, on success *offset is past the closing quote
+static int SkipJsonString(const char* json, size_t length, size_t* offset)
+{
+    size_t i = *offset + 1;
+    int j = 0;
+
+    while (i < length)
+    {
+        if ('"' == json[i])
+        {
+            *offset = i + 1;
+            return 0;
+        }
+        else if ((unsigned char)json[i] < 0x20)
+        {
+            return EINVAL;
+        }
+        else if ('\\' == json[i])
+        {
+            if (++i >= length)
+            {
+                return EINVAL;
+            }
+            else if ('u' == json[i])
+            {
+                for (j = 0; j < 4; j++)
+                {
+                    if ((++i >= length) || (!IsJsonHexDigit(json[i])))
+                    {
+                        return EINVAL;
+                    }
+                }
+            }
+            else if (NULL == strchr("\"\\/bfnrt", json[i]))
+            {
+                return EINVAL;
+            }
+        }
+
+        i += 1;
+    }
+
+    return EINVAL;
+}
+
+static int SkipJsonNumber(const char* json, size_t length, size_t* offset)
+{
+    size_t i = *offset;
+    size_t start = 0;
+
+    if ((i < length) && ('-' == json[i]))
+    {
+        i += 1;
+    }
+
+    if ((i < length) && ('0' == json[i]))
+    {
+        i += 1;
+    }
+    else if ((i < length) && IsJsonDigit(json[i]))
+    {
+        while ((i < length) && IsJsonDigit(json[i]))
+        {
+            i += 1;
+        }
+    }
+    else
+    {
+        return EINVAL;
+    }
+
+    if ((i < length) && ('.' == json[i]))
+    {
+        start = ++i;
+        while ((i < length) && IsJsonDigit(json[i]))
+        {
+            i += 1;
+        }
+
+        if (start == i)
+        {
+            return EINVAL;
+        }
+    }
+
+    if ((i < length) && (('e' == json[i]) || ('E' == json[i])))
+    {
+        i += 1;
+        if ((i < length) && (('+' == json[i]) || ('-' == json[i])))
+        {
+            i += 1;
+        }
+
+        start = i;
+        while ((i < length) && IsJsonDigit(json[i]))
+        {
+            i += 1;
+        }
+
+        if (start == i)
+        {
+            return EINVAL;
+        }
+    }
+
+    *offset = i;
+    return 0;
+}
+
+static int SkipJsonLiteral(const char* json, size_t length, size_t* offset, const char* literal)
+{
+    size_t literalLength = strlen(literal);
+
+    if (((length - *offset) < literalLength) || (0 != strncmp(json + *offset, literal, literalLength)))
+    {
+        return EINVAL;
+    }
+
+    *offset += literalLength;
+    return 0;
+}
+
+static int SkipJsonValueAtDepth(const char* json, size_t length, size_t* offset, int depth)
+{
+    size_t i = SkipJsonWhitespace(json, length, *offset);
+    char closing = 0;
+    int status = 0;
+
+    if (i >= length)
+    {
+        return EINVAL;
+    }
+
+    switch (json[i])
+    {
+        case '"':
+            status = SkipJsonString(json, length, &i);
+            break;
+
+        case 't':
+            status = SkipJsonLiteral(json, length, &i, "true");
+            break;
+
+        case 'f':
+            status = SkipJsonLiteral(json, length, &i, "false");
+            break;
+
+        case 'n':
+            status = SkipJsonLiteral(json, length, &i, "null");
+            break;
+
+        case '{':
+        case '[':
+            if (depth >= MAX_JSON_NESTING_DEPTH)
+            {
+                return EINVAL;
+            }
+
+            closing = ('{' == json[i]) ? '}' : ']';
+            i = SkipJsonWhitespace(json, length, i + 1);
+
+            if ((i < length) && (closing == json[i]))
+            {
+                i += 1;
+                break;
+            }
+
+            while (0 == status)
+            {
+                if ('}' == closing)
+                {
+                    if ((i >= length) || ('"' != json[i]) || (0 != SkipJsonString(json, length, &i)))
+                    {
+                        return EINVAL;
+                    }
+
+                    i = SkipJsonWhitespace(json, length, i);
+                    if ((i >= length) || (':' != json[i]))
+                    {
+                        return EINVAL;
+                    }
+
+                    i += 1;
+                }
+
+                if (0 != (status = SkipJsonValueAtDepth(json, length, &i, depth + 1)))
+                {
+                    break;
+                }
+
+                i = SkipJsonWhitespace(json, length, i);
+                if ((i < length) && (',' == json[i]))
+                {
+                    i = SkipJsonWhitespace(json, length, i + 1);
+                }
+                else if ((i < length) && (closing == json[i]))
+                {
+                    i += 1;
+                    break;
+                }
+                else
+                {
+                    status = EINVAL;
+                }
+            }
+            break;
+
+        default:
+            status = SkipJsonNumber(json, length, &i);
+    }
+
+    if (0 == status)
+    {
+        *offset = i;
+    }
+
+    return status;
+}
+
+int SkipJsonValue(const char* json, size_t length, size_t* offset)
+{
+    if ((NULL == json) || (NULL == offset) || (*offset > length))
+    {
+        return EINVAL;
+    }
+
+    return SkipJsonValueAtDepth(json, length, offset, 0);
+}
+
+int GetNextJsonObjectMember(const char* json, size_t length, size_t* offset, JSON_SPAN* name, JSON_SPAN* value)
+{
+    size_t i = 0;
+    size_t start = 0;
+
+    if ((NULL == json) || (NULL == offset) || (NULL == name) || (NULL == value) || (*offset > length))
+    {
+        return EINVAL;
+    }
+
+    i = SkipJsonWhitespace(json, length, *offset);
+
+    if (0 == *offset)
+    {
+        if ((i >= length) || ('{' != json[i]))
+        {
+            return EINVAL;
+        }
+
+        i = SkipJsonWhitespace(json, length, i + 1);
+    }
+    else if ((i < length) && (',' == json[i]))
+    {
+        i = SkipJsonWhitespace(json, length, i + 1);
+        if ((i >= length) || ('"' != json[i]))
+        {
+            return EINVAL;
+        }
+    }
+    else if ((i >= length) || ('}' != json[i]))
+    {
+        return EINVAL;
+    }
+
+    if ((i < length) && ('}' == json[i]))
+    {
+        // Only whitespace may follow the object, a terminating null character ends the text the same way
+        i = SkipJsonWhitespace(json, length, i + 1);
+        *offset = i;
+        return ((i == length) || ('\0' == json[i])) ? ENOENT : EINVAL;
+    }
+
+    start = i;
+    if ((i >= length) || ('"' != json[i]) || (0 != SkipJsonString(json, length, &i)))
+    {
+        return EINVAL;
+    }
+
+    name->data = json + start + 1;
+    name->length = i - start - 2;
+
+    i = SkipJsonWhitespace(json, length, i);
+    if ((i >= length) || (':' != json[i]))
+    {
+        return EINVAL;
+    }
+
+    start = SkipJsonWhitespace(json, length, i + 1);
+    i = start;
+    if (0 != SkipJsonValue(json, length, &i))
+    {
+        return EINVAL;
+    }
+
+    value->data = json + start;
+    value->length = i - start;
+    *offset = i;
+
+    return 0;
+}
+
+int GetNextJsonArrayElement(const char* json, size_t length, size_t* offset, JSON_SPAN* value)
+{
+    size_t i = 0;
+    size_t start = 0;
+    bool end = false;
+
+    if ((NULL == json) || (NULL == offset) || (NULL == value) || (*offset > length))
+    {
+        return EINVAL;
+    }
+
+    i = SkipJsonWhitespace(json, length, *offset);
+
+    if (0 == *offset)
+    {
+        if ((i >= length) || ('[' != json[i]))
+        {
+            return EINVAL;
+        }
+
+        i = SkipJsonWhitespace(json, length, i + 1);
+        end = (i < length) && (']' == json[i]);
+    }
+    else if ((i < length) && (',' == json[i]))
+    {
+        i = SkipJsonWhitespace(json, length, i + 1);
+    }
+    else if ((i < length) && (']' == json[i]))
+    {
+        end = true;
+    }
+    else
+    {
+        return EINVAL;
+    }
+
+    if (end)
+    {
+        // Only whitespace may follow the array, a terminating null character ends the text the same way
+        i = SkipJsonWhitespace(json, length, i + 1);
+        *offset = i;
+        return ((i == length) || ('\0' == json[i])) ? ENOENT : EINVAL;
+    }
+
+    start = i;
+    if (0 != SkipJsonValue(json, length, &i))
+    {
+        return EINVAL;
+    }
+
+    value->data = json + start;
+    value->length = i - start;
+    *offset = i;
+
+    return 0;
+}
+
+int FindJsonObjectMember(const char* json, size_t length, const char* name, JSON_SPAN* value)
+{
+    JSON_SPAN memberName = {0};
+    JSON_SPAN memberValue = {0};
+    size_t offset = 0;
+    size_t nameLength = 0;
+    int status = 0;
+
+    if ((NULL == name) || (NULL == value))
+    {
+        return EINVAL;
+    }
+
+    nameLength = strlen(name);
+
+    while (0 == (status = GetNextJsonObjectMember(json, length, &offset, &memberName, &memberValue)))
+    {
+        if ((memberName.length == nameLength) && (0 == strncmp(memberName.data, name, nameLength)))
+        {
+            *value = memberValue;
+            return 0;
+        }
+    }
+
+    return status;
+}
+
+static unsigned int GetJsonHexValue(const char* hex)
+{
+    unsigned int value = 0;
+    int i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        value = (value << 4) | (unsigned int)(IsJsonDigit(hex[i]) ? (hex[i] - '0') : ((tolower(hex[i]) - 'a') + 10));
+    }
+
+    return value;
+}
+
+// Writes the code point as UTF-8, returns the number of bytes written
+static size_t WriteUtf8(unsigned int codePoint, char* output)
+{
+    if (codePoint < 0x80)
+    {
+        output[0] = (char)codePoint;
+        return 1;
+    }
+    else if (codePoint < 0x800)
+    {
+        output[0] = (char)(0xC0 | (codePoint >> 6));
+        output[1] = (char)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    else if (codePoint < 0x10000)
+    {
+        output[0] = (char)(0xE0 | (codePoint >> 12));
+        output[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        output[2] = (char)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+
+    output[0] = (char)(0xF0 | (codePoint >> 18));
+    output[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+    output[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+    output[3] = (char)(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+char* CopyJsonString(const JSON_SPAN* value)
+{
+    const char* escapes = "\"\\/bfnrt";
+    const char* decoded = "\"\\/\b\f\n\r\t";
+    char* string = NULL;
+    size_t offset = 0;
+    size_t length = 0;
+    size_t i = 0;
+    unsigned int codePoint = 0;
+    unsigned int lowSurrogate = 0;
+
+    if ((NULL == value) || (NULL == value->data) || (value->length < 2) || ('"' != value->data[0]) ||
+        (0 != SkipJsonString(value->data, value->length, &offset)) || (offset != value->length))
+    {
+        return NULL;
+    }
+
+    // Decoded text is never longer than the escaped text, each escape sequence is at least as long as its UTF-8
+    if (NULL == (string = (char*)malloc(value->length - 1)))
+    {
+        return NULL;
+    }
+
+    for (i = 1; i < (value->length - 1); i++)
+    {
+        if ('\\' != value->data[i])
+        {
+            string[length++] = value->data[i];
+        }
+        else if ('u' != value->data[++i])
+        {
+            string[length++] = decoded[strchr(escapes, value->data[i]) - escapes];
+        }
+        else
+        {
+            codePoint = GetJsonHexValue(value->data + i + 1);
+            i += 4;
+
+            // A surrogate pair escapes one code point outside of the basic multilingual plane
+            if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF) && ((i + 6) < value->length) && ('\\' == value->data[i + 1]) && ('u' == value->data[i + 2]) &&
+                ((lowSurrogate = GetJsonHexValue(value->data + i + 3)) >= 0xDC00) && (lowSurrogate <= 0xDFFF))
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                i += 6;
+            }
+
+            if (0 == codePoint)
+            {
+                free(string);
+                return NULL;
+            }
+
+            length += WriteUtf8(codePoint, string + length);
+        }
+    }
+
+    string[length] = 0;
+
+    return string;
+}
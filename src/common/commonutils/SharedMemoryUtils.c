@@ -0,0 +1,308 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Internal.h"
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#if ((__GLIBC__ == 2) && (__GLIBC_MINOR__ < 27))
+#include <sys/syscall.h>
+#define memfd_create(name, flags) syscall(SYS_memfd_create, name, flags)
+#endif
+
+#ifndef MFD_ALLOW_SEALING
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+#define SHARED_MEMORY_MAGIC 0x4D50494DU
+#define SHARED_MEMORY_HEADER_SIZE 4096
+
+// Describes the message last posted in one direction, the message itself follows in the data area of that direction
+typedef struct SHARED_MEMORY_MESSAGE
+{
+    uint32_t sequence;
+    uint32_t length;
+    int32_t status;
+    char name[HTTP_MAX_URI_LENGTH + 1];
+} SHARED_MEMORY_MESSAGE;
+
+// At the start of the shared memory, followed (at SHARED_MEMORY_HEADER_SIZE) by the request and then the response data areas
+typedef struct SHARED_MEMORY_HEADER
+{
+    uint32_t magic;
+    uint32_t requestCapacity;
+    uint32_t responseCapacity;
+    SHARED_MEMORY_MESSAGE request;
+    SHARED_MEMORY_MESSAGE response;
+} SHARED_MEMORY_HEADER;
+
+static void InitSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel)
+{
+    memset(channel, 0, sizeof(SHARED_MEMORY_CHANNEL));
+    channel->memoryHandle = -1;
+    channel->requestEvent = -1;
+    channel->responseEvent = -1;
+}
+
+int CreateSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel, size_t requestCapacity, size_t responseCapacity, void* log)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+    int status = 0;
+
+    if ((NULL == channel) || (0 == requestCapacity) || (0 == responseCapacity) || (requestCapacity > UINT32_MAX) || (responseCapacity > UINT32_MAX))
+    {
+        OsConfigLogError(log, "CreateSharedMemoryChannel: invalid arguments");
+        return EINVAL;
+    }
+
+    InitSharedMemoryChannel(channel);
+    channel->mappedSize = SHARED_MEMORY_HEADER_SIZE + requestCapacity + responseCapacity;
+
+    // The size is sealed so that the other process cannot truncate the memory under this one; pages are only allocated when touched
+    if ((0 > (channel->memoryHandle = memfd_create("osconfig-mpi", MFD_CLOEXEC | MFD_ALLOW_SEALING))) ||
+        (0 != ftruncate(channel->memoryHandle, (off_t)channel->mappedSize)) ||
+        (0 != fcntl(channel->memoryHandle, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) ||
+        (0 > (channel->requestEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))) ||
+        (0 > (channel->responseEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))) ||
+        (MAP_FAILED == (channel->memory = mmap(NULL, channel->mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, channel->memoryHandle, 0))))
+    {
+        status = errno ? errno : ENOMEM;
+        OsConfigLogError(log, "CreateSharedMemoryChannel: failed to set up %u bytes of shared memory (%d)", (unsigned int)channel->mappedSize, status);
+        channel->memory = NULL;
+        CloseSharedMemoryChannel(channel);
+        return status;
+    }
+
+    header = (SHARED_MEMORY_HEADER*)channel->memory;
+    header->magic = SHARED_MEMORY_MAGIC;
+    header->requestCapacity = (uint32_t)requestCapacity;
+    header->responseCapacity = (uint32_t)responseCapacity;
+
+    channel->requestCapacity = requestCapacity;
+    channel->responseCapacity = responseCapacity;
+
+    return status;
+}
+
+int OpenSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel, int memoryHandle, int requestEvent, int responseEvent, void* log)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+    struct stat memoryStat = {0};
+    int status = 0;
+
+    if ((NULL == channel) || (0 > memoryHandle) || (0 > requestEvent) || (0 > responseEvent))
+    {
+        OsConfigLogError(log, "OpenSharedMemoryChannel: invalid arguments");
+        return EINVAL;
+    }
+
+    InitSharedMemoryChannel(channel);
+    channel->memoryHandle = memoryHandle;
+    channel->requestEvent = requestEvent;
+    channel->responseEvent = responseEvent;
+
+    if ((0 != fstat(memoryHandle, &memoryStat)) || (memoryStat.st_size <= SHARED_MEMORY_HEADER_SIZE))
+    {
+        status = EINVAL;
+    }
+    else if (MAP_FAILED == (channel->memory = mmap(NULL, (size_t)memoryStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, memoryHandle, 0)))
+    {
+        channel->memory = NULL;
+        status = errno ? errno : ENOMEM;
+    }
+    else
+    {
+        channel->mappedSize = (size_t)memoryStat.st_size;
+        header = (SHARED_MEMORY_HEADER*)channel->memory;
+
+        if ((SHARED_MEMORY_MAGIC != header->magic) || (channel->mappedSize < (SHARED_MEMORY_HEADER_SIZE + (size_t)header->requestCapacity + (size_t)header->responseCapacity)))
+        {
+            status = EINVAL;
+        }
+        else
+        {
+            channel->requestCapacity = header->requestCapacity;
+            channel->responseCapacity = header->responseCapacity;
+        }
+    }
+
+    if (0 != status)
+    {
+        OsConfigLogError(log, "OpenSharedMemoryChannel: invalid shared memory (%d)", status);
+        CloseSharedMemoryChannel(channel);
+    }
+
+    return status;
+}
+
+void CloseSharedMemoryChannel(SHARED_MEMORY_CHANNEL* channel)
+{
+    if (NULL == channel)
+    {
+        return;
+    }
+
+    if (NULL != channel->memory)
+    {
+        munmap(channel->memory, channel->mappedSize);
+    }
+
+    if (0 <= channel->memoryHandle)
+    {
+        close(channel->memoryHandle);
+    }
+
+    if (0 <= channel->requestEvent)
+    {
+        close(channel->requestEvent);
+    }
+
+    if (0 <= channel->responseEvent)
+    {
+        close(channel->responseEvent);
+    }
+
+    InitSharedMemoryChannel(channel);
+}
+
+bool IsSharedMemoryChannelOpen(const SHARED_MEMORY_CHANNEL* channel)
+{
+    return ((NULL != channel) && (NULL != channel->memory));
+}
+
+static int PostSharedMemoryMessage(SHARED_MEMORY_MESSAGE* message, char* area, size_t capacity, int event, const char* name, int messageStatus, const char* data, size_t dataSize)
+{
+    uint64_t wakeup = 1;
+
+    if (dataSize > capacity)
+    {
+        return E2BIG;
+    }
+
+    if ((NULL != data) && (dataSize > 0))
+    {
+        memcpy(area, data, dataSize);
+    }
+
+    memset(message->name, 0, sizeof(message->name));
+    if (NULL != name)
+    {
+        strncpy(message->name, name, sizeof(message->name) - 1);
+    }
+
+    message->length = (uint32_t)dataSize;
+    message->status = (int32_t)messageStatus;
+
+    // The message is complete before the new sequence number makes it visible to the other side
+    __atomic_store_n(&message->sequence, message->sequence + 1, __ATOMIC_RELEASE);
+
+    return (sizeof(wakeup) == write(event, &wakeup, sizeof(wakeup))) ? 0 : (errno ? errno : EIO);
+}
+
+// The other process can write to the shared memory at any time, so the message is validated and copied out before being used
+static int ReceiveSharedMemoryMessage(SHARED_MEMORY_MESSAGE* message, const char* area, size_t capacity, int event, unsigned int* lastSequence, char* name, int* messageStatus, char** data, size_t* dataSize)
+{
+    uint64_t wakeups = 0;
+    unsigned int sequence = 0;
+    size_t length = 0;
+
+    if ((0 > read(event, &wakeups, sizeof(wakeups))) && (EAGAIN != errno))
+    {
+        return errno ? errno : EIO;
+    }
+
+    if ((sequence = __atomic_load_n(&message->sequence, __ATOMIC_ACQUIRE)) == *lastSequence)
+    {
+        return EAGAIN;
+    }
+
+    *lastSequence = sequence;
+
+    if ((length = (size_t)message->length) > capacity)
+    {
+        return EINVAL;
+    }
+
+    if (NULL != name)
+    {
+        memcpy(name, message->name, HTTP_MAX_URI_LENGTH);
+        name[HTTP_MAX_URI_LENGTH] = 0;
+    }
+
+    if (NULL != messageStatus)
+    {
+        *messageStatus = (int)message->status;
+    }
+
+    if (NULL == (*data = (char*)malloc(length + 1)))
+    {
+        return ENOMEM;
+    }
+
+    memcpy(*data, area, length);
+    (*data)[length] = 0;
+    *dataSize = length;
+
+    return 0;
+}
+
+int PostSharedMemoryRequest(SHARED_MEMORY_CHANNEL* channel, const char* name, const char* request, size_t requestSize)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+
+    if (!IsSharedMemoryChannelOpen(channel) || (NULL == name))
+    {
+        return EINVAL;
+    }
+
+    header = (SHARED_MEMORY_HEADER*)channel->memory;
+    return PostSharedMemoryMessage(&header->request, (char*)channel->memory + SHARED_MEMORY_HEADER_SIZE, channel->requestCapacity, channel->requestEvent, name, 0, request, requestSize);
+}
+
+int ReceiveSharedMemoryRequest(SHARED_MEMORY_CHANNEL* channel, char name[HTTP_MAX_URI_LENGTH + 1], char** request, size_t* requestSize)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+
+    if (!IsSharedMemoryChannelOpen(channel) || (NULL == name) || (NULL == request) || (NULL == requestSize))
+    {
+        return EINVAL;
+    }
+
+    header = (SHARED_MEMORY_HEADER*)channel->memory;
+    return ReceiveSharedMemoryMessage(&header->request, (char*)channel->memory + SHARED_MEMORY_HEADER_SIZE, channel->requestCapacity, channel->requestEvent, &channel->lastRequest, name, NULL, request, requestSize);
+}
+
+int PostSharedMemoryResponse(SHARED_MEMORY_CHANNEL* channel, int responseStatus, const char* response, size_t responseSize)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+
+    if (!IsSharedMemoryChannelOpen(channel))
+    {
+        return EINVAL;
+    }
+
+    header = (SHARED_MEMORY_HEADER*)channel->memory;
+    return PostSharedMemoryMessage(&header->response, (char*)channel->memory + SHARED_MEMORY_HEADER_SIZE + channel->requestCapacity, channel->responseCapacity, channel->responseEvent, NULL, responseStatus, response, responseSize);
+}
+
+int ReceiveSharedMemoryResponse(SHARED_MEMORY_CHANNEL* channel, int* responseStatus, char** response, size_t* responseSize)
+{
+    SHARED_MEMORY_HEADER* header = NULL;
+
+    if (!IsSharedMemoryChannelOpen(channel) || (NULL == responseStatus) || (NULL == response) || (NULL == responseSize))
+    {
+        return EINVAL;
+    }
+
+    header = (SHARED_MEMORY_HEADER*)channel->memory;
+    return ReceiveSharedMemoryMessage(&header->response, (char*)channel->memory + SHARED_MEMORY_HEADER_SIZE + channel->requestCapacity, channel->responseCapacity, channel->responseEvent, &channel->lastResponse, NULL, responseStatus, response, responseSize);
+}
@@ -4,12 +4,17 @@
 #include "Internal.h"
 
 #define MAX_MPI_URI_LENGTH 32
+#define HTTP_READ_CHUNK_SIZE 4096
 
+// Reads one byte at a time so that nothing past the string is consumed from the socket, see ReadHttpMessageFromSocket for buffered reading
 static char* ReadUntilStringFound(int socketHandle, const char* what, void* log)
 {
     char* found = NULL;
     char* buffer = NULL;
-    int size = 1;
+    char* newBuffer = NULL;
+    size_t whatLength = 0;
+    size_t bufferSize = HTTP_READ_CHUNK_SIZE;
+    size_t size = 0;
 
     if ((NULL == what) || (socketHandle < 0))
     {
@@ -17,35 +22,38 @@ static char* ReadUntilStringFound(int socketHandle, const char* what, void* log)
         return NULL;
     }
 
-    buffer = (char*)malloc(size + 1);
+    whatLength = strlen(what);
+
+    buffer = (char*)malloc(bufferSize);
     if (NULL == buffer)
     {
         OsConfigLogError(log, "ReadUntilStringFound: out of memory allocating initial buffer");
         return NULL;
     }
 
-    memset(buffer, 0, size + 1);
+    memset(buffer, 0, bufferSize);
 
-    while (1 == read(socketHandle, &(buffer[size - 1]), 1))
+    while (1 == read(socketHandle, &(buffer[size]), 1))
     {
-        if (NULL != (found = strstr(buffer, what)))
+        size += 1;
+        buffer[size] = 0;
+
+        // Only the newest bytes can complete a match
+        if ((size >= whatLength) && (0 == memcmp(&(buffer[size - whatLength]), what, whatLength)))
         {
-            buffer[size] = 0;
+            found = buffer;
             break;
         }
-        else
+
+        if ((size + 1) >= bufferSize)
         {
-            size += 1;
-            buffer = (char*)realloc(buffer, size + 1);
-            if (NULL == buffer)
+            bufferSize *= 2;
+            if (NULL == (newBuffer = (char*)realloc(buffer, bufferSize)))
             {
                 OsConfigLogError(log, "ReadUntilStringFound: out of memory reallocating buffer");
                 break;
             }
-            else
-            {
-                buffer[size] = 0;
-            }
+            buffer = newBuffer;
         }
     }
 
@@ -207,4 +215,520 @@ int ReadHttpContentLengthFromSocket(int socketHandle, void* log)
     }
 
     return httpContentLength;
-}
\ No newline at end of file
+}
+
+void InitHttpParser(HTTP_PARSER* parser, size_t maxContentLength)
+{
+    if (NULL != parser)
+    {
+        memset(parser, 0, sizeof(HTTP_PARSER));
+        parser->maxContentLength = maxContentLength;
+    }
+}
+
+void FreeHttpParser(HTTP_PARSER* parser)
+{
+    if (NULL != parser)
+    {
+        FREE_MEMORY(parser->buffer);
+        InitHttpParser(parser, parser->maxContentLength);
+    }
+}
+
+static bool IsHttpHeader(const char* line, size_t lineLength, const char* name, const char** value)
+{
+    size_t nameLength = strlen(name);
+
+    if ((lineLength > nameLength) && (':' == line[nameLength]) && (0 == strncasecmp(line, name, nameLength)))
+    {
+        *value = line + nameLength + 1;
+
+        while ((' ' == **value) || ('\t' == **value))
+        {
+            *value += 1;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static int ParseHttpStartLine(HTTP_PARSER* parser, const char* line, size_t lineLength)
+{
+    const char* httpVersion = "HTTP/1.";
+    size_t versionLength = strlen(httpVersion);
+    const char* uri = NULL;
+    size_t i = 0;
+
+    if ((lineLength > versionLength) && (0 == strncmp(line, httpVersion, versionLength)))
+    {
+        // Status line of a response, for example 'HTTP/1.1 200 OK'
+        if ((lineLength < versionLength + 5) || (' ' != line[versionLength + 1]) ||
+            (!isdigit(line[versionLength + 2])) || (!isdigit(line[versionLength + 3])) || (!isdigit(line[versionLength + 4])))
+        {
+            return EINVAL;
+        }
+
+        parser->httpStatus = atoi(line + versionLength + 2);
+        parser->keepAlive = ('1' == line[versionLength]);
+    }
+    else
+    {
+        // Request line, for example 'POST /MpiOpen/ HTTP/1.1', of which the URI is kept without slashes
+        if ((NULL == (uri = memchr(line, ' ', lineLength))) || ('/' != uri[1]))
+        {
+            return EINVAL;
+        }
+
+        uri += 2;
+
+        for (i = 0; (i < HTTP_MAX_URI_LENGTH) && ((size_t)(uri + i - line) < lineLength) && isalpha(uri[i]); i++)
+        {
+            parser->uri[i] = uri[i];
+        }
+
+        parser->uri[i] = 0;
+
+        if ((lineLength > versionLength + 1) && (0 == strncmp(line + lineLength - versionLength - 1, httpVersion, versionLength)))
+        {
+            parser->keepAlive = ('1' == line[lineLength - 1]);
+        }
+    }
+
+    return 0;
+}
+
+static int ParseHttpHeaderLine(HTTP_PARSER* parser, const char* line, size_t lineLength, void* log)
+{
+    const char* value = NULL;
+    size_t contentLength = 0;
+
+    if (IsHttpHeader(line, lineLength, "Content-Length", &value))
+    {
+        if (!isdigit(*value))
+        {
+            OsConfigLogError(log, "ParseHttpMessage: invalid Content-Length");
+            return EINVAL;
+        }
+
+        while (isdigit(*value))
+        {
+            contentLength = (contentLength * 10) + (size_t)(*value - '0');
+
+            if (contentLength > parser->maxContentLength)
+            {
+                OsConfigLogError(log, "ParseHttpMessage: Content-Length exceeds the maximum of %u bytes", (unsigned int)parser->maxContentLength);
+                return E2BIG;
+            }
+
+            value += 1;
+        }
+
+        parser->contentLength = contentLength;
+    }
+    else if (IsHttpHeader(line, lineLength, "Transfer-Encoding", &value))
+    {
+        if (0 != strncasecmp(value, "chunked", strlen("chunked")))
+        {
+            OsConfigLogError(log, "ParseHttpMessage: unsupported Transfer-Encoding");
+            return EINVAL;
+        }
+
+        parser->chunked = true;
+    }
+    else if (IsHttpHeader(line, lineLength, "Connection", &value))
+    {
+        if (0 == strncasecmp(value, "close", strlen("close")))
+        {
+            parser->keepAlive = false;
+        }
+        else if (0 == strncasecmp(value, "keep-alive", strlen("keep-alive")))
+        {
+            parser->keepAlive = true;
+        }
+    }
+
+    return 0;
+}
+
+int ParseHttpMessage(HTTP_PARSER* parser, void* log)
+{
+    char* line = NULL;
+    char* lineEnd = NULL;
+    size_t lineLength = 0;
+    size_t messageLength = 0;
+    int status = 0;
+
+    if (NULL == parser)
+    {
+        OsConfigLogError(log, "ParseHttpMessage: invalid argument");
+        return EINVAL;
+    }
+
+    if (parser->complete)
+    {
+        return 0;
+    }
+
+    // Each header line is scanned once as it arrives, resuming where the previous call stopped
+    while ((0 == parser->headerLength) && (parser->lineStart < parser->received))
+    {
+        line = parser->buffer + parser->lineStart;
+
+        if (NULL == (lineEnd = (char*)memchr(line, '\n', parser->received - parser->lineStart)))
+        {
+            break;
+        }
+
+        lineLength = (size_t)(lineEnd - line);
+        if ((lineLength > 0) && ('\r' == line[lineLength - 1]))
+        {
+            lineLength -= 1;
+        }
+
+        parser->lineStart = (size_t)(lineEnd - parser->buffer) + 1;
+
+        // The message starts at the start of the buffer, a client sending header lines without end is cut off here
+        if (parser->lineStart > HTTP_MAX_HEADERS_SIZE)
+        {
+            OsConfigLogError(log, "ParseHttpMessage: headers exceed %d bytes", HTTP_MAX_HEADERS_SIZE);
+            return EMSGSIZE;
+        }
+
+        if (0 == lineLength)
+        {
+            if (!parser->startLineParsed)
+            {
+                return EINVAL;
+            }
+
+            parser->headerLength = parser->lineStart;
+        }
+        else if (!parser->startLineParsed)
+        {
+            status = ParseHttpStartLine(parser, line, lineLength);
+            parser->startLineParsed = true;
+        }
+        else
+        {
+            status = ParseHttpHeaderLine(parser, line, lineLength, log);
+        }
+
+        if (0 != status)
+        {
+            return status;
+        }
+    }
+
+    if (0 == parser->headerLength)
+    {
+        if ((parser->received - parser->lineStart) > HTTP_MAX_HEADER_LENGTH)
+        {
+            OsConfigLogError(log, "ParseHttpMessage: header line exceeds %d bytes", HTTP_MAX_HEADER_LENGTH);
+            return EMSGSIZE;
+        }
+
+        return EAGAIN;
+    }
+
+    // The body of a chunked message is not buffered as a whole, it is read one chunk at a time with ReadHttpChunkFromSocket
+    if (parser->chunked)
+    {
+        parser->contentLength = 0;
+    }
+
+    messageLength = parser->headerLength + parser->contentLength;
+    if (parser->received < messageLength)
+    {
+        return EAGAIN;
+    }
+
+    // Terminates the body in place, the first byte of a message received after this one is restored when the message is consumed
+    parser->savedByte = parser->buffer[messageLength];
+    parser->buffer[messageLength] = 0;
+    parser->complete = true;
+
+    return 0;
+}
+
+static int ReserveHttpBuffer(HTTP_PARSER* parser, size_t size)
+{
+    char* buffer = NULL;
+    size_t bufferSize = parser->bufferSize ? parser->bufferSize : HTTP_READ_CHUNK_SIZE;
+
+    while (bufferSize < size)
+    {
+        bufferSize *= 2;
+    }
+
+    if (bufferSize > parser->bufferSize)
+    {
+        if (NULL == (buffer = (char*)realloc(parser->buffer, bufferSize)))
+        {
+            return ENOMEM;
+        }
+
+        parser->buffer = buffer;
+        parser->bufferSize = bufferSize;
+    }
+
+    return 0;
+}
+
+// Reads once from the socket into the parser buffer, grown to hold at least the wanted number of bytes
+static int ReceiveHttpData(int socketHandle, HTTP_PARSER* parser, size_t wanted, void* log)
+{
+    ssize_t bytes = 0;
+    int status = 0;
+
+    // Keeps room for a null terminator after the received data
+    if (0 != (status = ReserveHttpBuffer(parser, wanted + 1)))
+    {
+        OsConfigLogError(log, "ReceiveHttpData: out of memory reserving %u bytes", (unsigned int)(wanted + 1));
+        return status;
+    }
+
+    do
+    {
+        bytes = read(socketHandle, parser->buffer + parser->received, parser->bufferSize - parser->received - 1);
+    } while ((bytes < 0) && (EINTR == errno));
+
+    if (0 < bytes)
+    {
+        parser->received += (size_t)bytes;
+        parser->buffer[parser->received] = 0;
+    }
+    else
+    {
+        // EAGAIN on a non-blocking socket means that the rest of the message is still to come
+        status = (0 == bytes) ? ECONNRESET : errno;
+    }
+
+    return status;
+}
+
+int ReadHttpMessageFromSocket(int socketHandle, HTTP_PARSER* parser, void* log)
+{
+    size_t wanted = 0;
+    int status = 0;
+
+    if ((socketHandle < 0) || (NULL == parser))
+    {
+        OsConfigLogError(log, "ReadHttpMessageFromSocket: invalid arguments");
+        return EINVAL;
+    }
+
+    while (EAGAIN == (status = ParseHttpMessage(parser, log)))
+    {
+        // Once the header is parsed the whole body is read at once, until then the header is read in chunks
+        wanted = parser->headerLength ? (parser->headerLength + parser->contentLength) : (parser->received + HTTP_READ_CHUNK_SIZE);
+
+        if (0 != (status = ReceiveHttpData(socketHandle, parser, wanted, log)))
+        {
+            break;
+        }
+    }
+
+    return status;
+}
+
+char* GetHttpBody(HTTP_PARSER* parser)
+{
+    return ((NULL != parser) && parser->complete) ? (parser->buffer + parser->headerLength) : NULL;
+}
+
+void ConsumeHttpMessage(HTTP_PARSER* parser)
+{
+    size_t messageLength = 0;
+
+    if ((NULL == parser) || (!parser->complete))
+    {
+        return;
+    }
+
+    messageLength = parser->headerLength + parser->contentLength;
+
+    parser->buffer[messageLength] = parser->savedByte;
+    parser->received -= messageLength;
+    memmove(parser->buffer, parser->buffer + messageLength, parser->received + 1);
+
+    parser->lineStart = 0;
+    parser->headerLength = 0;
+    parser->contentLength = 0;
+    parser->chunkLength = 0;
+    parser->httpStatus = 0;
+    parser->uri[0] = 0;
+    parser->keepAlive = false;
+    parser->chunked = false;
+    parser->lastChunk = false;
+    parser->startLineParsed = false;
+    parser->complete = false;
+}
+
+// Reads from the socket until a complete line starts at the given offset of the buffer, returns the offset after the line
+static int ReadHttpLine(int socketHandle, HTTP_PARSER* parser, size_t start, size_t* lineLength, size_t* nextLine, void* log)
+{
+    char* lineEnd = NULL;
+    int status = 0;
+
+    while (NULL == (lineEnd = (char*)memchr(parser->buffer + start, '\n', parser->received - start)))
+    {
+        if ((parser->received - start) > HTTP_MAX_HEADER_LENGTH)
+        {
+            OsConfigLogError(log, "ReadHttpChunkFromSocket: chunk line exceeds %d bytes", HTTP_MAX_HEADER_LENGTH);
+            return E2BIG;
+        }
+
+        if (0 != (status = ReceiveHttpData(socketHandle, parser, parser->received + HTTP_READ_CHUNK_SIZE, log)))
+        {
+            return status;
+        }
+    }
+
+    *nextLine = (size_t)(lineEnd - parser->buffer) + 1;
+    *lineLength = (size_t)(lineEnd - parser->buffer) - start;
+
+    if ((*lineLength > 0) && ('\r' == parser->buffer[start + *lineLength - 1]))
+    {
+        *lineLength -= 1;
+    }
+
+    return 0;
+}
+
+// Returns the next chunk of the body of a complete message received with 'Transfer-Encoding: chunked', terminated in place and
+// valid until the next call, so that the body is never buffered as a whole; a chunk of size zero ends the body
+int ReadHttpChunkFromSocket(int socketHandle, HTTP_PARSER* parser, char** chunk, size_t* chunkSize, void* log)
+{
+    size_t bodyStart = 0;
+    size_t lineLength = 0;
+    size_t dataStart = 0;
+    size_t dataLength = 0;
+    size_t chunkEnd = 0;
+    char* sizeEnd = NULL;
+    int status = 0;
+
+    if ((socketHandle < 0) || (NULL == parser) || (NULL == chunk) || (NULL == chunkSize) || (!parser->complete) || (!parser->chunked))
+    {
+        OsConfigLogError(log, "ReadHttpChunkFromSocket: invalid arguments");
+        return EINVAL;
+    }
+
+    *chunk = NULL;
+    *chunkSize = 0;
+
+    if (parser->lastChunk)
+    {
+        return 0;
+    }
+
+    bodyStart = parser->headerLength;
+
+    if (0 == parser->chunkLength)
+    {
+        // Restores the first byte after the header, terminated in place by ParseHttpMessage
+        parser->buffer[bodyStart] = parser->savedByte;
+    }
+    else
+    {
+        // Drops the chunk returned by the previous call, including its framing
+        parser->received -= parser->chunkLength;
+        memmove(parser->buffer + bodyStart, parser->buffer + bodyStart + parser->chunkLength, parser->received - bodyStart + 1);
+        parser->chunkLength = 0;
+    }
+
+    // The chunk size line, in hexadecimal, optionally followed by chunk extensions that are ignored
+    if (0 != (status = ReadHttpLine(socketHandle, parser, bodyStart, &lineLength, &dataStart, log)))
+    {
+        return status;
+    }
+
+    if (!isxdigit(parser->buffer[bodyStart]))
+    {
+        OsConfigLogError(log, "ReadHttpChunkFromSocket: invalid chunk size");
+        return EINVAL;
+    }
+
+    errno = 0;
+    dataLength = (size_t)strtoull(parser->buffer + bodyStart, &sizeEnd, 16);
+
+    if ((0 != errno) || (sizeEnd > (parser->buffer + bodyStart + lineLength)) || (dataLength > parser->maxContentLength))
+    {
+        OsConfigLogError(log, "ReadHttpChunkFromSocket: chunk size exceeds the maximum of %u bytes", (unsigned int)parser->maxContentLength);
+        return E2BIG;
+    }
+
+    if (dataLength > 0)
+    {
+        chunkEnd = dataStart + dataLength + 2;
+
+        while (parser->received < chunkEnd)
+        {
+            if (0 != (status = ReceiveHttpData(socketHandle, parser, chunkEnd, log)))
+            {
+                return status;
+            }
+        }
+
+        if (('\r' != parser->buffer[chunkEnd - 2]) || ('\n' != parser->buffer[chunkEnd - 1]))
+        {
+            OsConfigLogError(log, "ReadHttpChunkFromSocket: chunk data not followed by CRLF");
+            return EINVAL;
+        }
+
+        parser->buffer[chunkEnd - 2] = 0;
+        parser->chunkLength = chunkEnd - bodyStart;
+
+        *chunk = parser->buffer + dataStart;
+        *chunkSize = dataLength;
+    }
+    else
+    {
+        // The last chunk is followed by optional trailer fields, which are skipped, and an empty line
+        do
+        {
+            if (0 != (status = ReadHttpLine(socketHandle, parser, dataStart, &lineLength, &chunkEnd, log)))
+            {
+                return status;
+            }
+
+            dataStart = chunkEnd;
+
+            if ((chunkEnd - bodyStart) > HTTP_MAX_HEADERS_SIZE)
+            {
+                OsConfigLogError(log, "ReadHttpChunkFromSocket: trailers exceed %d bytes", HTTP_MAX_HEADERS_SIZE);
+                return EMSGSIZE;
+            }
+        } while (lineLength > 0);
+
+        // Leaves the message as if it had no body, so that it can be consumed as usual
+        parser->received -= (chunkEnd - bodyStart);
+        memmove(parser->buffer + bodyStart, parser->buffer + chunkEnd, parser->received - bodyStart + 1);
+        parser->savedByte = parser->buffer[bodyStart];
+        parser->buffer[bodyStart] = 0;
+        parser->lastChunk = true;
+    }
+
+    return 0;
+}
+
+char* DetachHttpBody(HTTP_PARSER* parser, int* bodySize)
+{
+    char* body = NULL;
+
+    if ((NULL == parser) || (NULL == bodySize) || (!parser->complete))
+    {
+        return NULL;
+    }
+
+    // Hands over the buffer with the body moved to its start, anything received after the message is dropped
+    body = parser->buffer;
+    *bodySize = (int)parser->contentLength;
+    memmove(body, body + parser->headerLength, parser->contentLength + 1);
+
+    parser->buffer = NULL;
+    FreeHttpParser(parser);
+
+    return body;
+}
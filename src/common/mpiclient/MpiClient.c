@@ -6,6 +6,9 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <parson.h>
@@ -16,36 +19,245 @@
 #include "MpiClient.h"
 
 #define MPI_MAX_CONTENT_LENGTH 64
+#define MPI_MAX_SEND_ATTEMPTS 2
 
 #define HTTP_INTERNAL_SERVER_ERROR 500
 
 extern MPI_HANDLE g_mpiHandle;
 
-static int CallMpi(const char* name, const char* request, char** response, int* responseSize, void* log)
+static const char* g_mpiSocket = "/run/osconfig/mpid.sock";
+
+#ifdef TEST_CODE
+void SetMpiClientSocket(const char* socketPath)
+{
+    g_mpiSocket = socketPath;
+}
+#endif
+
+typedef enum MPI_RESPONSE_KIND
+{
+    MpiStatusResponse = 0,
+    MpiObjectResponse,
+    MpiManyResponse
+} MPI_RESPONSE_KIND;
+
+// An asynchronous call from submission to completion, the calls are kept in the order they are submitted. A repeatable
+// call does no harm when the platform serves it twice (MpiGet, MpiGetMany)
+typedef struct MPI_ASYNC_CALL
+{
+    const char* name;
+    char* componentName;
+    char* objectName;
+    MPI_RESPONSE_KIND kind;
+    bool repeatable;
+    char* data;
+    int dataSize;
+    int sent;
+    int attempts;
+    MPI_COMPLETION_CALLBACK callback;
+    void* context;
+    struct MPI_ASYNC_CALL* next;
+} MPI_ASYNC_CALL;
+
+static int g_mpiSocketHandle = -1;
+static pthread_mutex_t g_mpiSocketMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Offered by the platform with the MpiOpen response, lasts as long as the connection it was offered on
+static SHARED_MEMORY_CHANNEL g_mpiChannel = {0};
+
+// Asynchronous calls are pipelined on a separate non-blocking connection, from the oldest call waiting for its response
+// to the last one submitted; g_nextAsyncCall is the first call not completely sent yet
+static int g_mpiAsyncSocketHandle = -1;
+static HTTP_PARSER g_mpiAsyncParser = {0};
+static MPI_ASYNC_CALL* g_firstAsyncCall = NULL;
+static MPI_ASYNC_CALL* g_lastAsyncCall = NULL;
+static MPI_ASYNC_CALL* g_nextAsyncCall = NULL;
+static int g_numAsyncCalls = 0;
+
+static void CloseMpiSocket(void)
+{
+    if (IsSharedMemoryChannelOpen(&g_mpiChannel))
+    {
+        CloseSharedMemoryChannel(&g_mpiChannel);
+    }
+
+    if (0 <= g_mpiSocketHandle)
+    {
+        close(g_mpiSocketHandle);
+        g_mpiSocketHandle = -1;
+    }
+}
+
+static void CloseDescriptors(int* descriptors, int numDescriptors)
+{
+    int i = 0;
+
+    for (i = 0; i < numDescriptors; i++)
+    {
+        if (0 <= descriptors[i])
+        {
+            close(descriptors[i]);
+            descriptors[i] = -1;
+        }
+    }
+}
+
+static int OpenMpiSocket(int* socketHandle, const char* name, void* log)
 {
-    const char* mpiSocket = "/run/osconfig/mpid.sock";
-    const char* dataFormat = "POST /%s/ HTTP/1.1\r\nHost: OSConfig\r\nUser-Agent: OSConfig\r\nAccept: */*\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%s";
-    
-    int socketHandle = -1;
-    char* data = {0};
-    int estimatedDataSize = 0;
-    int actualDataSize = 0;
-    char contentLengthString[MPI_MAX_CONTENT_LENGTH] = {0};
     struct sockaddr_un socketAddress = {0};
-    socklen_t socketLength = 0;
-    ssize_t bytes = 0;
     int status = MPI_OK;
-    int httpStatus = -1;
 
-    if ((NULL == name) || (NULL == request) || (NULL == response) || (NULL == responseSize))
+    if (0 > (*socketHandle = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)))
     {
-        status = EINVAL;
-        OsConfigLogError(log, "CallMpi(%s): invalid arguments (%d)", name, status);
+        status = errno ? errno : EIO;
+        OsConfigLogError(log, "CallMpi(%s): failed to open socket '%s' (%d)", name, g_mpiSocket, status);
         return status;
     }
-    
-    *response = NULL;
-    *responseSize = 0;
+
+    socketAddress.sun_family = AF_UNIX;
+    strncpy(socketAddress.sun_path, g_mpiSocket, sizeof(socketAddress.sun_path) - 1);
+
+    if (0 != connect(*socketHandle, (struct sockaddr*)&socketAddress, sizeof(socketAddress)))
+    {
+        status = errno ? errno : EIO;
+        OsConfigLogError(log, "CallMpi(%s): failed to connect to socket '%s' (%d)", name, g_mpiSocket, status);
+        close(*socketHandle);
+        *socketHandle = -1;
+    }
+
+    return status;
+}
+
+// Between requests nothing is expected from the platform, a readable connection was closed by the platform (idle or restarted)
+static bool IsMpiSocketStale(int socketHandle)
+{
+    struct pollfd pollDescriptor = {0};
+
+    pollDescriptor.fd = socketHandle;
+    pollDescriptor.events = POLLIN;
+
+    return (0 != poll(&pollDescriptor, 1, 0));
+}
+
+// Waits for the start of the response without consuming it, keeping the descriptors that may come along with it when asked for
+static ssize_t PeekMpiResponse(int* descriptors)
+{
+    union
+    {
+        char buffer[CMSG_SPACE(sizeof(int) * SHARED_MEMORY_CHANNEL_DESCRIPTORS)];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr message = {0};
+    struct iovec buffer = {0};
+    struct cmsghdr* controlMessage = NULL;
+    char firstResponseByte = 0;
+    ssize_t bytes = 0;
+    int numDescriptors = 0;
+    int descriptor = -1;
+    int i = 0;
+
+    buffer.iov_base = &firstResponseByte;
+    buffer.iov_len = sizeof(firstResponseByte);
+
+    message.msg_iov = &buffer;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    if (0 < (bytes = recvmsg(g_mpiSocketHandle, &message, MSG_PEEK | MSG_CMSG_CLOEXEC)))
+    {
+        for (controlMessage = CMSG_FIRSTHDR(&message); NULL != controlMessage; controlMessage = CMSG_NXTHDR(&message, controlMessage))
+        {
+            if ((SOL_SOCKET != controlMessage->cmsg_level) || (SCM_RIGHTS != controlMessage->cmsg_type))
+            {
+                continue;
+            }
+
+            numDescriptors = (int)((controlMessage->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+
+            for (i = 0; i < numDescriptors; i++)
+            {
+                memcpy(&descriptor, CMSG_DATA(controlMessage) + (i * sizeof(int)), sizeof(int));
+
+                if ((NULL != descriptors) && (SHARED_MEMORY_CHANNEL_DESCRIPTORS == numDescriptors) && (0 > descriptors[i]))
+                {
+                    descriptors[i] = descriptor;
+                }
+                else
+                {
+                    close(descriptor);
+                }
+            }
+        }
+    }
+
+    return bytes;
+}
+
+static int SendMpiRequest(const char* name, const char* data, int dataSize, int* descriptors, void* log)
+{
+    ssize_t bytes = 0;
+    int sent = 0;
+    int status = MPI_OK;
+
+    while (sent < dataSize)
+    {
+        if (0 < (bytes = send(g_mpiSocketHandle, data + sent, dataSize - sent, MSG_NOSIGNAL)))
+        {
+            sent += (int)bytes;
+        }
+        else if ((0 > bytes) && (EINTR == errno))
+        {
+            continue;
+        }
+        else
+        {
+            status = errno ? errno : EIO;
+            break;
+        }
+    }
+
+    if (MPI_OK != status)
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(log, "CallMpi(%s): failed to send request '%s' (%d bytes) to socket '%s' (%d)", name, data, dataSize, g_mpiSocket, status);
+        }
+        else
+        {
+            OsConfigLogError(log, "CallMpi(%s): failed to send request to socket '%s' of %d bytes (%d)", name, g_mpiSocket, dataSize, status);
+        }
+    }
+    else
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogInfo(log, "CallMpi(%s): sent to '%s' '%s' (%d bytes)", name, g_mpiSocket, data, dataSize);
+        }
+
+        // Waits for the response, the platform closing the connection instead means the request was not served
+        if (0 == (bytes = PeekMpiResponse(descriptors)))
+        {
+            status = ECONNRESET;
+        }
+        else if (0 > bytes)
+        {
+            status = errno ? errno : EIO;
+        }
+    }
+
+    return status;
+}
+
+// Wraps the request body into the HTTP request sent to the platform
+static char* FormatMpiRequest(const char* name, const char* request, int* dataSize, void* log)
+{
+    const char* dataFormat = "POST /%s/ HTTP/1.1\r\nHost: OSConfig\r\nUser-Agent: OSConfig\r\nAccept: */*\r\nConnection: keep-alive\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%s";
+
+    char* data = {0};
+    int estimatedDataSize = 0;
+    char contentLengthString[MPI_MAX_CONTENT_LENGTH] = {0};
 
     snprintf(contentLengthString, sizeof(contentLengthString), "%d", (int)strlen(request));
     estimatedDataSize = strlen(name) + strlen(dataFormat) + strlen(request) + strlen(contentLengthString) + 1;
@@ -53,101 +265,202 @@ static int CallMpi(const char* name, const char* request, char** response, int*
     data = (char*)malloc(estimatedDataSize);
     if (NULL == data)
     {
-        status = ENOMEM;
-        OsConfigLogError(log, "CallMpi(%s): failed to allocate memory for request (%d)", name, status);
-        return status;
+        OsConfigLogError(log, "CallMpi(%s): failed to allocate memory for request (%d)", name, ENOMEM);
+        return NULL;
     }
 
     memset(data, 0, estimatedDataSize);
+    snprintf(data, estimatedDataSize, dataFormat, name, strlen(request), request);
+    *dataSize = (int)strlen(data);
+
+    return data;
+}
+
+// Sends the request and reads the response up to its body, or the whole response when not chunked; g_mpiSocketMutex must be held.
+// Descriptors received with the response are returned when asked for, otherwise closed
+static int ExchangeMpiRequest(const char* name, const char* request, HTTP_PARSER* parser, int* descriptors, void* log)
+{
+    char* data = NULL;
+    int actualDataSize = 0;
+    bool reusedConnection = false;
+    int attempt = 0;
+    int status = MPI_OK;
 
-    socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (0 > socketHandle)
+    if (NULL == (data = FormatMpiRequest(name, request, &actualDataSize, log)))
     {
-        status = errno ? errno : EIO;
-        OsConfigLogError(log, "CallMpi(%s): failed to open socket '%s' (%d)", name, mpiSocket, status);
+        return ENOMEM;
     }
-    else
+
+    // The connection is kept open across calls, a connection found closed is reopened once
+    for (attempt = 0; attempt < MPI_MAX_SEND_ATTEMPTS; attempt++)
     {
-        memset(&socketAddress, 0, sizeof(socketAddress));
-        socketAddress.sun_family = AF_UNIX;
-        strncpy(socketAddress.sun_path, mpiSocket, sizeof(socketAddress.sun_path) - 1);
-        socketLength = sizeof(socketAddress);
+        if ((0 <= g_mpiSocketHandle) && IsMpiSocketStale(g_mpiSocketHandle))
+        {
+            CloseMpiSocket();
+        }
+
+        reusedConnection = (0 <= g_mpiSocketHandle);
+
+        if ((!reusedConnection) && (MPI_OK != (status = OpenMpiSocket(&g_mpiSocketHandle, name, log))))
+        {
+            break;
+        }
+
+        if (MPI_OK == (status = SendMpiRequest(name, data, actualDataSize, descriptors, log)))
+        {
+            break;
+        }
+
+        CloseMpiSocket();
+
+        if ((!reusedConnection) || ((EPIPE != status) && (ECONNRESET != status)))
+        {
+            break;
+        }
+
+        OsConfigLogInfo(log, "CallMpi(%s): connection to socket '%s' was closed (%d), reconnecting", name, g_mpiSocket, status);
     }
 
+    FREE_MEMORY(data);
+
     if (MPI_OK == status)
     {
-        if (0 == connect(socketHandle, (struct sockaddr*)&socketAddress, socketLength))
+        InitHttpParser(parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+
+        if (0 != (status = ReadHttpMessageFromSocket(g_mpiSocketHandle, parser, log)))
         {
-            snprintf(data, estimatedDataSize, dataFormat, name, strlen(request), request);
-            actualDataSize = (int)strlen(data);
+            OsConfigLogError(log, "CallMpi(%s): failed to read response from socket '%s' (%d)", name, g_mpiSocket, status);
+            FreeHttpParser(parser);
+            CloseMpiSocket();
         }
-        else
+    }
+
+    return status;
+}
+
+// Returns ENOTCONN when the request has to go over the socket instead; g_mpiSocketMutex must be held
+static int ExchangeMpiChannelRequest(const char* name, const char* request, char** response, int* responseSize, void* log)
+{
+    struct pollfd descriptors[2] = {{0}};
+    size_t size = 0;
+    int httpStatus = 0;
+    int status = MPI_OK;
+    bool received = false;
+
+    if (!IsSharedMemoryChannelOpen(&g_mpiChannel))
+    {
+        return ENOTCONN;
+    }
+    else if (IsMpiSocketStale(g_mpiSocketHandle))
+    {
+        CloseMpiSocket();
+        return ENOTCONN;
+    }
+    else if (E2BIG == (status = PostSharedMemoryRequest(&g_mpiChannel, name, request, strlen(request))))
+    {
+        if (IsFullLoggingEnabled())
         {
-            status = errno ? errno : EIO;
-            OsConfigLogError(log, "CallMpi(%s): failed to connect to socket '%s' (%d)", name, mpiSocket, status);
+            OsConfigLogInfo(log, "CallMpi(%s): request of %d bytes does not fit the shared memory channel, sending it to socket '%s'", name, (int)strlen(request), g_mpiSocket);
         }
+        return ENOTCONN;
     }
 
-    if (MPI_OK == status)
+    descriptors[0].fd = g_mpiChannel.responseEvent;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = g_mpiSocketHandle;
+    descriptors[1].events = POLLIN;
+
+    while ((MPI_OK == status) && (!received))
     {
-        bytes = send(socketHandle, data, actualDataSize, 0);
-        if (bytes != actualDataSize)
+        if (0 > poll(descriptors, ARRAY_SIZE(descriptors), -1))
         {
-            status = errno ? errno : EIO;
-            if (IsFullLoggingEnabled())
+            status = (EINTR == errno) ? MPI_OK : (errno ? errno : EIO);
+        }
+        else if (0 != descriptors[0].revents)
+        {
+            if (MPI_OK == (status = ReceiveSharedMemoryResponse(&g_mpiChannel, &httpStatus, response, &size)))
             {
-                OsConfigLogError(log, "CallMpi(%s): failed to send request '%s' (%d bytes) to socket '%s' (%d)", name, data, actualDataSize, mpiSocket, status);
+                received = true;
             }
-            else
+            else if (EAGAIN == status)
             {
-                OsConfigLogError(log, "CallMpi(%s): failed to send request to socket '%s' of %d bytes (%d)", name, mpiSocket, actualDataSize, status);
+                status = MPI_OK;
             }
         }
-        else if (IsFullLoggingEnabled())
+        else if (0 != descriptors[1].revents)
         {
-            OsConfigLogInfo(log, "CallMpi(%s): sent to '%s' '%s' (%d bytes)", name, mpiSocket, data, actualDataSize);
+            // Nothing comes over the socket while the channel is in use, unless the platform closed the connection
+            status = ECONNRESET;
         }
     }
 
-    FREE_MEMORY(data);
-
-    if (MPI_OK == status)
+    if (MPI_OK != status)
+    {
+        OsConfigLogError(log, "CallMpi(%s): failed to get response from the shared memory channel (%d)", name, status);
+        CloseMpiSocket();
+    }
+    else
     {
-        httpStatus = ReadHttpStatusFromSocket(socketHandle, log);
+        *responseSize = (int)size;
         status = (200 == httpStatus) ? MPI_OK : httpStatus;
+    }
+
+    return status;
+}
+
+static int CallMpi(const char* name, const char* request, char** response, int* responseSize, void* log)
+{
+    HTTP_PARSER parser = {0};
+    int descriptors[SHARED_MEMORY_CHANNEL_DESCRIPTORS] = {-1, -1, -1};
+    bool keepAlive = false;
+    int status = MPI_OK;
+
+    if ((NULL == name) || (NULL == request) || (NULL == response) || (NULL == responseSize))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpi(%s): invalid arguments (%d)", name, status);
+        return status;
+    }
+    
+    *response = NULL;
+    *responseSize = 0;
+
+    pthread_mutex_lock(&g_mpiSocketMutex);
+
+    if (ENOTCONN != (status = ExchangeMpiChannelRequest(name, request, response, responseSize, log)))
+    {
+        // Served over the shared memory channel
+    }
+    else if (MPI_OK == (status = ExchangeMpiRequest(name, request, &parser, descriptors, log)))
+    {
+        keepAlive = parser.keepAlive && (!parser.chunked);
+        status = (200 == parser.httpStatus) ? MPI_OK : parser.httpStatus;
+        *response = DetachHttpBody(&parser, responseSize);
 
-        *responseSize = ReadHttpContentLengthFromSocket(socketHandle, log);
-        *response = (char*)malloc(*responseSize + 1);
-        if (NULL != *response)
+        if (!keepAlive)
         {
-            memset(*response, 0, *responseSize + 1);
-            
-            if (*responseSize != read(socketHandle, *response, *responseSize))
-            {
-                if ((MPI_OK == status) || IsFullLoggingEnabled())
-                {
-                    OsConfigLogError(log, "CallMpi(%s): failed to read %d bytes response from socket '%s' (%d)", name, *responseSize, mpiSocket, status);
-                }
-                status = errno ? errno : EIO;
-            }
+            CloseMpiSocket();
         }
-        else
+        else if ((MPI_OK == status) && (0 <= descriptors[0]) && (!IsSharedMemoryChannelOpen(&g_mpiChannel)))
         {
-            status = ENOMEM;
-            *responseSize = 0;
-            OsConfigLogError(log, "CallMpi(%s): failed to allocate memory for response (%d)", name, status);
+            // The channel owns the descriptors from here on, also when it fails to open
+            if (MPI_OK == OpenSharedMemoryChannel(&g_mpiChannel, descriptors[0], descriptors[1], descriptors[2], log))
+            {
+                OsConfigLogInfo(log, "CallMpi(%s): using the shared memory channel offered on socket '%s'", name, g_mpiSocket);
+            }
+
+            descriptors[0] = descriptors[1] = descriptors[2] = -1;
         }
     }
 
-    if (0 <= socketHandle)
-    {
-        close(socketHandle);
-    }
+    CloseDescriptors(descriptors, ARRAY_SIZE(descriptors));
+
+    pthread_mutex_unlock(&g_mpiSocketMutex);
 
     if (IsFullLoggingEnabled())
     {
         OsConfigLogInfo(log, "CallMpi(name: '%s', request: '%s', response: '%s', response size: %d bytes) to socket '%s' returned %d", 
-            name, request, *response, *responseSize, mpiSocket, status);
+            name, request, *response, *responseSize, g_mpiSocket, status);
     }
     
     return status;
@@ -173,387 +486,1248 @@ static char* ParseString(void* log, char* jsonString)
         }
         else
         {
-            returnValue = strdup(parsedValue);
-            if (NULL == returnValue)
-            {
-                OsConfigLogError(log, "ParseString: strdup on '%s' failed", parsedValue);
-            }
+            returnValue = strdup(parsedValue);
+            if (NULL == returnValue)
+            {
+                OsConfigLogError(log, "ParseString: strdup on '%s' failed", parsedValue);
+            }
+        }
+        json_value_free(jsonValue);
+    }
+
+    return returnValue;
+}
+
+// MpiSet and MpiSetDesired respond with their status as a JSON string, the response itself is not returned
+static int ParseStatusResponse(int status, char** response, int* responseSize, void* log)
+{
+    char* statusFromResponse = NULL;
+
+    if ((NULL != *response) && (*responseSize > 0))
+    {
+        statusFromResponse = ParseString(log, *response);
+        status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
+        FREE_MEMORY(statusFromResponse);
+    }
+
+    FREE_MEMORY(*response);
+    *responseSize = 0;
+
+    return status;
+}
+
+// MpiGet responds with the object payload, or with its status as a JSON string along with HTTP 500
+static int ParseObjectResponse(const char* componentName, const char* propertyName, int status, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    char* statusFromResponse = NULL;
+
+    if (HTTP_INTERNAL_SERVER_ERROR == status)
+    {
+        if ((NULL != *payload) && (*payloadSizeBytes > 0))
+        {
+            statusFromResponse = ParseString(log, *payload);
+            status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
+            FREE_MEMORY(statusFromResponse);
+
+            FREE_MEMORY(*payload);
+            *payloadSizeBytes = 0;
+        }
+        else
+        {
+            OsConfigLogError(log, "CallMpiGet(%s, %s): invalid response for HTTP internal server error (500)", componentName, propertyName);
+            status = EINVAL;
+        }
+    }
+    else if ((NULL != *payload) && ((*payloadSizeBytes != (int)strlen(*payload)) || (!IsValidMimObjectPayload(*payload, *payloadSizeBytes, log))))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiGet(%s, %s): invalid response (%d)", componentName, propertyName, status);
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+
+    return status;
+}
+
+// MpiSetMany and MpiGetMany respond with the JSON array of results
+static int ParseManyResponse(const char* name, int status, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    if ((MPI_OK != status) || ((NULL != *payload) && (*payloadSizeBytes != (int)strlen(*payload))))
+    {
+        OsConfigLogError(log, "CallMpiMany(%s): failed with %d (%p, %d)", name, status, *payload, *payloadSizeBytes);
+
+        if (MPI_OK == status)
+        {
+            status = EINVAL;
+        }
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+
+    return status;
+}
+
+MPI_HANDLE CallMpiOpen(const char* clientName, const unsigned int maxPayloadSizeBytes, void* log)
+{
+    const char *name = "MpiOpen";
+    const char *requestBodyFormat = "{ \"ClientName\": \"%s\", \"MaxPayloadSizeBytes\": %d, \"SharedMemory\": true }";
+    
+    char* request = NULL; 
+    char *response = NULL;
+    int requestSize = 0;
+    int responseSize = 0;
+    int status = MPI_OK;
+    MPI_HANDLE mpiHandle = NULL;
+    char maxPayloadSizeBytesString[MPI_MAX_CONTENT_LENGTH] = {0};
+    char* mpiHandleValue = NULL;
+
+    if (NULL == clientName)
+    {
+        OsConfigLogError(log, "CallMpiOpen: invalid NULL MPI handle");
+        return NULL;
+    }
+
+    snprintf(maxPayloadSizeBytesString, sizeof(maxPayloadSizeBytesString), "%d", maxPayloadSizeBytes);
+    requestSize = strlen(requestBodyFormat) + strlen(clientName) + strlen(maxPayloadSizeBytesString) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        OsConfigLogError(log, "CallMpiOpen(%s, %u): failed to allocate memory for request", clientName, maxPayloadSizeBytes);
+        return NULL;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, clientName, maxPayloadSizeBytes);
+
+    status = CallMpi(name, request, &response, &responseSize, log);
+
+    FREE_MEMORY(request);
+
+    mpiHandle = (MPI_OK == status) ? (MPI_HANDLE)response : NULL;
+    
+    if ((NULL != mpiHandle) && (NULL == (mpiHandleValue = ParseString(log, (char*)mpiHandle))))
+    {
+        OsConfigLogError(log, "CallMpiOpen: invalid MPI handle '%s'", (char*)mpiHandle);
+        mpiHandle = NULL;
+    }
+
+    OsConfigLogInfo(log, "CallMpiOpen(%s, %u): %p ('%s')", clientName, maxPayloadSizeBytes, mpiHandle, mpiHandleValue);
+
+    FREE_MEMORY(mpiHandleValue);
+
+    // The MPI handle returned here is a JSON string already wrapped in ""
+    return mpiHandle;
+}
+
+void CallMpiClose(MPI_HANDLE clientSession, void* log)
+{
+    const char *name = "MpiClose";
+    const char *requestBodyFormat = "{ \"ClientSession\": %s }";
+    
+    char* request = NULL; 
+    char *response = NULL;
+    int requestSize = 0;
+    int responseSize = 0;
+
+    if ((NULL == clientSession) || (0 == strlen((char*)clientSession)))
+    {
+        OsConfigLogError(log, "CallMpiClose(%p) called with invalid argument", clientSession);
+        return;
+    }
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)clientSession) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        OsConfigLogError(log, "CallMpiClose(%p): failed to allocate memory for request", clientSession);
+        return;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)clientSession);
+
+    CallMpi(name, request, &response, &responseSize, log);
+
+    pthread_mutex_lock(&g_mpiSocketMutex);
+    CloseMpiSocket();
+    pthread_mutex_unlock(&g_mpiSocketMutex);
+
+    FREE_MEMORY(request);
+    FREE_MEMORY(response);
+    
+    OsConfigLogInfo(log, "CallMpiClose(%p)", clientSession);
+}
+
+int CallMpiSet(const char* componentName, const char* propertyName, const MPI_JSON_STRING payload, const int payloadSizeBytes, void* log)
+{
+    const char *name = "MpiSet";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\", \"Payload\": %s }";
+
+    char* request = NULL;
+    char *response = NULL;
+    int requestSize = 0;
+    int responseSize = 0;
+    int status = MPI_OK;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiSet: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if ((NULL == componentName) || (NULL == propertyName) || (NULL == payload) || (0 >= payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiSet: invalid arguments (%d)", status);
+        return status;
+    }
+
+    if (!IsValidMimObjectPayload(payload, payloadSizeBytes, log))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiSet(%s, %s): invalid payload (%d)", componentName, propertyName, status);
+        return status;
+    }
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(componentName) + strlen(propertyName) + payloadSizeBytes + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiSet(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, componentName, propertyName, payload);
+
+    status = CallMpi(name, request, &response, &responseSize, log);
+
+    FREE_MEMORY(request);
+
+    status = ParseStatusResponse(status, &response, &responseSize, log);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiSet(%p, %s, %s, %.*s, %d bytes) returned %d", g_mpiHandle, componentName, propertyName, payloadSizeBytes, payload, payloadSizeBytes, status);
+    }
+    else
+    {
+        OsConfigLogInfo(log, "CallMpiSet(%p, %s, %s, %d bytes) returned %d", g_mpiHandle, componentName, propertyName, payloadSizeBytes, status);
+    }
+
+    return status;
+};
+
+int CallMpiGet(const char* componentName, const char* propertyName, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    const char *name = "MpiGet";
+    const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\" }";
+
+    char* request = NULL;
+    int requestSize = 0;
+    int status = MPI_OK;
+    
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiGet: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if ((NULL == componentName) || (NULL == propertyName) || (NULL == payload) || (NULL == payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiGet: called with invalid arguments (%d)", status);
+        return status;
+    }
+
+    *payload = NULL;
+    *payloadSizeBytes = 0;
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(componentName) + strlen(propertyName) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiGet(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, componentName, propertyName);
+
+    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+
+    FREE_MEMORY(request);
+
+    status = ParseObjectResponse(componentName, propertyName, status, payload, payloadSizeBytes, log);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiGet(%p, %s, %s, %.*s, %d bytes): %d", g_mpiHandle, componentName, propertyName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+    }
+
+    return status;
+};
+
+int CallMpiSetDesired(const MPI_JSON_STRING payload, const int payloadSizeBytes, void* log)
+{
+    const char *name = "MpiSetDesired";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Payload\": %s }";
+    
+    char* request = NULL;
+    char *response = NULL;
+    int requestSize = 0;
+    int responseSize = 0;
+    int status = MPI_OK;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiSetDesired: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if ((NULL == payload) || (0 >= payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiSetDesired: invalid arguments (%d)", status);
+        return status;
+    }
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + payloadSizeBytes + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiSetDesired: failed to allocate memory for request (%d)", status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, payload);
+
+    status = CallMpi(name, request, &response, &responseSize, log);
+
+    FREE_MEMORY(request);
+
+    status = ParseStatusResponse(status, &response, &responseSize, log);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiSetDesired(%p, %.*s, %d bytes) returned %d", g_mpiHandle, payloadSizeBytes, payload, payloadSizeBytes, status);
+    }
+    else
+    {
+        OsConfigLogInfo(log, "CallMpiSetDesired(%p, %d bytes) returned %d", g_mpiHandle, payloadSizeBytes, status);
+    }
+
+    return status;
+}
+
+int CallMpiGetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    const char *name = "MpiGetReported";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s }";
+
+    char* request = NULL;
+    int requestSize = 0;
+    int status = MPI_OK;
+    char* statusFromResponse = NULL;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiGetReported: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if ((NULL == payload) || (NULL == payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiGetReported: called with invalid arguments (%d)", status);
+        return status;
+    }
+
+    *payload = NULL;
+    *payloadSizeBytes = 0;
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiGetReported: failed to allocate memory for request (%d)", status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle);
+
+    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+
+    FREE_MEMORY(request);
+
+    if (HTTP_INTERNAL_SERVER_ERROR == status)
+    {
+        if ((NULL != *payload) && (*payloadSizeBytes > 0))
+        {
+            statusFromResponse = ParseString(log, *payload);
+            status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
+            FREE_MEMORY(statusFromResponse);
+        }
+        else
+        {
+            OsConfigLogError(log, "CallMpiGetReported: invalid response for HTTP internal server error (500)");
+            status = EINVAL;
+        }
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+    else if ((NULL != *payload) && (*payloadSizeBytes != (int)strlen(*payload)))
+    {
+        OsConfigLogError(log, "CallMpiGetReported: invalid response (%p, %d)", *payload, *payloadSizeBytes);
+
+        status = EINVAL;
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiGetReported(%p, %.*s, %d bytes): %d", g_mpiHandle, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+    }
+
+    return status;
+}
+
+int CallMpiGetReportedChanges(const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    const char *name = "MpiGetReportedChanges";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Version\": %llu }";
+
+    char* request = NULL;
+    int requestSize = 0;
+    int status = MPI_OK;
+    char* statusFromResponse = NULL;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiGetReportedChanges: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if ((NULL == payload) || (NULL == payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiGetReportedChanges: called with invalid arguments (%d)", status);
+        return status;
+    }
+
+    *payload = NULL;
+    *payloadSizeBytes = 0;
+
+    // Plus up to 20 digits for the version
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + 20 + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiGetReportedChanges: failed to allocate memory for request (%d)", status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, sinceVersion);
+
+    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+
+    FREE_MEMORY(request);
+
+    if (HTTP_INTERNAL_SERVER_ERROR == status)
+    {
+        if ((NULL != *payload) && (*payloadSizeBytes > 0))
+        {
+            statusFromResponse = ParseString(log, *payload);
+            status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
+            FREE_MEMORY(statusFromResponse);
+        }
+        else
+        {
+            OsConfigLogError(log, "CallMpiGetReportedChanges: invalid response for HTTP internal server error (500)");
+            status = EINVAL;
+        }
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+    else if ((NULL != *payload) && (*payloadSizeBytes != (int)strlen(*payload)))
+    {
+        OsConfigLogError(log, "CallMpiGetReportedChanges: invalid response (%p, %d)", *payload, *payloadSizeBytes);
+
+        status = EINVAL;
+
+        FREE_MEMORY(*payload);
+        *payloadSizeBytes = 0;
+    }
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiGetReportedChanges(%p, %llu, %.*s, %d bytes): %d", g_mpiHandle, sinceVersion, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+    }
+
+    return status;
+}
+
+static int CallMpiMany(const char* name, const char* objects, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Objects\": %s }";
+
+    char* request = NULL;
+    int requestSize = 0;
+    int status = MPI_OK;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiMany(%s): called without a valid MPI handle (%d)", name, status);
+        return status;
+    }
+
+    if ((NULL == objects) || (NULL == payload) || (NULL == payloadSizeBytes))
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiMany(%s): called with invalid arguments (%d)", name, status);
+        return status;
+    }
+
+    *payload = NULL;
+    *payloadSizeBytes = 0;
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(objects) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiMany(%s): failed to allocate memory for request (%d)", name, status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, objects);
+
+    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+
+    FREE_MEMORY(request);
+
+    status = ParseManyResponse(name, status, payload, payloadSizeBytes, log);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiMany(%s, %p, %s, %.*s, %d bytes): %d", name, g_mpiHandle, objects, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+    }
+
+    return status;
+}
+
+int CallMpiSetMany(const char* objects, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    return CallMpiMany("MpiSetMany", objects, payload, payloadSizeBytes, log);
+}
+
+int CallMpiGetMany(const char* objects, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+{
+    return CallMpiMany("MpiGetMany", objects, payload, payloadSizeBytes, log);
+}
+
+int CallMpiGetReportedStream(MPI_WRITE_CALLBACK writeCallback, void* context, void* log)
+{
+    const char *name = "MpiGetReportedStream";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s }";
+
+    char* request = NULL;
+    int requestSize = 0;
+    HTTP_PARSER parser = {0};
+    char* chunk = NULL;
+    size_t chunkSize = 0;
+    size_t streamedSize = 0;
+    char* response = NULL;
+    int responseSize = 0;
+    char* statusFromResponse = NULL;
+    int status = MPI_OK;
+
+    if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
+    {
+        status = EPERM;
+        OsConfigLogError(log, "CallMpiGetReportedStream: called without a valid MPI handle (%d)", status);
+        return status;
+    }
+
+    if (NULL == writeCallback)
+    {
+        status = EINVAL;
+        OsConfigLogError(log, "CallMpiGetReportedStream: called with invalid arguments (%d)", status);
+        return status;
+    }
+
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + 1;
+
+    request = (char*)malloc(requestSize);
+    if (NULL == request)
+    {
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiGetReportedStream: failed to allocate memory for request (%d)", status);
+        return status;
+    }
+
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle);
+
+    pthread_mutex_lock(&g_mpiSocketMutex);
+
+    if (MPI_OK == (status = ExchangeMpiRequest(name, request, &parser, NULL, log)))
+    {
+        if ((200 == parser.httpStatus) && parser.chunked)
+        {
+            // Each chunk is handed over as it arrives, so the reported payload is never held whole
+            while ((MPI_OK == (status = ReadHttpChunkFromSocket(g_mpiSocketHandle, &parser, &chunk, &chunkSize, log))) && (chunkSize > 0))
+            {
+                streamedSize += chunkSize;
+
+                if (MPI_OK != (status = writeCallback(chunk, (int)chunkSize, context)))
+                {
+                    break;
+                }
+            }
+
+            // The rest of an interrupted stream is not read, so the connection cannot be reused
+            if ((MPI_OK != status) || (!parser.keepAlive))
+            {
+                CloseMpiSocket();
+            }
+        }
+        else
+        {
+            if (!parser.keepAlive)
+            {
+                CloseMpiSocket();
+            }
+
+            if ((HTTP_INTERNAL_SERVER_ERROR == parser.httpStatus) && (parser.contentLength > 0))
+            {
+                response = DetachHttpBody(&parser, &responseSize);
+                statusFromResponse = ParseString(log, response);
+                status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
+                FREE_MEMORY(statusFromResponse);
+                FREE_MEMORY(response);
+            }
+            else
+            {
+                OsConfigLogError(log, "CallMpiGetReportedStream: unexpected response (%d)", parser.httpStatus);
+                status = (200 == parser.httpStatus) ? EINVAL : parser.httpStatus;
+            }
+        }
+    }
+
+    FreeHttpParser(&parser);
+
+    pthread_mutex_unlock(&g_mpiSocketMutex);
+
+    FREE_MEMORY(request);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiGetReportedStream(%p, %u bytes): %d", g_mpiHandle, (unsigned int)streamedSize, status);
+    }
+
+    return status;
+}
+
+static void CloseMpiAsyncSocket(void)
+{
+    if (0 <= g_mpiAsyncSocketHandle)
+    {
+        close(g_mpiAsyncSocketHandle);
+        g_mpiAsyncSocketHandle = -1;
+    }
+
+    FreeHttpParser(&g_mpiAsyncParser);
+}
+
+static MPI_ASYNC_CALL* RemoveFirstMpiAsyncCall(void)
+{
+    MPI_ASYNC_CALL* call = g_firstAsyncCall;
+
+    if (NULL != call)
+    {
+        g_firstAsyncCall = call->next;
+        g_numAsyncCalls -= 1;
+
+        if (g_lastAsyncCall == call)
+        {
+            g_lastAsyncCall = NULL;
+        }
+
+        if (g_nextAsyncCall == call)
+        {
+            g_nextAsyncCall = call->next;
+        }
+    }
+
+    return call;
+}
+
+// The callback can submit new calls, the call is no longer in the list when it runs
+static void CompleteMpiAsyncCall(MPI_ASYNC_CALL* call, int status, char* response, int responseSize, void* log)
+{
+    switch (call->kind)
+    {
+        case MpiStatusResponse:
+            status = ParseStatusResponse(status, &response, &responseSize, log);
+            break;
+
+        case MpiObjectResponse:
+            status = ParseObjectResponse(call->componentName, call->objectName, status, &response, &responseSize, log);
+            break;
+
+        case MpiManyResponse:
+        default:
+            status = ParseManyResponse(call->name, status, &response, &responseSize, log);
+    }
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(log, "CallMpiAsync(%s, %.*s, %d bytes): %d", call->name, responseSize, response, responseSize, status);
+    }
+
+    call->callback(status, response, responseSize, call->context);
+
+    FREE_MEMORY(response);
+    FREE_MEMORY(call->componentName);
+    FREE_MEMORY(call->objectName);
+    FREE_MEMORY(call->data);
+    FREE_MEMORY(call);
+}
+
+static void SendMpiAsyncCalls(void* log);
+
+// Closes the connection and takes out the calls sent on it that cannot be sent again on a new one, returned in order for
+// FailMpiAsyncCalls. A call sent in full may have been served already unless the platform closed the connection after the
+// previous response (unserved), it is sent again only when repeatable and its response had not started to arrive. A call
+// partially sent was not served. Calls out of attempts are taken out as well
+static MPI_ASYNC_CALL* ResetMpiAsyncConnection(bool unserved)
+{
+    MPI_ASYNC_CALL* call = NULL;
+    MPI_ASYNC_CALL* previous = NULL;
+    MPI_ASYNC_CALL* next = NULL;
+    MPI_ASYNC_CALL* firstFailed = NULL;
+    MPI_ASYNC_CALL* lastFailed = NULL;
+    MPI_ASYNC_CALL* waiting = g_firstAsyncCall;
+    bool responseStarted = (0 < g_mpiAsyncParser.received);
+    bool served = false;
+
+    CloseMpiAsyncSocket();
+
+    // Only the calls at least partially sent can have been served, these are ahead of the ones not sent yet
+    for (call = g_firstAsyncCall; (NULL != call) && (0 < call->sent); call = next)
+    {
+        next = call->next;
+        served = (call->sent == call->dataSize) && (!unserved) && ((!call->repeatable) || ((call == waiting) && responseStarted));
+
+        if (served || (call->attempts >= MPI_MAX_SEND_ATTEMPTS))
+        {
+            if (NULL == previous)
+            {
+                g_firstAsyncCall = next;
+            }
+            else
+            {
+                previous->next = next;
+            }
+
+            if (g_lastAsyncCall == call)
+            {
+                g_lastAsyncCall = previous;
+            }
+
+            g_numAsyncCalls -= 1;
+
+            call->next = NULL;
+
+            if (NULL == lastFailed)
+            {
+                firstFailed = call;
+            }
+            else
+            {
+                lastFailed->next = call;
+            }
+
+            lastFailed = call;
+        }
+        else
+        {
+            call->sent = 0;
+            previous = call;
+        }
+    }
+
+    g_nextAsyncCall = g_firstAsyncCall;
+
+    return firstFailed;
+}
+
+static void FailMpiAsyncCalls(MPI_ASYNC_CALL* calls, int status, void* log)
+{
+    MPI_ASYNC_CALL* call = NULL;
+
+    while (NULL != (call = calls))
+    {
+        calls = call->next;
+        OsConfigLogError(log, "CallMpiAsync(%s): connection to socket '%s' was closed before the response (%d)", call->name, g_mpiSocket, status);
+        CompleteMpiAsyncCall(call, status, NULL, 0, log);
+    }
+}
+
+// The calls that cannot be sent again fail with the status, the others are sent again on a new connection
+static void CloseMpiAsyncConnection(int status, void* log)
+{
+    FailMpiAsyncCalls(ResetMpiAsyncConnection(false), status, log);
+    SendMpiAsyncCalls(log);
+}
+
+static int OpenMpiAsyncSocket(const char* name, void* log)
+{
+    int flags = 0;
+    int status = MPI_OK;
+
+    if (MPI_OK == (status = OpenMpiSocket(&g_mpiAsyncSocketHandle, name, log)))
+    {
+        // Connecting blocks only for as long as the platform takes to accept, everything after that does not block
+        if ((0 > (flags = fcntl(g_mpiAsyncSocketHandle, F_GETFL))) || (0 != fcntl(g_mpiAsyncSocketHandle, F_SETFL, flags | O_NONBLOCK)))
+        {
+            status = errno ? errno : EIO;
+            OsConfigLogError(log, "CallMpiAsync(%s): failed to make the connection to socket '%s' non-blocking (%d)", name, g_mpiSocket, status);
+            CloseMpiAsyncSocket();
+        }
+        else
+        {
+            InitHttpParser(&g_mpiAsyncParser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+        }
+    }
+
+    return status;
+}
+
+// Sends as much of the calls not sent yet as the connection takes without blocking, opening the connection when needed
+static void SendMpiAsyncCalls(void* log)
+{
+    ssize_t bytes = 0;
+    int status = MPI_OK;
+
+    if ((NULL != g_nextAsyncCall) && (0 > g_mpiAsyncSocketHandle) && (MPI_OK != (status = OpenMpiAsyncSocket(g_nextAsyncCall->name, log))))
+    {
+        while (NULL != g_firstAsyncCall)
+        {
+            CompleteMpiAsyncCall(RemoveFirstMpiAsyncCall(), status, NULL, 0, log);
+        }
+        return;
+    }
+
+    while (NULL != g_nextAsyncCall)
+    {
+        if (0 == g_nextAsyncCall->sent)
+        {
+            g_nextAsyncCall->attempts += 1;
+        }
+
+        if (0 < (bytes = send(g_mpiAsyncSocketHandle, g_nextAsyncCall->data + g_nextAsyncCall->sent, g_nextAsyncCall->dataSize - g_nextAsyncCall->sent, MSG_NOSIGNAL)))
+        {
+            if ((g_nextAsyncCall->sent += (int)bytes) == g_nextAsyncCall->dataSize)
+            {
+                if (IsFullLoggingEnabled())
+                {
+                    OsConfigLogInfo(log, "CallMpiAsync(%s): sent to '%s' '%s' (%d bytes)", g_nextAsyncCall->name, g_mpiSocket, g_nextAsyncCall->data, g_nextAsyncCall->dataSize);
+                }
+
+                g_nextAsyncCall = g_nextAsyncCall->next;
+            }
+        }
+        else if ((0 > bytes) && (EINTR == errno))
+        {
+            continue;
+        }
+        else if ((0 > bytes) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+        {
+            break;
+        }
+        else
+        {
+            status = errno ? errno : EIO;
+            OsConfigLogError(log, "CallMpiAsync(%s): failed to send request to socket '%s' (%d)", g_nextAsyncCall->name, g_mpiSocket, status);
+            CloseMpiAsyncConnection(status, log);
+            break;
+        }
+    }
+}
+
+// Completes the calls whose responses have arrived, the responses come back in the order the requests were sent
+static void ReceiveMpiAsyncResponses(void* log)
+{
+    HTTP_PARSER* parser = &g_mpiAsyncParser;
+    MPI_ASYNC_CALL* call = NULL;
+    MPI_ASYNC_CALL* failed = NULL;
+    char* response = NULL;
+    int responseSize = 0;
+    bool keepAlive = false;
+    int status = MPI_OK;
+
+    while (0 <= g_mpiAsyncSocketHandle)
+    {
+        if (EAGAIN == (status = ReadHttpMessageFromSocket(g_mpiAsyncSocketHandle, parser, log)))
+        {
+            break;
+        }
+        else if (MPI_OK != status)
+        {
+            CloseMpiAsyncConnection(status, log);
+            break;
+        }
+        else if ((NULL == g_firstAsyncCall) || (g_firstAsyncCall == g_nextAsyncCall) || parser->chunked)
+        {
+            OsConfigLogError(log, "CallMpiAsync: unexpected response from socket '%s' (%d)", g_mpiSocket, parser->httpStatus);
+            CloseMpiAsyncConnection(EPROTO, log);
+            break;
+        }
+
+        responseSize = (int)parser->contentLength;
+        if (NULL == (response = (char*)malloc(responseSize + 1)))
+        {
+            OsConfigLogError(log, "CallMpiAsync(%s): failed to allocate memory for response (%d)", g_firstAsyncCall->name, ENOMEM);
+            CloseMpiAsyncConnection(ENOMEM, log);
+            break;
+        }
+
+        // Anything received after this response is kept for the next ones
+        memcpy(response, GetHttpBody(parser), responseSize + 1);
+        status = (200 == parser->httpStatus) ? MPI_OK : parser->httpStatus;
+        keepAlive = parser->keepAlive;
+        ConsumeHttpMessage(parser);
+
+        // The platform closing the connection after this response serves none of the requests that followed, these are reset
+        // before the callback runs so that the calls it submits go to the new connection after them
+        call = RemoveFirstMpiAsyncCall();
+        failed = keepAlive ? NULL : ResetMpiAsyncConnection(true);
+
+        CompleteMpiAsyncCall(call, status, response, responseSize, log);
+
+        if (!keepAlive)
+        {
+            FailMpiAsyncCalls(failed, ECONNRESET, log);
+            SendMpiAsyncCalls(log);
         }
-        json_value_free(jsonValue);
     }
-
-    return returnValue;
 }
 
-MPI_HANDLE CallMpiOpen(const char* clientName, const unsigned int maxPayloadSizeBytes, void* log)
+static int SubmitMpiCall(const char* name, const char* componentName, const char* objectName, MPI_RESPONSE_KIND kind, bool repeatable, const char* request, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
 {
-    const char *name = "MpiOpen";
-    const char *requestBodyFormat = "{ \"ClientName\": \"%s\", \"MaxPayloadSizeBytes\": %d }";
-    
-    char* request = NULL; 
-    char *response = NULL;
-    int requestSize = 0;
-    int responseSize = 0;
+    MPI_ASYNC_CALL* call = NULL;
     int status = MPI_OK;
-    MPI_HANDLE mpiHandle = NULL;
-    char maxPayloadSizeBytesString[MPI_MAX_CONTENT_LENGTH] = {0};
-    char* mpiHandleValue = NULL;
 
-    if (NULL == clientName)
+    // With nothing in flight a connection found closed by the platform (idle or restarted) is replaced, failing to connect fails the submission
+    if ((0 <= g_mpiAsyncSocketHandle) && (NULL == g_firstAsyncCall) && IsMpiSocketStale(g_mpiAsyncSocketHandle))
     {
-        OsConfigLogError(log, "CallMpiOpen: invalid NULL MPI handle");
-        return NULL;
+        CloseMpiAsyncSocket();
     }
 
-    snprintf(maxPayloadSizeBytesString, sizeof(maxPayloadSizeBytesString), "%d", maxPayloadSizeBytes);
-    requestSize = strlen(requestBodyFormat) + strlen(clientName) + strlen(maxPayloadSizeBytesString) + 1;
-
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if ((0 > g_mpiAsyncSocketHandle) && (MPI_OK != (status = OpenMpiAsyncSocket(name, log))))
     {
-        OsConfigLogError(log, "CallMpiOpen(%s, %u): failed to allocate memory for request", clientName, maxPayloadSizeBytes);
-        return NULL;
+        return status;
     }
 
-    snprintf(request, requestSize, requestBodyFormat, clientName, maxPayloadSizeBytes);
-
-    status = CallMpi(name, request, &response, &responseSize, log);
-
-    FREE_MEMORY(request);
-
-    mpiHandle = (MPI_OK == status) ? (MPI_HANDLE)response : NULL;
-    
-    if ((NULL != mpiHandle) && (NULL == (mpiHandleValue = ParseString(log, (char*)mpiHandle))))
+    if ((NULL == (call = (MPI_ASYNC_CALL*)calloc(1, sizeof(MPI_ASYNC_CALL)))) ||
+        (NULL == (call->data = FormatMpiRequest(name, request, &call->dataSize, log))) ||
+        ((NULL != componentName) && (NULL == (call->componentName = strdup(componentName)))) ||
+        ((NULL != objectName) && (NULL == (call->objectName = strdup(objectName)))))
     {
-        OsConfigLogError(log, "CallMpiOpen: invalid MPI handle '%s'", (char*)mpiHandle);
-        mpiHandle = NULL;
-    }
-
-    OsConfigLogInfo(log, "CallMpiOpen(%s, %u): %p ('%s')", clientName, maxPayloadSizeBytes, mpiHandle, mpiHandleValue);
+        status = ENOMEM;
+        OsConfigLogError(log, "CallMpiAsync(%s): failed to allocate memory for call (%d)", name, status);
 
-    FREE_MEMORY(mpiHandleValue);
+        if (NULL != call)
+        {
+            FREE_MEMORY(call->componentName);
+            FREE_MEMORY(call->data);
+            FREE_MEMORY(call);
+        }
 
-    // The MPI handle returned here is a JSON string already wrapped in ""
-    return mpiHandle;
-}
+        return status;
+    }
 
-void CallMpiClose(MPI_HANDLE clientSession, void* log)
-{
-    const char *name = "MpiClose";
-    const char *requestBodyFormat = "{ \"ClientSession\": %s }";
-    
-    char* request = NULL; 
-    char *response = NULL;
-    int requestSize = 0;
-    int responseSize = 0;
+    call->name = name;
+    call->kind = kind;
+    call->repeatable = repeatable;
+    call->callback = callback;
+    call->context = context;
 
-    if ((NULL == clientSession) || (0 == strlen((char*)clientSession)))
+    if (NULL == g_lastAsyncCall)
     {
-        OsConfigLogError(log, "CallMpiClose(%p) called with invalid argument", clientSession);
-        return;
+        g_firstAsyncCall = call;
+    }
+    else
+    {
+        g_lastAsyncCall->next = call;
     }
 
-    requestSize = strlen(requestBodyFormat) + strlen((char*)clientSession) + 1;
+    g_lastAsyncCall = call;
+    g_numAsyncCalls += 1;
 
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if (NULL == g_nextAsyncCall)
     {
-        OsConfigLogError(log, "CallMpiClose(%p): failed to allocate memory for request", clientSession);
-        return;
+        g_nextAsyncCall = call;
     }
 
-    snprintf(request, requestSize, requestBodyFormat, (char*)clientSession);
-
-    CallMpi(name, request, &response, &responseSize, log);
+    // The request goes out right away when the connection takes it, the response is for CallMpiDoWork to pick up
+    SendMpiAsyncCalls(log);
 
-    FREE_MEMORY(request);
-    FREE_MEMORY(response);
-    
-    OsConfigLogInfo(log, "CallMpiClose(%p)", clientSession);
+    return MPI_OK;
 }
 
-int CallMpiSet(const char* componentName, const char* propertyName, const MPI_JSON_STRING payload, const int payloadSizeBytes, void* log)
+int CallMpiSetAsync(const char* componentName, const char* propertyName, const MPI_JSON_STRING payload, const int payloadSizeBytes, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
 {
-    const char *name = "MpiSet";
-    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\", \"Payload\": %s }";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\", \"Payload\": %.*s }";
 
     char* request = NULL;
-    char *response = NULL;
     int requestSize = 0;
-    int responseSize = 0;
     int status = MPI_OK;
-    char* statusFromResponse = NULL;
 
     if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
     {
         status = EPERM;
-        OsConfigLogError(log, "CallMpiSet: called without a valid MPI handle (%d)", status);
+        OsConfigLogError(log, "CallMpiSetAsync: called without a valid MPI handle (%d)", status);
         return status;
     }
 
-    if ((NULL == componentName) || (NULL == propertyName) || (NULL == payload) || (0 >= payloadSizeBytes))
+    if ((NULL == componentName) || (NULL == propertyName) || (NULL == payload) || (0 >= payloadSizeBytes) || (NULL == callback))
     {
         status = EINVAL;
-        OsConfigLogError(log, "CallMpiSet: invalid arguments (%d)", status);
+        OsConfigLogError(log, "CallMpiSetAsync: invalid arguments (%d)", status);
         return status;
     }
 
     if (!IsValidMimObjectPayload(payload, payloadSizeBytes, log))
     {
         status = EINVAL;
-        OsConfigLogError(log, "CallMpiSet(%s, %s): invalid payload (%d)", componentName, propertyName, status);
+        OsConfigLogError(log, "CallMpiSetAsync(%s, %s): invalid payload (%d)", componentName, propertyName, status);
         return status;
     }
 
     requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(componentName) + strlen(propertyName) + payloadSizeBytes + 1;
 
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if (NULL == (request = (char*)malloc(requestSize)))
     {
         status = ENOMEM;
-        OsConfigLogError(log, "CallMpiSet(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
+        OsConfigLogError(log, "CallMpiSetAsync(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
         return status;
     }
 
-    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, componentName, propertyName, payload);
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, componentName, propertyName, payloadSizeBytes, payload);
 
-    status = CallMpi(name, request, &response, &responseSize, log);
+    status = SubmitMpiCall("MpiSet", NULL, NULL, MpiStatusResponse, false, request, callback, context, log);
 
     FREE_MEMORY(request);
 
-    if ((NULL != response) && (responseSize > 0))
-    {
-        statusFromResponse = ParseString(log, response);
-        status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
-        FREE_MEMORY(statusFromResponse);
-    }
-
-    if (IsFullLoggingEnabled())
-    {
-        OsConfigLogInfo(log, "CallMpiSet(%p, %s, %s, %.*s, %d bytes) returned %d", g_mpiHandle, componentName, propertyName, payloadSizeBytes, payload, payloadSizeBytes, status);
-    }
-    else
-    {
-        OsConfigLogInfo(log, "CallMpiSet(%p, %s, %s, %d bytes) returned %d", g_mpiHandle, componentName, propertyName, payloadSizeBytes, status);
-    }
-
     return status;
-};
+}
 
-int CallMpiGet(const char* componentName, const char* propertyName, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+int CallMpiGetAsync(const char* componentName, const char* propertyName, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
 {
-    const char *name = "MpiGet";
-    const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\" }";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"ComponentName\": \"%s\", \"ObjectName\": \"%s\" }";
 
     char* request = NULL;
     int requestSize = 0;
     int status = MPI_OK;
-    char* statusFromResponse = NULL;
-    
+
     if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
     {
         status = EPERM;
-        OsConfigLogError(log, "CallMpiGet: called without a valid MPI handle (%d)", status);
+        OsConfigLogError(log, "CallMpiGetAsync: called without a valid MPI handle (%d)", status);
         return status;
     }
 
-    if ((NULL == componentName) || (NULL == propertyName) || (NULL == payload) || (NULL == payloadSizeBytes))
+    if ((NULL == componentName) || (NULL == propertyName) || (NULL == callback))
     {
         status = EINVAL;
-        OsConfigLogError(log, "CallMpiGet: called with invalid arguments (%d)", status);
+        OsConfigLogError(log, "CallMpiGetAsync: invalid arguments (%d)", status);
         return status;
     }
 
-    *payload = NULL;
-    *payloadSizeBytes = 0;
-
     requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(componentName) + strlen(propertyName) + 1;
 
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if (NULL == (request = (char*)malloc(requestSize)))
     {
         status = ENOMEM;
-        OsConfigLogError(log, "CallMpiGet(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
+        OsConfigLogError(log, "CallMpiGetAsync(%s, %s): failed to allocate memory for request (%d)", componentName, propertyName, status);
         return status;
     }
 
     snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, componentName, propertyName);
 
-    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+    status = SubmitMpiCall("MpiGet", componentName, propertyName, MpiObjectResponse, true, request, callback, context, log);
 
     FREE_MEMORY(request);
 
-    if (HTTP_INTERNAL_SERVER_ERROR == status)
-    {
-        if ((NULL != *payload) && (*payloadSizeBytes > 0))
-        {
-            statusFromResponse = ParseString(log, *payload);
-            status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
-            FREE_MEMORY(statusFromResponse);
-
-            FREE_MEMORY(*payload);
-            *payloadSizeBytes = 0;
-        }
-        else
-        {
-            OsConfigLogError(log, "CallMpiGet(%s, %s): invalid response for HTTP internal server error (500)", componentName, propertyName);
-            status = EINVAL;
-        }
-    }
-    else if ((NULL != *payload) && ((*payloadSizeBytes != (int)strlen(*payload)) || (!IsValidMimObjectPayload(*payload, *payloadSizeBytes, log))))
-    {
-        status = EINVAL;
-        OsConfigLogError(log, "CallMpiGet(%s, %s): invalid response (%d)", componentName, propertyName, status);
-
-        FREE_MEMORY(*payload);
-        *payloadSizeBytes = 0;
-    }
-
-    if (IsFullLoggingEnabled())
-    {
-        OsConfigLogInfo(log, "CallMpiGet(%p, %s, %s, %.*s, %d bytes): %d", g_mpiHandle, componentName, propertyName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
-    }
-
     return status;
-};
+}
 
-int CallMpiSetDesired(const MPI_JSON_STRING payload, const int payloadSizeBytes, void* log)
+int CallMpiSetDesiredAsync(const MPI_JSON_STRING payload, const int payloadSizeBytes, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
 {
-    const char *name = "MpiSetDesired";
-    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Payload\": %s }";
-    
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Payload\": %.*s }";
+
     char* request = NULL;
-    char *response = NULL;
     int requestSize = 0;
-    int responseSize = 0;
     int status = MPI_OK;
-    char* statusFromResponse = NULL;
 
     if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
     {
         status = EPERM;
-        OsConfigLogError(log, "CallMpiSetDesired: called without a valid MPI handle (%d)", status);
+        OsConfigLogError(log, "CallMpiSetDesiredAsync: called without a valid MPI handle (%d)", status);
         return status;
     }
 
-    if ((NULL == payload) || (0 >= payloadSizeBytes))
+    if ((NULL == payload) || (0 >= payloadSizeBytes) || (NULL == callback))
     {
         status = EINVAL;
-        OsConfigLogError(log, "CallMpiSetDesired: invalid arguments (%d)", status);
+        OsConfigLogError(log, "CallMpiSetDesiredAsync: invalid arguments (%d)", status);
         return status;
     }
 
     requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + payloadSizeBytes + 1;
 
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if (NULL == (request = (char*)malloc(requestSize)))
     {
         status = ENOMEM;
-        OsConfigLogError(log, "CallMpiSetDesired: failed to allocate memory for request (%d)", status);
+        OsConfigLogError(log, "CallMpiSetDesiredAsync: failed to allocate memory for request (%d)", status);
         return status;
     }
 
-    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, payload);
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, payloadSizeBytes, payload);
 
-    status = CallMpi(name, request, &response, &responseSize, log);
+    status = SubmitMpiCall("MpiSetDesired", NULL, NULL, MpiStatusResponse, false, request, callback, context, log);
 
     FREE_MEMORY(request);
 
-    if ((NULL != response) && (responseSize > 0))
-    {
-        statusFromResponse = ParseString(log, response);
-        status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
-        FREE_MEMORY(statusFromResponse);
-    }
-
-    if (IsFullLoggingEnabled())
-    {
-        OsConfigLogInfo(log, "CallMpiSetDesired(%p, %.*s, %d bytes) returned %d", g_mpiHandle, payloadSizeBytes, payload, payloadSizeBytes, status);
-    }
-    else
-    {
-        OsConfigLogInfo(log, "CallMpiSetDesired(%p, %d bytes) returned %d", g_mpiHandle, payloadSizeBytes, status);
-    }
-
     return status;
 }
 
-int CallMpiGetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log)
+static int CallMpiManyAsync(const char* name, bool repeatable, const char* objects, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
 {
-    const char *name = "MpiGetReported";
-    static const char *requestBodyFormat = "{ \"ClientSession\": %s }";
+    static const char *requestBodyFormat = "{ \"ClientSession\": %s, \"Objects\": %s }";
 
     char* request = NULL;
     int requestSize = 0;
     int status = MPI_OK;
-    char* statusFromResponse = NULL;
 
     if ((NULL == g_mpiHandle) || (0 == strlen((char*)g_mpiHandle)))
     {
         status = EPERM;
-        OsConfigLogError(log, "CallMpiGetReported: called without a valid MPI handle (%d)", status);
+        OsConfigLogError(log, "CallMpiManyAsync(%s): called without a valid MPI handle (%d)", name, status);
         return status;
     }
 
-    if ((NULL == payload) || (NULL == payloadSizeBytes))
+    if ((NULL == objects) || (NULL == callback))
     {
         status = EINVAL;
-        OsConfigLogError(log, "CallMpiGetReported: called with invalid arguments (%d)", status);
+        OsConfigLogError(log, "CallMpiManyAsync(%s): called with invalid arguments (%d)", name, status);
         return status;
     }
 
-    *payload = NULL;
-    *payloadSizeBytes = 0;
-
-    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + 1;
+    requestSize = strlen(requestBodyFormat) + strlen((char*)g_mpiHandle) + strlen(objects) + 1;
 
-    request = (char*)malloc(requestSize);
-    if (NULL == request)
+    if (NULL == (request = (char*)malloc(requestSize)))
     {
         status = ENOMEM;
-        OsConfigLogError(log, "CallMpiGetReported: failed to allocate memory for request (%d)", status);
+        OsConfigLogError(log, "CallMpiManyAsync(%s): failed to allocate memory for request (%d)", name, status);
         return status;
     }
 
-    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle);
+    snprintf(request, requestSize, requestBodyFormat, (char*)g_mpiHandle, objects);
 
-    status = CallMpi(name, request, payload, payloadSizeBytes, log);
+    status = SubmitMpiCall(name, NULL, NULL, MpiManyResponse, repeatable, request, callback, context, log);
 
     FREE_MEMORY(request);
 
-    if (HTTP_INTERNAL_SERVER_ERROR == status)
+    return status;
+}
+
+int CallMpiSetManyAsync(const char* objects, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
+{
+    return CallMpiManyAsync("MpiSetMany", false, objects, callback, context, log);
+}
+
+int CallMpiGetManyAsync(const char* objects, MPI_COMPLETION_CALLBACK callback, void* context, void* log)
+{
+    return CallMpiManyAsync("MpiGetMany", true, objects, callback, context, log);
+}
+
+int GetMpiAsyncDescriptor(short* events)
+{
+    if ((NULL == g_firstAsyncCall) || (0 > g_mpiAsyncSocketHandle))
     {
-        if ((NULL != *payload) && (*payloadSizeBytes > 0))
+        return -1;
+    }
+
+    if (NULL != events)
+    {
+        *events = (NULL != g_nextAsyncCall) ? (POLLIN | POLLOUT) : POLLIN;
+    }
+
+    return g_mpiAsyncSocketHandle;
+}
+
+int CallMpiDoWork(int timeoutMilliseconds, void* log)
+{
+    struct pollfd pollDescriptor = {0};
+    int result = 0;
+
+    if (0 > (pollDescriptor.fd = GetMpiAsyncDescriptor(&pollDescriptor.events)))
+    {
+        return g_numAsyncCalls;
+    }
+
+    if ((0 > (result = poll(&pollDescriptor, 1, timeoutMilliseconds))) && (EINTR != errno))
+    {
+        OsConfigLogError(log, "CallMpiDoWork: poll on socket '%s' failed (%d)", g_mpiSocket, errno);
+    }
+    else if (0 < result)
+    {
+        if (0 != (pollDescriptor.revents & POLLOUT))
         {
-            statusFromResponse = ParseString(log, *payload);
-            status = (NULL == statusFromResponse) ? EINVAL : atoi(statusFromResponse);
-            FREE_MEMORY(statusFromResponse);
+            SendMpiAsyncCalls(log);
         }
-        else
+
+        if (0 != (pollDescriptor.revents & (POLLIN | POLLHUP | POLLERR)))
         {
-            OsConfigLogError(log, "CallMpiGetReported: invalid response for HTTP internal server error (500)");
-            status = EINVAL;
+            ReceiveMpiAsyncResponses(log);
         }
-
-        FREE_MEMORY(*payload);
-        *payloadSizeBytes = 0;
     }
-    else if ((NULL != *payload) && (*payloadSizeBytes != (int)strlen(*payload)))
-    {
-        OsConfigLogError(log, "CallMpiGetReported: invalid response (%p, %d)", *payload, *payloadSizeBytes);
 
-        status = EINVAL;
+    return g_numAsyncCalls;
+}
 
-        FREE_MEMORY(*payload);
-        *payloadSizeBytes = 0;
-    }
+void CancelMpiAsyncCalls(void* log)
+{
+    CloseMpiAsyncSocket();
 
-    if (IsFullLoggingEnabled())
+    while (NULL != g_firstAsyncCall)
     {
-        OsConfigLogInfo(log, "CallMpiGetReported(%p, %.*s, %d bytes): %d", g_mpiHandle, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+        CompleteMpiAsyncCall(RemoveFirstMpiAsyncCall(), ECANCELED, NULL, 0, log);
     }
-
-    return status;
 }
 
 void CallMpiFree(MPI_JSON_STRING payload)
@@ -15,8 +15,45 @@ int CallMpiSet(const char* componentName, const char* propertyName, const MPI_JS
 int CallMpiGet(const char* componentName, const char* propertyName, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log);
 int CallMpiSetDesired(const MPI_JSON_STRING payload, const int payloadSizeBytes, void* log);
 int CallMpiGetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log);
+
+// Returns the reported objects changed since the version returned by the previous call (0 the first time) as {"Reported": {...}, "Version": n, "Full": b},
+// "Full" is true when all objects are returned because the platform did not hand out that version (for example when it was restarted since)
+int CallMpiGetReportedChanges(const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log);
+
+// Hands the reported payload to the callback piece by piece as it is received, the callback cannot make other MPI calls
+int CallMpiGetReportedStream(MPI_WRITE_CALLBACK writeCallback, void* context, void* log);
+
+// The objects are a JSON array of {"ComponentName", "ObjectName"(, "Payload")} items, the payload returned is a JSON
+// array with one {"ComponentName", "ObjectName", "Status"(, "Payload")} result per requested object, in the same order
+int CallMpiSetMany(const char* objects, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log);
+int CallMpiGetMany(const char* objects, MPI_JSON_STRING* payload, int* payloadSizeBytes, void* log);
 void CallMpiFree(MPI_JSON_STRING payload);
 
+// Receives the status and payload of an asynchronous call as the blocking call returns them, the payload is freed when the callback returns
+typedef void(*MPI_COMPLETION_CALLBACK)(int status, MPI_JSON_STRING payload, int payloadSizeBytes, void* context);
+
+// Asynchronous calls are pipelined in order on their own connection to the platform, submitted and driven from one thread. A call submitted
+// with MPI_OK completes exactly once, from CallMpiDoWork, CancelMpiAsyncCalls or a later submission; completion callbacks can submit new calls.
+// When the connection is lost, the calls the platform may have served already fail unless repeating them does no harm (MpiGet, MpiGetMany)
+int CallMpiSetAsync(const char* componentName, const char* propertyName, const MPI_JSON_STRING payload, const int payloadSizeBytes, MPI_COMPLETION_CALLBACK callback, void* context, void* log);
+int CallMpiGetAsync(const char* componentName, const char* propertyName, MPI_COMPLETION_CALLBACK callback, void* context, void* log);
+int CallMpiSetDesiredAsync(const MPI_JSON_STRING payload, const int payloadSizeBytes, MPI_COMPLETION_CALLBACK callback, void* context, void* log);
+int CallMpiSetManyAsync(const char* objects, MPI_COMPLETION_CALLBACK callback, void* context, void* log);
+int CallMpiGetManyAsync(const char* objects, MPI_COMPLETION_CALLBACK callback, void* context, void* log);
+
+// Returns the descriptor to poll, with the events to poll for, while asynchronous calls are in flight; otherwise -1
+int GetMpiAsyncDescriptor(short* events);
+
+// Waits up to the timeout for the connection to make progress and completes the calls answered, returns the number of calls still in flight
+int CallMpiDoWork(int timeoutMilliseconds, void* log);
+
+// Completes all calls in flight with ECANCELED
+void CancelMpiAsyncCalls(void* log);
+
+#ifdef TEST_CODE
+void SetMpiClientSocket(const char* socketPath);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -621,6 +621,10 @@ TEST_F(CommonUtilsTest, ValidateMimObjectPayload)
     const char invalidIntegerArrayPayload[] = R"""({"integerArray": [1, "value1"]})""";
     const char invalidStringMapPayload[] = R"""({"stringMap": {"key1": "value1", "key2": 1}})""";
     const char invalidIntegerMapPayload[] = R"""({"integerMap": {"key1": 1, "key2": "value1"}})""";
+    const char invalidDoublePayload[] = R"""(1.5)""";
+    const char invalidNullPayload[] = R"""({"string": "value", "boolean": true, "null": null})""";
+    const char invalidArrayPayload[] = R"""([["value1"], ["value2"]])""";
+    const char invalidObjectArrayPayload[] = R"""([{"string": "value", "null": null}])""";
 
     ASSERT_FALSE(IsValidMimObjectPayload(nullptr, 0, nullptr));
     ASSERT_FALSE(IsValidMimObjectPayload(invalidJson, sizeof(invalidJson), nullptr));
@@ -628,6 +632,10 @@ TEST_F(CommonUtilsTest, ValidateMimObjectPayload)
     ASSERT_FALSE(IsValidMimObjectPayload(invalidIntegerArrayPayload, sizeof(invalidIntegerArrayPayload), nullptr));
     ASSERT_FALSE(IsValidMimObjectPayload(invalidStringMapPayload, sizeof(invalidStringMapPayload), nullptr));
     ASSERT_FALSE(IsValidMimObjectPayload(invalidIntegerMapPayload, sizeof(invalidIntegerMapPayload), nullptr));
+    ASSERT_FALSE(IsValidMimObjectPayload(invalidDoublePayload, sizeof(invalidDoublePayload), nullptr));
+    ASSERT_FALSE(IsValidMimObjectPayload(invalidNullPayload, sizeof(invalidNullPayload), nullptr));
+    ASSERT_FALSE(IsValidMimObjectPayload(invalidArrayPayload, sizeof(invalidArrayPayload), nullptr));
+    ASSERT_FALSE(IsValidMimObjectPayload(invalidObjectArrayPayload, sizeof(invalidObjectArrayPayload), nullptr));
 }
 
 struct HttpProxyOptions
@@ -1063,6 +1071,364 @@ TEST_F(CommonUtilsTest, ReadtHttpHeaderInfoFromSocket)
     }
 }
 
+TEST_F(CommonUtilsTest, ReadHttpMessageFromSocket)
+{
+    const char* testPath = "~socket.test";
+    const char* pipelined =
+        "POST /MpiOpen/ HTTP/1.1\r\nHost: osconfig\r\ncontent-length: 4\r\n\r\n\"ab\""
+        "POST /MpiClose/ HTTP/1.1\r\nConnection: close\r\nContent-Length: 2\r\n\r\n{}"
+        "POST /MpiGet/ HTTP/1.1\r\n";
+    const char* firstPart = "HTTP/1.1 200 OK\r\nContent-Le";
+    const char* secondPart = "ngth: 7\r\n\r\n\"val";
+    const char* lastPart = "ue\"";
+    const char* startLine = "POST /MpiGet/ HTTP/1.1\r\n";
+    const char* headerLine = "X-Header: 1\r\n";
+
+    HTTP_PARSER parser = {};
+    char* body = nullptr;
+    int bodySize = 0;
+    int status = 0;
+    int fileDescriptor = -1;
+    int pipeDescriptors[2] = {-1, -1};
+
+    // Pipelined requests are parsed one at a time from the same buffer
+    EXPECT_TRUE(CreateTestFile(testPath, pipelined));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_STREQ("MpiOpen", parser.uri);
+    EXPECT_EQ(4, (int)parser.contentLength);
+    EXPECT_STREQ("\"ab\"", GetHttpBody(&parser));
+    EXPECT_TRUE(parser.keepAlive);
+    ConsumeHttpMessage(&parser);
+    EXPECT_EQ(nullptr, GetHttpBody(&parser));
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_STREQ("MpiClose", parser.uri);
+    EXPECT_STREQ("{}", GetHttpBody(&parser));
+    EXPECT_FALSE(parser.keepAlive);
+    ConsumeHttpMessage(&parser);
+    EXPECT_EQ(ECONNRESET, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    // A message arriving in parts on a non-blocking socket is completed across reads
+    EXPECT_EQ(0, pipe(pipeDescriptors));
+    EXPECT_EQ(0, fcntl(pipeDescriptors[0], F_SETFL, O_NONBLOCK));
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_EQ(EAGAIN, ReadHttpMessageFromSocket(pipeDescriptors[0], &parser, nullptr));
+    EXPECT_EQ((ssize_t)strlen(firstPart), write(pipeDescriptors[1], firstPart, strlen(firstPart)));
+    EXPECT_EQ(EAGAIN, ReadHttpMessageFromSocket(pipeDescriptors[0], &parser, nullptr));
+    EXPECT_EQ((ssize_t)strlen(secondPart), write(pipeDescriptors[1], secondPart, strlen(secondPart)));
+    EXPECT_EQ(EAGAIN, ReadHttpMessageFromSocket(pipeDescriptors[0], &parser, nullptr));
+    EXPECT_EQ((ssize_t)strlen(lastPart), write(pipeDescriptors[1], lastPart, strlen(lastPart)));
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(pipeDescriptors[0], &parser, nullptr));
+    EXPECT_EQ(200, parser.httpStatus);
+    EXPECT_STREQ("\"value\"", body = DetachHttpBody(&parser, &bodySize));
+    EXPECT_EQ(7, bodySize);
+    EXPECT_EQ(nullptr, parser.buffer);
+    FREE_MEMORY(body);
+    EXPECT_EQ(0, close(pipeDescriptors[0]));
+    EXPECT_EQ(0, close(pipeDescriptors[1]));
+
+    // Content-Length is validated against the maximum
+    EXPECT_TRUE(CreateTestFile(testPath, "POST /MpiSet/ HTTP/1.1\r\nContent-Length: 1025\r\n\r\n"));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, 1024);
+    EXPECT_EQ(E2BIG, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    EXPECT_TRUE(CreateTestFile(testPath, "POST /MpiSet/ HTTP/1.1\r\nContent-Length: abc\r\n\r\n"));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, 1024);
+    EXPECT_EQ(EINVAL, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    // Short header lines that do not end are cut off once all of them together exceed the maximum
+    EXPECT_EQ(0, pipe(pipeDescriptors));
+    EXPECT_EQ(0, fcntl(pipeDescriptors[0], F_SETFL, O_NONBLOCK));
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_EQ((ssize_t)strlen(startLine), write(pipeDescriptors[1], startLine, strlen(startLine)));
+    for (int i = 0; (i <= HTTP_MAX_HEADERS_SIZE / (int)strlen(headerLine)) && (EAGAIN == (status = ReadHttpMessageFromSocket(pipeDescriptors[0], &parser, nullptr))); i++)
+    {
+        EXPECT_EQ((ssize_t)strlen(headerLine), write(pipeDescriptors[1], headerLine, strlen(headerLine)));
+    }
+    EXPECT_EQ(EMSGSIZE, status);
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(pipeDescriptors[0]));
+    EXPECT_EQ(0, close(pipeDescriptors[1]));
+
+    EXPECT_EQ(EINVAL, ReadHttpMessageFromSocket(-1, &parser, nullptr));
+    EXPECT_EQ(EINVAL, ParseHttpMessage(nullptr, nullptr));
+}
+
+TEST_F(CommonUtilsTest, ReadHttpChunkFromSocket)
+{
+    const char* testPath = "~socket.test";
+    const char* chunked =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "7\r\n{\"A\": 1\r\n"
+        "1;name=value\r\n}\r\n"
+        "0\r\nTrailer: ignored\r\n\r\n"
+        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}";
+
+    HTTP_PARSER parser = {};
+    char* chunk = nullptr;
+    size_t chunkSize = 0;
+    int fileDescriptor = -1;
+
+    EXPECT_TRUE(CreateTestFile(testPath, chunked));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_EQ(EINVAL, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_TRUE(parser.chunked);
+    EXPECT_EQ(0, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_STREQ("{\"A\": 1", chunk);
+    EXPECT_EQ(7, (int)chunkSize);
+    EXPECT_EQ(0, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_STREQ("}", chunk);
+    EXPECT_EQ(1, (int)chunkSize);
+    EXPECT_EQ(0, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_EQ(nullptr, chunk);
+    EXPECT_EQ(0, (int)chunkSize);
+    EXPECT_EQ(0, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_EQ(0, (int)chunkSize);
+
+    // The message following the chunked one is kept
+    ConsumeHttpMessage(&parser);
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_FALSE(parser.chunked);
+    EXPECT_STREQ("{}", GetHttpBody(&parser));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    // Chunk sizes are validated against the maximum and the chunk data must be followed by CRLF
+    EXPECT_TRUE(CreateTestFile(testPath, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n401\r\n"));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, 1024);
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_EQ(E2BIG, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    EXPECT_TRUE(CreateTestFile(testPath, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}}\r\n"));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, 1024);
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_EQ(EINVAL, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+
+    // A body that ends before its last chunk is reported
+    EXPECT_TRUE(CreateTestFile(testPath, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}\r\n"));
+    EXPECT_NE(-1, fileDescriptor = open(testPath, O_RDONLY));
+    InitHttpParser(&parser, 1024);
+    EXPECT_EQ(0, ReadHttpMessageFromSocket(fileDescriptor, &parser, nullptr));
+    EXPECT_EQ(0, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    EXPECT_STREQ("{}", chunk);
+    EXPECT_EQ(ECONNRESET, ReadHttpChunkFromSocket(fileDescriptor, &parser, &chunk, &chunkSize, nullptr));
+    FreeHttpParser(&parser);
+    EXPECT_EQ(0, close(fileDescriptor));
+    EXPECT_TRUE(Cleanup(testPath));
+}
+
+TEST_F(CommonUtilsTest, SkipJsonValue)
+{
+    const char* valid[] = {
+        "0", "-12.5e+3", "1E9", "true", "false", "null", "\"\"", "\"a\\\"b\\u00E9\\n\"", "[]", "{}",
+        " [ 1 , \"two\" , { \"three\" : [ null ] } ] ", "{\"a\":{\"b\":[true,false]}}"
+    };
+    const char* invalid[] = {
+        "", " ", "[01]", "-", "1.", "1e", "+1", "tru", "nul", "\"abc", "\"\\x\"", "\"\\u12G4\"", "\"a\tb\"",
+        "[1,]", "[1 2]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{a:1}", "[", "{\"a\":[1}"
+    };
+    size_t offset = 0;
+    std::string deep(600, '[');
+
+    for (size_t i = 0; i < ARRAY_SIZE(valid); i++)
+    {
+        offset = 0;
+        EXPECT_EQ(0, SkipJsonValue(valid[i], strlen(valid[i]), &offset)) << valid[i];
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(invalid); i++)
+    {
+        offset = 0;
+        EXPECT_EQ(EINVAL, SkipJsonValue(invalid[i], strlen(invalid[i]), &offset)) << invalid[i];
+    }
+
+    offset = 0;
+    EXPECT_EQ(0, SkipJsonValue("[1, 2] tail", strlen("[1, 2] tail"), &offset));
+    EXPECT_EQ(strlen("[1, 2]"), offset);
+
+    deep += std::string(600, ']');
+    offset = 0;
+    EXPECT_EQ(EINVAL, SkipJsonValue(deep.c_str(), deep.size(), &offset));
+
+    EXPECT_EQ(EINVAL, SkipJsonValue(nullptr, 0, &offset));
+    EXPECT_EQ(EINVAL, SkipJsonValue("1", 1, nullptr));
+}
+
+TEST_F(CommonUtilsTest, GetNextJsonObjectMember)
+{
+    const char object[] = " { \"a\" : 1, \"b\":{ \"c\": [true] } ,\"d\\\"e\":\"x}\" } \n";
+    JSON_SPAN name = {};
+    JSON_SPAN value = {};
+    size_t offset = 0;
+
+    EXPECT_EQ(0, GetNextJsonObjectMember(object, strlen(object), &offset, &name, &value));
+    EXPECT_EQ("a", std::string(name.data, name.length));
+    EXPECT_EQ("1", std::string(value.data, value.length));
+
+    EXPECT_EQ(0, GetNextJsonObjectMember(object, strlen(object), &offset, &name, &value));
+    EXPECT_EQ("b", std::string(name.data, name.length));
+    EXPECT_EQ("{ \"c\": [true] }", std::string(value.data, value.length));
+
+    EXPECT_EQ(0, GetNextJsonObjectMember(object, strlen(object), &offset, &name, &value));
+    EXPECT_EQ("d\\\"e", std::string(name.data, name.length));
+    EXPECT_EQ("\"x}\"", std::string(value.data, value.length));
+
+    EXPECT_EQ(ENOENT, GetNextJsonObjectMember(object, strlen(object), &offset, &name, &value));
+
+    // The terminating null character is accepted as the end of the text
+    offset = 0;
+    EXPECT_EQ(ENOENT, GetNextJsonObjectMember("{}", sizeof("{}"), &offset, &name, &value));
+
+    offset = 0;
+    EXPECT_EQ(EINVAL, GetNextJsonObjectMember("[]", 2, &offset, &name, &value));
+    offset = 0;
+    EXPECT_EQ(EINVAL, GetNextJsonObjectMember("{} {}", 5, &offset, &name, &value));
+    offset = 0;
+    EXPECT_EQ(EINVAL, GetNextJsonObjectMember("invalid", 7, &offset, &name, &value));
+    offset = 0;
+    EXPECT_EQ(0, GetNextJsonObjectMember("{\"a\":1,}", 8, &offset, &name, &value));
+    EXPECT_EQ(EINVAL, GetNextJsonObjectMember("{\"a\":1,}", 8, &offset, &name, &value));
+
+    EXPECT_EQ(0, FindJsonObjectMember(object, strlen(object), "b", &value));
+    EXPECT_EQ("{ \"c\": [true] }", std::string(value.data, value.length));
+    EXPECT_EQ(ENOENT, FindJsonObjectMember(object, strlen(object), "c", &value));
+    EXPECT_EQ(EINVAL, FindJsonObjectMember("{\"a\":}", 6, "a", &value));
+}
+
+TEST_F(CommonUtilsTest, GetNextJsonArrayElement)
+{
+    const char array[] = " [ 1, {\"a\": [2, 3]} ,\"x]\" ] \n";
+    JSON_SPAN value = {};
+    size_t offset = 0;
+
+    EXPECT_EQ(0, GetNextJsonArrayElement(array, strlen(array), &offset, &value));
+    EXPECT_EQ("1", std::string(value.data, value.length));
+    EXPECT_EQ(0, GetNextJsonArrayElement(array, strlen(array), &offset, &value));
+    EXPECT_EQ("{\"a\": [2, 3]}", std::string(value.data, value.length));
+    EXPECT_EQ(0, GetNextJsonArrayElement(array, strlen(array), &offset, &value));
+    EXPECT_EQ("\"x]\"", std::string(value.data, value.length));
+    EXPECT_EQ(ENOENT, GetNextJsonArrayElement(array, strlen(array), &offset, &value));
+
+    offset = 0;
+    EXPECT_EQ(ENOENT, GetNextJsonArrayElement("[]", sizeof("[]"), &offset, &value));
+
+    offset = 0;
+    EXPECT_EQ(EINVAL, GetNextJsonArrayElement("{}", 2, &offset, &value));
+    offset = 0;
+    EXPECT_EQ(EINVAL, GetNextJsonArrayElement("[] []", 5, &offset, &value));
+    offset = 0;
+    EXPECT_EQ(0, GetNextJsonArrayElement("[1,]", 4, &offset, &value));
+    EXPECT_EQ(EINVAL, GetNextJsonArrayElement("[1,]", 4, &offset, &value));
+    offset = 0;
+    EXPECT_EQ(0, GetNextJsonArrayElement("[1 2]", 5, &offset, &value));
+    EXPECT_EQ(EINVAL, GetNextJsonArrayElement("[1 2]", 5, &offset, &value));
+}
+
+TEST_F(CommonUtilsTest, CopyJsonString)
+{
+    const char* valid[][2] = {
+        {"\"\"", ""},
+        {"\"name\"", "name"},
+        {"\"a\\\"b\\\\c\\/d\\te\"", "a\"b\\c/d\te"},
+        {"\"\\u0041\\u00e9\\u20ac\"", "A\xc3\xa9\xe2\x82\xac"},
+        {"\"\\ud83d\\ude00\"", "\xf0\x9f\x98\x80"}
+    };
+    const char* invalid[] = {"name", "\"name", "\"a\" ", "1", "\"\\x\"", "\"\\u0000\""};
+    JSON_SPAN value = {};
+    char* string = nullptr;
+
+    for (size_t i = 0; i < ARRAY_SIZE(valid); i++)
+    {
+        value.data = valid[i][0];
+        value.length = strlen(valid[i][0]);
+        EXPECT_STREQ(valid[i][1], string = CopyJsonString(&value)) << valid[i][0];
+        FREE_MEMORY(string);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(invalid); i++)
+    {
+        value.data = invalid[i];
+        value.length = strlen(invalid[i]);
+        EXPECT_EQ(nullptr, CopyJsonString(&value)) << invalid[i];
+    }
+
+    EXPECT_EQ(nullptr, CopyJsonString(nullptr));
+}
+
+TEST_F(CommonUtilsTest, SharedMemoryChannel)
+{
+    SHARED_MEMORY_CHANNEL responder = {};
+    SHARED_MEMORY_CHANNEL requester = {};
+    char name[HTTP_MAX_URI_LENGTH + 1] = {0};
+    char* message = nullptr;
+    size_t messageSize = 0;
+    int messageStatus = 0;
+
+    ASSERT_EQ(0, CreateSharedMemoryChannel(&responder, 16, 32, nullptr));
+    ASSERT_TRUE(IsSharedMemoryChannelOpen(&responder));
+
+    // The requester gets its own descriptors, like when they are passed over a socket
+    ASSERT_EQ(0, OpenSharedMemoryChannel(&requester, dup(responder.memoryHandle), dup(responder.requestEvent), dup(responder.responseEvent), nullptr));
+    EXPECT_EQ(16, requester.requestCapacity);
+    EXPECT_EQ(32, requester.responseCapacity);
+
+    EXPECT_EQ(EAGAIN, ReceiveSharedMemoryRequest(&responder, name, &message, &messageSize));
+
+    EXPECT_EQ(E2BIG, PostSharedMemoryRequest(&requester, "MpiGet", "{\"too\": \"long\"}", 17));
+    EXPECT_EQ(0, PostSharedMemoryRequest(&requester, "MpiGet", "{\"a\": 1}", 8));
+    EXPECT_EQ(0, ReceiveSharedMemoryRequest(&responder, name, &message, &messageSize));
+    EXPECT_STREQ("MpiGet", name);
+    EXPECT_STREQ("{\"a\": 1}", message);
+    EXPECT_EQ(8, messageSize);
+    FREE_MEMORY(message);
+
+    EXPECT_EQ(EAGAIN, ReceiveSharedMemoryRequest(&responder, name, &message, &messageSize));
+
+    EXPECT_EQ(0, PostSharedMemoryResponse(&responder, 200, "\"value\"", 7));
+    EXPECT_EQ(0, ReceiveSharedMemoryResponse(&requester, &messageStatus, &message, &messageSize));
+    EXPECT_EQ(200, messageStatus);
+    EXPECT_STREQ("\"value\"", message);
+    EXPECT_EQ(7, messageSize);
+    FREE_MEMORY(message);
+
+    EXPECT_EQ(0, PostSharedMemoryResponse(&responder, 500, nullptr, 0));
+    EXPECT_EQ(0, ReceiveSharedMemoryResponse(&requester, &messageStatus, &message, &messageSize));
+    EXPECT_EQ(500, messageStatus);
+    EXPECT_STREQ("", message);
+    EXPECT_EQ(0, messageSize);
+    FREE_MEMORY(message);
+
+    CloseSharedMemoryChannel(&requester);
+    EXPECT_FALSE(IsSharedMemoryChannelOpen(&requester));
+    EXPECT_EQ(EINVAL, PostSharedMemoryRequest(&requester, "MpiGet", "{}", 2));
+
+    CloseSharedMemoryChannel(&responder);
+    EXPECT_FALSE(IsSharedMemoryChannelOpen(&responder));
+}
+
 TEST_F(CommonUtilsTest, MillisecondsSleep)
 {
     long validValue = 100;
@@ -1083,6 +1449,15 @@ TEST_F(CommonUtilsTest, LoadConfiguration)
           "\"LocalManagement\": 3,"
           "\"ModelVersion\": 11,"
           "\"IotHubProtocol\": 2,"
+          "\"MpiServerWorkers\": 100,"
+          "\"MaxHttpContentLength\": 100,"
+          "\"SharedMemoryTransport\": 1,"
+          "\"ModuleIdleUnloadSeconds\": 100000,"
+          "\"ReportedObjectTimeoutMilliseconds\": 5000,"
+          "\"ModuleCallTimeoutMilliseconds\": 30000,"
+          "\"PrettyPrintReported\": 1,"
+          "\"ParallelDesired\": 1,"
+          "\"ModuleHost\": 1,"
           "\"Reported\": ["
           "  {"
           "    \"ComponentName\": \"DeviceInfo\","
@@ -1107,6 +1482,36 @@ TEST_F(CommonUtilsTest, LoadConfiguration)
     // The value of 3 is too big, shall be changed to 1
     EXPECT_EQ(1, GetLocalManagementFromJsonConfig(configuration, nullptr));
 
+    // The value of 100 is too big, shall be changed to 64
+    EXPECT_EQ(64, GetMpiServerWorkersFromJsonConfig(configuration, nullptr));
+    EXPECT_LE(1, GetMpiServerWorkersFromJsonConfig("{}", nullptr));
+
+    // The value of 100 is too small, shall be changed to 1024
+    EXPECT_EQ(1024, GetMaxHttpContentLengthFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(HTTP_DEFAULT_MAX_CONTENT_LENGTH, GetMaxHttpContentLengthFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(1, GetSharedMemoryTransportFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetSharedMemoryTransportFromJsonConfig("{}", nullptr));
+
+    // The value of 100000 is too big, shall be changed to 86400
+    EXPECT_EQ(86400, GetModuleIdleUnloadSecondsFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetModuleIdleUnloadSecondsFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(5000, GetReportedObjectTimeoutFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetReportedObjectTimeoutFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(30000, GetModuleCallTimeoutFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetModuleCallTimeoutFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(1, GetPrettyPrintReportedFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetPrettyPrintReportedFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(1, GetParallelDesiredFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetParallelDesiredFromJsonConfig("{}", nullptr));
+
+    EXPECT_EQ(1, GetModuleHostFromJsonConfig(configuration, nullptr));
+    EXPECT_EQ(0, GetModuleHostFromJsonConfig("{}", nullptr));
+
     EXPECT_EQ(2, LoadReportedFromJsonConfig(configuration, &reportedProperties, nullptr));
     EXPECT_STREQ("DeviceInfo", reportedProperties[0].componentName);
     EXPECT_STREQ("osName", reportedProperties[0].propertyName);
@@ -0,0 +1,469 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <gtest/gtest.h>
+#include <CommonUtils.h>
+#include <Mpi.h>
+#include <MpiClient.h>
+
+using namespace std;
+
+extern "C"
+{
+    MPI_HANDLE g_mpiHandle = nullptr;
+}
+
+struct MpiCompletion
+{
+    string tag;
+    int status;
+    string payload;
+};
+
+static vector<MpiCompletion> g_completions;
+
+static void RecordCompletion(int status, MPI_JSON_STRING payload, int payloadSizeBytes, void* context)
+{
+    g_completions.push_back({(const char*)context, status, (nullptr != payload) ? string(payload, payloadSizeBytes) : string()});
+}
+
+// Completion callbacks can submit new calls
+static void ResubmitOnCompletion(int status, MPI_JSON_STRING payload, int payloadSizeBytes, void* context)
+{
+    RecordCompletion(status, payload, payloadSizeBytes, context);
+    EXPECT_EQ(MPI_OK, CallMpiGetAsync("Component", "Resubmitted", RecordCompletion, (void*)"resubmitted", nullptr));
+}
+
+// Stands in for the platform on a local socket, the asynchronous calls never block so the test drives both sides from one thread
+class MpiClientTest : public ::testing::Test
+{
+    protected:
+        string m_socketPath;
+        int m_listenSocket = -1;
+        vector<int> m_connections;
+
+        void SetUp() override
+        {
+            struct sockaddr_un socketAddress = {};
+
+            m_socketPath = "/tmp/osconfig-mpiclient-test-" + to_string(getpid()) + ".sock";
+            unlink(m_socketPath.c_str());
+
+            socketAddress.sun_family = AF_UNIX;
+            strncpy(socketAddress.sun_path, m_socketPath.c_str(), sizeof(socketAddress.sun_path) - 1);
+
+            ASSERT_LE(0, m_listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+            ASSERT_EQ(0, bind(m_listenSocket, (struct sockaddr*)&socketAddress, sizeof(socketAddress)));
+            ASSERT_EQ(0, listen(m_listenSocket, 8));
+
+            SetMpiClientSocket(m_socketPath.c_str());
+            g_mpiHandle = (MPI_HANDLE)"\"test\"";
+            g_completions.clear();
+        }
+
+        void TearDown() override
+        {
+            CancelMpiAsyncCalls(nullptr);
+            g_mpiHandle = nullptr;
+
+            for (int connection : m_connections)
+            {
+                close(connection);
+            }
+
+            if (0 <= m_listenSocket)
+            {
+                close(m_listenSocket);
+            }
+
+            unlink(m_socketPath.c_str());
+        }
+
+        // Returns -1 when no connection is made within the timeout
+        int Accept(int timeoutMilliseconds = 1000)
+        {
+            struct pollfd pollDescriptor = {m_listenSocket, POLLIN, 0};
+            struct timeval timeout = {5, 0};
+            int connection = -1;
+
+            if ((1 == poll(&pollDescriptor, 1, timeoutMilliseconds)) && (0 <= (connection = accept(m_listenSocket, nullptr, nullptr))))
+            {
+                setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            }
+
+            return connection;
+        }
+
+        // Returns the name of the request read (such as "MpiGet") with its body, pipelined requests stay buffered in the parser
+        string ReadRequest(int connection, HTTP_PARSER* parser, string* body = nullptr)
+        {
+            string name;
+
+            if (0 == ReadHttpMessageFromSocket(connection, parser, nullptr))
+            {
+                name = parser->uri;
+
+                if (nullptr != body)
+                {
+                    *body = string(GetHttpBody(parser), parser->contentLength);
+                }
+
+                ConsumeHttpMessage(parser);
+            }
+
+            return name;
+        }
+
+        static string FormatResponse(const string& body, int httpStatus = 200, bool keepAlive = true)
+        {
+            return "HTTP/1.1 " + to_string(httpStatus) + ((200 == httpStatus) ? " OK" : " Internal Server Error") + "\r\nContent-Type: application/json\r\nContent-Length: " +
+                to_string(body.size()) + "\r\nConnection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n" + body;
+        }
+
+        static void Send(int connection, const string& data)
+        {
+            ASSERT_EQ((ssize_t)data.size(), send(connection, data.c_str(), data.size(), MSG_NOSIGNAL));
+        }
+
+        // Answers the given number of requests on a new connection with the same response, the blocking calls need this on another thread
+        thread Serve(int requests, const string& response, bool closeAfter = false)
+        {
+            return thread([this, requests, response, closeAfter]()
+            {
+                HTTP_PARSER parser = {};
+                int connection = -1;
+                int i = 0;
+
+                ASSERT_LE(0, connection = Accept());
+                InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+
+                for (i = 0; i < requests; i++)
+                {
+                    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+                    Send(connection, FormatResponse(response));
+                }
+
+                FreeHttpParser(&parser);
+
+                // The platform closes a connection left idle
+                if (closeAfter)
+                {
+                    close(connection);
+                }
+                else
+                {
+                    m_connections.push_back(connection);
+                }
+            });
+        }
+
+        // Works on the calls until no more than the given number is left in flight
+        static int DoWork(int inFlight = 0)
+        {
+            int result = 0;
+            int i = 0;
+
+            for (i = 0; (i < 50) && (inFlight < (result = CallMpiDoWork(100, nullptr))); i++)
+            {
+            }
+
+            return result;
+        }
+};
+
+TEST_F(MpiClientTest, SubmitAsync)
+{
+    HTTP_PARSER parser = {};
+    string body;
+    int connection = -1;
+
+    EXPECT_EQ(EINVAL, CallMpiGetAsync(nullptr, "Object", RecordCompletion, (void*)"get", nullptr));
+    EXPECT_EQ(-1, GetMpiAsyncDescriptor(nullptr));
+
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Object", RecordCompletion, (void*)"get", nullptr));
+    EXPECT_LE(0, GetMpiAsyncDescriptor(nullptr));
+    EXPECT_TRUE(g_completions.empty());
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser, &body).c_str());
+    EXPECT_NE(string::npos, body.find("\"ComponentName\": \"Component\", \"ObjectName\": \"Object\""));
+
+    Send(connection, FormatResponse("\"value\""));
+    EXPECT_EQ(0, DoWork());
+
+    ASSERT_EQ(1, (int)g_completions.size());
+    EXPECT_EQ("get", g_completions[0].tag);
+    EXPECT_EQ(MPI_OK, g_completions[0].status);
+    EXPECT_EQ("\"value\"", g_completions[0].payload);
+    EXPECT_EQ(-1, GetMpiAsyncDescriptor(nullptr));
+
+    FreeHttpParser(&parser);
+    close(connection);
+}
+
+TEST_F(MpiClientTest, PipelineAsync)
+{
+    HTTP_PARSER parser = {};
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiSetAsync("Component", "Desired", (MPI_JSON_STRING)"1", 1, RecordCompletion, (void*)"set", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Reported", RecordCompletion, (void*)"get", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetManyAsync("[{\"ComponentName\": \"Component\", \"ObjectName\": \"Reported\"}]", RecordCompletion, (void*)"getMany", nullptr));
+
+    // All requests go out on one connection before any response comes back
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+
+    EXPECT_STREQ("MpiSet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGetMany", ReadRequest(connection, &parser).c_str());
+    EXPECT_EQ(-1, Accept(0));
+
+    Send(connection, FormatResponse("\"0\"") + FormatResponse("\"22\"", 500) + FormatResponse("[{\"Status\": 0}]"));
+    EXPECT_EQ(0, DoWork());
+
+    ASSERT_EQ(3, (int)g_completions.size());
+    EXPECT_EQ("set", g_completions[0].tag);
+    EXPECT_EQ(MPI_OK, g_completions[0].status);
+    EXPECT_EQ("get", g_completions[1].tag);
+    EXPECT_EQ(EINVAL, g_completions[1].status);
+    EXPECT_EQ("getMany", g_completions[2].tag);
+    EXPECT_EQ(MPI_OK, g_completions[2].status);
+    EXPECT_EQ("[{\"Status\": 0}]", g_completions[2].payload);
+
+    FreeHttpParser(&parser);
+    close(connection);
+}
+
+TEST_F(MpiClientTest, ResendAsyncAfterConnectionLoss)
+{
+    HTTP_PARSER parser = {};
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "First", RecordCompletion, (void*)"first", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiSetDesiredAsync((MPI_JSON_STRING)"{}", 2, RecordCompletion, (void*)"setDesired", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Last", RecordCompletion, (void*)"last", nullptr));
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiSetDesired", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    FreeHttpParser(&parser);
+    close(connection);
+
+    // The platform may have applied the desired payload before the connection was lost, only the reads are sent again
+    EXPECT_EQ(2, DoWork(2));
+    ASSERT_EQ(1, (int)g_completions.size());
+    EXPECT_EQ("setDesired", g_completions[0].tag);
+    EXPECT_EQ(ECONNRESET, g_completions[0].status);
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+
+    Send(connection, FormatResponse("\"first\"") + FormatResponse("\"last\""));
+    EXPECT_EQ(0, DoWork());
+
+    ASSERT_EQ(3, (int)g_completions.size());
+    EXPECT_EQ("first", g_completions[1].tag);
+    EXPECT_EQ(MPI_OK, g_completions[1].status);
+    EXPECT_EQ("last", g_completions[2].tag);
+    EXPECT_EQ(MPI_OK, g_completions[2].status);
+
+    FreeHttpParser(&parser);
+    close(connection);
+}
+
+TEST_F(MpiClientTest, FailAsyncAfterResponseStarted)
+{
+    HTTP_PARSER parser = {};
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "First", RecordCompletion, (void*)"first", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Last", RecordCompletion, (void*)"last", nullptr));
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    FreeHttpParser(&parser);
+
+    // A call whose response was cut short is not sent again, the call after it is until out of attempts
+    Send(connection, FormatResponse("\"first\"").substr(0, 20));
+    close(connection);
+
+    EXPECT_EQ(1, DoWork(1));
+    ASSERT_EQ(1, (int)g_completions.size());
+    EXPECT_EQ("first", g_completions[0].tag);
+    EXPECT_EQ(ECONNRESET, g_completions[0].status);
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    FreeHttpParser(&parser);
+    close(connection);
+
+    EXPECT_EQ(0, DoWork());
+    ASSERT_EQ(2, (int)g_completions.size());
+    EXPECT_EQ("last", g_completions[1].tag);
+    EXPECT_EQ(ECONNRESET, g_completions[1].status);
+    EXPECT_EQ(-1, Accept(0));
+}
+
+TEST_F(MpiClientTest, ResendAsyncAfterConnectionClose)
+{
+    HTTP_PARSER parser = {};
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiSetAsync("Component", "First", (MPI_JSON_STRING)"1", 1, RecordCompletion, (void*)"first", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiSetAsync("Component", "Last", (MPI_JSON_STRING)"2", 1, RecordCompletion, (void*)"last", nullptr));
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiSet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiSet", ReadRequest(connection, &parser).c_str());
+    FreeHttpParser(&parser);
+
+    // Closing the connection along with a response serves none of the requests after it, these are sent again
+    Send(connection, FormatResponse("\"0\"", 200, false));
+    close(connection);
+
+    EXPECT_EQ(1, DoWork(1));
+    ASSERT_EQ(1, (int)g_completions.size());
+    EXPECT_EQ("first", g_completions[0].tag);
+    EXPECT_EQ(MPI_OK, g_completions[0].status);
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiSet", ReadRequest(connection, &parser).c_str());
+
+    Send(connection, FormatResponse("\"0\""));
+    EXPECT_EQ(0, DoWork());
+
+    ASSERT_EQ(2, (int)g_completions.size());
+    EXPECT_EQ("last", g_completions[1].tag);
+    EXPECT_EQ(MPI_OK, g_completions[1].status);
+
+    FreeHttpParser(&parser);
+    close(connection);
+}
+
+TEST_F(MpiClientTest, SubmitAsyncFromCompletion)
+{
+    HTTP_PARSER parser = {};
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "First", ResubmitOnCompletion, (void*)"first", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Last", RecordCompletion, (void*)"last", nullptr));
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser).c_str());
+    FreeHttpParser(&parser);
+
+    // The call submitted by the callback goes to the new connection after the call sent again
+    Send(connection, FormatResponse("\"first\"", 200, false));
+    close(connection);
+
+    EXPECT_EQ(2, DoWork(2));
+    ASSERT_EQ(1, (int)g_completions.size());
+    EXPECT_EQ("first", g_completions[0].tag);
+
+    ASSERT_LE(0, connection = Accept());
+    InitHttpParser(&parser, HTTP_DEFAULT_MAX_CONTENT_LENGTH);
+    string body;
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser, &body).c_str());
+    EXPECT_NE(string::npos, body.find("\"Last\""));
+    EXPECT_STREQ("MpiGet", ReadRequest(connection, &parser, &body).c_str());
+    EXPECT_NE(string::npos, body.find("\"Resubmitted\""));
+
+    Send(connection, FormatResponse("\"last\"") + FormatResponse("\"resubmitted\""));
+    EXPECT_EQ(0, DoWork());
+
+    ASSERT_EQ(3, (int)g_completions.size());
+    EXPECT_EQ("last", g_completions[1].tag);
+    EXPECT_EQ(MPI_OK, g_completions[1].status);
+    EXPECT_EQ("resubmitted", g_completions[2].tag);
+    EXPECT_EQ(MPI_OK, g_completions[2].status);
+    EXPECT_EQ("\"resubmitted\"", g_completions[2].payload);
+
+    FreeHttpParser(&parser);
+    close(connection);
+}
+
+TEST_F(MpiClientTest, CancelAsync)
+{
+    int connection = -1;
+
+    ASSERT_EQ(MPI_OK, CallMpiSetAsync("Component", "Desired", (MPI_JSON_STRING)"1", 1, RecordCompletion, (void*)"set", nullptr));
+    ASSERT_EQ(MPI_OK, CallMpiGetAsync("Component", "Reported", RecordCompletion, (void*)"get", nullptr));
+    ASSERT_LE(0, connection = Accept());
+
+    CancelMpiAsyncCalls(nullptr);
+
+    ASSERT_EQ(2, (int)g_completions.size());
+    EXPECT_EQ("set", g_completions[0].tag);
+    EXPECT_EQ(ECANCELED, g_completions[0].status);
+    EXPECT_EQ("get", g_completions[1].tag);
+    EXPECT_EQ(ECANCELED, g_completions[1].status);
+
+    EXPECT_EQ(-1, GetMpiAsyncDescriptor(nullptr));
+    EXPECT_EQ(0, CallMpiDoWork(0, nullptr));
+
+    close(connection);
+}
+
+TEST_F(MpiClientTest, KeepAlive)
+{
+    char* payload = nullptr;
+    int payloadSizeBytes = 0;
+    thread server = Serve(2, "\"value\"");
+
+    // Both requests are served on the same connection
+    EXPECT_EQ(MPI_OK, CallMpiGet("Component", "First", &payload, &payloadSizeBytes, nullptr));
+    EXPECT_EQ("\"value\"", string(payload, payloadSizeBytes));
+    CallMpiFree(payload);
+
+    EXPECT_EQ(MPI_OK, CallMpiGet("Component", "Last", &payload, &payloadSizeBytes, nullptr));
+    EXPECT_EQ("\"value\"", string(payload, payloadSizeBytes));
+    CallMpiFree(payload);
+
+    server.join();
+    EXPECT_EQ(-1, Accept(0));
+}
+
+TEST_F(MpiClientTest, ReconnectAfterIdleClose)
+{
+    char* payload = nullptr;
+    int payloadSizeBytes = 0;
+    thread server = Serve(1, "\"first\"", true);
+
+    EXPECT_EQ(MPI_OK, CallMpiGet("Component", "First", &payload, &payloadSizeBytes, nullptr));
+    EXPECT_EQ("\"first\"", string(payload, payloadSizeBytes));
+    CallMpiFree(payload);
+
+    server.join();
+
+    // The connection found closed by the platform is replaced before the next request is sent
+    server = Serve(1, "\"last\"");
+
+    EXPECT_EQ(MPI_OK, CallMpiGet("Component", "Last", &payload, &payloadSizeBytes, nullptr));
+    EXPECT_EQ("\"last\"", string(payload, payloadSizeBytes));
+    CallMpiFree(payload);
+
+    server.join();
+}
@@ -0,0 +1,348 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef MIMBINDINGS_H
+#define MIMBINDINGS_H
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rapidjson/encodedstream.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+// Support for the typed MIM bindings that mimcodegen generates at build time from the MIM models in src/modules/mim.
+// The payload of a MIM object is read into the generated type of the object while it is parsed (SAX) and written from it with a SAX writer,
+// without building a document. ValueReader and ValueWriter are specialized by the generated headers for the enums and objects of each MIM
+namespace Mim
+{
+    // Receives the SAX events of one JSON value. Objects and arrays hand out the reader of each of their members and elements
+    class ValueReaderBase
+    {
+    public:
+        virtual ~ValueReaderBase() = default;
+
+        virtual bool Null() { return false; }
+        virtual bool Bool(bool) { return false; }
+        virtual bool Integer(int64_t) { return false; }
+        virtual bool String(const char*, size_t) { return false; }
+        virtual bool StartObject() { return false; }
+        virtual std::unique_ptr<ValueReaderBase> Key(const char*, size_t) { return nullptr; }
+        virtual bool StartArray() { return false; }
+        virtual std::unique_ptr<ValueReaderBase> Element() { return nullptr; }
+    };
+
+    template <typename T>
+    class ValueReader;
+
+    template <typename T>
+    struct ValueWriter;
+
+    template <typename T>
+    std::unique_ptr<ValueReaderBase> MakeValueReader(T& value)
+    {
+        return std::unique_ptr<ValueReaderBase>(new ValueReader<T>(value));
+    }
+
+    template <>
+    class ValueReader<bool> : public ValueReaderBase
+    {
+    public:
+        explicit ValueReader(bool& value) : m_value(value) {}
+
+        bool Bool(bool value) override
+        {
+            m_value = value;
+            return true;
+        }
+
+    private:
+        bool& m_value;
+    };
+
+    template <>
+    class ValueReader<int> : public ValueReaderBase
+    {
+    public:
+        explicit ValueReader(int& value) : m_value(value) {}
+
+        bool Integer(int64_t value) override
+        {
+            if ((value < INT_MIN) || (value > INT_MAX))
+            {
+                return false;
+            }
+
+            m_value = static_cast<int>(value);
+            return true;
+        }
+
+    private:
+        int& m_value;
+    };
+
+    template <>
+    class ValueReader<std::string> : public ValueReaderBase
+    {
+    public:
+        explicit ValueReader(std::string& value) : m_value(value) {}
+
+        bool String(const char* value, size_t length) override
+        {
+            m_value.assign(value, length);
+            return true;
+        }
+
+    private:
+        std::string& m_value;
+    };
+
+    template <typename T>
+    class ValueReader<std::vector<T>> : public ValueReaderBase
+    {
+    public:
+        explicit ValueReader(std::vector<T>& value) : m_value(value) {}
+
+        bool StartArray() override
+        {
+            m_value.clear();
+            return true;
+        }
+
+        std::unique_ptr<ValueReaderBase> Element() override
+        {
+            m_value.emplace_back();
+            return MakeValueReader(m_value.back());
+        }
+
+    private:
+        std::vector<T>& m_value;
+    };
+
+    // A null map value removes the key from the map
+    template <typename T>
+    class MapValueReader : public ValueReaderBase
+    {
+    public:
+        MapValueReader(std::map<std::string, T>& map, std::string key) : m_map(map), m_key(std::move(key)), m_reader(map[m_key]) {}
+
+        bool Null() override
+        {
+            m_map.erase(m_key);
+            return true;
+        }
+
+        bool Bool(bool value) override { return m_reader.Bool(value); }
+        bool Integer(int64_t value) override { return m_reader.Integer(value); }
+        bool String(const char* value, size_t length) override { return m_reader.String(value, length); }
+        bool StartObject() override { return m_reader.StartObject(); }
+        std::unique_ptr<ValueReaderBase> Key(const char* name, size_t length) override { return m_reader.Key(name, length); }
+        bool StartArray() override { return m_reader.StartArray(); }
+        std::unique_ptr<ValueReaderBase> Element() override { return m_reader.Element(); }
+
+    private:
+        std::map<std::string, T>& m_map;
+        std::string m_key;
+        ValueReader<T> m_reader;
+    };
+
+    template <typename T>
+    class ValueReader<std::map<std::string, T>> : public ValueReaderBase
+    {
+    public:
+        explicit ValueReader(std::map<std::string, T>& value) : m_value(value) {}
+
+        bool StartObject() override
+        {
+            m_value.clear();
+            return true;
+        }
+
+        std::unique_ptr<ValueReaderBase> Key(const char* name, size_t length) override
+        {
+            return std::unique_ptr<ValueReaderBase>(new MapValueReader<T>(m_value, std::string(name, length)));
+        }
+
+    private:
+        std::map<std::string, T>& m_value;
+    };
+
+    // Hands the SAX events of rapidjson::Reader to the reader of the value they belong to
+    class PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler>
+    {
+    public:
+        explicit PayloadHandler(std::unique_ptr<ValueReaderBase> root) : m_next(std::move(root)) {}
+
+        bool Null() { return (nullptr != Next()) && m_current->Null(); }
+        bool Bool(bool value) { return (nullptr != Next()) && m_current->Bool(value); }
+        bool Int(int value) { return (nullptr != Next()) && m_current->Integer(value); }
+        bool Uint(unsigned value) { return (nullptr != Next()) && m_current->Integer(value); }
+        bool Int64(int64_t value) { return (nullptr != Next()) && m_current->Integer(value); }
+        bool Uint64(uint64_t value) { return (value <= INT64_MAX) && (nullptr != Next()) && m_current->Integer(static_cast<int64_t>(value)); }
+        bool Double(double) { return false; }
+        bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }
+        bool String(const char* value, rapidjson::SizeType length, bool) { return (nullptr != Next()) && m_current->String(value, length); }
+
+        bool StartObject()
+        {
+            return (nullptr != Next()) && m_current->StartObject() && Push(false);
+        }
+
+        bool Key(const char* name, rapidjson::SizeType length, bool)
+        {
+            m_next = m_containers.back()->Key(name, length);
+            return (nullptr != m_next);
+        }
+
+        bool EndObject(rapidjson::SizeType)
+        {
+            return Pop();
+        }
+
+        bool StartArray()
+        {
+            return (nullptr != Next()) && m_current->StartArray() && Push(true);
+        }
+
+        bool EndArray(rapidjson::SizeType)
+        {
+            return Pop();
+        }
+
+    private:
+        // The reader of the next value is handed out by a key, by the array the value is an element of, or is the root reader
+        std::unique_ptr<ValueReaderBase> m_next;
+        std::unique_ptr<ValueReaderBase> m_current;
+        std::vector<std::unique_ptr<ValueReaderBase>> m_containers;
+        std::vector<bool> m_arrays;
+
+        ValueReaderBase* Next()
+        {
+            m_current = (!m_arrays.empty() && m_arrays.back()) ? m_containers.back()->Element() : std::move(m_next);
+            return m_current.get();
+        }
+
+        bool Push(bool array)
+        {
+            m_containers.push_back(std::move(m_current));
+            m_arrays.push_back(array);
+            return true;
+        }
+
+        bool Pop()
+        {
+            m_containers.pop_back();
+            m_arrays.pop_back();
+            return true;
+        }
+    };
+
+    // Reads a payload into the type of a MIM object (or any type with a ValueReader), value is left unchanged when the payload does not match the type
+    template <typename T>
+    bool ReadValue(const char* payload, int payloadSizeBytes, T& value)
+    {
+        if ((nullptr == payload) || (0 >= payloadSizeBytes))
+        {
+            return false;
+        }
+
+        T result{};
+        rapidjson::MemoryStream memoryStream(payload, payloadSizeBytes);
+        rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> stream(memoryStream);
+        rapidjson::Reader reader;
+        PayloadHandler handler(MakeValueReader(result));
+
+        if (reader.Parse(stream, handler).IsError())
+        {
+            return false;
+        }
+
+        value = std::move(result);
+        return true;
+    }
+
+    template <>
+    struct ValueWriter<bool>
+    {
+        template <typename W>
+        static bool Write(W& writer, bool value)
+        {
+            return writer.Bool(value);
+        }
+    };
+
+    template <>
+    struct ValueWriter<int>
+    {
+        template <typename W>
+        static bool Write(W& writer, int value)
+        {
+            return writer.Int(value);
+        }
+    };
+
+    template <>
+    struct ValueWriter<std::string>
+    {
+        template <typename W>
+        static bool Write(W& writer, const std::string& value)
+        {
+            return writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.length()));
+        }
+    };
+
+    template <typename T>
+    struct ValueWriter<std::vector<T>>
+    {
+        template <typename W>
+        static bool Write(W& writer, const std::vector<T>& value)
+        {
+            bool result = writer.StartArray();
+
+            for (auto it = value.begin(); result && (it != value.end()); it++)
+            {
+                result = ValueWriter<T>::Write(writer, *it);
+            }
+
+            return result && writer.EndArray();
+        }
+    };
+
+    template <typename T>
+    struct ValueWriter<std::map<std::string, T>>
+    {
+        template <typename W>
+        static bool Write(W& writer, const std::map<std::string, T>& value)
+        {
+            bool result = writer.StartObject();
+
+            for (auto it = value.begin(); result && (it != value.end()); it++)
+            {
+                result = writer.Key(it->first.c_str(), static_cast<rapidjson::SizeType>(it->first.length())) && ValueWriter<T>::Write(writer, it->second);
+            }
+
+            return result && writer.EndObject();
+        }
+    };
+
+    // Writes the JSON payload of a MIM object (or any type with a ValueWriter)
+    template <typename T>
+    std::string WriteValue(const T& value)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+        ValueWriter<T>::Write(writer, value);
+
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+} // namespace Mim
+
+#endif // MIMBINDINGS_H
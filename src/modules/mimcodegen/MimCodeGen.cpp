@@ -0,0 +1,631 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Generates the typed C++ bindings of a MIM model (see src/modules/mim and src/modules/inc/MimBindings.h):
+// for each component a namespace with the object ids, a type for each object (structs and enums for the object and enum schemas)
+// and the ValueReader and ValueWriter specializations that read and write their JSON payloads with SAX.
+//
+// Usage: mimcodegen <mim.json> <output.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+struct MimType
+{
+    enum Kind
+    {
+        String,
+        Integer,
+        Boolean,
+        IntegerEnum,
+        StringEnum,
+        Array,
+        Object,
+        Map
+    };
+
+    Kind kind;
+
+    // The name of the generated type, for enums and objects
+    std::string name;
+
+    std::vector<std::pair<std::string, long long>> integerValues;
+    std::vector<std::pair<std::string, std::string>> stringValues;
+
+    // The elements of an array or the values of a map
+    std::shared_ptr<MimType> element;
+
+    std::vector<std::pair<std::string, std::shared_ptr<MimType>>> fields;
+};
+
+struct MimObject
+{
+    std::string name;
+    bool desired;
+    std::shared_ptr<MimType> type;
+};
+
+struct MimComponent
+{
+    std::string name;
+    std::vector<MimObject> objects;
+};
+
+static std::string ToPascalCase(const std::string& name)
+{
+    std::string result;
+    bool upper = true;
+
+    for (char c : name)
+    {
+        if (!isalnum(static_cast<unsigned char>(c)))
+        {
+            upper = true;
+        }
+        else
+        {
+            result += upper ? static_cast<char>(toupper(static_cast<unsigned char>(c))) : c;
+            upper = false;
+        }
+    }
+
+    if (result.empty() || isdigit(static_cast<unsigned char>(result[0])))
+    {
+        result = "Value" + result;
+    }
+
+    return result;
+}
+
+static std::string ToMemberName(const std::string& name)
+{
+    static const std::set<std::string> keywords = {
+        "auto", "bool", "break", "case", "catch", "char", "class", "const", "continue", "default", "delete", "do", "double", "else", "enum",
+        "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "namespace", "new", "operator",
+        "private", "protected", "public", "register", "return", "short", "signed", "sizeof", "static", "struct", "switch", "template", "this",
+        "throw", "true", "try", "typedef", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "while"};
+
+    std::string result;
+
+    for (char c : name)
+    {
+        result += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+
+    if (result.empty() || isdigit(static_cast<unsigned char>(result[0])) || (keywords.end() != keywords.find(result)))
+    {
+        result += "_";
+    }
+
+    return result;
+}
+
+static bool IsString(const rapidjson::Value& value, const char* name)
+{
+    return value.IsObject() && value.HasMember(name) && value[name].IsString();
+}
+
+static std::shared_ptr<MimType> ParseSchema(const rapidjson::Value& schema, const std::string& name, std::string& error)
+{
+    std::shared_ptr<MimType> type = std::make_shared<MimType>();
+    std::string schemaType = IsString(schema, "type") ? schema["type"].GetString() : "";
+
+    if (schema.IsString())
+    {
+        std::string basic = schema.GetString();
+
+        if ("string" == basic)
+        {
+            type->kind = MimType::String;
+        }
+        else if ("integer" == basic)
+        {
+            type->kind = MimType::Integer;
+        }
+        else if ("boolean" == basic)
+        {
+            type->kind = MimType::Boolean;
+        }
+        else
+        {
+            error = "unsupported schema '" + basic + "' for " + name;
+            return nullptr;
+        }
+    }
+    else if (!schema.IsObject())
+    {
+        error = "schema of " + name + " is not a string or an object";
+        return nullptr;
+    }
+    else if ("enum" == schemaType)
+    {
+        std::string valueSchema = IsString(schema, "valueSchema") ? schema["valueSchema"].GetString() : "";
+
+        if ((("integer" != valueSchema) && ("string" != valueSchema)) || !schema.HasMember("enumValues") || !schema["enumValues"].IsArray())
+        {
+            error = "invalid enum schema for " + name;
+            return nullptr;
+        }
+
+        type->kind = ("integer" == valueSchema) ? MimType::IntegerEnum : MimType::StringEnum;
+        type->name = name;
+
+        for (auto& value : schema["enumValues"].GetArray())
+        {
+            if (!IsString(value, "name") || !value.HasMember("enumValue"))
+            {
+                error = "invalid enum value for " + name;
+                return nullptr;
+            }
+            else if ((MimType::IntegerEnum == type->kind) && value["enumValue"].IsInt64())
+            {
+                type->integerValues.push_back({value["name"].GetString(), value["enumValue"].GetInt64()});
+            }
+            else if ((MimType::StringEnum == type->kind) && value["enumValue"].IsString())
+            {
+                type->stringValues.push_back({value["name"].GetString(), value["enumValue"].GetString()});
+            }
+            else
+            {
+                error = "enum value of " + name + " is not of type " + valueSchema;
+                return nullptr;
+            }
+        }
+
+        if (type->integerValues.empty() && type->stringValues.empty())
+        {
+            error = "enum " + name + " has no values";
+            return nullptr;
+        }
+    }
+    else if ("array" == schemaType)
+    {
+        type->kind = MimType::Array;
+
+        if (!schema.HasMember("elementSchema") || (nullptr == (type->element = ParseSchema(schema["elementSchema"], name + "Item", error))))
+        {
+            error = error.empty() ? ("array schema of " + name + " has no elementSchema") : error;
+            return nullptr;
+        }
+        else if (MimType::Boolean == type->element->kind)
+        {
+            // std::vector<bool> has no references to its elements to read them into
+            error = "arrays of booleans are not supported (" + name + ")";
+            return nullptr;
+        }
+    }
+    else if ("map" == schemaType)
+    {
+        type->kind = MimType::Map;
+
+        if (!schema.HasMember("mapValue") || !schema["mapValue"].IsObject() || !schema["mapValue"].HasMember("schema") ||
+            (nullptr == (type->element = ParseSchema(schema["mapValue"]["schema"], name + "Value", error))))
+        {
+            error = error.empty() ? ("map schema of " + name + " has no mapValue") : error;
+            return nullptr;
+        }
+    }
+    else if ((schemaType.empty() || ("object" == schemaType)) && schema.HasMember("fields") && schema["fields"].IsArray())
+    {
+        // Some models leave out the type of an object schema and only have its fields
+        type->kind = MimType::Object;
+        type->name = name;
+
+        for (auto& field : schema["fields"].GetArray())
+        {
+            std::shared_ptr<MimType> fieldType;
+
+            if (!IsString(field, "name") || !field.HasMember("schema"))
+            {
+                error = "invalid field of " + name;
+                return nullptr;
+            }
+            else if (nullptr == (fieldType = ParseSchema(field["schema"], name + ToPascalCase(field["name"].GetString()), error)))
+            {
+                return nullptr;
+            }
+
+            type->fields.push_back({field["name"].GetString(), fieldType});
+        }
+    }
+    else
+    {
+        error = "unsupported schema for " + name;
+        return nullptr;
+    }
+
+    return type;
+}
+
+// The generated types are qualified with their component namespace when used outside of it
+static std::string GetTypeName(const MimType& type, const std::string& qualifier = "")
+{
+    switch (type.kind)
+    {
+        case MimType::String:
+            return "std::string";
+        case MimType::Integer:
+            return "int";
+        case MimType::Boolean:
+            return "bool";
+        case MimType::Array:
+            return "std::vector<" + GetTypeName(*type.element, qualifier) + ">";
+        case MimType::Map:
+            return "std::map<std::string, " + GetTypeName(*type.element, qualifier) + ">";
+        default:
+            return qualifier + type.name;
+    }
+}
+
+static std::string GetDefaultValue(const MimType& type)
+{
+    switch (type.kind)
+    {
+        case MimType::Integer:
+            return " = 0";
+        case MimType::Boolean:
+            return " = false";
+        case MimType::IntegerEnum:
+            return " = " + type.name + "::" + ToPascalCase(type.integerValues[0].first);
+        case MimType::StringEnum:
+            return " = " + type.name + "::" + ToPascalCase(type.stringValues[0].first);
+        default:
+            return "";
+    }
+}
+
+// Compares a string of known length to each name: a switch on the length and a memcmp for each name of that length
+template <typename F>
+static void WriteNameSwitch(std::ostream& out, const std::string& indent, const std::vector<std::string>& names, F writeMatch)
+{
+    std::map<size_t, std::vector<size_t>> byLength;
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        byLength[names[i].length()].push_back(i);
+    }
+
+    out << indent << "switch (length)\n" << indent << "{\n";
+
+    for (auto& length : byLength)
+    {
+        out << indent << "    case " << length.first << ":\n";
+
+        for (size_t i : length.second)
+        {
+            out << indent << "        if (0 == memcmp(name, \"" << names[i] << "\", " << length.first << "))\n";
+            out << indent << "        {\n";
+            writeMatch(out, indent + "            ", i);
+            out << indent << "        }\n";
+        }
+
+        out << indent << "        break;\n";
+    }
+
+    out << indent << "    default:\n" << indent << "        break;\n" << indent << "}\n";
+}
+
+// Declares the enums and structs of a type and of the types it is made of, in the order they are used
+static void WriteTypes(std::ostream& out, const MimType& type)
+{
+    const std::string indent = "        ";
+
+    if (type.element)
+    {
+        WriteTypes(out, *type.element);
+    }
+
+    for (auto& field : type.fields)
+    {
+        WriteTypes(out, *field.second);
+    }
+
+    if (MimType::IntegerEnum == type.kind)
+    {
+        out << indent << "enum class " << type.name << " : int\n" << indent << "{\n";
+        for (size_t i = 0; i < type.integerValues.size(); i++)
+        {
+            out << indent << "    " << ToPascalCase(type.integerValues[i].first) << " = " << type.integerValues[i].second << ((i + 1 < type.integerValues.size()) ? ",\n" : "\n");
+        }
+        out << indent << "};\n\n";
+    }
+    else if (MimType::StringEnum == type.kind)
+    {
+        out << indent << "enum class " << type.name << " : int\n" << indent << "{\n";
+        for (size_t i = 0; i < type.stringValues.size(); i++)
+        {
+            out << indent << "    " << ToPascalCase(type.stringValues[i].first) << ((i + 1 < type.stringValues.size()) ? ",\n" : "\n");
+        }
+        out << indent << "};\n\n";
+    }
+    else if (MimType::Object == type.kind)
+    {
+        out << indent << "struct " << type.name << "\n" << indent << "{\n";
+        for (auto& field : type.fields)
+        {
+            out << indent << "    " << GetTypeName(*field.second) << " " << ToMemberName(field.first) << GetDefaultValue(*field.second) << ";\n";
+        }
+        out << indent << "};\n\n";
+    }
+}
+
+// Specializes ValueReader and ValueWriter for the enums and structs of a type
+static void WriteReadersAndWriters(std::ostream& out, const std::string& component, const MimType& type)
+{
+    const std::string indent = "    ";
+    const std::string name = component + "::" + type.name;
+
+    if (type.element)
+    {
+        WriteReadersAndWriters(out, component, *type.element);
+    }
+
+    for (auto& field : type.fields)
+    {
+        WriteReadersAndWriters(out, component, *field.second);
+    }
+
+    if ((MimType::IntegerEnum != type.kind) && (MimType::StringEnum != type.kind) && (MimType::Object != type.kind))
+    {
+        return;
+    }
+
+    out << indent << "template <>\n" << indent << "class ValueReader<" << name << "> : public ValueReaderBase\n" << indent << "{\n";
+    out << indent << "public:\n";
+    out << indent << "    explicit ValueReader(" << name << "& value) : m_value(value) {}\n\n";
+
+    if (MimType::IntegerEnum == type.kind)
+    {
+        std::set<long long> values;
+
+        out << indent << "    bool Integer(int64_t value) override\n" << indent << "    {\n";
+        out << indent << "        switch (value)\n" << indent << "        {\n";
+        for (auto& value : type.integerValues)
+        {
+            if (values.insert(value.second).second)
+            {
+                out << indent << "            case " << value.second << ":\n";
+            }
+        }
+        out << indent << "                m_value = static_cast<" << name << ">(value);\n";
+        out << indent << "                return true;\n";
+        out << indent << "            default:\n" << indent << "                return false;\n";
+        out << indent << "        }\n" << indent << "    }\n\n";
+    }
+    else if (MimType::StringEnum == type.kind)
+    {
+        std::vector<std::string> values;
+
+        for (auto& value : type.stringValues)
+        {
+            values.push_back(value.second);
+        }
+
+        out << indent << "    bool String(const char* name, size_t length) override\n" << indent << "    {\n";
+        WriteNameSwitch(out, indent + "        ", values, [&](std::ostream& o, const std::string& i, size_t index)
+        {
+            o << i << "m_value = " << name << "::" << ToPascalCase(type.stringValues[index].first) << ";\n" << i << "return true;\n";
+        });
+        out << "\n" << indent << "        return false;\n" << indent << "    }\n\n";
+    }
+    else
+    {
+        std::vector<std::string> fields;
+
+        for (auto& field : type.fields)
+        {
+            fields.push_back(field.first);
+        }
+
+        out << indent << "    bool StartObject() override\n" << indent << "    {\n" << indent << "        return true;\n" << indent << "    }\n\n";
+
+        if (fields.empty())
+        {
+            out << indent << "    std::unique_ptr<ValueReaderBase> Key(const char*, size_t) override\n" << indent << "    {\n";
+        }
+        else
+        {
+            out << indent << "    std::unique_ptr<ValueReaderBase> Key(const char* name, size_t length) override\n" << indent << "    {\n";
+            WriteNameSwitch(out, indent + "        ", fields, [&](std::ostream& o, const std::string& i, size_t index)
+            {
+                o << i << "return MakeValueReader(m_value." << ToMemberName(fields[index]) << ");\n";
+            });
+            out << "\n";
+        }
+        out << indent << "        return nullptr;\n" << indent << "    }\n\n";
+    }
+
+    out << indent << "private:\n" << indent << "    " << name << "& m_value;\n" << indent << "};\n\n";
+
+    out << indent << "template <>\n" << indent << "struct ValueWriter<" << name << ">\n" << indent << "{\n";
+    out << indent << "    template <typename W>\n";
+
+    if (MimType::IntegerEnum == type.kind)
+    {
+        out << indent << "    static bool Write(W& writer, " << name << " value)\n" << indent << "    {\n";
+        out << indent << "        return writer.Int(static_cast<int>(value));\n";
+    }
+    else if (MimType::StringEnum == type.kind)
+    {
+        out << indent << "    static bool Write(W& writer, " << name << " value)\n" << indent << "    {\n";
+        out << indent << "        switch (value)\n" << indent << "        {\n";
+        for (auto& value : type.stringValues)
+        {
+            out << indent << "            case " << name << "::" << ToPascalCase(value.first) << ":\n";
+            out << indent << "                return writer.String(\"" << value.second << "\");\n";
+        }
+        out << indent << "            default:\n" << indent << "                return false;\n" << indent << "        }\n";
+    }
+    else
+    {
+        out << indent << "    static bool Write(W& writer, const " << name << "& value)\n" << indent << "    {\n";
+        out << indent << "        return writer.StartObject() &&\n";
+        for (auto& field : type.fields)
+        {
+            out << indent << "            writer.Key(\"" << field.first << "\") && ValueWriter<" << GetTypeName(*field.second, component + "::") << ">::Write(writer, value." << ToMemberName(field.first) << ") &&\n";
+        }
+        out << indent << "            writer.EndObject();\n";
+    }
+
+    out << indent << "    }\n" << indent << "};\n\n";
+}
+
+static void WriteComponent(std::ostream& out, const MimComponent& component)
+{
+    const std::string indent = "        ";
+    const std::string name = ToPascalCase(component.name);
+    std::vector<std::string> objectNames;
+
+    out << "    namespace " << name << "\n    {\n";
+    out << indent << "constexpr const char* ComponentName()\n" << indent << "{\n" << indent << "    return \"" << component.name << "\";\n" << indent << "}\n\n";
+
+    out << indent << "enum class ObjectId\n" << indent << "{\n" << indent << "    Unknown = 0";
+    for (auto& object : component.objects)
+    {
+        out << ",\n" << indent << "    " << ToPascalCase(object.name);
+        objectNames.push_back(object.name);
+    }
+    out << "\n" << indent << "};\n\n";
+
+    for (auto& object : component.objects)
+    {
+        WriteTypes(out, *object.type);
+
+        if (object.type->name.empty())
+        {
+            out << indent << "typedef " << GetTypeName(*object.type) << " " << ToPascalCase(object.name) << ";\n\n";
+        }
+    }
+
+    out << indent << "template <ObjectId id>\n" << indent << "struct Object;\n\n";
+    for (auto& object : component.objects)
+    {
+        std::string objectName = ToPascalCase(object.name);
+
+        out << indent << "template <>\n" << indent << "struct Object<ObjectId::" << objectName << ">\n" << indent << "{\n";
+        out << indent << "    typedef " << name << "::" << objectName << " Type;\n";
+        out << indent << "    static constexpr const char* Name() { return \"" << object.name << "\"; }\n";
+        out << indent << "    static constexpr bool Desired() { return " << (object.desired ? "true" : "false") << "; }\n";
+        out << indent << "};\n\n";
+    }
+
+    out << indent << "inline ObjectId FindObject(const char* name)\n" << indent << "{\n";
+    out << indent << "    size_t length = (nullptr != name) ? strlen(name) : 0;\n\n";
+    WriteNameSwitch(out, indent + "    ", objectNames, [&](std::ostream& o, const std::string& i, size_t index)
+    {
+        o << i << "return ObjectId::" << ToPascalCase(objectNames[index]) << ";\n";
+    });
+    out << "\n" << indent << "    return ObjectId::Unknown;\n" << indent << "}\n";
+
+    out << "    } // namespace " << name << "\n\n";
+}
+
+static int Generate(const std::string& mimPath, const std::string& outputPath)
+{
+    std::ifstream ifs(mimPath);
+    std::string mimJson((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    rapidjson::Document document;
+    std::vector<MimComponent> components;
+    std::string error;
+
+    if (!ifs.good() || document.Parse(mimJson.c_str(), mimJson.length()).HasParseError() || !document.IsObject() || !document.HasMember("contents") || !document["contents"].IsArray())
+    {
+        std::cerr << mimPath << ": not a valid MIM model" << std::endl;
+        return EINVAL;
+    }
+
+    for (auto& component : document["contents"].GetArray())
+    {
+        MimComponent mimComponent;
+
+        if (!IsString(component, "name") || !component.HasMember("contents") || !component["contents"].IsArray())
+        {
+            std::cerr << mimPath << ": invalid MIM component" << std::endl;
+            return EINVAL;
+        }
+
+        mimComponent.name = component["name"].GetString();
+
+        for (auto& object : component["contents"].GetArray())
+        {
+            MimObject mimObject;
+
+            if (!IsString(object, "name") || !object.HasMember("schema"))
+            {
+                std::cerr << mimPath << ": invalid MIM object in " << mimComponent.name << std::endl;
+                return EINVAL;
+            }
+
+            mimObject.name = object["name"].GetString();
+            mimObject.desired = object.HasMember("desired") && object["desired"].IsBool() && object["desired"].GetBool();
+
+            if (nullptr == (mimObject.type = ParseSchema(object["schema"], ToPascalCase(mimObject.name), error)))
+            {
+                std::cerr << mimPath << ": " << mimComponent.name << "." << mimObject.name << ": " << error << std::endl;
+                return EINVAL;
+            }
+
+            mimComponent.objects.push_back(mimObject);
+        }
+
+        components.push_back(mimComponent);
+    }
+
+    std::string guard = outputPath.substr(outputPath.find_last_of('/') + 1);
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) { return isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(toupper(static_cast<unsigned char>(c))) : '_'; });
+
+    std::ostringstream out;
+    out << "// Copyright (c) Microsoft Corporation. All rights reserved.\n// Licensed under the MIT License.\n\n";
+    out << "// Generated by mimcodegen from " << mimPath.substr(mimPath.find_last_of('/') + 1) << ", do not edit\n\n";
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n#include <MimBindings.h>\n\nnamespace Mim\n{\n";
+
+    for (auto& component : components)
+    {
+        WriteComponent(out, component);
+    }
+
+    for (auto& component : components)
+    {
+        for (auto& object : component.objects)
+        {
+            WriteReadersAndWriters(out, ToPascalCase(component.name), *object.type);
+        }
+    }
+
+    out << "} // namespace Mim\n\n#endif // " << guard << "\n";
+
+    std::ofstream ofs(outputPath, std::ios::out | std::ios::trunc);
+    ofs << out.str();
+    ofs.close();
+
+    if (ofs.fail())
+    {
+        std::cerr << outputPath << ": failed to write" << std::endl;
+        return EIO;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (3 != argc)
+    {
+        std::cerr << "Usage: " << argv[0] << " <mim.json> <output.h>" << std::endl;
+        return EINVAL;
+    }
+
+    return Generate(argv[1], argv[2]);
+}
@@ -0,0 +1,206 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Compares the generated MIM bindings with the hand-written paths of the modules: dispatch on the object name with a strcmp chain,
+// reading a payload into a rapidjson document and walking it, and writing a payload from a rapidjson document.
+//
+// Usage: mimbindingsbenchmark [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include <rapidjson/document.h>
+
+#include <SampleMim.h>
+
+using namespace Mim::SampleComponent;
+
+static const char* g_objectNames[] = {
+    "desiredStringObject", "reportedStringObject", "desiredIntegerObject", "reportedIntegerObject", "desiredBooleanObject",
+    "reportedBooleanObject", "desiredObject", "reportedObject", "desiredArrayObject", "reportedArrayObject"};
+
+static const char g_payload[] = R"""({"stringSetting":"test","integerSetting":3,"booleanSetting":true,"integerEnumerationSetting":2,"stringEnumerationSetting":"value1",)"""
+    R"""("stringsArraySetting":["a","b","c","d"],"integerArraySetting":[1,2,3,4],"stringMapSetting":{"a":"1","b":"2"},"integerMapSetting":{"a":1,"b":2}})""";
+
+// The strcmp chain of the modules (as in DeviceInfoMmiGet), returns the index of the object
+static int DispatchHandWritten(const char* objectName)
+{
+    if (0 == strcmp(objectName, "desiredStringObject")) return 1;
+    else if (0 == strcmp(objectName, "reportedStringObject")) return 2;
+    else if (0 == strcmp(objectName, "desiredIntegerObject")) return 3;
+    else if (0 == strcmp(objectName, "reportedIntegerObject")) return 4;
+    else if (0 == strcmp(objectName, "desiredBooleanObject")) return 5;
+    else if (0 == strcmp(objectName, "reportedBooleanObject")) return 6;
+    else if (0 == strcmp(objectName, "desiredObject")) return 7;
+    else if (0 == strcmp(objectName, "reportedObject")) return 8;
+    else if (0 == strcmp(objectName, "desiredArrayObject")) return 9;
+    else if (0 == strcmp(objectName, "reportedArrayObject")) return 10;
+    return 0;
+}
+
+// Parsing into a document and walking it, as the modules do for their desired objects
+static bool ReadHandWritten(const char* payload, int payloadSizeBytes, DesiredObject& value)
+{
+    rapidjson::Document document;
+
+    if (document.Parse(payload, payloadSizeBytes).HasParseError() || !document.IsObject())
+    {
+        return false;
+    }
+
+    for (auto& member : document.GetObject())
+    {
+        std::string name = member.name.GetString();
+
+        if (("stringSetting" == name) && member.value.IsString())
+        {
+            value.stringSetting = member.value.GetString();
+        }
+        else if (("integerSetting" == name) && member.value.IsInt())
+        {
+            value.integerSetting = member.value.GetInt();
+        }
+        else if (("booleanSetting" == name) && member.value.IsBool())
+        {
+            value.booleanSetting = member.value.GetBool();
+        }
+        else if (("integerEnumerationSetting" == name) && member.value.IsInt() && (0 <= member.value.GetInt()) && (2 >= member.value.GetInt()))
+        {
+            value.integerEnumerationSetting = static_cast<DesiredObjectIntegerEnumerationSetting>(member.value.GetInt());
+        }
+        else if (("stringEnumerationSetting" == name) && member.value.IsString())
+        {
+            std::string setting = member.value.GetString();
+            value.stringEnumerationSetting = ("value1" == setting) ? DesiredObjectStringEnumerationSetting::Value1 : (("value2" == setting) ? DesiredObjectStringEnumerationSetting::Value2 : DesiredObjectStringEnumerationSetting::None);
+        }
+        else if (("stringsArraySetting" == name) && member.value.IsArray())
+        {
+            value.stringsArraySetting.clear();
+            for (auto& element : member.value.GetArray())
+            {
+                value.stringsArraySetting.push_back(element.GetString());
+            }
+        }
+        else if (("integerArraySetting" == name) && member.value.IsArray())
+        {
+            value.integerArraySetting.clear();
+            for (auto& element : member.value.GetArray())
+            {
+                value.integerArraySetting.push_back(element.GetInt());
+            }
+        }
+        else if (("stringMapSetting" == name) && member.value.IsObject())
+        {
+            value.stringMapSetting.clear();
+            for (auto& entry : member.value.GetObject())
+            {
+                value.stringMapSetting[entry.name.GetString()] = entry.value.GetString();
+            }
+        }
+        else if (("integerMapSetting" == name) && member.value.IsObject())
+        {
+            value.integerMapSetting.clear();
+            for (auto& entry : member.value.GetObject())
+            {
+                value.integerMapSetting[entry.name.GetString()] = entry.value.GetInt();
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Building a document and writing it, as the modules do for their reported objects
+static std::string WriteHandWritten(const DesiredObject& value)
+{
+    rapidjson::Document document(rapidjson::kObjectType);
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+    rapidjson::Value stringsArray(rapidjson::kArrayType);
+    rapidjson::Value integerArray(rapidjson::kArrayType);
+    rapidjson::Value stringMap(rapidjson::kObjectType);
+    rapidjson::Value integerMap(rapidjson::kObjectType);
+    static const char* stringEnumeration[] = {"none", "value1", "value2"};
+
+    for (auto& element : value.stringsArraySetting)
+    {
+        stringsArray.PushBack(rapidjson::Value(element.c_str(), allocator), allocator);
+    }
+    for (auto& element : value.integerArraySetting)
+    {
+        integerArray.PushBack(element, allocator);
+    }
+    for (auto& entry : value.stringMapSetting)
+    {
+        stringMap.AddMember(rapidjson::Value(entry.first.c_str(), allocator), rapidjson::Value(entry.second.c_str(), allocator), allocator);
+    }
+    for (auto& entry : value.integerMapSetting)
+    {
+        integerMap.AddMember(rapidjson::Value(entry.first.c_str(), allocator), entry.second, allocator);
+    }
+
+    document.AddMember("stringSetting", rapidjson::Value(value.stringSetting.c_str(), allocator), allocator);
+    document.AddMember("integerSetting", value.integerSetting, allocator);
+    document.AddMember("booleanSetting", value.booleanSetting, allocator);
+    document.AddMember("integerEnumerationSetting", static_cast<int>(value.integerEnumerationSetting), allocator);
+    document.AddMember("stringEnumerationSetting", rapidjson::StringRef(stringEnumeration[static_cast<int>(value.stringEnumerationSetting)]), allocator);
+    document.AddMember("stringsArraySetting", stringsArray, allocator);
+    document.AddMember("integerArraySetting", integerArray, allocator);
+    document.AddMember("stringMapSetting", stringMap, allocator);
+    document.AddMember("integerMapSetting", integerMap, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    document.Accept(writer);
+
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+static double Measure(long iterations, const std::function<void()>& operation)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (long i = 0; i < iterations; i++)
+    {
+        operation();
+    }
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void Report(const char* name, double handWritten, double generated)
+{
+    printf("%-10s hand-written: %10.1f ns  generated: %10.1f ns  (%.1fx)\n", name, handWritten, generated, handWritten / generated);
+}
+
+int main(int argc, char* argv[])
+{
+    long iterations = (argc > 1) ? atol(argv[1]) : 100000;
+    volatile long sink = 0;
+    DesiredObject value;
+
+    if ((iterations <= 0) || !ReadHandWritten(g_payload, sizeof(g_payload) - 1, value) || (WriteHandWritten(value) != Mim::WriteValue(value)))
+    {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    Report("dispatch",
+        Measure(iterations, [&]() { for (auto name : g_objectNames) { sink += DispatchHandWritten(name); } }) / 10,
+        Measure(iterations, [&]() { for (auto name : g_objectNames) { sink += static_cast<long>(FindObject(name)); } }) / 10);
+
+    Report("read",
+        Measure(iterations, [&]() { DesiredObject result; sink += ReadHandWritten(g_payload, sizeof(g_payload) - 1, result) ? 1 : 0; }),
+        Measure(iterations, [&]() { DesiredObject result; sink += Mim::ReadValue(g_payload, sizeof(g_payload) - 1, result) ? 1 : 0; }));
+
+    Report("write",
+        Measure(iterations, [&]() { sink += WriteHandWritten(value).length(); }),
+        Measure(iterations, [&]() { sink += Mim::WriteValue(value).length(); }));
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+
+#include <SampleMim.h>
+#include <CommandrunnerMim.h>
+
+using namespace Mim::SampleComponent;
+
+namespace Tests
+{
+    static_assert(0 == strcmp("desiredObject", Object<ObjectId::DesiredObject>::Name()), "Object name");
+    static_assert(Object<ObjectId::DesiredObject>::Desired() && !Object<ObjectId::ReportedObject>::Desired(), "Desired objects");
+
+    template <typename T>
+    static bool Read(const std::string& payload, T& value)
+    {
+        return Mim::ReadValue(payload.c_str(), static_cast<int>(payload.length()), value);
+    }
+
+    TEST(MimBindingsTests, FindObject)
+    {
+        EXPECT_STREQ("SampleComponent", ComponentName());
+        EXPECT_EQ(ObjectId::DesiredStringObject, FindObject("desiredStringObject"));
+        EXPECT_EQ(ObjectId::ReportedArrayObject, FindObject("reportedArrayObject"));
+        EXPECT_EQ(ObjectId::DesiredObject, FindObject("desiredObject"));
+        EXPECT_EQ(ObjectId::Unknown, FindObject("desiredObjectX"));
+        EXPECT_EQ(ObjectId::Unknown, FindObject("DesiredObject"));
+        EXPECT_EQ(ObjectId::Unknown, FindObject(""));
+        EXPECT_EQ(ObjectId::Unknown, FindObject(nullptr));
+        EXPECT_EQ(Mim::CommandRunner::ObjectId::CommandArguments, Mim::CommandRunner::FindObject("commandArguments"));
+    }
+
+    TEST(MimBindingsTests, ReadWriteObject)
+    {
+        const std::string payload = R"""({"stringSetting":"test","integerSetting":3,"booleanSetting":true,"integerEnumerationSetting":2,"stringEnumerationSetting":"value1",)"""
+            R"""("stringsArraySetting":["a","b"],"integerArraySetting":[1,2,3],"stringMapSetting":{"a":"1","b":"2"},"integerMapSetting":{"a":1}})""";
+        DesiredObject value;
+
+        ASSERT_TRUE(Read(payload, value));
+        EXPECT_EQ("test", value.stringSetting);
+        EXPECT_EQ(3, value.integerSetting);
+        EXPECT_TRUE(value.booleanSetting);
+        EXPECT_EQ(DesiredObjectIntegerEnumerationSetting::Value2, value.integerEnumerationSetting);
+        EXPECT_EQ(DesiredObjectStringEnumerationSetting::Value1, value.stringEnumerationSetting);
+        EXPECT_EQ((std::vector<std::string>{"a", "b"}), value.stringsArraySetting);
+        EXPECT_EQ((std::vector<int>{1, 2, 3}), value.integerArraySetting);
+        EXPECT_EQ((std::map<std::string, std::string>{{"a", "1"}, {"b", "2"}}), value.stringMapSetting);
+        EXPECT_EQ((std::map<std::string, int>{{"a", 1}}), value.integerMapSetting);
+
+        EXPECT_EQ(payload, Mim::WriteValue(value));
+    }
+
+    TEST(MimBindingsTests, ReadWriteArrayOfObjects)
+    {
+        DesiredArrayObject value;
+
+        ASSERT_TRUE(Read(R"""([{"stringSetting": "a", "integerMapSetting": {"x": 1, "y": null}}, {"integerSetting": 2}])""", value));
+        ASSERT_EQ(2u, value.size());
+        EXPECT_EQ("a", value[0].stringSetting);
+        EXPECT_EQ((std::map<std::string, int>{{"x", 1}}), value[0].integerMapSetting);
+        EXPECT_EQ(2, value[1].integerSetting);
+        EXPECT_EQ(DesiredArrayObjectItemStringEnumerationSetting::None, value[1].stringEnumerationSetting);
+
+        ASSERT_TRUE(Read("[]", value));
+        EXPECT_TRUE(value.empty());
+        EXPECT_EQ("[]", Mim::WriteValue(value));
+    }
+
+    TEST(MimBindingsTests, ReadWriteBasicTypes)
+    {
+        DesiredStringObject stringValue;
+        DesiredIntegerObject integerValue = 0;
+        DesiredBooleanObject booleanValue = false;
+
+        ASSERT_TRUE(Read(R"""("value")""", stringValue));
+        EXPECT_EQ("value", stringValue);
+        EXPECT_EQ(R"""("value")""", Mim::WriteValue(stringValue));
+
+        ASSERT_TRUE(Read("-7", integerValue));
+        EXPECT_EQ(-7, integerValue);
+        EXPECT_EQ("-7", Mim::WriteValue(integerValue));
+
+        ASSERT_TRUE(Read("true", booleanValue));
+        EXPECT_TRUE(booleanValue);
+        EXPECT_EQ("true", Mim::WriteValue(booleanValue));
+    }
+
+    TEST(MimBindingsTests, InvalidPayloads)
+    {
+        DesiredObject value;
+        value.stringSetting = "unchanged";
+
+        EXPECT_FALSE(Read(R"""({"unknownSetting": 1})""", value));
+        EXPECT_FALSE(Read(R"""({"integerSetting": "1"})""", value));
+        EXPECT_FALSE(Read(R"""({"integerSetting": 1.5})""", value));
+        EXPECT_FALSE(Read(R"""({"integerSetting": 4294967296})""", value));
+        EXPECT_FALSE(Read(R"""({"integerEnumerationSetting": 3})""", value));
+        EXPECT_FALSE(Read(R"""({"stringEnumerationSetting": "value3"})""", value));
+        EXPECT_FALSE(Read(R"""({"stringsArraySetting": ["a", 1]})""", value));
+        EXPECT_FALSE(Read(R"""({"stringSetting": null})""", value));
+        EXPECT_FALSE(Read(R"""({"stringMapSetting": {"a": 1}})""", value));
+        EXPECT_FALSE(Read(R"""({"stringSetting": "a"} {})""", value));
+        EXPECT_FALSE(Read(R"""(["stringSetting"])""", value));
+        EXPECT_FALSE(Read("", value));
+        EXPECT_FALSE(Mim::ReadValue(nullptr, 0, value));
+
+        EXPECT_EQ("unchanged", value.stringSetting);
+    }
+} // namespace Tests
@@ -17,6 +17,9 @@
 #include "CommonUtils.h"
 #include "Mmi.h"
 #include "Ztsi.h"
+#include "ZtsiMim.h"
+
+namespace ZtsiMim = Mim::ZtsiAgentConfiguration;
 
 static const char g_configurationPropertyEnabled[] = "enabled";
 static const char g_configurationPropertyMaxScheduledAttestationsPerDay[] = "maxScheduledAttestationsPerDay";
@@ -36,19 +39,12 @@ const std::string Ztsi::m_componentName = "Ztsi";
 const std::string Ztsi::m_desiredEnabled = "desiredEnabled";
 const std::string Ztsi::m_desiredMaxScheduledAttestationsPerDay = "desiredMaxScheduledAttestationsPerDay";
 const std::string Ztsi::m_desiredMaxManualAttestationsPerDay = "desiredMaxManualAttestationsPerDay";
-const std::string Ztsi::m_reportedEnabled = "enabled";
-const std::string Ztsi::m_reportedMaxScheduledAttestationsPerDay = "maxScheduledAttestationsPerDay";
-const std::string Ztsi::m_reportedMaxManualAttestationsPerDay = "maxManualAttestationsPerDay";
 
-int SerializeJsonObject(MMI_JSON_STRING* payload, int* payloadSizeBytes, unsigned int maxPayloadSizeBytes, rapidjson::Document& document)
+int SerializeJsonObject(MMI_JSON_STRING* payload, int* payloadSizeBytes, unsigned int maxPayloadSizeBytes, const std::string& buffer)
 {
     int status = MMI_OK;
 
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    document.Accept(writer);
-
-    if ((maxPayloadSizeBytes > 0) && (buffer.GetSize() > maxPayloadSizeBytes))
+    if ((maxPayloadSizeBytes > 0) && (buffer.size() > maxPayloadSizeBytes))
     {
         OsConfigLogError(ZtsiLog::Get(), "Failed to serialize JSON object to buffer");
         status = E2BIG;
@@ -57,7 +53,7 @@ int SerializeJsonObject(MMI_JSON_STRING* payload, int* payloadSizeBytes, unsigne
     {
         try
         {
-            *payload = new (std::nothrow) char[buffer.GetSize()];
+            *payload = new (std::nothrow) char[buffer.size()];
             if (nullptr == *payload)
             {
                 OsConfigLogError(ZtsiLog::Get(), "Unable to allocate memory for payload");
@@ -65,9 +61,9 @@ int SerializeJsonObject(MMI_JSON_STRING* payload, int* payloadSizeBytes, unsigne
             }
             else
             {
-                std::fill(*payload, *payload + buffer.GetSize(), 0);
-                std::memcpy(*payload, buffer.GetString(), buffer.GetSize());
-                *payloadSizeBytes = buffer.GetSize();
+                std::fill(*payload, *payload + buffer.size(), 0);
+                std::memcpy(*payload, buffer.c_str(), buffer.size());
+                *payloadSizeBytes = buffer.size();
             }
         }
         catch (const std::exception& e)
@@ -195,32 +191,32 @@ int Ztsi::Get(const char* componentName, const char* objectName, MMI_JSON_STRING
         *payloadSizeBytes = 0;
 
         unsigned int maxPayloadSizeBytes = GetMaxPayloadSizeBytes();
-        rapidjson::Document document;
         if (0 == Ztsi::m_componentName.compare(componentName))
         {
-            if (0 == Ztsi::m_reportedEnabled.compare(objectName))
-            {
-                Ztsi::EnabledState enabledState = GetEnabledState();
-                document.SetInt(static_cast<int>(enabledState));
-                status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, document);
-            }
-            else if (0 == Ztsi::m_reportedMaxManualAttestationsPerDay.compare(objectName))
-            {
-                int maxManualAttestationsPerDay = GetMaxManualAttestationsPerDay();
-                document.SetInt(maxManualAttestationsPerDay);
-                status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, document);
-            }
-
-            else if (0 == Ztsi::m_reportedMaxScheduledAttestationsPerDay.compare(objectName))
-            {
-                int maxScheduledAttestationsPerDay = GetMaxScheduledAttestationsPerDay();
-                document.SetInt(maxScheduledAttestationsPerDay);
-                status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, document);
-            }
-            else
+            // The reported objects are written with the bindings generated from the MIM (ZtsiMim.h)
+            switch (ZtsiMim::FindObject(objectName))
             {
-                OsConfigLogError(ZtsiLog::Get(), "Invalid objectName: %s", objectName);
-                status = EINVAL;
+                case ZtsiMim::ObjectId::Enabled:
+                {
+                    ZtsiMim::Enabled enabledState = static_cast<ZtsiMim::Enabled>(GetEnabledState());
+                    status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, Mim::WriteValue(enabledState));
+                    break;
+                }
+                case ZtsiMim::ObjectId::MaxManualAttestationsPerDay:
+                {
+                    ZtsiMim::MaxManualAttestationsPerDay maxManualAttestationsPerDay = GetMaxManualAttestationsPerDay();
+                    status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, Mim::WriteValue(maxManualAttestationsPerDay));
+                    break;
+                }
+                case ZtsiMim::ObjectId::MaxScheduledAttestationsPerDay:
+                {
+                    ZtsiMim::MaxScheduledAttestationsPerDay maxScheduledAttestationsPerDay = GetMaxScheduledAttestationsPerDay();
+                    status = SerializeJsonObject(payload, payloadSizeBytes, maxPayloadSizeBytes, Mim::WriteValue(maxScheduledAttestationsPerDay));
+                    break;
+                }
+                default:
+                    OsConfigLogError(ZtsiLog::Get(), "Invalid objectName: %s", objectName);
+                    status = EINVAL;
             }
         }
         else
@@ -236,7 +232,6 @@ int Ztsi::Get(const char* componentName, const char* objectName, MMI_JSON_STRING
 int Ztsi::Set(const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes)
 {
     int status = MMI_OK;
-    rapidjson::Document document;
 
     if (nullptr == componentName)
     {
@@ -248,55 +243,58 @@ int Ztsi::Set(const char* componentName, const char* objectName, const MMI_JSON_
         OsConfigLogError(ZtsiLog::Get(), "Set called with null objectName");
         status = EINVAL;
     }
-    else if (document.Parse(payload, payloadSizeBytes).HasParseError())
-    {
-        OsConfigLogError(ZtsiLog::Get(), "Unabled to parse JSON payload");
-        status = EINVAL;
-    }
     else
     {
         if (0 == Ztsi::m_componentName.compare(componentName))
         {
-            if (0 == Ztsi::m_desiredEnabled.compare(objectName))
-            {
-                if (document.IsBool())
-                {
-                    status = SetEnabled(document.GetBool());
-                }
-                else
-                {
-                    OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type boolean", Ztsi::m_desiredEnabled.c_str());
-                    status = EINVAL;
-                }
-            }
-            else if (0 == Ztsi::m_desiredMaxScheduledAttestationsPerDay.compare(objectName))
+            // The desired payloads are read straight into the types generated from the MIM (ZtsiMim.h), an invalid payload leaves them unset
+            switch (ZtsiMim::FindObject(objectName))
             {
-                if (document.IsInt())
+                case ZtsiMim::ObjectId::DesiredEnabled:
                 {
-                    status = SetMaxScheduledAttestationsPerDay(document.GetInt());
+                    ZtsiMim::DesiredEnabled enabled = g_defaultEnabled;
+                    if (Mim::ReadValue(payload, payloadSizeBytes, enabled))
+                    {
+                        status = SetEnabled(enabled);
+                    }
+                    else
+                    {
+                        OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type boolean", Ztsi::m_desiredEnabled.c_str());
+                        status = EINVAL;
+                    }
+                    break;
                 }
-                else
+                case ZtsiMim::ObjectId::DesiredMaxScheduledAttestationsPerDay:
                 {
-                    OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type int", Ztsi::m_desiredMaxScheduledAttestationsPerDay.c_str());
-                    status = EINVAL;
+                    ZtsiMim::DesiredMaxScheduledAttestationsPerDay maxScheduledAttestationsPerDay = g_defaultMaxScheduledAttestationsPerDay;
+                    if (Mim::ReadValue(payload, payloadSizeBytes, maxScheduledAttestationsPerDay))
+                    {
+                        status = SetMaxScheduledAttestationsPerDay(maxScheduledAttestationsPerDay);
+                    }
+                    else
+                    {
+                        OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type int", Ztsi::m_desiredMaxScheduledAttestationsPerDay.c_str());
+                        status = EINVAL;
+                    }
+                    break;
                 }
-            }
-            else if (0 == Ztsi::m_desiredMaxManualAttestationsPerDay.compare(objectName))
-            {
-                if (document.IsInt())
+                case ZtsiMim::ObjectId::DesiredMaxManualAttestationsPerDay:
                 {
-                    status = SetMaxManualAttestationsPerDay(document.GetInt());
+                    ZtsiMim::DesiredMaxManualAttestationsPerDay maxManualAttestationsPerDay = g_defaultMaxManualAttestationsPerDay;
+                    if (Mim::ReadValue(payload, payloadSizeBytes, maxManualAttestationsPerDay))
+                    {
+                        status = SetMaxManualAttestationsPerDay(maxManualAttestationsPerDay);
+                    }
+                    else
+                    {
+                        OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type int", Ztsi::m_desiredMaxManualAttestationsPerDay.c_str());
+                        status = EINVAL;
+                    }
+                    break;
                 }
-                else
-                {
-                    OsConfigLogError(ZtsiLog::Get(), "'%s' is not of type int", Ztsi::m_desiredMaxManualAttestationsPerDay.c_str());
+                default:
+                    OsConfigLogError(ZtsiLog::Get(), "Invalid objectName: %s", objectName);
                     status = EINVAL;
-                }
-            }
-            else
-            {
-                OsConfigLogError(ZtsiLog::Get(), "Invalid objectName: %s", objectName);
-                status = EINVAL;
             }
         }
         else
@@ -81,9 +81,6 @@ private:
     static const std::string m_desiredEnabled;
     static const std::string m_desiredMaxScheduledAttestationsPerDay;
     static const std::string m_desiredMaxManualAttestationsPerDay;
-    static const std::string m_reportedEnabled;
-    static const std::string m_reportedMaxScheduledAttestationsPerDay;
-    static const std::string m_reportedMaxManualAttestationsPerDay;
 
     std::string m_agentConfigurationDir;
     std::string m_agentConfigurationFile;
@@ -0,0 +1,348 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <PlatformCommon.h>
+#include <ManagementModule.h>
+#include <ModuleHostProtocol.h>
+#include <HostedManagementModule.h>
+
+// How long a host gets to exit by itself once its socket is closed, before it is killed
+static const int g_hostExitWaits = 10;
+static const std::chrono::milliseconds g_hostExitWaitInterval(10);
+
+// The sessions of a hosted module are known by their number in the host
+static MMI_HANDLE ToHandle(int session)
+{
+    return reinterpret_cast<MMI_HANDLE>(static_cast<intptr_t>(session));
+}
+
+static int ToSession(MMI_HANDLE handle)
+{
+    return static_cast<int>(reinterpret_cast<intptr_t>(handle));
+}
+
+static void LogHostExit(const std::string& modulePath, pid_t pid, int status)
+{
+    if (WIFSIGNALED(status))
+    {
+        OsConfigLogError(GetPlatformLog(), "Host process %d of module '%s' ended with signal %d", pid, modulePath.c_str(), WTERMSIG(status));
+    }
+    else if (WIFEXITED(status) && (0 != WEXITSTATUS(status)))
+    {
+        OsConfigLogError(GetPlatformLog(), "Host process %d of module '%s' exited with %d", pid, modulePath.c_str(), WEXITSTATUS(status));
+    }
+    else if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "Host process %d of module '%s' exited", pid, modulePath.c_str());
+    }
+}
+
+// Reads the status and payload of a response to GetInfo or Get, the payload is copied into memory that the caller frees with delete[]
+static int ReadPayload(ModuleHostFrame& response, MMI_JSON_STRING* payload, int* payloadSizeBytes)
+{
+    std::string value;
+    bool isNull = false;
+    int status = MMI_OK;
+
+    *payload = nullptr;
+    *payloadSizeBytes = 0;
+
+    if (!response.GetInteger(status) || !response.GetString(value, isNull))
+    {
+        return EPROTO;
+    }
+
+    if ((MMI_OK == status) && !isNull)
+    {
+        if (nullptr == (*payload = new (std::nothrow) char[value.length() + 1]))
+        {
+            OsConfigLogError(GetPlatformLog(), "Unable to allocate %d bytes for a payload from a module host", static_cast<int>(value.length()));
+            return ENOMEM;
+        }
+
+        memcpy(*payload, value.data(), value.length());
+        *payloadSizeBytes = static_cast<int>(value.length());
+    }
+
+    return status;
+}
+
+HostedManagementModule::HostedManagementModule(const std::string path, const std::string hostPath) :
+    ManagementModule(path),
+    m_hostPath(hostPath),
+    m_hostPid(-1),
+    m_hostSocket(-1)
+{
+    // Payloads come from the responses of the host
+    m_mmiFree = [](MMI_JSON_STRING payload) { delete[] payload; };
+}
+
+HostedManagementModule::~HostedManagementModule()
+{
+    StopHost(false);
+}
+
+int HostedManagementModule::Load()
+{
+    int status = 0;
+
+    if (IsLoaded())
+    {
+        return status;
+    }
+
+    if ((0 == (status = StartHost())) && (0 == (status = LoadInfo())))
+    {
+        OsConfigLogInfo(GetPlatformLog(), "Loaded '%s' module (v%s) from '%s' in host process %d", m_info.name.c_str(), m_info.version.ToString().c_str(), m_modulePath.c_str(), m_hostPid);
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to load module '%s' in a host process", m_modulePath.c_str());
+        StopHost(true);
+    }
+
+    return status;
+}
+
+// Called with m_mmiMutex held
+void HostedManagementModule::UnloadModule()
+{
+    StopHost(false);
+}
+
+pid_t HostedManagementModule::GetHostPid()
+{
+    std::lock_guard<std::mutex> lock(m_mmiMutex);
+    return m_hostPid;
+}
+
+int HostedManagementModule::StartHost()
+{
+    int sockets[2] = {-1, -1};
+    pid_t pid = -1;
+    int status = 0;
+
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets))
+    {
+        status = errno;
+        OsConfigLogError(GetPlatformLog(), "Failed to create a socket pair for the host of module '%s' (%d)", m_modulePath.c_str(), status);
+        return status;
+    }
+
+    // All that the child needs is prepared before the fork, only async-signal-safe calls can be made between the fork and the exec
+    std::string socketArgument = std::to_string(sockets[1]);
+    char* const arguments[] = {const_cast<char*>(m_hostPath.c_str()), const_cast<char*>(m_modulePath.c_str()), const_cast<char*>(socketArgument.c_str()), nullptr};
+    sigset_t signals;
+    sigemptyset(&signals);
+
+    if (0 == (pid = fork()))
+    {
+        // The host gets its end of the socket pair, and none of the signals blocked in the platform
+        fcntl(sockets[1], F_SETFD, 0);
+        sigprocmask(SIG_SETMASK, &signals, nullptr);
+        execv(arguments[0], arguments);
+        _exit(127);
+    }
+
+    status = (0 > pid) ? errno : 0;
+    close(sockets[1]);
+
+    if (0 != status)
+    {
+        close(sockets[0]);
+        OsConfigLogError(GetPlatformLog(), "Failed to start '%s' for module '%s' (%d)", m_hostPath.c_str(), m_modulePath.c_str(), status);
+        return status;
+    }
+
+    m_hostPid = pid;
+    m_hostSocket = sockets[0];
+
+    return status;
+}
+
+void HostedManagementModule::StopHost(bool kill)
+{
+    int status = 0;
+    pid_t result = 0;
+
+    if (0 <= m_hostSocket)
+    {
+        close(m_hostSocket);
+        m_hostSocket = -1;
+    }
+
+    if (0 < m_hostPid)
+    {
+        // The host exits once its socket is closed, unless it is stuck in a call into the module
+        for (int i = 0; !kill && (i < g_hostExitWaits) && (0 == (result = waitpid(m_hostPid, &status, WNOHANG))); i++)
+        {
+            std::this_thread::sleep_for(g_hostExitWaitInterval);
+        }
+
+        if (0 == result)
+        {
+            ::kill(m_hostPid, SIGKILL);
+            result = waitpid(m_hostPid, &status, 0);
+        }
+
+        if (m_hostPid == result)
+        {
+            LogHostExit(m_modulePath, m_hostPid, status);
+        }
+
+        m_hostPid = -1;
+    }
+}
+
+int HostedManagementModule::Call(const ModuleHostFrame& request, ModuleHostFrame& response)
+{
+    int status = 0;
+
+    if (0 > m_hostSocket)
+    {
+        return EIO;
+    }
+
+    if ((0 != (status = request.Send(m_hostSocket, m_callTimeoutMilliseconds))) || (0 != (status = response.Receive(m_hostSocket, m_callTimeoutMilliseconds))))
+    {
+        if (ETIME == status)
+        {
+            OsConfigLogError(GetPlatformLog(), "Host process %d of module '%s' did not answer within %u ms, it is killed and started again with the next call", m_hostPid, m_modulePath.c_str(), m_callTimeoutMilliseconds);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Lost host process %d of module '%s' (%d), it is started again with the next call", m_hostPid, m_modulePath.c_str(), status);
+        }
+
+        StopHost(ETIME == status);
+        SuspendSessions(false);
+        status = (ETIME == status) ? ETIME : EIO;
+    }
+
+    return status;
+}
+
+bool HostedManagementModule::IsLoaded() const
+{
+    return (0 < m_hostPid);
+}
+
+void HostedManagementModule::CheckLoaded()
+{
+    int status = 0;
+    pid_t result = 0;
+
+    // A host that exited between calls is noticed here, so that the next call does not go to it
+    if ((0 < m_hostPid) && (0 != (result = waitpid(m_hostPid, &status, WNOHANG))))
+    {
+        if (m_hostPid == result)
+        {
+            LogHostExit(m_modulePath, m_hostPid, status);
+        }
+
+        m_hostPid = -1;
+        StopHost(false);
+        SuspendSessions(false);
+    }
+}
+
+int HostedManagementModule::CallMmiGetInfo(const char* clientName, MMI_JSON_STRING* payload, int* payloadSizeBytes)
+{
+    ModuleHostFrame request;
+    ModuleHostFrame response;
+    int status = MMI_OK;
+
+    if ((nullptr == payload) || (nullptr == payloadSizeBytes))
+    {
+        return EINVAL;
+    }
+
+    request.AddInteger(static_cast<int>(ModuleHostMessage::GetInfo));
+    request.AddString(clientName);
+
+    if (0 == (status = Call(request, response)))
+    {
+        status = ReadPayload(response, payload, payloadSizeBytes);
+    }
+
+    return status;
+}
+
+MMI_HANDLE HostedManagementModule::CallMmiOpen(const char* clientName, unsigned int maxPayloadSizeBytes)
+{
+    ModuleHostFrame request;
+    ModuleHostFrame response;
+    int session = 0;
+
+    request.AddInteger(static_cast<int>(ModuleHostMessage::Open));
+    request.AddString(clientName);
+    request.AddInteger(static_cast<int>(maxPayloadSizeBytes));
+
+    if ((0 != Call(request, response)) || !response.GetInteger(session))
+    {
+        session = 0;
+    }
+
+    return ToHandle(session);
+}
+
+void HostedManagementModule::CallMmiClose(MMI_HANDLE handle)
+{
+    ModuleHostFrame request;
+    ModuleHostFrame response;
+
+    request.AddInteger(static_cast<int>(ModuleHostMessage::Close));
+    request.AddInteger(ToSession(handle));
+
+    Call(request, response);
+}
+
+int HostedManagementModule::CallMmiSet(MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes)
+{
+    ModuleHostFrame request;
+    ModuleHostFrame response;
+    int status = MMI_OK;
+
+    if (!IsValidPayload(componentName, objectName, payload, payloadSizeBytes))
+    {
+        return EINVAL;
+    }
+
+    request.AddInteger(static_cast<int>(ModuleHostMessage::Set));
+    request.AddInteger(ToSession(handle));
+    request.AddString(componentName);
+    request.AddString(objectName);
+    request.AddString(payload, payloadSizeBytes);
+
+    if ((0 == (status = Call(request, response))) && !response.GetInteger(status))
+    {
+        status = EPROTO;
+    }
+
+    return status;
+}
+
+int HostedManagementModule::CallMmiGet(MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING* payload, int* payloadSizeBytes)
+{
+    ModuleHostFrame request;
+    ModuleHostFrame response;
+    int status = MMI_OK;
+
+    if ((nullptr == payload) || (nullptr == payloadSizeBytes))
+    {
+        return EINVAL;
+    }
+
+    request.AddInteger(static_cast<int>(ModuleHostMessage::Get));
+    request.AddInteger(ToSession(handle));
+    request.AddString(componentName);
+    request.AddString(objectName);
+
+    if ((0 == (status = Call(request, response))) && (MMI_OK == (status = ReadPayload(response, payload, payloadSizeBytes))))
+    {
+        // Validate payload from MmiGet
+        status = IsValidPayload(componentName, objectName, *payload, *payloadSizeBytes) ? MMI_OK : EINVAL;
+    }
+
+    return status;
+}
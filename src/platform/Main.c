@@ -4,12 +4,11 @@
 #include <PlatformCommon.h>
 #include <MpiServer.h>
 
-// 100 milliseconds
-#define DOWORK_SLEEP 100
-
 // 30 seconds
 #define DOWORK_INTERVAL 30
 
+#define MAX_EVENTS 8
+
 // The configuration file for OSConfig
 #define CONFIG_FILE "/etc/osconfig/osconfig.json"
 
@@ -20,30 +19,38 @@
 #define COMMAND_LOGGING "CommandLogging"
 #define FULL_LOGGING "FullLogging"
 
-static unsigned int g_lastTime = 0;
-
 extern OSCONFIG_LOG_HANDLE g_platformLog;
 
-extern char g_mpiCall[MPI_CALL_MESSAGE_LENGTH];
+extern __thread char g_mpiCall[MPI_CALL_MESSAGE_LENGTH];
 
-// All signals on which we want the agent to cleanup before terminating process.
-// SIGKILL is omitted to allow a clean and immediate process kill if needed.
+// All signals on which we want the agent to cleanup before terminating process, these and SIGHUP come in through g_signalfd.
+// SIGKILL (and SIGSTOP, that cannot be caught) is omitted to allow a clean and immediate process kill if needed.
 static int g_stopSignals[] = {
-    0,
     SIGINT,  // 2
     SIGQUIT, // 3
+    SIGTERM, //15
+    SIGTSTP  //20
+};
+
+// Signals of a crash, these are raised on the thread that crashed and are handled there
+static int g_crashSignals[] = {
     SIGILL,  // 4
     SIGABRT, // 6
     SIGBUS,  // 7
     SIGFPE,  // 8
-    SIGSEGV, //11
-    SIGTERM, //15
-    SIGSTOP, //19
-    SIGTSTP  //20
+    SIGSEGV  //11
 };
 
 static int g_stopSignal = 0;
-static int g_refreshSignal = 0;
+
+// The main loop waits on these without a timeout: signals, the timer of the periodic work (armed only when there is such work) and refresh requests
+static int g_epollfd = -1;
+static int g_signalfd = -1;
+static int g_timerfd = -1;
+static int g_refreshfd = -1;
+
+// The signal mask from before the signals of g_signalfd were blocked, restored in child processes
+static sigset_t g_originalSignalMask;
 
 #define EOL_TERMINATOR "\n"
 #define ERROR_MESSAGE_CRASH "[ERROR] OSConfig Platform crash due to "
@@ -82,11 +89,6 @@ static void SignalInterrupt(int signal)
     {
         errorMessage = ERROR_MESSAGE_SIGBUS;
     }
-    else
-    {
-        OsConfigLogInfo(g_platformLog, "Interrupt signal (%d)", signal);
-        g_stopSignal = signal;
-    }
 
     if (NULL != errorMessage)
     {
@@ -110,34 +112,49 @@ static void SignalInterrupt(int signal)
     }
 }
 
-static void SignalReloadConfiguration(int incomingSignal)
+// MpiDoWork only has work to do when modules are unloaded while idle, otherwise the timer stays disarmed
+static void SchedulePlatformWork(void)
 {
-    g_refreshSignal = incomingSignal;
-    
-    // Reset the handler
-    signal(SIGHUP, SignalReloadConfiguration);
+    char* jsonConfiguration = LoadStringFromFile(CONFIG_FILE, false, GetPlatformLog());
+    struct itimerspec interval = {{0, 0}, {0, 0}};
+
+    if (0 < GetModuleIdleUnloadSecondsFromJsonConfig(jsonConfiguration, GetPlatformLog()))
+    {
+        interval.it_interval.tv_sec = DOWORK_INTERVAL;
+        interval.it_value.tv_sec = DOWORK_INTERVAL;
+    }
+
+    FREE_MEMORY(jsonConfiguration);
+
+    if (0 != timerfd_settime(g_timerfd, 0, &interval, NULL))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to schedule the platform work (%d)", errno);
+    }
 }
 
 static void Refresh()
 {
     MpiShutdown();
     MpiInitialize();
+    SchedulePlatformWork();
 
     OsConfigLogInfo(GetPlatformLog(), "OSConfig Platform reintialized");
 }
 
+// Can be called from any thread, the refresh is done by the main loop
 void ScheduleRefresh(void)
 {
+    uint64_t refresh = 1;
+
     OsConfigLogInfo(GetPlatformLog(), "Scheduling refresh");
-    g_refreshSignal = SIGHUP;
+    UNUSED(write(g_refreshfd, &refresh, sizeof(refresh)));
 }
 
 static void InitializePlatform(void)
 {
-    g_lastTime = (unsigned int)time(NULL);
-    
     MpiInitialize();
-    
+    SchedulePlatformWork();
+
     OsConfigLogInfo(GetPlatformLog(), "OSConfig Platform intialized");
 }
 
@@ -148,15 +165,139 @@ void TerminatePlatform(void)
     OsConfigLogInfo(GetPlatformLog(), "OSConfig Platform terminated");
 }
 
-static void PlatformDoWork(void)
+static void RestoreSignalMask(void)
+{
+    sigprocmask(SIG_SETMASK, &g_originalSignalMask, NULL);
+}
+
+static int WatchDescriptor(int* descriptor)
+{
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = descriptor;
+    return epoll_ctl(g_epollfd, EPOLL_CTL_ADD, *descriptor, &event);
+}
+
+// The stop signals and SIGHUP are blocked before any other thread starts, so that all threads inherit the mask and these signals are only
+// received through g_signalfd. Child processes get the original mask back
+static int InitializeMainLoop(void)
+{
+    sigset_t signals;
+    int status = 0;
+    int i = 0;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+
+    for (i = 0; i < (int)ARRAY_SIZE(g_stopSignals); i++)
+    {
+        sigaddset(&signals, g_stopSignals[i]);
+    }
+
+    if ((0 != (status = pthread_sigmask(SIG_BLOCK, &signals, &g_originalSignalMask))) ||
+        (0 != (status = pthread_atfork(NULL, NULL, RestoreSignalMask))))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to block signals for the main loop (%d)", status);
+        return status;
+    }
+
+    if ((0 > (g_epollfd = epoll_create1(EPOLL_CLOEXEC))) ||
+        (0 > (g_signalfd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC))) ||
+        (0 > (g_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))) ||
+        (0 > (g_refreshfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) ||
+        (0 != WatchDescriptor(&g_signalfd)) ||
+        (0 != WatchDescriptor(&g_timerfd)) ||
+        (0 != WatchDescriptor(&g_refreshfd)))
+    {
+        status = errno;
+        OsConfigLogError(GetPlatformLog(), "Failed to set up the main loop (%d)", status);
+    }
+
+    return status;
+}
+
+static void CloseDescriptor(int* descriptor)
+{
+    if (0 <= *descriptor)
+    {
+        close(*descriptor);
+        *descriptor = -1;
+    }
+}
+
+static void TerminateMainLoop(void)
+{
+    CloseDescriptor(&g_refreshfd);
+    CloseDescriptor(&g_timerfd);
+    CloseDescriptor(&g_signalfd);
+    CloseDescriptor(&g_epollfd);
+}
+
+// Runs until a stop signal comes in
+static void RunMainLoop(void)
 {
-    unsigned int currentTime = time(NULL);
-    unsigned int timeInterval = DOWORK_INTERVAL;
+    struct epoll_event events[MAX_EVENTS];
+    struct signalfd_siginfo signalInfo;
+    uint64_t value = 0;
+    bool refresh = false;
+    bool doWork = false;
+    int numEvents = 0;
+    int i = 0;
 
-    if (timeInterval <= (currentTime - g_lastTime))
+    while (0 == g_stopSignal)
     {
-        MpiDoWork();
-        g_lastTime = (unsigned int)time(NULL);
+        if (0 > (numEvents = epoll_wait(g_epollfd, events, MAX_EVENTS, -1)))
+        {
+            if (EINTR != errno)
+            {
+                OsConfigLogError(GetPlatformLog(), "Failed waiting for events in the main loop (%d)", errno);
+                break;
+            }
+            numEvents = 0;
+        }
+
+        refresh = false;
+        doWork = false;
+
+        for (i = 0; i < numEvents; i++)
+        {
+            if (&g_signalfd == events[i].data.ptr)
+            {
+                while (sizeof(signalInfo) == read(g_signalfd, &signalInfo, sizeof(signalInfo)))
+                {
+                    if (SIGHUP == signalInfo.ssi_signo)
+                    {
+                        refresh = true;
+                    }
+                    else
+                    {
+                        OsConfigLogInfo(GetPlatformLog(), "Interrupt signal (%d)", (int)signalInfo.ssi_signo);
+                        g_stopSignal = (int)signalInfo.ssi_signo;
+                    }
+                }
+            }
+            else if (&g_timerfd == events[i].data.ptr)
+            {
+                doWork = (sizeof(value) == read(g_timerfd, &value, sizeof(value)));
+            }
+            else if (&g_refreshfd == events[i].data.ptr)
+            {
+                refresh = (sizeof(value) == read(g_refreshfd, &value, sizeof(value)));
+            }
+        }
+
+        if (0 != g_stopSignal)
+        {
+            break;
+        }
+        else if (refresh)
+        {
+            Refresh();
+        }
+        else if (doWork)
+        {
+            MpiDoWork();
+        }
     }
 }
 
@@ -197,7 +338,7 @@ int main(int argc, char *argv[])
     UNUSED(argv);
     
     pid_t pid = 0;
-    int stopSignalsCount = ARRAY_SIZE(g_stopSignals);
+    int status = 0;
 
     char* jsonConfiguration = LoadStringFromFile(CONFIG_FILE, false, GetPlatformLog());
     if (NULL != jsonConfiguration)
@@ -219,31 +360,23 @@ int main(int argc, char *argv[])
         OsConfigLogInfo(GetPlatformLog(), "WARNING: verbose logging (command and/or full) is enabled. To disable verbose logging edit %s and restart OSConfig", CONFIG_FILE);
     }
 
-    for (int i = 0; i < stopSignalsCount; i++)
+    for (int i = 0; i < (int)ARRAY_SIZE(g_crashSignals); i++)
     {
-        signal(g_stopSignals[i], SignalInterrupt);
+        signal(g_crashSignals[i], SignalInterrupt);
     }
-    signal(SIGHUP, SignalReloadConfiguration);
 
-    InitializePlatform();
-
-    while (0 == g_stopSignal)
+    if (0 == (status = InitializeMainLoop()))
     {
-        PlatformDoWork();
-        
-        sleep(DOWORK_SLEEP);
+        InitializePlatform();
+        RunMainLoop();
 
-        if (0 != g_refreshSignal)
-        {
-            g_refreshSignal = 0;
-            Refresh();
-        }
-    }
+        OsConfigLogInfo(GetPlatformLog(), "OSConfig Platform (PID: %d) exiting with %d", pid, g_stopSignal);
 
-    OsConfigLogInfo(GetPlatformLog(), "OSConfig Platform (PID: %d) exiting with %d", pid, g_stopSignal);
+        TerminatePlatform();
+    }
 
-    TerminatePlatform();
+    TerminateMainLoop();
     CloseLog(&g_platformLog);
 
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <PlatformCommon.h>
 #include <ManagementModule.h>
+#include <MimValidator.h>
 #include <ModulesManager.h>
 #include <MpiServer.h>
 
@@ -26,14 +27,148 @@ static const char g_mmiGetInfoLifetime[] = "Lifetime";
 static const char g_mmiGetInfoLicenseUri[] = "LicenseUri";
 static const char g_mmiGetInfoProjectUri[] = "ProjectUri";
 static const char g_mmiGetInfoUserAccount[] = "UserAccount";
+static const char g_mmiGetInfoReportedCacheSeconds[] = "ReportedCacheSeconds";
 
 typedef void (*mmi_t)();
 
+// Resident set size of the whole process, used to account for the memory that a module takes
+static long GetResidentKilobytes()
+{
+    long pages = 0;
+    std::ifstream statm("/proc/self/statm");
+
+    // The first field is the total program size, the second the resident set size
+    if (!(statm >> pages >> pages))
+    {
+        return 0;
+    }
+
+    return (pages * sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+MmiExecutor::MmiExecutor() : m_calls(std::make_shared<Calls>()) {}
+
+MmiExecutor::~MmiExecutor()
+{
+    bool busy = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_calls->mutex);
+        m_calls->stop = true;
+        busy = (m_calls->queued != m_calls->completed);
+    }
+
+    m_calls->changed.notify_all();
+
+    if (m_thread.joinable())
+    {
+        // Not waiting for a call that may never return, the thread exits by itself once it ran the calls left
+        if (busy)
+        {
+            m_thread.detach();
+        }
+        else
+        {
+            m_thread.join();
+        }
+    }
+}
+
+unsigned long long MmiExecutor::Queue(const std::function<void()>& call)
+{
+    if (!m_thread.joinable())
+    {
+        try
+        {
+            m_thread = std::thread(Execute, m_calls);
+        }
+        catch (const std::system_error& e)
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to start a thread for MMI calls, calling on the calling thread (%s)", e.what());
+            return 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_calls->mutex);
+    m_calls->queue.push(call);
+    m_calls->changed.notify_all();
+
+    return ++m_calls->queued;
+}
+
+bool MmiExecutor::Run(const std::function<void()>& call, std::chrono::milliseconds timeout)
+{
+    unsigned long long number = Queue(call);
+
+    if (0 == number)
+    {
+        call();
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(m_calls->mutex);
+    return m_calls->changed.wait_for(lock, timeout, [&]() { return m_calls->completed >= number; });
+}
+
+void MmiExecutor::Post(const std::function<void()>& call)
+{
+    if (0 == Queue(call))
+    {
+        call();
+    }
+}
+
+bool MmiExecutor::IsBusy()
+{
+    std::lock_guard<std::mutex> lock(m_calls->mutex);
+    return (m_calls->queued != m_calls->completed);
+}
+
+void MmiExecutor::Execute(std::shared_ptr<Calls> calls)
+{
+    std::unique_lock<std::mutex> lock(calls->mutex);
+
+    while (true)
+    {
+        calls->changed.wait(lock, [&]() { return calls->stop || !calls->queue.empty(); });
+
+        if (calls->queue.empty())
+        {
+            break;
+        }
+
+        std::function<void()> call = std::move(calls->queue.front());
+        calls->queue.pop();
+
+        lock.unlock();
+        call();
+        call = nullptr;
+        lock.lock();
+
+        calls->completed++;
+        calls->changed.notify_all();
+    }
+}
+
 ManagementModule::ManagementModule() : ManagementModule("") {}
 
 ManagementModule::ManagementModule(const std::string path) :
     m_modulePath(path),
-    m_handle(nullptr)
+    m_handle(nullptr),
+    m_mmiGetInfo(nullptr),
+    m_mmiOpen(nullptr),
+    m_mmiClose(nullptr),
+    m_mmiSet(nullptr),
+    m_mmiGet(nullptr),
+    m_mmiFree(nullptr),
+    m_callTimeoutMilliseconds(0),
+    m_degraded(false),
+    m_lastCallTime(std::chrono::steady_clock::now()),
+    m_callStartTime(0),
+    m_unloaded(false),
+    m_reloads(0),
+    m_loadedKilobytes(0),
+    m_unloadedKilobytes(0)
 {
     m_info.lifetime = Lifetime::Undefined;
     m_info.userAccount= 0;
@@ -46,6 +181,7 @@ ManagementModule::~ManagementModule()
 
 int ManagementModule::Load()
 {
+    long residentKilobytes = 0;
     int status = 0;
 
     if (nullptr != m_handle)
@@ -53,7 +189,9 @@ int ManagementModule::Load()
         return status;
     }
 
-    void* m_handle = dlopen(m_modulePath.c_str(), RTLD_LAZY);
+    residentKilobytes = GetResidentKilobytes();
+
+    m_handle = dlopen(m_modulePath.c_str(), RTLD_LAZY);
     if (nullptr != m_handle)
     {
         const std::vector<std::string> symbols = {g_mmiFuncMmiGetInfo, g_mmiFuncMmiOpen, g_mmiFuncMmiClose, g_mmiFuncMmiSet, g_mmiFuncMmiGet, g_mmiFuncMmiFree};
@@ -77,27 +215,7 @@ int ManagementModule::Load()
             m_mmiGet = reinterpret_cast<Mmi_Get>(dlsym(m_handle, g_mmiFuncMmiGet.c_str()));
             m_mmiFree = reinterpret_cast<Mmi_Free>(dlsym(m_handle, g_mmiFuncMmiFree.c_str()));
 
-            MMI_JSON_STRING payload = nullptr;
-            int payloadSizeBytes = 0;
-
-            if (MMI_OK == CallMmiGetInfo("Azure OsConfig", &payload, &payloadSizeBytes))
-            {
-                rapidjson::Document document;
-                if (document.Parse(payload, payloadSizeBytes).HasParseError())
-                {
-                    OsConfigLogError(GetPlatformLog(), "Failed to parse info JSON for module '%s'", m_modulePath.c_str());
-                    status = EINVAL;
-                }
-                else if (0 != Info::Deserialize(document, m_info))
-                {
-                    status = EINVAL;
-                }
-            }
-            else
-            {
-                OsConfigLogError(GetPlatformLog(), "Failed to get info for module '%s'", m_modulePath.c_str());
-                status = EINVAL;
-            }
+            status = LoadInfo();
         }
     }
     else
@@ -116,7 +234,10 @@ int ManagementModule::Load()
         }
         ss << "]";
 
-        OsConfigLogInfo(GetPlatformLog(), "Loaded '%s' module (v%s) from '%s', supported components: %s", m_info.name.c_str(), m_info.version.ToString().c_str(), m_modulePath.c_str(), ss.str().c_str());
+        m_loadedKilobytes = GetResidentKilobytes() - residentKilobytes;
+
+        OsConfigLogInfo(GetPlatformLog(), "Loaded '%s' module (v%s) from '%s', supported components: %s, resident memory %+ld KB", m_info.name.c_str(), m_info.version.ToString().c_str(),
+            m_modulePath.c_str(), ss.str().c_str(), m_loadedKilobytes.load());
     }
     else
     {
@@ -131,20 +252,238 @@ int ManagementModule::Load()
     return status;
 }
 
+int ManagementModule::LoadInfo()
+{
+    MMI_JSON_STRING payload = nullptr;
+    int payloadSizeBytes = 0;
+    int status = 0;
+
+    if ((MMI_OK == CallMmiGetInfo("Azure OsConfig", &payload, &payloadSizeBytes)) && (nullptr != payload))
+    {
+        // The info is read anew each time the module loads, a module that was unloaded can come back as a different version
+        rapidjson::Document document;
+        Info info;
+        info.lifetime = Lifetime::Undefined;
+        info.userAccount = 0;
+
+        if (document.Parse(payload, payloadSizeBytes).HasParseError())
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to parse info JSON for module '%s'", m_modulePath.c_str());
+            status = EINVAL;
+        }
+        else if (0 != Info::Deserialize(document, info))
+        {
+            status = EINVAL;
+        }
+        else
+        {
+            m_info = info;
+            m_infoJson.assign(payload, payloadSizeBytes);
+        }
+
+        m_mmiFree(payload);
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to get info for module '%s'", m_modulePath.c_str());
+        status = EINVAL;
+    }
+
+    return status;
+}
+
 void ManagementModule::Unload()
 {
-    if (nullptr != m_handle)
+    std::lock_guard<std::mutex> lock(m_mmiMutex);
+    UnloadModule();
+}
+
+void ManagementModule::UnloadModule()
+{
+    if ((nullptr != m_handle) && m_executor.IsBusy())
+    {
+        // The code of the module must stay mapped for as long as a call that timed out can still return into it
+        OsConfigLogError(GetPlatformLog(), "'%s' module did not return from a call that timed out, it is left loaded", m_info.name.c_str());
+    }
+    else if (nullptr != m_handle)
     {
+        long residentKilobytes = GetResidentKilobytes();
+
         dlclose(m_handle);
         m_handle = nullptr;
+        m_unloadedKilobytes = GetResidentKilobytes() - residentKilobytes;
+
+        m_mmiGetInfo = nullptr;
+        m_mmiOpen = nullptr;
+        m_mmiClose = nullptr;
+        m_mmiSet = nullptr;
+        m_mmiGet = nullptr;
+        m_mmiFree = nullptr;
     }
 }
 
+bool ManagementModule::UnloadIfIdle(unsigned int idleSeconds)
+{
+    std::lock_guard<std::mutex> lock(m_mmiMutex);
+    long residentKilobytes = 0;
+
+    if ((Lifetime::Short != m_info.lifetime) || !IsLoaded() || m_executor.IsBusy() || ((std::chrono::steady_clock::now() - m_lastCallTime) < std::chrono::seconds(idleSeconds)))
+    {
+        return false;
+    }
+
+    residentKilobytes = GetResidentKilobytes();
+
+    SuspendSessions(true);
+    UnloadModule();
+
+    // Includes the memory that the module gave back when its sessions were closed
+    m_unloadedKilobytes = GetResidentKilobytes() - residentKilobytes;
+
+    OsConfigLogInfo(GetPlatformLog(), "Unloaded '%s' module after %u seconds idle, resident memory %+ld KB", m_info.name.c_str(), idleSeconds, m_unloadedKilobytes.load());
+
+    return true;
+}
+
+void ManagementModule::SuspendSessions(bool close)
+{
+    for (auto& mmiSession : m_mmiSessions)
+    {
+        if (nullptr != mmiSession->m_mmiHandle)
+        {
+            if (close)
+            {
+                CallMmiClose(mmiSession->m_mmiHandle);
+            }
+
+            mmiSession->m_mmiHandle = nullptr;
+            mmiSession->m_reopen = true;
+        }
+    }
+
+    m_unloaded = true;
+}
+
+bool ManagementModule::IsLoaded() const
+{
+    return (nullptr != m_handle);
+}
+
+void ManagementModule::CheckLoaded()
+{
+}
+
+// Called with m_mmiMutex held, for a module unloaded with sessions open
+int ManagementModule::Reload()
+{
+    int status = 0;
+
+    if (0 == (status = Load()))
+    {
+        m_unloaded = false;
+        m_reloads++;
+        OsConfigLogInfo(GetPlatformLog(), "Reloaded '%s' module on demand, resident memory %+ld KB", m_info.name.c_str(), m_loadedKilobytes.load());
+
+        if (m_reloadCallback)
+        {
+            m_reloadCallback(m_info);
+        }
+    }
+
+    return status;
+}
+
 ManagementModule::Info ManagementModule::GetInfo() const
 {
     return m_info;
 }
 
+std::string ManagementModule::GetInfoJson() const
+{
+    return m_infoJson;
+}
+
+unsigned int ManagementModule::GetReportedCacheSeconds(const std::string& componentName, const std::string& objectName) const
+{
+    auto component = m_info.reportedCacheSeconds.find(componentName);
+
+    if (component != m_info.reportedCacheSeconds.end())
+    {
+        auto object = component->second.find(objectName);
+
+        if (object != component->second.end())
+        {
+            return object->second;
+        }
+    }
+
+    return 0;
+}
+
+void ManagementModule::SetMimValidator(std::shared_ptr<const MimValidator> mimValidator)
+{
+    m_mimValidator = mimValidator;
+}
+
+void ManagementModule::SetCallTimeout(unsigned int milliseconds)
+{
+    std::lock_guard<std::mutex> lock(m_mmiMutex);
+    m_callTimeoutMilliseconds = milliseconds;
+}
+
+bool ManagementModule::IsDegraded()
+{
+    return m_degraded && m_executor.IsBusy();
+}
+
+unsigned int ManagementModule::GetReloads() const
+{
+    return m_reloads;
+}
+
+std::chrono::milliseconds ManagementModule::GetCallDuration() const
+{
+    std::chrono::steady_clock::rep start = m_callStartTime;
+
+    if (0 == start)
+    {
+        return std::chrono::milliseconds(0);
+    }
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(start)));
+}
+
+long ManagementModule::GetLoadedKilobytes() const
+{
+    return m_loadedKilobytes;
+}
+
+long ManagementModule::GetUnloadedKilobytes() const
+{
+    return m_unloadedKilobytes;
+}
+
+void ManagementModule::SetReloadCallback(const std::function<void(const Info&)>& callback)
+{
+    std::lock_guard<std::mutex> lock(m_mmiMutex);
+    m_reloadCallback = callback;
+}
+
+void ManagementModule::SetCallInProgress(bool inProgress)
+{
+    m_callStartTime = inProgress ? std::chrono::steady_clock::now().time_since_epoch().count() : 0;
+}
+
+bool ManagementModule::IsValidPayload(const char* componentName, const char* objectName, const char* payload, int payloadSizeBytes) const
+{
+    if ((nullptr != m_mimValidator) && (nullptr != componentName) && (nullptr != objectName))
+    {
+        return m_mimValidator->IsValid(componentName, objectName, payload, payloadSizeBytes);
+    }
+
+    return IsValidMimObjectPayload(payload, payloadSizeBytes, GetPlatformLog());
+}
+
 int ManagementModule::CallMmiGetInfo(const char* clientName, MMI_JSON_STRING* payload, int* payloadSizeBytes)
 {
     return (nullptr != m_mmiGetInfo) ? m_mmiGetInfo(clientName, payload, payloadSizeBytes) : EINVAL;
@@ -152,12 +491,24 @@ int ManagementModule::CallMmiGetInfo(const char* clientName, MMI_JSON_STRING* pa
 
 MMI_HANDLE ManagementModule::CallMmiOpen(const char* clientName, unsigned int maxPayloadSizeBytes)
 {
+    if (m_executor.IsBusy())
+    {
+        OsConfigLogError(GetPlatformLog(), "MmiOpen(%s) not called, '%s' module did not return from a call that timed out", clientName, m_info.name.c_str());
+        return nullptr;
+    }
+
     return (nullptr != m_mmiOpen) ? m_mmiOpen(clientName, maxPayloadSizeBytes) : nullptr;
 }
 
 void ManagementModule::CallMmiClose(MMI_HANDLE handle)
 {
-    if (nullptr != m_mmiClose)
+    if ((nullptr != m_mmiClose) && m_executor.IsBusy())
+    {
+        // A call that timed out can still be using the session, it is closed after that call returns
+        Mmi_Close mmiClose = m_mmiClose;
+        m_executor.Post([=]() { mmiClose(handle); });
+    }
+    else if (nullptr != m_mmiClose)
     {
         m_mmiClose(handle);
     }
@@ -167,9 +518,9 @@ int ManagementModule::CallMmiSet(MMI_HANDLE handle, const char* componentName, c
 {
     int status = MMI_OK;
 
-    if (nullptr != m_mmiSet && IsValidMimObjectPayload(payload, payloadSizeBytes, GetPlatformLog()))
+    if ((nullptr != m_mmiSet) && IsValidPayload(componentName, objectName, payload, payloadSizeBytes))
     {
-        status = m_mmiSet(handle, componentName, objectName, payload, payloadSizeBytes);
+        status = (0 == m_callTimeoutMilliseconds) ? m_mmiSet(handle, componentName, objectName, payload, payloadSizeBytes) : CallMmiSetWithTimeout(handle, componentName, objectName, payload, payloadSizeBytes);
     }
     else
     {
@@ -183,10 +534,105 @@ int ManagementModule::CallMmiGet(MMI_HANDLE handle, const char* componentName, c
 {
     int status = MMI_OK;
 
-    if ((nullptr != m_mmiGet) && (MMI_OK == (status = m_mmiGet(handle, componentName, objectName, payload, payloadSizeBytes))))
+    if (nullptr != m_mmiGet)
     {
-        // Validate payload from MmiGet
-        status = IsValidMimObjectPayload(*payload, *payloadSizeBytes, GetPlatformLog()) ? MMI_OK : EINVAL;
+        status = (0 == m_callTimeoutMilliseconds) ? m_mmiGet(handle, componentName, objectName, payload, payloadSizeBytes) : CallMmiGetWithTimeout(handle, componentName, objectName, payload, payloadSizeBytes);
+
+        if (MMI_OK == status)
+        {
+            // Validate payload from MmiGet
+            status = IsValidPayload(componentName, objectName, *payload, *payloadSizeBytes) ? MMI_OK : EINVAL;
+        }
+    }
+
+    return status;
+}
+
+void ManagementModule::CallMmiFree(MMI_JSON_STRING payload)
+{
+    if (nullptr != m_mmiFree)
+    {
+        m_mmiFree(payload);
+    }
+}
+
+// Called with m_mmiMutex held. Returns ETIME without making the call while the module is degraded, and when the call does not return in time
+int ManagementModule::CallWithTimeout(const std::function<void()>& call, const std::string& function, const char* componentName, const char* objectName)
+{
+    if (m_degraded && m_executor.IsBusy())
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "%s(%s, %s) not called, '%s' module did not return from a call that timed out", function.c_str(), componentName, objectName, m_info.name.c_str());
+        }
+
+        return ETIME;
+    }
+    else if (m_degraded)
+    {
+        m_degraded = false;
+        OsConfigLogInfo(GetPlatformLog(), "'%s' module returned from the call that timed out", m_info.name.c_str());
+    }
+
+    if (!m_executor.Run(call, std::chrono::milliseconds(m_callTimeoutMilliseconds)))
+    {
+        m_degraded = true;
+        OsConfigLogError(GetPlatformLog(), "%s(%s, %s) did not return within %u ms, calls into '%s' module fail until it does", function.c_str(), componentName, objectName, m_callTimeoutMilliseconds, m_info.name.c_str());
+        return ETIME;
+    }
+
+    return MMI_OK;
+}
+
+// The call can outlive the caller, so it gets copies of the arguments
+int ManagementModule::CallMmiSetWithTimeout(MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes)
+{
+    if ((nullptr == componentName) || (nullptr == objectName))
+    {
+        return EINVAL;
+    }
+
+    Mmi_Set mmiSet = m_mmiSet;
+    std::shared_ptr<int> result = std::make_shared<int>(MMI_OK);
+    std::string component = componentName;
+    std::string object = objectName;
+    std::string value(payload, payloadSizeBytes);
+    int status = CallWithTimeout([=]() mutable { *result = mmiSet(handle, component.c_str(), object.c_str(), &value[0], static_cast<int>(value.length())); }, g_mmiFuncMmiSet, componentName, objectName);
+
+    return (MMI_OK == status) ? *result : status;
+}
+
+int ManagementModule::CallMmiGetWithTimeout(MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING* payload, int* payloadSizeBytes)
+{
+    struct Result
+    {
+        int status = MMI_OK;
+        MMI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+    };
+
+    if ((nullptr == componentName) || (nullptr == objectName) || (nullptr == payload) || (nullptr == payloadSizeBytes))
+    {
+        return EINVAL;
+    }
+
+    Mmi_Get mmiGet = m_mmiGet;
+    Mmi_Free mmiFree = m_mmiFree;
+    std::shared_ptr<Result> result = std::make_shared<Result>();
+    std::string component = componentName;
+    std::string object = objectName;
+    int status = CallWithTimeout([=]() { result->status = mmiGet(handle, component.c_str(), object.c_str(), &result->payload, &result->payloadSizeBytes); }, g_mmiFuncMmiGet, componentName, objectName);
+
+    if (MMI_OK == status)
+    {
+        *payload = result->payload;
+        *payloadSizeBytes = result->payloadSizeBytes;
+        status = result->status;
+    }
+    else if (nullptr != mmiFree)
+    {
+        // Runs after the call that timed out returns, to free the payload that nobody waits for anymore
+        m_executor.Post([=]() { if (nullptr != result->payload) { mmiFree(result->payload); } });
     }
 
     return status;
@@ -441,6 +887,39 @@ int ManagementModule::Info::Deserialize(const rapidjson::Value& object, Manageme
         }
     }
 
+    // Reported Cache Seconds
+    if (object.HasMember(g_mmiGetInfoReportedCacheSeconds))
+    {
+        if (object[g_mmiGetInfoReportedCacheSeconds].IsObject())
+        {
+            for (auto& component : object[g_mmiGetInfoReportedCacheSeconds].GetObject())
+            {
+                if (component.value.IsObject())
+                {
+                    for (auto& cacheSeconds : component.value.GetObject())
+                    {
+                        if (cacheSeconds.value.IsUint())
+                        {
+                            info.reportedCacheSeconds[component.name.GetString()][cacheSeconds.name.GetString()] = cacheSeconds.value.GetUint();
+                        }
+                        else
+                        {
+                            OsConfigLogError(GetPlatformLog(), "Module info field '%s' has a value for '%s' that is not an unsigned integer", g_mmiGetInfoReportedCacheSeconds, component.name.GetString());
+                        }
+                    }
+                }
+                else
+                {
+                    OsConfigLogError(GetPlatformLog(), "Module info field '%s' has a value for '%s' that is not an object", g_mmiGetInfoReportedCacheSeconds, component.name.GetString());
+                }
+            }
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Module info field '%s' is not an object", g_mmiGetInfoReportedCacheSeconds);
+        }
+    }
+
     return status;
 }
 
@@ -448,7 +927,8 @@ MmiSession::MmiSession(std::shared_ptr<ManagementModule> module, const std::stri
     m_clientName(clientName),
     m_maxPayloadSizeBytes(maxPayloadSizeBytes),
     m_module(module),
-    m_mmiHandle(nullptr) {}
+    m_mmiHandle(nullptr),
+    m_reopen(false) {}
 
 MmiSession::~MmiSession()
 {
@@ -461,11 +941,17 @@ int MmiSession::Open()
 
     if (nullptr != m_module)
     {
-        if (nullptr == m_mmiHandle)
+        std::lock_guard<std::mutex> lock(m_module->m_mmiMutex);
+
+        if ((nullptr == m_mmiHandle) && !m_reopen)
         {
-            if (nullptr == (m_mmiHandle = m_module->CallMmiOpen(m_clientName.c_str(), m_maxPayloadSizeBytes)))
+            m_module->m_mmiSessions.insert(this);
+            m_reopen = true;
+
+            if (0 != (status = Resume()))
             {
-                OsConfigLogError(GetPlatformLog(), "Failed to open MMI session for client '%s'", m_clientName.c_str());
+                m_module->m_mmiSessions.erase(this);
+                m_reopen = false;
             }
         }
         else
@@ -493,25 +979,109 @@ void MmiSession::Close()
 {
     if (nullptr != m_module)
     {
+        std::lock_guard<std::mutex> lock(m_module->m_mmiMutex);
+
         if (nullptr != m_mmiHandle)
         {
             m_module->CallMmiClose(m_mmiHandle);
             m_mmiHandle = nullptr;
         }
+
+        m_module->m_mmiSessions.erase(this);
+        m_reopen = false;
     }
 }
 
+// Called with the module lock held before each MMI call, loads the module again and reopens this session if the module was unloaded
+int MmiSession::Resume()
+{
+    int status = 0;
+
+    m_module->m_lastCallTime = std::chrono::steady_clock::now();
+    m_module->CheckLoaded();
+
+    if (m_module->m_unloaded && (0 != (status = m_module->Reload())))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to reload '%s' module (%d)", m_module->m_info.name.c_str(), status);
+    }
+    else if (m_reopen)
+    {
+        m_reopen = false;
+
+        if (nullptr == (m_mmiHandle = m_module->CallMmiOpen(m_clientName.c_str(), m_maxPayloadSizeBytes)))
+        {
+            // Opening the session is tried again with the next call, for a module that is degraded or went away
+            m_reopen = m_module->IsDegraded() || m_module->m_unloaded;
+            OsConfigLogError(GetPlatformLog(), "Failed to open MMI session for client '%s'", m_clientName.c_str());
+        }
+    }
+
+    return status;
+}
+
 int MmiSession::Set(const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes)
 {
-    return (nullptr != m_module) ? m_module->CallMmiSet(m_mmiHandle, componentName, objectName, payload, payloadSizeBytes) : EINVAL;
+    if (nullptr == m_module)
+    {
+        return EINVAL;
+    }
+
+    std::lock_guard<std::mutex> lock(m_module->m_mmiMutex);
+    m_module->SetCallInProgress(true);
+    ScopeGuard sg{[&]() { m_module->SetCallInProgress(false); }};
+
+    int status = Resume();
+    return (0 == status) ? m_module->CallMmiSet(m_mmiHandle, componentName, objectName, payload, payloadSizeBytes) : status;
+}
+
+int MmiSession::Get(const char* componentName, const char* objectName, MMI_JSON_STRING *payload, int *payloadSizeBytes, const std::function<void()>& started)
+{
+    if (nullptr == m_module)
+    {
+        return EINVAL;
+    }
+
+    std::lock_guard<std::mutex> lock(m_module->m_mmiMutex);
+    m_module->SetCallInProgress(true);
+    ScopeGuard sg{[&]() { m_module->SetCallInProgress(false); }};
+
+    if (nullptr != started)
+    {
+        started();
+    }
+
+    int status = Resume();
+    return (0 == status) ? m_module->CallMmiGet(m_mmiHandle, componentName, objectName, payload, payloadSizeBytes) : status;
 }
 
-int MmiSession::Get(const char* componentName, const char* objectName, MMI_JSON_STRING *payload, int *payloadSizeBytes)
+void MmiSession::Free(MMI_JSON_STRING payload)
 {
-    return (nullptr != m_module) ? m_module->CallMmiGet(m_mmiHandle, componentName, objectName, payload, payloadSizeBytes) : EINVAL;
+    if ((nullptr == m_module) || (nullptr == payload))
+    {
+        return;
+    }
+
+    // Held so that the module is not unloaded under the call
+    std::lock_guard<std::mutex> lock(m_module->m_mmiMutex);
+    m_module->CallMmiFree(payload);
 }
 
 ManagementModule::Info MmiSession::GetInfo()
 {
     return (nullptr != m_module) ? m_module->GetInfo() : ManagementModule::Info();
+}
+
+unsigned int MmiSession::GetReportedCacheSeconds(const std::string& componentName, const std::string& objectName)
+{
+    return (nullptr != m_module) ? m_module->GetReportedCacheSeconds(componentName, objectName) : 0;
+}
+
+unsigned int MmiSession::GetReloads()
+{
+    return (nullptr != m_module) ? m_module->GetReloads() : 0;
+}
+
+std::chrono::milliseconds MmiSession::GetCallDuration()
+{
+    return (nullptr != m_module) ? m_module->GetCallDuration() : std::chrono::milliseconds(0);
 }
\ No newline at end of file
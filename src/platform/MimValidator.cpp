@@ -0,0 +1,385 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <PlatformCommon.h>
+#include <MimValidator.h>
+
+static const std::string g_mimExtension = ".json";
+
+static const char g_mimName[] = "name";
+static const char g_mimType[] = "type";
+static const char g_mimContents[] = "contents";
+static const char g_mimSchema[] = "schema";
+static const char g_mimComponent[] = "mimComponent";
+static const char g_mimObject[] = "mimObject";
+
+static const char g_schemaString[] = "string";
+static const char g_schemaInteger[] = "integer";
+static const char g_schemaBoolean[] = "boolean";
+static const char g_schemaEnum[] = "enum";
+static const char g_schemaArray[] = "array";
+static const char g_schemaObject[] = "object";
+static const char g_schemaMap[] = "map";
+static const char g_schemaValueSchema[] = "valueSchema";
+static const char g_schemaEnumValues[] = "enumValues";
+static const char g_schemaEnumValue[] = "enumValue";
+static const char g_schemaElementSchema[] = "elementSchema";
+static const char g_schemaFields[] = "fields";
+static const char g_schemaMapKey[] = "mapKey";
+static const char g_schemaMapValue[] = "mapValue";
+
+// Checks each value of a payload against the schema expected at its position while the payload is parsed.
+// Object fields not declared in the schema, values of another type and values not in an enum are invalid. Only map values can be null
+class MimPayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, MimPayloadHandler>
+{
+public:
+    MimPayloadHandler(const MimValidator::Schema* schema) : m_expected(schema), m_nullable(false) {}
+
+    bool Null() { return m_nullable ? Next() : false; }
+    bool Bool(bool) { return Is(MimValidator::Schema::Boolean) ? Next() : false; }
+    bool Int(int value) { return Integer(value); }
+    bool Uint(unsigned value) { return Integer(value); }
+    bool Int64(int64_t value) { return Integer(value); }
+    bool Uint64(uint64_t value) { return (value <= INT64_MAX) ? Integer((int64_t)value) : false; }
+    bool Double(double) { return false; }
+    bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }
+
+    bool String(const char* value, rapidjson::SizeType length, bool)
+    {
+        return (Is(MimValidator::Schema::String) && (m_expected->stringValues.empty() || (m_expected->stringValues.end() != m_expected->stringValues.find(std::string(value, length))))) ? Next() : false;
+    }
+
+    bool StartObject()
+    {
+        if (!Is(MimValidator::Schema::Object) && !Is(MimValidator::Schema::Map))
+        {
+            return false;
+        }
+
+        m_containers.push_back(m_expected);
+        m_expected = nullptr;
+        m_nullable = false;
+        return true;
+    }
+
+    bool Key(const char* name, rapidjson::SizeType length, bool)
+    {
+        const MimValidator::Schema* container = m_containers.back();
+
+        if (MimValidator::Schema::Map == container->type)
+        {
+            m_expected = container->element.get();
+            m_nullable = true;
+            return true;
+        }
+
+        auto field = container->fields.find(std::string(name, length));
+        if (container->fields.end() == field)
+        {
+            return false;
+        }
+
+        m_expected = field->second.get();
+        m_nullable = false;
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        m_containers.pop_back();
+        return Next();
+    }
+
+    bool StartArray()
+    {
+        if (!Is(MimValidator::Schema::Array))
+        {
+            return false;
+        }
+
+        m_containers.push_back(m_expected);
+        m_expected = m_expected->element.get();
+        m_nullable = false;
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType)
+    {
+        m_containers.pop_back();
+        return Next();
+    }
+
+private:
+    // The schema of the next value, none when a key or the end of the payload is next
+    const MimValidator::Schema* m_expected;
+    bool m_nullable;
+    std::vector<const MimValidator::Schema*> m_containers;
+
+    bool Is(MimValidator::Schema::Type type) const
+    {
+        return (nullptr != m_expected) && (type == m_expected->type);
+    }
+
+    bool Integer(int64_t value)
+    {
+        return (Is(MimValidator::Schema::Integer) && (m_expected->integerValues.empty() || (m_expected->integerValues.end() != m_expected->integerValues.find(value)))) ? Next() : false;
+    }
+
+    // After a value the next one is an element of the same array, or follows a key
+    bool Next()
+    {
+        m_expected = (!m_containers.empty() && (MimValidator::Schema::Array == m_containers.back()->type)) ? m_containers.back()->element.get() : nullptr;
+        m_nullable = false;
+        return true;
+    }
+};
+
+static bool IsStringMember(const rapidjson::Value& value, const char* name)
+{
+    return value.IsObject() && value.HasMember(name) && value[name].IsString();
+}
+
+std::shared_ptr<const MimValidator::Schema> MimValidator::CompileSchema(const rapidjson::Value& schema)
+{
+    std::shared_ptr<Schema> compiled = std::make_shared<Schema>();
+
+    if (schema.IsString())
+    {
+        if (0 == strcmp(schema.GetString(), g_schemaString))
+        {
+            compiled->type = Schema::String;
+        }
+        else if (0 == strcmp(schema.GetString(), g_schemaInteger))
+        {
+            compiled->type = Schema::Integer;
+        }
+        else if (0 == strcmp(schema.GetString(), g_schemaBoolean))
+        {
+            compiled->type = Schema::Boolean;
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Unsupported MIM schema type: '%s'", schema.GetString());
+            return nullptr;
+        }
+    }
+    else if (!schema.IsObject())
+    {
+        OsConfigLogError(GetPlatformLog(), "MIM schema is not a string or an object");
+        return nullptr;
+    }
+    else if (IsStringMember(schema, g_mimType) && (0 == strcmp(schema[g_mimType].GetString(), g_schemaEnum)))
+    {
+        if (!IsStringMember(schema, g_schemaValueSchema) || !schema.HasMember(g_schemaEnumValues) || !schema[g_schemaEnumValues].IsArray())
+        {
+            OsConfigLogError(GetPlatformLog(), "MIM enum schema without '%s' or '%s'", g_schemaValueSchema, g_schemaEnumValues);
+            return nullptr;
+        }
+        else if (0 == strcmp(schema[g_schemaValueSchema].GetString(), g_schemaInteger))
+        {
+            compiled->type = Schema::Integer;
+        }
+        else if (0 == strcmp(schema[g_schemaValueSchema].GetString(), g_schemaString))
+        {
+            compiled->type = Schema::String;
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Unsupported MIM enum value schema: '%s'", schema[g_schemaValueSchema].GetString());
+            return nullptr;
+        }
+
+        for (auto& enumValue : schema[g_schemaEnumValues].GetArray())
+        {
+            if (!enumValue.IsObject() || !enumValue.HasMember(g_schemaEnumValue))
+            {
+                continue;
+            }
+            else if ((Schema::Integer == compiled->type) && enumValue[g_schemaEnumValue].IsInt64())
+            {
+                compiled->integerValues.insert(enumValue[g_schemaEnumValue].GetInt64());
+            }
+            else if ((Schema::String == compiled->type) && enumValue[g_schemaEnumValue].IsString())
+            {
+                compiled->stringValues.insert(enumValue[g_schemaEnumValue].GetString());
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "MIM enum value is not of type '%s'", schema[g_schemaValueSchema].GetString());
+                return nullptr;
+            }
+        }
+    }
+    else if (IsStringMember(schema, g_mimType) && (0 == strcmp(schema[g_mimType].GetString(), g_schemaArray)))
+    {
+        compiled->type = Schema::Array;
+
+        if (!schema.HasMember(g_schemaElementSchema) || (nullptr == (compiled->element = CompileSchema(schema[g_schemaElementSchema]))))
+        {
+            OsConfigLogError(GetPlatformLog(), "MIM array schema without a valid '%s'", g_schemaElementSchema);
+            return nullptr;
+        }
+    }
+    else if (IsStringMember(schema, g_mimType) && (0 == strcmp(schema[g_mimType].GetString(), g_schemaMap)))
+    {
+        compiled->type = Schema::Map;
+
+        // Map keys are always strings
+        if (!schema.HasMember(g_schemaMapKey) || !schema.HasMember(g_schemaMapValue) || !schema[g_schemaMapValue].IsObject() || !schema[g_schemaMapValue].HasMember(g_mimSchema) ||
+            (nullptr == (compiled->element = CompileSchema(schema[g_schemaMapValue][g_mimSchema]))))
+        {
+            OsConfigLogError(GetPlatformLog(), "MIM map schema without '%s' or a valid '%s'", g_schemaMapKey, g_schemaMapValue);
+            return nullptr;
+        }
+    }
+    else if ((!schema.HasMember(g_mimType) || (IsStringMember(schema, g_mimType) && (0 == strcmp(schema[g_mimType].GetString(), g_schemaObject)))) &&
+        schema.HasMember(g_schemaFields) && schema[g_schemaFields].IsArray())
+    {
+        // Some models leave out the type of an object schema and only have its fields
+        compiled->type = Schema::Object;
+
+        for (auto& field : schema[g_schemaFields].GetArray())
+        {
+            std::shared_ptr<const Schema> fieldSchema;
+
+            if (!IsStringMember(field, g_mimName) || !field.HasMember(g_mimSchema) || (nullptr == (fieldSchema = CompileSchema(field[g_mimSchema]))))
+            {
+                OsConfigLogError(GetPlatformLog(), "MIM object schema with an invalid field");
+                return nullptr;
+            }
+
+            compiled->fields[field[g_mimName].GetString()] = fieldSchema;
+        }
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Unsupported MIM schema");
+        return nullptr;
+    }
+
+    return compiled;
+}
+
+int MimValidator::LoadModel(const char* modelJson, size_t modelJsonSizeBytes)
+{
+    rapidjson::Document document;
+
+    if (document.Parse(modelJson, modelJsonSizeBytes).HasParseError() || !document.IsObject())
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to parse MIM model JSON");
+        return EINVAL;
+    }
+    else if (!document.HasMember(g_mimContents) || !document[g_mimContents].IsArray())
+    {
+        OsConfigLogError(GetPlatformLog(), "MIM model without '%s' array", g_mimContents);
+        return EINVAL;
+    }
+
+    for (auto& component : document[g_mimContents].GetArray())
+    {
+        if (!IsStringMember(component, g_mimName) || !IsStringMember(component, g_mimType) || (0 != strcmp(component[g_mimType].GetString(), g_mimComponent)) ||
+            !component.HasMember(g_mimContents) || !component[g_mimContents].IsArray())
+        {
+            OsConfigLogError(GetPlatformLog(), "Skipping invalid MIM component");
+            continue;
+        }
+
+        std::string componentName = component[g_mimName].GetString();
+
+        for (auto& object : component[g_mimContents].GetArray())
+        {
+            std::shared_ptr<const Schema> schema;
+
+            if (!IsStringMember(object, g_mimName) || !IsStringMember(object, g_mimType) || (0 != strcmp(object[g_mimType].GetString(), g_mimObject)) || !object.HasMember(g_mimSchema))
+            {
+                OsConfigLogError(GetPlatformLog(), "Skipping invalid MIM object of component '%s'", componentName.c_str());
+            }
+            else if (nullptr == (schema = CompileSchema(object[g_mimSchema])))
+            {
+                // Payloads of the object are then validated against the generic MIM object schema
+                OsConfigLogError(GetPlatformLog(), "Skipping MIM object '%s' of component '%s' with an unsupported schema", object[g_mimName].GetString(), componentName.c_str());
+            }
+            else
+            {
+                m_objects[componentName][object[g_mimName].GetString()] = schema;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int MimValidator::LoadModels(const std::string& directory)
+{
+    DIR* dir;
+    struct dirent* ent;
+    int loaded = 0;
+
+    if ((dir = opendir(directory.c_str())) == NULL)
+    {
+        OsConfigLogInfo(GetPlatformLog(), "No MIM models in %s, payloads are validated against the generic MIM object schema", directory.c_str());
+        return 0;
+    }
+
+    while ((ent = readdir(dir)) != NULL)
+    {
+        std::string filename = directory + "/" + ent->d_name;
+
+        if ((filename.length() > g_mimExtension.length()) && (0 == filename.compare(filename.length() - g_mimExtension.length(), g_mimExtension.length(), g_mimExtension)))
+        {
+            std::ifstream ifs(filename);
+            std::string modelJson((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+            if (ifs.good() && (0 == LoadModel(modelJson.c_str(), modelJson.length())))
+            {
+                loaded++;
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "Failed to load MIM model: %s", filename.c_str());
+            }
+        }
+    }
+    closedir(dir);
+
+    OsConfigLogInfo(GetPlatformLog(), "Loaded %d MIM models from %s", loaded, directory.c_str());
+
+    return loaded;
+}
+
+bool MimValidator::HasObject(const std::string& componentName, const std::string& objectName) const
+{
+    auto component = m_objects.find(componentName);
+    return (m_objects.end() != component) && (component->second.end() != component->second.find(objectName));
+}
+
+bool MimValidator::IsValid(const std::string& componentName, const std::string& objectName, const char* payload, int payloadSizeBytes) const
+{
+    auto component = m_objects.find(componentName);
+    std::map<std::string, std::shared_ptr<const Schema>>::const_iterator object;
+
+    if ((m_objects.end() == component) || (component->second.end() == (object = component->second.find(objectName))))
+    {
+        return IsValidMimObjectPayload(payload, payloadSizeBytes, GetPlatformLog());
+    }
+    else if ((nullptr == payload) || (0 >= payloadSizeBytes))
+    {
+        return false;
+    }
+
+    rapidjson::MemoryStream memoryStream(payload, payloadSizeBytes);
+    rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> stream(memoryStream);
+    rapidjson::Reader reader;
+    MimPayloadHandler handler(object->second.get());
+
+    if (reader.Parse(stream, handler).IsError())
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "Invalid payload for %s.%s according to its MIM model: '%.*s' (%d bytes)", componentName.c_str(), objectName.c_str(), payloadSizeBytes, payload, payloadSizeBytes);
+        }
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <PlatformCommon.h>
+#include <ModuleHostProtocol.h>
+
+// Larger frames are taken for a broken stream
+static const uint32_t g_maxFrameSizeBytes = 64 * 1024 * 1024;
+
+void ModuleHostFrame::AddInteger(int value)
+{
+    int32_t field = static_cast<int32_t>(value);
+    m_data.append(reinterpret_cast<const char*>(&field), sizeof(field));
+}
+
+void ModuleHostFrame::AddString(const char* value, int length)
+{
+    if ((nullptr == value) || (0 > length))
+    {
+        AddInteger(-1);
+    }
+    else
+    {
+        AddInteger(length);
+        m_data.append(value, length);
+    }
+}
+
+void ModuleHostFrame::AddString(const char* value)
+{
+    AddString(value, (nullptr != value) ? static_cast<int>(strlen(value)) : -1);
+}
+
+bool ModuleHostFrame::GetInteger(int& value)
+{
+    int32_t field = 0;
+
+    if ((m_data.length() - m_position) < sizeof(field))
+    {
+        return false;
+    }
+
+    memcpy(&field, m_data.data() + m_position, sizeof(field));
+    m_position += sizeof(field);
+    value = static_cast<int>(field);
+
+    return true;
+}
+
+bool ModuleHostFrame::GetString(std::string& value, bool& isNull)
+{
+    int length = 0;
+
+    if (!GetInteger(length) || ((0 <= length) && ((m_data.length() - m_position) < static_cast<size_t>(length))))
+    {
+        return false;
+    }
+
+    isNull = (0 > length);
+    value.clear();
+
+    if (!isNull)
+    {
+        value.assign(m_data, m_position, length);
+        m_position += length;
+    }
+
+    return true;
+}
+
+bool ModuleHostFrame::GetString(std::string& value)
+{
+    bool isNull = false;
+    return GetString(value, isNull);
+}
+
+// Waits for the socket to become ready, with a deadline when the timeout is not 0
+static int WaitForSocket(int socket, short events, unsigned int timeoutMilliseconds, const std::chrono::steady_clock::time_point& deadline)
+{
+    struct pollfd pollFd = {socket, events, 0};
+    int timeout = -1;
+    int result = 0;
+
+    if (0 != timeoutMilliseconds)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        timeout = (0 < remaining) ? static_cast<int>(remaining) : 0;
+    }
+
+    while ((-1 == (result = poll(&pollFd, 1, timeout))) && (EINTR == errno))
+    {
+    }
+
+    if (0 > result)
+    {
+        return errno;
+    }
+    else if (0 == result)
+    {
+        return ETIME;
+    }
+
+    return 0;
+}
+
+int ModuleHostFrame::Send(int socket, unsigned int timeoutMilliseconds) const
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+    uint32_t length = static_cast<uint32_t>(m_data.length());
+    std::string frame(reinterpret_cast<const char*>(&length), sizeof(length));
+    size_t sent = 0;
+    int status = 0;
+
+    if (length > g_maxFrameSizeBytes)
+    {
+        return EMSGSIZE;
+    }
+
+    frame.append(m_data);
+
+    while ((0 == status) && (sent < frame.length()))
+    {
+        if (0 == (status = WaitForSocket(socket, POLLOUT, timeoutMilliseconds, deadline)))
+        {
+            ssize_t result = send(socket, frame.data() + sent, frame.length() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+            if (0 <= result)
+            {
+                sent += result;
+            }
+            else if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+            {
+                status = errno;
+            }
+        }
+    }
+
+    return status;
+}
+
+int ModuleHostFrame::Receive(int socket, unsigned int timeoutMilliseconds)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+    uint32_t length = 0;
+    size_t received = 0;
+    size_t expected = sizeof(length);
+    std::string data(expected, '\0');
+    int status = 0;
+
+    while ((0 == status) && (received < expected))
+    {
+        if (0 == (status = WaitForSocket(socket, POLLIN, timeoutMilliseconds, deadline)))
+        {
+            ssize_t result = recv(socket, &data[received], expected - received, MSG_DONTWAIT);
+
+            if (0 < result)
+            {
+                received += result;
+            }
+            else if (0 == result)
+            {
+                status = EPIPE;
+            }
+            else if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+            {
+                status = (ECONNRESET == errno) ? EPIPE : errno;
+            }
+
+            // The length is followed by the fields of the frame
+            if ((0 == status) && (received == sizeof(length)) && (expected == sizeof(length)))
+            {
+                memcpy(&length, data.data(), sizeof(length));
+
+                if (length > g_maxFrameSizeBytes)
+                {
+                    status = EMSGSIZE;
+                }
+                else
+                {
+                    expected += length;
+                    data.resize(expected);
+                }
+            }
+        }
+    }
+
+    if (0 == status)
+    {
+        m_data = data.substr(sizeof(length));
+        m_position = 0;
+    }
+
+    return status;
+}
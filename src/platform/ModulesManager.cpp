@@ -3,34 +3,61 @@
 
 #include <PlatformCommon.h>
 #include <ManagementModule.h>
+#include <ModuleHostProtocol.h>
+#include <HostedManagementModule.h>
+#include <MimValidator.h>
 #include <ModulesManager.h>
 #include <MpiServer.h>
 
 static const std::string g_moduleDir = "/usr/lib/osconfig";
 static const std::string g_moduleExtension = ".so";
+static const std::string g_mimDir = "mim";
 
 static const std::string g_configJson = "/etc/osconfig/osconfig.json";
+static const std::string g_moduleCache = "/var/lib/osconfig/modules.json";
+static const std::string g_moduleHostPath = "/usr/bin/osconfig-modulehost";
+
+static const char g_moduleCacheModules[] = "Modules";
+static const char g_moduleCachePath[] = "Path";
+static const char g_moduleCacheSize[] = "Size";
+static const char g_moduleCacheModifiedTime[] = "ModifiedTime";
+static const char g_moduleCacheInode[] = "Inode";
+static const char g_moduleCacheInfo[] = "Info";
 static const char g_configReported[] = "Reported";
 static const char g_configComponentName[] = "ComponentName";
 static const char g_configObjectName[] = "ObjectName";
+static const char g_reportedTimedOut[] = "TimedOut";
+static const char g_reportedRemoved[] = "Removed";
 
 #define UUID_LENGTH 36
 
 static ModulesManager modulesManager;
 static std::map<std::string, std::shared_ptr<MpiSession>> g_sessions;
+static std::mutex g_sessionsMutex;
 
 static bool g_modulesLoaded = false;
+static std::mutex g_modulesLoadedMutex;
+
+static std::thread g_modulesLoader;
+
+// When not 0, modules with a Short lifetime are unloaded after being idle for this many seconds
+static unsigned int g_moduleIdleUnloadSeconds = 0;
 
 void AreModulesLoadedAndLoadIfNot()
 {
+    std::lock_guard<std::mutex> lock(g_modulesLoadedMutex);
+
     if (false == g_modulesLoaded)
     {
-        g_modulesLoaded = (bool)(0 == modulesManager.LoadModules(g_moduleDir, g_configJson));
+        g_modulesLoaded = (bool)(0 == modulesManager.LoadModules(g_moduleDir, g_configJson, g_moduleCache));
     }
 }
 
 void UnloadModules()
 {
+    std::lock_guard<std::mutex> modulesLock(g_modulesLoadedMutex);
+    std::lock_guard<std::mutex> sessionsLock(g_sessionsMutex);
+
     for (auto& session : g_sessions)
     {
         session.second->Close();
@@ -38,19 +65,139 @@ void UnloadModules()
 
     g_sessions.clear();
     modulesManager.UnloadModules();
+    g_modulesLoaded = false;
+}
+
+// The session is returned as a shared pointer so that it stays valid for the duration of the call even if closed by another client request
+static std::shared_ptr<MpiSession> FindSession(const std::string& uuid)
+{
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto session = g_sessions.find(uuid);
+    return (session != g_sessions.end()) ? session->second : nullptr;
+}
+
+// "SequentialDesiredComponents" is an optional array of arrays of component names
+static std::vector<std::vector<std::string>> GetSequentialDesiredComponents(const char* jsonConfiguration)
+{
+    static const char sequentialDesiredComponents[] = "SequentialDesiredComponents";
+    std::vector<std::vector<std::string>> groups;
+    rapidjson::Document document;
+
+    if ((nullptr == jsonConfiguration) || document.Parse(jsonConfiguration).HasParseError() || !document.IsObject() || !document.HasMember(sequentialDesiredComponents))
+    {
+        return groups;
+    }
+
+    if (!document[sequentialDesiredComponents].IsArray())
+    {
+        OsConfigLogError(GetPlatformLog(), "%s is not an array in configuration", sequentialDesiredComponents);
+        return groups;
+    }
+
+    for (auto& group : document[sequentialDesiredComponents].GetArray())
+    {
+        if (group.IsArray())
+        {
+            groups.push_back(std::vector<std::string>());
+
+            for (auto& componentName : group.GetArray())
+            {
+                if (componentName.IsString())
+                {
+                    groups.back().push_back(componentName.GetString());
+                }
+            }
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "%s element is not an array of component names", sequentialDesiredComponents);
+        }
+    }
+
+    return groups;
+}
+
+// "ModuleCallTimeouts" is an optional object with the call timeout in milliseconds of each module by name, overriding "ModuleCallTimeoutMilliseconds"
+static std::map<std::string, unsigned int> GetModuleCallTimeouts(const char* jsonConfiguration)
+{
+    static const char moduleCallTimeouts[] = "ModuleCallTimeouts";
+    std::map<std::string, unsigned int> timeouts;
+    rapidjson::Document document;
+
+    if ((nullptr == jsonConfiguration) || document.Parse(jsonConfiguration).HasParseError() || !document.IsObject() || !document.HasMember(moduleCallTimeouts))
+    {
+        return timeouts;
+    }
+
+    if (!document[moduleCallTimeouts].IsObject())
+    {
+        OsConfigLogError(GetPlatformLog(), "%s is not an object in configuration", moduleCallTimeouts);
+        return timeouts;
+    }
+
+    for (auto& timeout : document[moduleCallTimeouts].GetObject())
+    {
+        if (timeout.value.IsUint())
+        {
+            timeouts[timeout.name.GetString()] = timeout.value.GetUint();
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "%s value for '%s' is not an unsigned integer", moduleCallTimeouts, timeout.name.GetString());
+        }
+    }
+
+    return timeouts;
 }
 
 void MpiInitialize(void)
 {
+    char* jsonConfiguration = LoadStringFromFile(g_configJson.c_str(), false, GetPlatformLog());
+
+    g_moduleIdleUnloadSeconds = (unsigned int)GetModuleIdleUnloadSecondsFromJsonConfig(jsonConfiguration, GetPlatformLog());
+    modulesManager.SetReportedObjectTimeout((unsigned int)GetReportedObjectTimeoutFromJsonConfig(jsonConfiguration, GetPlatformLog()));
+    modulesManager.SetPrettyPrintReported(1 == GetPrettyPrintReportedFromJsonConfig(jsonConfiguration, GetPlatformLog()));
+    modulesManager.SetParallelDesired(1 == GetParallelDesiredFromJsonConfig(jsonConfiguration, GetPlatformLog()), GetSequentialDesiredComponents(jsonConfiguration));
+    modulesManager.SetModuleCallTimeout((unsigned int)GetModuleCallTimeoutFromJsonConfig(jsonConfiguration, GetPlatformLog()), GetModuleCallTimeouts(jsonConfiguration));
+    modulesManager.SetModuleHost((1 == GetModuleHostFromJsonConfig(jsonConfiguration, GetPlatformLog())) ? g_moduleHostPath : "");
+    FREE_MEMORY(jsonConfiguration);
+
+    // Modules load in the background while the server starts, requests that come in meanwhile wait for them in AreModulesLoadedAndLoadIfNot
+    try
+    {
+        g_modulesLoader = std::thread(AreModulesLoadedAndLoadIfNot);
+    }
+    catch (const std::system_error& e)
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to start loading modules at startup, modules will load with the first request (%s)", e.what());
+    }
+
     MpiServerInitialize();
 }
 
 void MpiShutdown(void)
 {
+    if (g_modulesLoader.joinable())
+    {
+        g_modulesLoader.join();
+    }
+
     MpiServerShutdown();
 }
 
-void MpiDoWork() {}
+void MpiDoWork()
+{
+    if (0 < g_moduleIdleUnloadSeconds)
+    {
+        // Modules that are still loading are not idle, this is tried again with the next call
+        std::unique_lock<std::mutex> lock(g_modulesLoadedMutex, std::try_to_lock);
+
+        if (lock.owns_lock() && g_modulesLoaded)
+        {
+            modulesManager.UnloadIdleModules(g_moduleIdleUnloadSeconds);
+        }
+    }
+}
 
 MPI_HANDLE MpiOpen(
     const char* clientName,
@@ -76,6 +223,7 @@ MPI_HANDLE MpiOpen(
         if ((nullptr != session) && (0 == session->Open()))
         {
             char* uuid = session->GetUuid();
+            std::lock_guard<std::mutex> lock(g_sessionsMutex);
             g_sessions[uuid] = session;
             handle = reinterpret_cast<MPI_HANDLE>(uuid);
         }
@@ -97,11 +245,21 @@ void MpiClose(MPI_HANDLE handle)
     if (nullptr != handle)
     {
         std::string uuid = reinterpret_cast<const char*>(handle);
+        std::shared_ptr<MpiSession> session;
+
+        {
+            std::lock_guard<std::mutex> lock(g_sessionsMutex);
+            auto it = g_sessions.find(uuid);
+            if (it != g_sessions.end())
+            {
+                session = it->second;
+                g_sessions.erase(it);
+            }
+        }
 
-        if (g_sessions.find(uuid) != g_sessions.end())
+        if (nullptr != session)
         {
-            g_sessions[uuid]->Close();
-            g_sessions.erase(uuid);
+            session->Close();
         }
     }
     else
@@ -121,11 +279,11 @@ int MpiSet(
 
     if (nullptr != handle)
     {
-        std::string uuid = reinterpret_cast<const char*>(handle);
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
 
-        if (g_sessions.find(uuid) != g_sessions.end())
+        if (nullptr != session)
         {
-            status = g_sessions[uuid]->Set(componentName, objectName, payload, payloadSizeBytes);
+            status = session->Set(componentName, objectName, payload, payloadSizeBytes);
         }
         else
         {
@@ -153,11 +311,11 @@ int MpiGet(
 
     if (nullptr != handle)
     {
-        std::string uuid = reinterpret_cast<const char*>(handle);
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
 
-        if (g_sessions.find(uuid) != g_sessions.end())
+        if (nullptr != session)
         {
-            status = g_sessions[uuid]->Get(componentName, objectName, payload, payloadSizeBytes);
+            status = session->Get(componentName, objectName, payload, payloadSizeBytes);
         }
         else
         {
@@ -183,11 +341,11 @@ int MpiSetDesired(
 
     if (nullptr != handle)
     {
-        std::string uuid = reinterpret_cast<const char*>(handle);
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
 
-        if (g_sessions.find(uuid) != g_sessions.end())
+        if (nullptr != session)
         {
-            status = g_sessions[uuid]->SetDesired(payload, payloadSizeBytes);
+            status = session->SetDesired(payload, payloadSizeBytes);
         }
         else
         {
@@ -204,6 +362,27 @@ int MpiSetDesired(
     return status;
 }
 
+int MpiSetDesiredReapply(
+    MPI_HANDLE handle,
+    const MPI_JSON_STRING payload,
+    const int payloadSizeBytes)
+{
+    int status = MPI_OK;
+    std::shared_ptr<MpiSession> session;
+
+    if ((nullptr != handle) && (nullptr != (session = FindSession(reinterpret_cast<const char*>(handle)))))
+    {
+        status = session->SetDesired(payload, payloadSizeBytes, true);
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSetDesiredReapply called with an invalid handle: %p", handle);
+        status = EINVAL;
+    }
+
+    return status;
+}
+
 int MpiGetReported(
     MPI_HANDLE handle,
     MPI_JSON_STRING* payload,
@@ -213,11 +392,11 @@ int MpiGetReported(
 
     if (nullptr != handle)
     {
-        std::string uuid = reinterpret_cast<const char*>(handle);
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
 
-        if (g_sessions.find(uuid) != g_sessions.end())
+        if (nullptr != session)
         {
-            status = g_sessions[uuid]->GetReported(payload, payloadSizeBytes);
+            status = session->GetReported(payload, payloadSizeBytes);
         }
         else
         {
@@ -234,673 +413,2292 @@ int MpiGetReported(
     return status;
 }
 
-void MpiFree(MPI_JSON_STRING payload)
-{
-    delete[] payload;
-}
-
-ModulesManager::ModulesManager() {}
-
-ModulesManager::~ModulesManager()
-{
-    UnloadModules();
-}
-
-int ModulesManager::LoadModules(std::string modulePath, std::string configJson)
+int MpiGetReportedStream(
+    MPI_HANDLE handle,
+    MPI_WRITE_CALLBACK writeCallback,
+    void* context)
 {
-    int status = 0;
-
-    DIR* dir;
-    struct dirent* ent;
-    std::vector<std::string> fileList;
-
-    OsConfigLogInfo(GetPlatformLog(), "Loading modules from: %s", modulePath.c_str());
+    int status = MPI_OK;
 
-    if ((dir = opendir(modulePath.c_str())) != NULL)
+    if (nullptr != handle)
     {
-        while ((ent = readdir(dir)) != NULL)
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
+
+        if (nullptr != session)
         {
-            std::string filename = modulePath + "/" + ent->d_name;
-            // Find all .so's
-            if (filename.length() > g_moduleExtension.length() && (0 == filename.compare(filename.length() - g_moduleExtension.length(), g_moduleExtension.length(), g_moduleExtension.c_str())))
-            {
-                fileList.push_back(filename);
-            }
+            status = session->GetReportedStream(writeCallback, context);
         }
-        closedir(dir);
-
-        sort(fileList.begin(), fileList.end());
-
-        // Build map for module name -> ManagementModule
-        for (auto &filePath : fileList)
+        else
         {
-            std::shared_ptr<ManagementModule> mm = std::make_shared<ManagementModule>(filePath);
-            if (0 == mm->Load())
-            {
-                ManagementModule::Info info = mm->GetInfo();
-
-                if (m_modules.find(info.name) != m_modules.end())
-                {
-                    auto currentInfo = m_modules[info.name]->GetInfo();
-
-                    // Use the module with the latest version
-                    if (currentInfo.version < info.version)
-                    {
-                        OsConfigLogInfo(GetPlatformLog(), "Found newer version of '%s' module (v%s), loading newer version from '%s'", info.name.c_str(), info.version.ToString().c_str(), filePath.c_str());
-                        m_modules[info.name] = mm;
-
-                        RegisterModuleComponents(info.name, info.components, true);
-                    }
-                    else
-                    {
-                        OsConfigLogInfo(GetPlatformLog(), "Newer version of '%s' module already loaded (v%s), skipping '%s'", info.name.c_str(), currentInfo.version.ToString().c_str(), filePath.c_str());
-                    }
-                }
-                else
-                {
-                    m_modules[info.name] = mm;
-                    RegisterModuleComponents(info.name, info.components);
-                }
-            }
+            OsConfigLogError(GetPlatformLog(), "MpiGetReportedStream called with an invalid handle: %p ('%s')", handle, reinterpret_cast<char*>(handle));
+            status = EINVAL;
         }
-
-        status = SetReportedObjects(configJson);
     }
     else
     {
-        OsConfigLogError(GetPlatformLog(), "Unable to open directory: %s", modulePath.c_str());
-        status = ENOENT;
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedStream called with invalid null handle");
+        status = EINVAL;
     }
 
     return status;
 }
 
-int ModulesManager::SetReportedObjects(const std::string& configJson)
+int MpiGetReportedChanges(
+    MPI_HANDLE handle,
+    const unsigned long long sinceVersion,
+    MPI_JSON_STRING* payload,
+    int* payloadSizeBytes)
 {
     int status = MPI_OK;
-    std::ifstream ifs(configJson);
 
-    if (!ifs.good())
+    if (nullptr != handle)
     {
-        OsConfigLogError(GetPlatformLog(), "Unable to open configuration file: %s", configJson.c_str());
-        return ENOENT;
-    }
+        std::shared_ptr<MpiSession> session = FindSession(reinterpret_cast<const char*>(handle));
 
-    rapidjson::IStreamWrapper isw(ifs);
-    rapidjson::Document document;
-    if (document.ParseStream(isw).HasParseError())
-    {
-        OsConfigLogError(GetPlatformLog(), "Unable to parse configuration file: %s", configJson.c_str());
-        status = EINVAL;
-    }
-    else if (!document.IsObject())
-    {
-        OsConfigLogError(GetPlatformLog(), "Root configuration JSON is not an object: %s", configJson.c_str());
-        status = EINVAL;
+        if (nullptr != session)
+        {
+            status = session->GetReportedChanges(sinceVersion, payload, payloadSizeBytes);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges called with an invalid handle: %p ('%s')", handle, reinterpret_cast<char*>(handle));
+            status = EINVAL;
+        }
     }
-    else if (!document.HasMember(g_configReported))
+    else
     {
-        OsConfigLogError(GetPlatformLog(), "No valid %s array in configuration: %s", g_configReported, configJson.c_str());
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges called with invalid null handle");
         status = EINVAL;
     }
-    else if (!document[g_configReported].IsArray())
+
+    return status;
+}
+
+int MpiSetReportedCacheBypass(
+    MPI_HANDLE handle,
+    const int bypass)
+{
+    int status = MPI_OK;
+    std::shared_ptr<MpiSession> session;
+
+    if ((nullptr != handle) && (nullptr != (session = FindSession(reinterpret_cast<const char*>(handle)))))
     {
-        OsConfigLogError(GetPlatformLog(), "%s is not an array in configuration: %s", g_configReported, configJson.c_str());
-        status = EINVAL;
+        session->SetReportedCacheBypass(0 != bypass);
     }
     else
     {
-        int index = 0;
-        std::set<std::pair<std::string, std::string>> objects;
-        for (auto& reported : document[g_configReported].GetArray())
-        {
-            if (reported.IsObject())
-            {
-                if (reported.HasMember(g_configComponentName) && reported.HasMember(g_configObjectName))
-                {
-                    std::string componentName = reported[g_configComponentName].GetString();
-                    std::string objectName = reported[g_configObjectName].GetString();
-
-                    if (m_reportedComponents.find(componentName) == m_reportedComponents.end())
-                    {
-                        m_reportedComponents[componentName] = std::vector<std::string>();
-                    }
-
-                    if (objects.find({componentName, objectName}) == objects.end())
-                    {
-                        objects.insert({componentName, objectName});
-                        m_reportedComponents[componentName].push_back(objectName);
-                    }
-                }
-                else
-                {
-                    OsConfigLogError(GetPlatformLog(), "'%s' or '%s' missing at index %d", g_configComponentName, g_configObjectName, index);
-                    status = EINVAL;
-                }
-            }
-            else
-            {
-                OsConfigLogError(GetPlatformLog(), "%s array element %d is not an object: %s", g_configReported, index, configJson.c_str());
-                status = EINVAL;
-            }
-        }
+        OsConfigLogError(GetPlatformLog(), "MpiSetReportedCacheBypass called with an invalid handle: %p", handle);
+        status = EINVAL;
     }
 
     return status;
 }
 
-void ModulesManager::RegisterModuleComponents(const std::string& moduleName, const std::vector<std::string>& components, bool replace)
+void MpiFree(MPI_JSON_STRING payload)
 {
-    for (auto& component : components)
+    delete[] payload;
+}
+
+WorkerPool::WorkerPool() : m_tasks(std::make_shared<Tasks>()) {}
+
+WorkerPool::~WorkerPool()
+{
+    bool busy = false;
+
     {
-        if (replace || (m_moduleComponentName.find(component) == m_moduleComponentName.end()))
+        std::lock_guard<std::mutex> lock(m_tasks->mutex);
+        m_tasks->stop = true;
+        busy = (0 != m_tasks->pending);
+    }
+
+    m_tasks->changed.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        // Not waiting for a module that may never return, the threads exit by themselves once they ran the tasks left
+        if (busy)
         {
-            m_moduleComponentName[component] = moduleName;
+            thread.detach();
         }
         else
         {
-            OsConfigLogError(GetPlatformLog(), "Component '%s' is already registered to module '%s'", component.c_str(), m_moduleComponentName[component].c_str());
+            thread.join();
         }
     }
 }
 
-void ModulesManager::UnloadModules()
+void WorkerPool::Post(const std::string& key, const std::function<void()>& task)
 {
-    for (auto& module : m_modules)
+    bool runHere = false;
+
     {
-        module.second->Unload();
+        std::lock_guard<std::mutex> lock(m_tasks->mutex);
+        std::queue<std::function<void()>>& queue = m_tasks->queues[key];
+
+        // The task at the front of a queue stays there while it runs, so a key with a task running is not ready
+        queue.push(task);
+        m_tasks->pending++;
+
+        if (1 == queue.size())
+        {
+            m_tasks->ready.push(key);
+        }
+
+        if (m_tasks->ready.size() > m_tasks->idle)
+        {
+            try
+            {
+                m_threads.push_back(std::thread(Work, m_tasks, true));
+            }
+            catch (const std::system_error& e)
+            {
+                OsConfigLogError(GetPlatformLog(), "Failed to start a worker thread (%s)", e.what());
+                runHere = m_threads.empty();
+            }
+        }
+    }
+
+    m_tasks->changed.notify_all();
+
+    if (runHere)
+    {
+        Work(m_tasks, false);
+    }
+}
+
+void WorkerPool::Drain()
+{
+    std::unique_lock<std::mutex> lock(m_tasks->mutex);
+    m_tasks->changed.wait(lock, [&]() { return 0 == m_tasks->pending; });
+}
+
+void WorkerPool::Work(std::shared_ptr<Tasks> tasks, bool wait)
+{
+    std::unique_lock<std::mutex> lock(tasks->mutex);
+
+    while (true)
+    {
+        if (wait)
+        {
+            tasks->idle++;
+            tasks->changed.wait(lock, [&]() { return tasks->stop || !tasks->ready.empty(); });
+            tasks->idle--;
+        }
+
+        if (tasks->ready.empty())
+        {
+            break;
+        }
+
+        std::string key = tasks->ready.front();
+        tasks->ready.pop();
+        std::function<void()> task = std::move(tasks->queues[key].front());
+
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+
+        std::queue<std::function<void()>>& queue = tasks->queues[key];
+        queue.pop();
+
+        if (queue.empty())
+        {
+            tasks->queues.erase(key);
+        }
+        else
+        {
+            tasks->ready.push(key);
+        }
+
+        tasks->pending--;
+        tasks->changed.notify_all();
+    }
+}
+
+ModulesManager::ModulesManager() : m_reportedObjectTimeoutMilliseconds(0), m_prettyPrintReported(false), m_parallelDesired(false), m_moduleCallTimeoutMilliseconds(0), m_reportedCacheGeneration(0)
+{
+    m_reportedVersion = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    m_reportedBaseVersion = m_reportedVersion;
+    m_reportedReads = 0;
+}
+
+ModulesManager::~ModulesManager()
+{
+    UnloadModules();
+}
+
+// Identifies the module file that a cached MmiGetInfo payload came from, a file that changed is loaded again to get its info
+struct ModuleCacheEntry
+{
+    long long size = -1;
+    long long modifiedTime = -1;
+    unsigned long long inode = 0;
+    std::string info;
+};
+
+static bool GetModuleFileEntry(const std::string& path, ModuleCacheEntry& entry)
+{
+    struct stat fileStat = {};
+
+    if (0 != stat(path.c_str(), &fileStat))
+    {
+        return false;
+    }
+
+    entry.size = (long long)fileStat.st_size;
+    entry.modifiedTime = ((long long)fileStat.st_mtim.tv_sec * 1000000000LL) + (long long)fileStat.st_mtim.tv_nsec;
+    entry.inode = (unsigned long long)fileStat.st_ino;
+
+    return true;
+}
+
+static bool IsSameModuleFile(const ModuleCacheEntry& left, const ModuleCacheEntry& right)
+{
+    return ((left.size == right.size) && (left.modifiedTime == right.modifiedTime) && (left.inode == right.inode));
+}
+
+static bool IsSameModuleCache(const std::map<std::string, ModuleCacheEntry>& left, const std::map<std::string, ModuleCacheEntry>& right)
+{
+    if (left.size() != right.size())
+    {
+        return false;
+    }
+
+    return std::equal(left.begin(), left.end(), right.begin(), [](const std::pair<const std::string, ModuleCacheEntry>& l, const std::pair<const std::string, ModuleCacheEntry>& r)
+    {
+        return (l.first == r.first) && IsSameModuleFile(l.second, r.second) && (l.second.info == r.second.info);
+    });
+}
+
+static int DeserializeModuleInfo(const std::string& infoJson, ManagementModule::Info& info)
+{
+    rapidjson::Document document;
+
+    if (document.Parse(infoJson.c_str(), infoJson.length()).HasParseError())
+    {
+        return EINVAL;
+    }
+
+    info = ManagementModule::Info();
+    return ManagementModule::Info::Deserialize(document, info);
+}
+
+// A missing or invalid cache is not an error, the modules are then all loaded to get their info and the cache is written again
+static void ReadModuleCache(const std::string& cachePath, std::map<std::string, ModuleCacheEntry>& cache)
+{
+    std::ifstream ifs(cachePath);
+
+    if (!ifs.good())
+    {
+        return;
+    }
+
+    rapidjson::IStreamWrapper isw(ifs);
+    rapidjson::Document document;
+
+    if (document.ParseStream(isw).HasParseError() || !document.IsObject() || !document.HasMember(g_moduleCacheModules) || !document[g_moduleCacheModules].IsArray())
+    {
+        OsConfigLogError(GetPlatformLog(), "Ignoring invalid module cache: %s", cachePath.c_str());
+        return;
+    }
+
+    for (auto& module : document[g_moduleCacheModules].GetArray())
+    {
+        if (module.IsObject() && module.HasMember(g_moduleCachePath) && module[g_moduleCachePath].IsString() &&
+            module.HasMember(g_moduleCacheSize) && module[g_moduleCacheSize].IsInt64() &&
+            module.HasMember(g_moduleCacheModifiedTime) && module[g_moduleCacheModifiedTime].IsInt64() &&
+            module.HasMember(g_moduleCacheInode) && module[g_moduleCacheInode].IsUint64() &&
+            module.HasMember(g_moduleCacheInfo) && module[g_moduleCacheInfo].IsObject())
+        {
+            ModuleCacheEntry entry;
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+            module[g_moduleCacheInfo].Accept(writer);
+
+            entry.size = module[g_moduleCacheSize].GetInt64();
+            entry.modifiedTime = module[g_moduleCacheModifiedTime].GetInt64();
+            entry.inode = module[g_moduleCacheInode].GetUint64();
+            entry.info.assign(buffer.GetString(), buffer.GetSize());
+
+            cache[module[g_moduleCachePath].GetString()] = entry;
+        }
+    }
+}
+
+// Written to a temporary file first so that a cache cut short (crash, power loss) is never read
+static void WriteModuleCache(const std::string& cachePath, const std::map<std::string, ModuleCacheEntry>& cache)
+{
+    std::string cacheDirectory = cachePath.substr(0, cachePath.find_last_of('/'));
+    std::string tempPath = cachePath + ".tmp";
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartObject();
+    writer.Key(g_moduleCacheModules);
+    writer.StartArray();
+
+    for (auto& module : cache)
+    {
+        writer.StartObject();
+        writer.Key(g_moduleCachePath);
+        writer.String(module.first.c_str());
+        writer.Key(g_moduleCacheSize);
+        writer.Int64(module.second.size);
+        writer.Key(g_moduleCacheModifiedTime);
+        writer.Int64(module.second.modifiedTime);
+        writer.Key(g_moduleCacheInode);
+        writer.Uint64(module.second.inode);
+        writer.Key(g_moduleCacheInfo);
+        writer.RawValue(module.second.info.c_str(), module.second.info.length(), rapidjson::kObjectType);
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+
+    if ((0 != mkdir(cacheDirectory.c_str(), S_IRWXU)) && (EEXIST != errno))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to create directory for module cache: %s (%d)", cacheDirectory.c_str(), errno);
+        return;
+    }
+
+    {
+        std::ofstream ofs(tempPath, std::ios::out | std::ios::trunc);
+        ofs.write(buffer.GetString(), buffer.GetSize());
+        ofs.close();
+
+        if (ofs.fail())
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to write module cache: %s", tempPath.c_str());
+            remove(tempPath.c_str());
+            return;
+        }
+    }
+
+    if (0 != rename(tempPath.c_str(), cachePath.c_str()))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to replace module cache %s (%d)", cachePath.c_str(), errno);
+        remove(tempPath.c_str());
+    }
+    else
+    {
+        OsConfigLogInfo(GetPlatformLog(), "Module cache written to %s (%u modules)", cachePath.c_str(), (unsigned int)cache.size());
+    }
+}
+
+// Modules can take long to load (running commands from their constructors and initializers), so they are loaded in parallel.
+// Modules that fail to load are reset, the time each module took is recorded in loadTimes
+static void LoadModulesInParallel(std::vector<std::shared_ptr<ManagementModule>>& modules, std::vector<long long>& loadTimes)
+{
+    std::vector<size_t> indices;
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> loaders;
+
+    for (size_t i = 0; i < modules.size(); i++)
+    {
+        if (nullptr != modules[i])
+        {
+            indices.push_back(i);
+        }
+    }
+
+    auto loadModules = [&]()
+    {
+        size_t i = 0;
+        while ((i = next++) < indices.size())
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            std::shared_ptr<ManagementModule>& module = modules[indices[i]];
+
+            if (0 != module->Load())
+            {
+                module.reset();
+            }
+
+            loadTimes[indices[i]] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        }
+    };
+
+    // The calling thread loads modules too, so loading goes on with fewer threads when some cannot be started
+    for (size_t i = 1; i < std::min<size_t>(indices.size(), std::max(1u, std::thread::hardware_concurrency())); i++)
+    {
+        try
+        {
+            loaders.emplace_back(loadModules);
+        }
+        catch (const std::system_error& e)
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to start a thread to load modules (%s)", e.what());
+            break;
+        }
+    }
+
+    loadModules();
+
+    for (auto& loader : loaders)
+    {
+        loader.join();
+    }
+}
+
+int ModulesManager::LoadModules(std::string modulePath, std::string configJson, std::string cachePath)
+{
+    int status = 0;
+
+    DIR* dir;
+    struct dirent* ent;
+    std::vector<std::string> fileList;
+
+    OsConfigLogInfo(GetPlatformLog(), "Loading modules from: %s", modulePath.c_str());
+
+    if ((dir = opendir(modulePath.c_str())) != NULL)
+    {
+        while ((ent = readdir(dir)) != NULL)
+        {
+            std::string filename = modulePath + "/" + ent->d_name;
+            // Find all .so's
+            if (filename.length() > g_moduleExtension.length() && (0 == filename.compare(filename.length() - g_moduleExtension.length(), g_moduleExtension.length(), g_moduleExtension.c_str())))
+            {
+                fileList.push_back(filename);
+            }
+        }
+        closedir(dir);
+
+        sort(fileList.begin(), fileList.end());
+
+        // The MIM models installed next to the modules are compiled once here, the payloads of all MmiSet and MmiGet calls are validated against them
+        std::shared_ptr<MimValidator> mimValidator = std::make_shared<MimValidator>();
+        mimValidator->LoadModels(modulePath + "/" + g_mimDir);
+
+        // MmiGetInfo payloads cached from earlier loads tell which module files are superseded by newer versions without loading them
+        std::map<std::string, ModuleCacheEntry> cache;
+        std::map<std::string, ModuleCacheEntry> updatedCache;
+        std::vector<ModuleCacheEntry> entries(fileList.size());
+        std::vector<ManagementModule::Info> infos(fileList.size());
+        std::vector<bool> cached(fileList.size(), false);
+        std::vector<std::shared_ptr<ManagementModule>> loadedModules(fileList.size());
+        std::vector<std::shared_ptr<ManagementModule>> newestModules;
+        std::vector<long long> loadTimes(fileList.size(), -1);
+        bool retry = false;
+        auto startTime = std::chrono::steady_clock::now();
+
+        if (!cachePath.empty())
+        {
+            ReadModuleCache(cachePath, cache);
+        }
+
+        for (size_t i = 0; i < fileList.size(); i++)
+        {
+            auto cacheEntry = cache.find(fileList[i]);
+
+            if (GetModuleFileEntry(fileList[i], entries[i]) && (cacheEntry != cache.end()) && IsSameModuleFile(cacheEntry->second, entries[i]) && (0 == DeserializeModuleInfo(cacheEntry->second.info, infos[i])))
+            {
+                entries[i].info = cacheEntry->second.info;
+                cached[i] = true;
+            }
+            else
+            {
+                // Modules not in the cache, or changed since cached, are loaded to get their info
+                loadedModules[i] = CreateModule(fileList[i]);
+            }
+        }
+
+        LoadModulesInParallel(loadedModules, loadTimes);
+
+        // Of the cached modules only the newest version of each is loaded, if that fails to load the next newest one is tried
+        do
+        {
+            std::map<std::string, size_t> newest;
+            newestModules.assign(fileList.size(), nullptr);
+            retry = false;
+
+            for (size_t i = 0; i < fileList.size(); i++)
+            {
+                if (nullptr != loadedModules[i])
+                {
+                    infos[i] = loadedModules[i]->GetInfo();
+                }
+                else if (!cached[i])
+                {
+                    continue;
+                }
+
+                auto current = newest.find(infos[i].name);
+                if ((current == newest.end()) || (infos[current->second].version < infos[i].version))
+                {
+                    newest[infos[i].name] = i;
+                }
+            }
+
+            for (auto& module : newest)
+            {
+                if (nullptr == loadedModules[module.second])
+                {
+                    newestModules[module.second] = CreateModule(fileList[module.second]);
+                }
+            }
+
+            std::vector<std::shared_ptr<ManagementModule>> attempted = newestModules;
+            LoadModulesInParallel(newestModules, loadTimes);
+
+            for (size_t i = 0; i < fileList.size(); i++)
+            {
+                if (nullptr != newestModules[i])
+                {
+                    loadedModules[i] = newestModules[i];
+                }
+                else if (nullptr != attempted[i])
+                {
+                    cached[i] = false;
+                    retry = true;
+                }
+            }
+        } while (retry);
+
+        OsConfigLogInfo(GetPlatformLog(), "Loaded modules from %s in %lld ms", modulePath.c_str(), (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+
+        // Build map for module name -> ManagementModule, in the order of the module paths so that the result does not depend on which module loaded first
+        for (size_t i = 0; i < fileList.size(); i++)
+        {
+            const std::string& filePath = fileList[i];
+            std::shared_ptr<ManagementModule> mm = loadedModules[i];
+
+            if (0 <= loadTimes[i])
+            {
+                OsConfigLogInfo(GetPlatformLog(), "'%s' took %lld ms to load", filePath.c_str(), loadTimes[i]);
+            }
+
+            if ((nullptr != mm) && (0 <= entries[i].size))
+            {
+                entries[i].info = mm->GetInfoJson();
+                updatedCache[filePath] = entries[i];
+            }
+            else if (cached[i])
+            {
+                OsConfigLogInfo(GetPlatformLog(), "Module cache has a newer version of '%s' module than v%s, skipping '%s'", infos[i].name.c_str(), infos[i].version.ToString().c_str(), filePath.c_str());
+                updatedCache[filePath] = entries[i];
+            }
+
+            if (nullptr != mm)
+            {
+                ManagementModule::Info info = mm->GetInfo();
+                auto callTimeout = m_moduleCallTimeouts.find(info.name);
+                mm->SetMimValidator(mimValidator);
+                mm->SetCallTimeout((callTimeout != m_moduleCallTimeouts.end()) ? callTimeout->second : m_moduleCallTimeoutMilliseconds);
+
+                if (m_modules.find(info.name) != m_modules.end())
+                {
+                    auto currentInfo = m_modules[info.name]->GetInfo();
+
+                    // Use the module with the latest version
+                    if (currentInfo.version < info.version)
+                    {
+                        OsConfigLogInfo(GetPlatformLog(), "Found newer version of '%s' module (v%s), loading newer version from '%s'", info.name.c_str(), info.version.ToString().c_str(), filePath.c_str());
+                        m_modules[info.name] = mm;
+
+                        RegisterModuleComponents(info.name, info.components, true);
+                    }
+                    else
+                    {
+                        OsConfigLogInfo(GetPlatformLog(), "Newer version of '%s' module already loaded (v%s), skipping '%s'", info.name.c_str(), currentInfo.version.ToString().c_str(), filePath.c_str());
+                    }
+                }
+                else
+                {
+                    m_modules[info.name] = mm;
+                    RegisterModuleComponents(info.name, info.components);
+                }
+
+                if (m_modules[info.name] == mm)
+                {
+                    FollowModuleReloads(info.name, mm);
+                }
+            }
+        }
+
+        if (!cachePath.empty() && !IsSameModuleCache(cache, updatedCache))
+        {
+            WriteModuleCache(cachePath, updatedCache);
+        }
+
+        status = SetReportedObjects(configJson);
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Unable to open directory: %s", modulePath.c_str());
+        status = ENOENT;
+    }
+
+    return status;
+}
+
+int ModulesManager::SetReportedObjects(const std::string& configJson)
+{
+    int status = MPI_OK;
+    std::ifstream ifs(configJson);
+
+    if (!ifs.good())
+    {
+        OsConfigLogError(GetPlatformLog(), "Unable to open configuration file: %s", configJson.c_str());
+        return ENOENT;
+    }
+
+    rapidjson::IStreamWrapper isw(ifs);
+    rapidjson::Document document;
+    if (document.ParseStream(isw).HasParseError())
+    {
+        OsConfigLogError(GetPlatformLog(), "Unable to parse configuration file: %s", configJson.c_str());
+        status = EINVAL;
+    }
+    else if (!document.IsObject())
+    {
+        OsConfigLogError(GetPlatformLog(), "Root configuration JSON is not an object: %s", configJson.c_str());
+        status = EINVAL;
+    }
+    else if (!document.HasMember(g_configReported))
+    {
+        OsConfigLogError(GetPlatformLog(), "No valid %s array in configuration: %s", g_configReported, configJson.c_str());
+        status = EINVAL;
+    }
+    else if (!document[g_configReported].IsArray())
+    {
+        OsConfigLogError(GetPlatformLog(), "%s is not an array in configuration: %s", g_configReported, configJson.c_str());
+        status = EINVAL;
+    }
+    else
+    {
+        int index = 0;
+        std::set<std::pair<std::string, std::string>> objects;
+        for (auto& reported : document[g_configReported].GetArray())
+        {
+            if (reported.IsObject())
+            {
+                if (reported.HasMember(g_configComponentName) && reported.HasMember(g_configObjectName))
+                {
+                    std::string componentName = reported[g_configComponentName].GetString();
+                    std::string objectName = reported[g_configObjectName].GetString();
+
+                    if (m_reportedComponents.find(componentName) == m_reportedComponents.end())
+                    {
+                        m_reportedComponents[componentName] = std::vector<std::string>();
+                    }
+
+                    if (objects.find({componentName, objectName}) == objects.end())
+                    {
+                        objects.insert({componentName, objectName});
+                        m_reportedComponents[componentName].push_back(objectName);
+                    }
+                }
+                else
+                {
+                    OsConfigLogError(GetPlatformLog(), "'%s' or '%s' missing at index %d", g_configComponentName, g_configObjectName, index);
+                    status = EINVAL;
+                }
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "%s array element %d is not an object: %s", g_configReported, index, configJson.c_str());
+                status = EINVAL;
+            }
+        }
+    }
+
+    return status;
+}
+
+void ModulesManager::RegisterModuleComponents(const std::string& moduleName, const std::vector<std::string>& components, bool replace)
+{
+    std::lock_guard<std::mutex> lock(m_moduleComponentNameMutex);
+
+    for (auto& component : components)
+    {
+        if (replace || (m_moduleComponentName.find(component) == m_moduleComponentName.end()))
+        {
+            m_moduleComponentName[component] = moduleName;
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Component '%s' is already registered to module '%s'", component.c_str(), m_moduleComponentName[component].c_str());
+        }
+    }
+}
+
+void ModulesManager::FollowModuleReloads(const std::string& moduleName, std::shared_ptr<ManagementModule> module)
+{
+    module->SetReloadCallback([this, moduleName](const ManagementModule::Info& info)
+    {
+        UpdateModuleComponents(moduleName, info.components);
+    });
+}
+
+// Called when a module is loaded again after being unloaded, the components it no longer implements are dropped and the new ones added
+void ModulesManager::UpdateModuleComponents(const std::string& moduleName, const std::vector<std::string>& components)
+{
+    std::lock_guard<std::mutex> lock(m_moduleComponentNameMutex);
+
+    for (auto it = m_moduleComponentName.begin(); it != m_moduleComponentName.end();)
+    {
+        if ((it->second == moduleName) && (std::find(components.begin(), components.end(), it->first) == components.end()))
+        {
+            OsConfigLogInfo(GetPlatformLog(), "Reloaded '%s' module no longer implements component '%s'", moduleName.c_str(), it->first.c_str());
+            it = m_moduleComponentName.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto& component : components)
+    {
+        auto registered = m_moduleComponentName.find(component);
+
+        if (registered == m_moduleComponentName.end())
+        {
+            OsConfigLogInfo(GetPlatformLog(), "Reloaded '%s' module now implements component '%s'", moduleName.c_str(), component.c_str());
+            m_moduleComponentName[component] = moduleName;
+        }
+        else if (registered->second != moduleName)
+        {
+            OsConfigLogError(GetPlatformLog(), "Component '%s' is already registered to module '%s'", component.c_str(), registered->second.c_str());
+        }
+    }
+}
+
+std::string ModulesManager::GetModuleName(const std::string& componentName)
+{
+    std::lock_guard<std::mutex> lock(m_moduleComponentNameMutex);
+    auto moduleName = m_moduleComponentName.find(componentName);
+
+    return (moduleName != m_moduleComponentName.end()) ? moduleName->second : std::string();
+}
+
+void ModulesManager::UnloadModules()
+{
+    m_workers.Drain();
+
+    {
+        std::lock_guard<std::mutex> lock(m_reportedCacheMutex);
+        m_reportedCacheGeneration += 1;
+        m_reportedCache.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_desiredHashesMutex);
+        m_desiredHashes.clear();
+        m_desiredReloads.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_reportedVersionsMutex);
+        m_reportedVersions.clear();
+        m_reportedVersion += 1;
+        m_reportedBaseVersion = m_reportedVersion;
+    }
+
+    for (auto& module : m_modules)
+    {
+        module.second->SetReloadCallback(nullptr);
+        module.second->Unload();
         module.second.reset();
     }
 
-    m_modules.clear();
+    m_modules.clear();
+}
+
+void ModulesManager::SetReportedObjectTimeout(unsigned int milliseconds)
+{
+    m_reportedObjectTimeoutMilliseconds = milliseconds;
+}
+
+bool ModulesManager::GetCachedReported(const std::string& componentName, const std::string& objectName, std::string& payload)
+{
+    std::lock_guard<std::mutex> lock(m_reportedCacheMutex);
+    auto cached = m_reportedCache.find(std::make_pair(componentName, objectName));
+
+    if (cached == m_reportedCache.end())
+    {
+        return false;
+    }
+    else if (cached->second.expiryTime <= std::chrono::steady_clock::now())
+    {
+        m_reportedCache.erase(cached);
+        return false;
+    }
+
+    payload = cached->second.payload;
+    return true;
+}
+
+// The cache seconds come from the module the value was read from (see MmiSession::GetReportedCacheSeconds) and the cache generation is taken
+// before reading the value from the module, a value read before the cache was invalidated is not cached
+void ModulesManager::CacheReported(const std::string& componentName, const std::string& objectName, const std::string& payload, unsigned int cacheSeconds, unsigned long long generation)
+{
+    if (0 < cacheSeconds)
+    {
+        std::lock_guard<std::mutex> lock(m_reportedCacheMutex);
+
+        if (generation == m_reportedCacheGeneration)
+        {
+            ReportedCacheEntry& entry = m_reportedCache[std::make_pair(componentName, objectName)];
+            entry.payload = payload;
+            entry.expiryTime = std::chrono::steady_clock::now() + std::chrono::seconds(cacheSeconds);
+        }
+    }
+}
+
+unsigned long long ModulesManager::GetReportedCacheGeneration()
+{
+    std::lock_guard<std::mutex> lock(m_reportedCacheMutex);
+    return m_reportedCacheGeneration;
+}
+
+void ModulesManager::InvalidateReportedCache(const std::string& componentName)
+{
+    std::lock_guard<std::mutex> lock(m_reportedCacheMutex);
+
+    m_reportedCacheGeneration += 1;
+    m_reportedCache.erase(m_reportedCache.lower_bound(std::make_pair(componentName, std::string())), m_reportedCache.upper_bound(std::make_pair(componentName + '\0', std::string())));
+}
+
+bool ModulesManager::IsDesiredUnchanged(const std::string& componentName, const std::string& objectName, size_t hash)
+{
+    std::lock_guard<std::mutex> lock(m_desiredHashesMutex);
+    auto desired = m_desiredHashes.find(std::make_pair(componentName, objectName));
+    return ((desired != m_desiredHashes.end()) && (desired->second == hash));
+}
+
+void ModulesManager::SetDesiredHash(const std::string& componentName, const std::string& objectName, size_t hash)
+{
+    std::lock_guard<std::mutex> lock(m_desiredHashesMutex);
+    m_desiredHashes[std::make_pair(componentName, objectName)] = hash;
+}
+
+// Without an object name, forgets all objects of the component
+void ModulesManager::ForgetDesired(const std::string& componentName, const std::string& objectName)
+{
+    std::lock_guard<std::mutex> lock(m_desiredHashesMutex);
+
+    if (objectName.empty())
+    {
+        m_desiredHashes.erase(m_desiredHashes.lower_bound(std::make_pair(componentName, std::string())), m_desiredHashes.upper_bound(std::make_pair(componentName + '\0', std::string())));
+    }
+    else
+    {
+        m_desiredHashes.erase(std::make_pair(componentName, objectName));
+    }
+}
+
+// The desired values of a component are forgotten when its module was loaded again since they were set, as when a module host restarted
+void ModulesManager::ForgetDesiredIfReloaded(const std::string& componentName, unsigned int reloads)
+{
+    bool reloaded = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_desiredHashesMutex);
+        auto desiredReloads = m_desiredReloads.find(componentName);
+
+        reloaded = (desiredReloads != m_desiredReloads.end()) && (desiredReloads->second != reloads);
+        m_desiredReloads[componentName] = reloads;
+    }
+
+    if (reloaded)
+    {
+        ForgetDesired(componentName);
+    }
+}
+
+void ModulesManager::SetPrettyPrintReported(bool prettyPrint)
+{
+    m_prettyPrintReported = prettyPrint;
+}
+
+void ModulesManager::SetParallelDesired(bool parallel, const std::vector<std::vector<std::string>>& sequentialComponents)
+{
+    m_parallelDesired = parallel;
+    m_sequentialDesiredGroups.clear();
+
+    for (size_t i = 0; i < sequentialComponents.size(); i++)
+    {
+        for (const std::string& componentName : sequentialComponents[i])
+        {
+            m_sequentialDesiredGroups[componentName] = i;
+        }
+    }
+}
+
+void ModulesManager::SetModuleCallTimeout(unsigned int milliseconds, const std::map<std::string, unsigned int>& moduleMilliseconds)
+{
+    m_moduleCallTimeoutMilliseconds = milliseconds;
+    m_moduleCallTimeouts = moduleMilliseconds;
+}
+
+void ModulesManager::SetModuleHost(const std::string& hostPath)
+{
+    m_moduleHostPath = hostPath;
+}
+
+std::shared_ptr<ManagementModule> ModulesManager::CreateModule(const std::string& path)
+{
+    if (m_moduleHostPath.empty())
+    {
+        return std::make_shared<ManagementModule>(path);
+    }
+
+    return std::make_shared<HostedManagementModule>(path, m_moduleHostPath);
+}
+
+void ModulesManager::UnloadIdleModules(unsigned int idleSeconds)
+{
+    for (auto& module : m_modules)
+    {
+        if (module.second->UnloadIfIdle(idleSeconds))
+        {
+            for (auto& componentName : module.second->GetInfo().components)
+            {
+                ForgetDesired(componentName);
+            }
+        }
+    }
+}
+
+static char* GenerateUuid()
+{
+    char* uuid = NULL;
+    static const char uuidTemplate[] = "xxxxxxxx-xxxx-Mxxx-Nxxx-xxxxxxxxxxxx";
+    const char* hex = "0123456789ABCDEF-";
+
+    // Seeded once per process, reseeding on every call generates duplicate UUIDs for sessions opened in the same clock tick
+    static std::mt19937 generator(std::random_device{}());
+    static std::mutex generatorMutex;
+
+    uuid = (char*)malloc(UUID_LENGTH + 1);
+    if (uuid == NULL)
+    {
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> lock(generatorMutex);
+
+    for (int i = 0; i < UUID_LENGTH + 1; i++)
+    {
+        int random = generator() % 16;
+        char c = ' ';
+
+        switch (uuidTemplate[i])
+        {
+            case 'x':
+                c = hex[random];
+                break;
+            case '-':
+                c = '-';
+                break;
+            case 'M':
+                c = hex[(random & 0x03) | 0x08];
+                break;
+            case 'N':
+                c = '4';
+                break;
+        }
+        uuid[i] = (i < UUID_LENGTH) ? c : 0x00;
+    }
+
+    return uuid;
+}
+
+MpiSession::MpiSession(ModulesManager& modulesManager, std::string clientName, unsigned int maxPayloadSizeBytes) :
+    m_modulesManager(modulesManager),
+    m_uuid(GenerateUuid()),
+    m_clientName(clientName),
+    m_maxPayloadSizeBytes(maxPayloadSizeBytes),
+    m_bypassReportedCache(false) {}
+
+MpiSession::~MpiSession()
+{
+    Close();
+}
+
+void MpiSession::SetReportedCacheBypass(bool bypass)
+{
+    m_bypassReportedCache = bypass;
+}
+
+char* MpiSession::GetUuid()
+{
+    char* uuid = new (std::nothrow) char[m_uuid.size() + 1];
+
+    if (uuid != NULL)
+    {
+        std::copy(m_uuid.begin(), m_uuid.end(), uuid);
+        uuid[m_uuid.size()] = '\0';
+    }
+
+    return uuid;
+}
+
+// MMI sessions are opened on the first use of a component (see GetSession), so a client does not pay for opening modules it never calls
+int MpiSession::Open()
+{
+    return 0;
+}
+
+void MpiSession::Close()
+{
+    std::lock_guard<std::mutex> lock(m_mmiSessionsMutex);
+
+    for (auto& mmiSession : m_mmiSessions)
+    {
+        mmiSession.second->Close();
+        mmiSession.second.reset();
+    }
+
+    m_mmiSessions.clear();
+}
+
+std::shared_ptr<MmiSession> MpiSession::GetSession(const std::string& componentName)
+{
+    std::shared_ptr<MmiSession> mmiSession;
+    std::string moduleName = m_modulesManager.GetModuleName(componentName);
+
+    if (!moduleName.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_mmiSessionsMutex);
+
+        if (m_mmiSessions.find(moduleName) != m_mmiSessions.end())
+        {
+            mmiSession = m_mmiSessions[moduleName];
+        }
+        else if (m_modulesManager.m_modules.find(moduleName) != m_modulesManager.m_modules.end())
+        {
+            mmiSession = std::make_shared<MmiSession>(m_modulesManager.m_modules[moduleName], m_clientName, m_maxPayloadSizeBytes);
+
+            if (0 == mmiSession->Open())
+            {
+                m_mmiSessions[moduleName] = mmiSession;
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "Unable to open MMI session for module '%s'", moduleName.c_str());
+                mmiSession.reset();
+            }
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Unable to find MMI session for component '%s'", componentName.c_str());
+        }
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Unable to find module for component '%s'", componentName.c_str());
+    }
+
+    return mmiSession;
+}
+
+int MpiSession::Set(const char* componentName, const char* objectName, const MPI_JSON_STRING payload, const int payloadSizeBytes)
+{
+    int status = MPI_OK;
+
+    ScopeGuard sg{[&]()
+    {
+        if (MPI_OK == status)
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiSet(%s, %s, %.*s, %d) returned %d", componentName, objectName, payloadSizeBytes, payload, payloadSizeBytes, status);
+            }
+            else
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiSet(%s, %s, -, %d) returned %d", componentName, objectName, payloadSizeBytes, status);
+            }
+        }
+        else
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiSet(%s, %s, %.*s, %d) returned %d", componentName, objectName, payloadSizeBytes, payload, payloadSizeBytes, status);
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiSet(%s, %s, -, %d) returned %d", componentName, objectName, payloadSizeBytes, status);
+            }
+        }
+    }};
+
+    if (nullptr == componentName)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid componentName: %s", componentName);
+        status = EINVAL;
+    }
+    else if (nullptr == objectName)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid objectName: %s", objectName);
+        status = EINVAL;
+    }
+    else if (nullptr == payload)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payload");
+        status = EINVAL;
+    }
+    else if (0 >= payloadSizeBytes)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payloadSizeBytes: %d", payloadSizeBytes);
+        status = EINVAL;
+    }
+    else
+    {
+        std::shared_ptr<MmiSession> moduleSession;
+        if (nullptr != (moduleSession = GetSession(componentName)))
+        {
+            status = moduleSession->Set(componentName, objectName, (MMI_JSON_STRING)payload, payloadSizeBytes);
+            m_modulesManager.InvalidateReportedCache(componentName);
+            m_modulesManager.ForgetDesired(componentName, objectName);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiSet componentName %s not found", componentName);
+            status = EINVAL;
+        }
+    }
+
+    return status;
+}
+
+int MpiSession::Get(const char* componentName, const char* objectName, MPI_JSON_STRING* payload, int* payloadSizeBytes)
+{
+    int status = MPI_OK;
+
+    ScopeGuard sg{[&]()
+    {
+        if ((MMI_OK == status) && (nullptr != *payload) && (nullptr != payloadSizeBytes) && (0 != *payloadSizeBytes))
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiGet(%s, %s, %.*s, %d) returned %d", componentName, objectName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+            }
+        }
+        else
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiGet(%s, %s, %.*s, %d) returned %d", componentName, objectName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
+            }
+        }
+    }};
+
+    if (nullptr == componentName)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid componentName: %s", componentName);
+        status = EINVAL;
+    }
+    else if (nullptr == objectName)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid objectName: %s", objectName);
+        status = EINVAL;
+    }
+    else if (nullptr == payload)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payload");
+        status = EINVAL;
+    }
+    else if (nullptr == payloadSizeBytes)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payloadSizeBytes");
+        status = EINVAL;
+    }
+    else
+    {
+        std::shared_ptr<MmiSession> moduleSession;
+        std::string cachedPayload;
+
+        if (!m_bypassReportedCache && m_modulesManager.GetCachedReported(componentName, objectName, cachedPayload))
+        {
+            if (nullptr != (*payload = new (std::nothrow) char[cachedPayload.length()]))
+            {
+                std::memcpy(*payload, cachedPayload.data(), cachedPayload.length());
+                *payloadSizeBytes = static_cast<int>(cachedPayload.length());
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiGet unable to allocate %d bytes", static_cast<int>(cachedPayload.length()));
+                status = ENOMEM;
+            }
+        }
+        else if (nullptr != (moduleSession = GetSession(componentName)))
+        {
+            unsigned long long cacheGeneration = m_modulesManager.GetReportedCacheGeneration();
+
+            if ((MMI_OK == (status = moduleSession->Get(componentName, objectName, payload, payloadSizeBytes))) && (nullptr != *payload) && (0 < *payloadSizeBytes))
+            {
+                m_modulesManager.CacheReported(componentName, objectName, std::string(*payload, *payloadSizeBytes), moduleSession->GetReportedCacheSeconds(componentName, objectName), cacheGeneration);
+            }
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiSet componentName %s not found", componentName);
+            status = EINVAL;
+        }
+    }
+
+    return status;
+}
+
+int MpiSession::SetDesired(const MPI_JSON_STRING payload, int payloadSizeBytes, bool reapply)
+{
+    int status = MPI_OK;
+
+    ScopeGuard sg{[&]()
+    {
+        if (IsFullLoggingEnabled())
+        {
+            if (MPI_OK == status)
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiSetDesired(%.*s, %d) returned %d", payloadSizeBytes, payload, payloadSizeBytes, status);
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiSetDesired(%.*s, %d) returned %d", payloadSizeBytes, payload, payloadSizeBytes, status);
+            }
+        }
+    }};
+
+    if (nullptr == payload)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payload: %s", payload);
+        status = EINVAL;
+    }
+    else if (0 >= payloadSizeBytes)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payloadSizeBytes: %d", payloadSizeBytes);
+        status = EINVAL;
+    }
+    else
+    {
+        // Validate the whole payload first (without building a document) so that nothing gets set from an invalid one
+        JSON_SPAN name = {};
+        JSON_SPAN value = {};
+        size_t offset = 0;
+        int scanStatus = 0;
+
+        while (0 == (scanStatus = GetNextJsonObjectMember(payload, payloadSizeBytes, &offset, &name, &value)))
+        {
+        }
+
+        if (ENOENT != scanStatus)
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payload: %.*s", payloadSizeBytes, payload);
+            }
+
+            status = EINVAL;
+        }
+        else
+        {
+            status = SetDesiredPayload(payload, payloadSizeBytes, reapply);
+        }
+    }
+
+    return status;
+}
+
+// FNV-1a of the value without the whitespace outside of strings, so that the same value formatted differently has the same hash
+static size_t HashDesiredValue(const char* value, size_t length)
+{
+    size_t hash = static_cast<size_t>(14695981039346656037ULL);
+    bool inString = false;
+    bool escaped = false;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = value[i];
+
+        if (inString)
+        {
+            if (escaped)
+            {
+                escaped = false;
+            }
+            else if ('\\' == c)
+            {
+                escaped = true;
+            }
+            else if ('"' == c)
+            {
+                inString = false;
+            }
+        }
+        else if (isspace(static_cast<unsigned char>(c)))
+        {
+            continue;
+        }
+        else if ('"' == c)
+        {
+            inString = true;
+        }
+
+        hash = (hash ^ static_cast<unsigned char>(c)) * static_cast<size_t>(1099511628211ULL);
+    }
+
+    return hash;
+}
+
+// Each object value is handed to its module as it appears in the (already validated) payload, without parsing and serializing it again.
+// All objects are set even when one fails, the status is that of the first MmiSet that failed
+int MpiSession::SetDesiredComponent(const std::string& componentName, const char* componentValue, const size_t componentValueSizeBytes, bool reapply)
+{
+    std::shared_ptr<MmiSession> module;
+    JSON_SPAN object = {};
+    JSON_SPAN objectValue = {};
+    size_t objectOffset = 0;
+    bool componentChanged = false;
+    int status = MPI_OK;
+
+    if ('{' != componentValue[0])
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "Component value is not an object");
+        }
+
+        return EINVAL;
+    }
+    else if (nullptr == (module = GetSession(componentName)))
+    {
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "Unable to find module for component %s", componentName.c_str());
+        }
+
+        return EINVAL;
+    }
+
+    m_modulesManager.ForgetDesiredIfReloaded(componentName, module->GetReloads());
+
+    while (0 == GetNextJsonObjectMember(componentValue, componentValueSizeBytes, &objectOffset, &object, &objectValue))
+    {
+        int moduleStatus = MMI_OK;
+        std::string objectName(object.data, object.length);
+        size_t hash = HashDesiredValue(objectValue.data, objectValue.length);
+
+        if (!reapply && m_modulesManager.IsDesiredUnchanged(componentName, objectName, hash))
+        {
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiSetDesired: %s.%s unchanged, not set again", componentName.c_str(), objectName.c_str());
+            }
+
+            continue;
+        }
+
+        componentChanged = true;
+        moduleStatus = module->Set(componentName.c_str(), objectName.c_str(), (MMI_JSON_STRING)objectValue.data, static_cast<int>(objectValue.length));
+
+        if (MMI_OK == moduleStatus)
+        {
+            m_modulesManager.SetDesiredHash(componentName, objectName, hash);
+        }
+        else
+        {
+            // Set again next time even when unchanged
+            m_modulesManager.ForgetDesired(componentName, objectName);
+
+            if (MPI_OK == status)
+            {
+                status = moduleStatus;
+            }
+
+            if (IsFullLoggingEnabled())
+            {
+                OsConfigLogError(GetPlatformLog(), "MmiSet(%s, %s, %.*s, %d) to %s returned %d", componentName.c_str(), objectName.c_str(), static_cast<int>(objectValue.length), objectValue.data, static_cast<int>(objectValue.length), module->GetInfo().name.c_str(), moduleStatus);
+            }
+        }
+    }
+
+    if (componentChanged)
+    {
+        m_modulesManager.InvalidateReportedCache(componentName);
+    }
+
+    return status;
+}
+
+// The status is that of the first component that failed
+int MpiSession::SetDesiredPayload(const char* payload, const size_t payloadSizeBytes, bool reapply)
+{
+    int status = MPI_OK;
+    int componentStatus = MPI_OK;
+    JSON_SPAN component = {};
+    JSON_SPAN componentValue = {};
+    size_t componentOffset = 0;
+
+    if (m_modulesManager.m_parallelDesired)
+    {
+        return SetDesiredPayloadInParallel(payload, payloadSizeBytes, reapply);
+    }
+
+    while (0 == GetNextJsonObjectMember(payload, payloadSizeBytes, &componentOffset, &component, &componentValue))
+    {
+        componentStatus = SetDesiredComponent(std::string(component.data, component.length), componentValue.data, componentValue.length, reapply);
+
+        if ((MPI_OK != componentStatus) && (MPI_OK == status))
+        {
+            status = componentStatus;
+        }
+    }
+
+    return status;
+}
+
+// Components of different modules are applied at the same time on the worker pool, the components of each module (and of each sequential group)
+// one after the other in the order of the payload. The status is the same as when all components are applied in order
+int MpiSession::SetDesiredPayloadInParallel(const char* payload, const size_t payloadSizeBytes, bool reapply)
+{
+    struct DesiredComponent
+    {
+        std::string name;
+        JSON_SPAN value;
+        int status;
+    };
+
+    std::vector<DesiredComponent> components;
+    std::vector<std::vector<size_t>> tasks;
+    std::vector<std::string> taskKeys;
+    std::map<std::string, size_t> taskIndices;
+    std::mutex doneMutex;
+    std::condition_variable done;
+    size_t remaining = 0;
+    JSON_SPAN component = {};
+    JSON_SPAN componentValue = {};
+    size_t componentOffset = 0;
+    int status = MPI_OK;
+
+    while (0 == GetNextJsonObjectMember(payload, payloadSizeBytes, &componentOffset, &component, &componentValue))
+    {
+        std::string componentName(component.data, component.length);
+        std::string taskKey = componentName;
+        auto group = m_modulesManager.m_sequentialDesiredGroups.find(componentName);
+        std::string moduleName = m_modulesManager.GetModuleName(componentName);
+
+        if (group != m_modulesManager.m_sequentialDesiredGroups.end())
+        {
+            taskKey = "group " + std::to_string(group->second);
+        }
+        else if (!moduleName.empty())
+        {
+            // The same key as the reads of the module, a module is called by one worker at a time
+            taskKey = moduleName;
+        }
+
+        auto task = taskIndices.find(taskKey);
+        if (task == taskIndices.end())
+        {
+            task = taskIndices.insert(std::make_pair(taskKey, tasks.size())).first;
+            tasks.push_back(std::vector<size_t>());
+            taskKeys.push_back(taskKey);
+        }
+
+        tasks[task->second].push_back(components.size());
+        components.push_back(DesiredComponent{componentName, componentValue, MPI_OK});
+    }
+
+    remaining = tasks.size();
+
+    // The tasks only use what lives on this stack for as long as this waits for them
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        m_modulesManager.m_workers.Post(taskKeys[i], [&, i]()
+        {
+            for (size_t j : tasks[i])
+            {
+                auto startTime = std::chrono::steady_clock::now();
+                components[j].status = SetDesiredComponent(components[j].name, components[j].value.data, components[j].value.length, reapply);
+
+                if (IsFullLoggingEnabled())
+                {
+                    OsConfigLogInfo(GetPlatformLog(), "MpiSetDesired: %s applied in %lld ms with %d", components[j].name.c_str(),
+                        static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count()), components[j].status);
+                }
+            }
+
+            // Notified with the mutex held, the waiter can return and take the condition variable with it as soon as the mutex is released
+            std::lock_guard<std::mutex> lock(doneMutex);
+            remaining--;
+            done.notify_all();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&]() { return 0 == remaining; });
+    }
+
+    for (const DesiredComponent& desired : components)
+    {
+        if (MPI_OK != desired.status)
+        {
+            status = desired.status;
+            break;
+        }
+    }
+
+    return status;
 }
 
-static char* GenerateUuid()
+int MpiSession::GetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes)
 {
-    char* uuid = NULL;
-    static const char uuidTemplate[] = "xxxxxxxx-xxxx-Mxxx-Nxxx-xxxxxxxxxxxx";
-    const char* hex = "0123456789ABCDEF-";
+    int status = MPI_OK;
 
-    uuid = (char*)malloc(UUID_LENGTH + 1);
-    if (uuid == NULL)
+    ScopeGuard sg{[&]()
     {
-        return NULL;
+        if (IsFullLoggingEnabled())
+        {
+            if (MPI_OK == status)
+            {
+                OsConfigLogInfo(GetPlatformLog(), "MpiGetReported(%p, %p) returned %d", payload, payloadSizeBytes, status);
+            }
+            else
+            {
+                OsConfigLogError(GetPlatformLog(), "MpiGetReported(%p, %p) returned %d", payload, payloadSizeBytes, status);
+            }
+        }
+    }};
+
+    if (nullptr == payload)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiGetReported invalid payload: %p", payload);
+        status = EINVAL;
+    }
+    else if (nullptr == payloadSizeBytes)
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiGetReported invalid payloadSizeBytes: %p", payloadSizeBytes);
+        status = EINVAL;
+    }
+    else
+    {
+        *payload = nullptr;
+        *payloadSizeBytes = 0;
+        status = GetReportedPayload(payload, payloadSizeBytes);
     }
 
-    srand(clock());
+    return status;
+}
 
-    for (int i = 0; i < UUID_LENGTH + 1; i++)
+// Shared between MpiSession::ReadReported and the reads it posts to the worker pool, these reads can outlive the call when a module misses the deadline
+struct ReportedObjectsRead
+{
+    enum State
     {
-        int random = rand() % 16;
-        char c = ' ';
+        Pending,
+        Reading,
+        Done,
+        Abandoned
+    };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<ReportedObject> objects;
+    std::vector<State> states;
+    std::vector<std::chrono::steady_clock::time_point> startTimes;
+};
+
+// Reads the given objects (all of the same module) in order, stops at the first object abandoned by the caller. The deadline of an object
+// starts when its call into the module is made, not while it waits for the calls of other sessions into the module
+static void ReadReportedObjects(std::shared_ptr<ReportedObjectsRead> read, std::vector<size_t> indices)
+{
+    for (size_t i : indices)
+    {
+        ReportedObject& reported = read->objects[i];
+        MMI_JSON_STRING objectPayload = nullptr;
+        int objectPayloadSizeBytes = 0;
+        int moduleStatus = MMI_OK;
 
-        switch (uuidTemplate[i])
         {
-            case 'x':
-                c = hex[random];
-                break;
-            case '-':
-                c = '-';
-                break;
-            case 'M':
-                c = hex[(random & 0x03) | 0x08];
-                break;
-            case 'N':
-                c = '4';
+            std::lock_guard<std::mutex> lock(read->mutex);
+
+            if (ReportedObjectsRead::Abandoned == read->states[i])
+            {
                 break;
+            }
         }
-        uuid[i] = (i < UUID_LENGTH) ? c : 0x00;
-    }
 
-    return uuid;
-}
+        moduleStatus = reported.module->Get(reported.componentName.c_str(), reported.objectName.c_str(), &objectPayload, &objectPayloadSizeBytes, [&]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(read->mutex);
 
-MpiSession::MpiSession(ModulesManager& modulesManager, std::string clientName, unsigned int maxPayloadSizeBytes) :
-    m_modulesManager(modulesManager),
-    m_uuid(GenerateUuid()),
-    m_clientName(clientName),
-    m_maxPayloadSizeBytes(maxPayloadSizeBytes) {}
+                if (ReportedObjectsRead::Pending == read->states[i])
+                {
+                    read->states[i] = ReportedObjectsRead::Reading;
+                    read->startTimes[i] = std::chrono::steady_clock::now();
+                }
+            }
 
-MpiSession::~MpiSession()
-{
-    Close();
+            read->changed.notify_all();
+        });
+
+        {
+            std::lock_guard<std::mutex> lock(read->mutex);
+
+            if (ReportedObjectsRead::Reading == read->states[i])
+            {
+                reported.status = moduleStatus;
+
+                if ((MMI_OK == moduleStatus) && (nullptr != objectPayload) && (0 < objectPayloadSizeBytes))
+                {
+                    reported.payload.assign(objectPayload, objectPayloadSizeBytes);
+                }
+
+                read->states[i] = ReportedObjectsRead::Done;
+            }
+        }
+
+        // Copied above when the object was still waited for, the payload of the module is not needed anymore either way
+        reported.module->Free(objectPayload);
+
+        read->changed.notify_all();
+    }
 }
 
-char* MpiSession::GetUuid()
+// Reads the reported objects with the modules read in parallel on the worker pool, the objects of a module one at a time, and hands them to
+// consume in the order of the reported configuration as soon as they are read. An object not read within the reported object timeout is
+// handed over with ETIMEDOUT, together with the objects of the same module after it, which would have to wait for it. So is an object of
+// a module that is still in a call (of any session) that has run for longer than the timeout, that module is not called again until it returns
+int MpiSession::ReadReported(const std::function<int(const ReportedObject&)>& consume)
 {
-    char* uuid = new (std::nothrow) char[m_uuid.size() + 1];
+    std::shared_ptr<ReportedObjectsRead> read = std::make_shared<ReportedObjectsRead>();
+    std::map<std::string, std::vector<size_t>> moduleObjects;
+    std::vector<bool> cached;
+    std::chrono::milliseconds timeout(m_modulesManager.m_reportedObjectTimeoutMilliseconds);
+    unsigned long long cacheGeneration = m_modulesManager.GetReportedCacheGeneration();
+    int status = MPI_OK;
 
-    if (uuid != NULL)
+    for (auto& reported : m_modulesManager.m_reportedComponents)
     {
-        std::copy(m_uuid.begin(), m_uuid.end(), uuid);
-        uuid[m_uuid.size()] = '\0';
-    }
+        std::shared_ptr<MmiSession> module = GetSession(reported.first);
+        std::string moduleName = m_modulesManager.GetModuleName(reported.first);
 
-    return uuid;
-}
+        if ((nullptr == module) || moduleName.empty())
+        {
+            continue;
+        }
 
-int MpiSession::Open()
-{
-    int status = 0;
+        for (auto& objectName : reported.second)
+        {
+            ReportedObject object;
+            object.componentName = reported.first;
+            object.objectName = objectName;
+            object.module = module;
 
-    for (auto& module : m_modulesManager.m_modules)
+            if (!m_bypassReportedCache && m_modulesManager.GetCachedReported(object.componentName, object.objectName, object.payload))
+            {
+                read->states.push_back(ReportedObjectsRead::Done);
+                cached.push_back(true);
+            }
+            else
+            {
+                moduleObjects[moduleName].push_back(read->objects.size());
+                read->states.push_back(ReportedObjectsRead::Pending);
+                cached.push_back(false);
+            }
+
+            read->objects.push_back(object);
+        }
+    }
+
+    read->startTimes.resize(read->objects.size());
+
+    // Called with the read mutex held
+    auto abandon = [&](size_t i)
     {
-        int mmiStatus = 0;
-        std::shared_ptr<MmiSession> mmiSession = std::make_shared<MmiSession>(module.second, m_clientName, m_maxPayloadSizeBytes);
+        for (size_t j = i; j < read->objects.size(); j++)
+        {
+            if ((read->objects[j].module == read->objects[i].module) && (ReportedObjectsRead::Done != read->states[j]) && (ReportedObjectsRead::Abandoned != read->states[j]))
+            {
+                read->states[j] = ReportedObjectsRead::Abandoned;
+                read->objects[j].status = ETIMEDOUT;
+                OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) did not complete within %u ms, omitted from the reported configuration",
+                    read->objects[j].componentName.c_str(), read->objects[j].objectName.c_str(), m_modulesManager.m_reportedObjectTimeoutMilliseconds);
+            }
+        }
+    };
 
-        if (0 == (mmiStatus = mmiSession->Open()))
+    for (auto& module : moduleObjects)
+    {
+        if ((0 < timeout.count()) && (read->objects[module.second.front()].module->GetCallDuration() >= timeout))
         {
-            m_mmiSessions[module.first] = mmiSession;
+            std::lock_guard<std::mutex> lock(read->mutex);
+            abandon(module.second.front());
         }
         else
         {
-            OsConfigLogError(GetPlatformLog(), "Unable to open MMI session for module '%s'", module.first.c_str());
-            status = EINVAL;
+            m_modulesManager.m_workers.Post(module.first, std::bind(ReadReportedObjects, read, module.second));
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(read->mutex);
+
+    for (size_t i = 0; (i < read->objects.size()) && (MPI_OK == status); i++)
+    {
+        while ((ReportedObjectsRead::Done != read->states[i]) && (ReportedObjectsRead::Abandoned != read->states[i]))
+        {
+            if (0 == timeout.count())
+            {
+                read->changed.wait(lock);
+            }
+            else if (ReportedObjectsRead::Reading == read->states[i])
+            {
+                if (std::cv_status::timeout == read->changed.wait_until(lock, read->startTimes[i] + timeout))
+                {
+                    abandon(i);
+                }
+            }
+            else
+            {
+                // Waiting for the module to finish the call that it is in, for this or for another session
+                std::chrono::milliseconds callDuration = read->objects[i].module->GetCallDuration();
+
+                if (callDuration >= timeout)
+                {
+                    abandon(i);
+                }
+                else
+                {
+                    read->changed.wait_for(lock, timeout - callDuration);
+                }
+            }
+        }
+
+        // The reading thread is done with an object that is done, while it can still be reading an abandoned one
+        ReportedObject object = (ReportedObjectsRead::Done == read->states[i]) ? std::move(read->objects[i]) : read->objects[i];
+
+        if (!cached[i] && (MMI_OK == object.status) && !object.payload.empty())
+        {
+            m_modulesManager.CacheReported(object.componentName, object.objectName, object.payload, object.module->GetReportedCacheSeconds(object.componentName, object.objectName), cacheGeneration);
+        }
+
+        lock.unlock();
+        status = consume(object);
+        lock.lock();
+    }
+
+    // Objects not read yet are not needed anymore, when consume failed
+    for (size_t i = 0; i < read->objects.size(); i++)
+    {
+        if (ReportedObjectsRead::Pending == read->states[i])
+        {
+            read->states[i] = ReportedObjectsRead::Abandoned;
         }
     }
 
     return status;
 }
 
-void MpiSession::Close()
+// A payload spliced in as it is must not break the document around it
+static bool IsSingleJsonValue(const std::string& json)
 {
-    for (auto& mmiSession : m_mmiSessions)
+    size_t offset = 0;
+
+    if (0 != SkipJsonValue(json.c_str(), json.length(), &offset))
     {
-        mmiSession.second->Close();
-        mmiSession.second.reset();
+        return false;
     }
 
-    m_mmiSessions.clear();
+    while ((offset < json.length()) && isspace(static_cast<unsigned char>(json[offset])))
+    {
+        offset += 1;
+    }
+
+    return (offset == json.length());
 }
 
-std::shared_ptr<MmiSession> MpiSession::GetSession(const std::string& componentName)
+// Objects that the module did not return in time are left out of the reported configuration and listed next to it instead, as
+// "TimedOut": [{"ComponentName": "...", "ObjectName": "..."}], so that a caller can tell them from objects that have no value
+static bool IsTimedOut(const ReportedObject& reported)
 {
-    std::shared_ptr<MmiSession> mmiSession;
+    return (ETIMEDOUT == reported.status) || (ETIME == reported.status);
+}
 
-    if (m_modulesManager.m_moduleComponentName.find(componentName) != m_modulesManager.m_moduleComponentName.end())
-    {
-        std::string moduleName = m_modulesManager.m_moduleComponentName[componentName];
-        if (m_mmiSessions.find(moduleName) != m_mmiSessions.end())
-        {
-            mmiSession = m_mmiSessions[moduleName];
-        }
-        else
-        {
-            OsConfigLogError(GetPlatformLog(), "Unable to find MMI session for component '%s'", componentName.c_str());
-        }
-    }
-    else
+static void WriteObjectNames(rapidjson::Writer<rapidjson::StringBuffer>& writer, const std::vector<std::pair<std::string, std::string>>& objectNames)
+{
+    writer.StartArray();
+
+    for (auto& object : objectNames)
     {
-        OsConfigLogError(GetPlatformLog(), "Unable to find module for component '%s'", componentName.c_str());
+        writer.StartObject();
+        writer.Key(g_configComponentName);
+        writer.String(object.first.c_str(), static_cast<rapidjson::SizeType>(object.first.length()));
+        writer.Key(g_configObjectName);
+        writer.String(object.second.c_str(), static_cast<rapidjson::SizeType>(object.second.length()));
+        writer.EndObject();
     }
 
-    return mmiSession;
+    writer.EndArray();
 }
 
-int MpiSession::Set(const char* componentName, const char* objectName, const MPI_JSON_STRING payload, const int payloadSizeBytes)
+static int AppendReportedToString(const char* data, int dataSizeBytes, void* context)
+{
+    static_cast<std::string*>(context)->append(data, dataSizeBytes);
+    return MPI_OK;
+}
+
+int MpiSession::GetReportedPayload(MPI_JSON_STRING* payload, int* payloadSizeBytes)
 {
     int status = MPI_OK;
 
-    ScopeGuard sg{[&]()
+    if (!m_modulesManager.m_prettyPrintReported)
     {
-        if (MPI_OK == status)
+        std::string reported;
+
+        if (MPI_OK == (status = WriteReported(AppendReportedToString, &reported)))
         {
-            if (IsFullLoggingEnabled())
+            if (nullptr == (*payload = new (std::nothrow) char[reported.length()]))
             {
-                OsConfigLogInfo(GetPlatformLog(), "MpiSet(%s, %s, %.*s, %d) returned %d", componentName, objectName, payloadSizeBytes, payload, payloadSizeBytes, status);
+                OsConfigLogError(GetPlatformLog(), "MpiGetReported unable to allocate %d bytes", static_cast<int>(reported.length()));
+                status = ENOMEM;
             }
             else
             {
-                OsConfigLogInfo(GetPlatformLog(), "MpiSet(%s, %s, -, %d) returned %d", componentName, objectName, payloadSizeBytes, status);
+                std::memcpy(*payload, reported.data(), reported.length());
+                *payloadSizeBytes = static_cast<int>(reported.length());
             }
         }
-        else
+
+        return status;
+    }
+
+    // Pretty printing needs the whole document parsed, so it is only done on request
+    rapidjson::Document document;
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+    rapidjson::Value timedOut(rapidjson::kArrayType);
+    document.SetObject();
+
+    ReadReported([&](const ReportedObject& reported) -> int
+    {
+        if (!document.HasMember(reported.componentName.c_str()))
         {
-            if (IsFullLoggingEnabled())
+            document.AddMember(rapidjson::Value(reported.componentName.c_str(), allocator), rapidjson::Value(rapidjson::kObjectType), allocator);
+        }
+
+        if ((MMI_OK == reported.status) && !reported.payload.empty())
+        {
+            rapidjson::Document objectDocument;
+            objectDocument.Parse(reported.payload.c_str());
+
+            if (!objectDocument.HasParseError())
             {
-                OsConfigLogError(GetPlatformLog(), "MpiSet(%s, %s, %.*s, %d) returned %d", componentName, objectName, payloadSizeBytes, payload, payloadSizeBytes, status);
+                rapidjson::Value object(rapidjson::kObjectType);
+                object.CopyFrom(objectDocument, allocator);
+                document[reported.componentName.c_str()].AddMember(rapidjson::Value(reported.objectName.c_str(), allocator), object, allocator);
             }
-            else
+            else if (IsFullLoggingEnabled())
             {
-                OsConfigLogError(GetPlatformLog(), "MpiSet(%s, %s, -, %d) returned %d", componentName, objectName, payloadSizeBytes, status);
+                OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned invalid payload: %s", reported.componentName.c_str(), reported.objectName.c_str(), reported.payload.c_str());
             }
         }
-    }};
+        else if (IsTimedOut(reported))
+        {
+            rapidjson::Value object(rapidjson::kObjectType);
+            object.AddMember(rapidjson::Value(g_configComponentName, allocator), rapidjson::Value(reported.componentName.c_str(), allocator), allocator);
+            object.AddMember(rapidjson::Value(g_configObjectName, allocator), rapidjson::Value(reported.objectName.c_str(), allocator), allocator);
+            timedOut.PushBack(object, allocator);
+        }
+        else if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned %d", reported.componentName.c_str(), reported.objectName.c_str(), reported.status);
+        }
 
-    if (nullptr == componentName)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid componentName: %s", componentName);
-        status = EINVAL;
-    }
-    else if (nullptr == objectName)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid objectName: %s", objectName);
-        status = EINVAL;
-    }
-    else if (nullptr == payload)
+        return MPI_OK;
+    });
+
+    if (!timedOut.Empty())
     {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payload");
-        status = EINVAL;
+        document.AddMember(rapidjson::Value(g_reportedTimedOut, allocator), timedOut, allocator);
     }
-    else if (0 >= payloadSizeBytes)
+
+    try
     {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payloadSizeBytes: %d", payloadSizeBytes);
-        status = EINVAL;
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.SetIndent(' ', 2);
+        document.Accept(writer);
+
+        *payloadSizeBytes = buffer.GetSize();
+        *payload = new (std::nothrow) char[*payloadSizeBytes];
+        if (nullptr == *payload)
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiGetReported unable to allocate %d bytes", *payloadSizeBytes);
+            status = ENOMEM;
+        }
+        else
+        {
+            std::fill(*payload, *payload + buffer.GetSize(), 0);
+            std::memcpy(*payload, buffer.GetString(), buffer.GetSize());
+            *payloadSizeBytes = buffer.GetSize();
+        }
     }
-    else
+    catch (const std::exception& e)
     {
-        std::shared_ptr<MmiSession> moduleSession;
-        if (nullptr != (moduleSession = GetSession(componentName)))
+        OsConfigLogError(GetPlatformLog(), "Could not allocate payload: %s", e.what());
+        status = EINTR;
+
+        if (nullptr != *payload)
         {
-            status = moduleSession->Set(componentName, objectName, (MMI_JSON_STRING)payload, payloadSizeBytes);
+            delete[] * payload;
+            *payload = nullptr;
         }
-        else
+
+        if (nullptr != payloadSizeBytes)
         {
-            OsConfigLogError(GetPlatformLog(), "MpiSet componentName %s not found", componentName);
-            status = EINVAL;
+            *payloadSizeBytes = 0;
         }
     }
 
     return status;
 }
 
-int MpiSession::Get(const char* componentName, const char* objectName, MPI_JSON_STRING* payload, int* payloadSizeBytes)
+int MpiSession::GetReportedStream(MPI_WRITE_CALLBACK writeCallback, void* context)
 {
     int status = MPI_OK;
 
-    ScopeGuard sg{[&]()
+    if (nullptr == writeCallback)
     {
-        if ((MMI_OK == status) && (nullptr != *payload) && (nullptr != payloadSizeBytes) && (0 != *payloadSizeBytes))
-        {
-            if (IsFullLoggingEnabled())
-            {
-                OsConfigLogInfo(GetPlatformLog(), "MpiGet(%s, %s, %.*s, %d) returned %d", componentName, objectName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
-            }
-        }
-        else
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedStream invalid writeCallback: %p", writeCallback);
+        return EINVAL;
+    }
+
+    if (m_modulesManager.m_prettyPrintReported)
+    {
+        MPI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+
+        if (MPI_OK == (status = GetReportedPayload(&payload, &payloadSizeBytes)))
         {
-            if (IsFullLoggingEnabled())
-            {
-                OsConfigLogError(GetPlatformLog(), "MpiGet(%s, %s, %.*s, %d) returned %d", componentName, objectName, *payloadSizeBytes, *payload, *payloadSizeBytes, status);
-            }
+            status = writeCallback(payload, payloadSizeBytes, context);
         }
-    }};
 
-    if (nullptr == componentName)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid componentName: %s", componentName);
-        status = EINVAL;
-    }
-    else if (nullptr == objectName)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid objectName: %s", objectName);
-        status = EINVAL;
-    }
-    else if (nullptr == payload)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payload");
-        status = EINVAL;
+        delete[] payload;
     }
-    else if (nullptr == payloadSizeBytes)
+    else
     {
-        OsConfigLogError(GetPlatformLog(), "MpiSet invalid payloadSizeBytes");
-        status = EINVAL;
+        status = WriteReported(writeCallback, context);
     }
-    else
+
+    if ((MPI_OK != status) && IsFullLoggingEnabled())
     {
-        std::shared_ptr<MmiSession> moduleSession;
-        if (nullptr != (moduleSession = GetSession(componentName)))
-        {
-            status = moduleSession->Get(componentName, objectName, payload, payloadSizeBytes);
-        }
-        else
-        {
-            OsConfigLogError(GetPlatformLog(), "MpiSet componentName %s not found", componentName);
-            status = EINVAL;
-        }
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedStream(%p) returned %d", context, status);
     }
 
     return status;
 }
 
-int MpiSession::SetDesired(const MPI_JSON_STRING payload, int payloadSizeBytes)
+int MpiSession::GetReportedChanges(const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSizeBytes)
 {
     int status = MPI_OK;
+    std::vector<ReportedObject> changedObjects;
+    std::vector<std::pair<std::string, std::string>> timedOut;
+    std::vector<std::pair<std::string, std::string>> removedObjects;
+    unsigned long long reportedRead = 0;
+    unsigned long long reportedBaseVersion = 0;
+    unsigned long long reportedVersion = std::numeric_limits<unsigned long long>::max();
+    bool full = false;
+
+    if ((nullptr == payload) || (nullptr == payloadSizeBytes))
+    {
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges invalid payload: %p, %p", payload, payloadSizeBytes);
+        return EINVAL;
+    }
+
+    *payload = nullptr;
+    *payloadSizeBytes = 0;
 
-    ScopeGuard sg{[&]()
     {
-        if (IsFullLoggingEnabled())
+        std::lock_guard<std::mutex> lock(m_modulesManager.m_reportedVersionsMutex);
+        reportedRead = ++m_modulesManager.m_reportedReads;
+        reportedBaseVersion = m_modulesManager.m_reportedBaseVersion;
+        full = (sinceVersion < reportedBaseVersion) || (sinceVersion > m_modulesManager.m_reportedVersion);
+    }
+
+    // The modules are read without the lock, which is only taken to record each object as it is handed over, so reads of the reported changes
+    // for other clients go on at the same time. Only the payloads of changed objects are kept: a full resync returns none of them and the client
+    // streams the whole reported configuration with MpiGetReportedStream instead
+    status = ReadReported([&](const ReportedObject& reported) -> int
+    {
+        if ((MMI_OK == reported.status) && !reported.payload.empty() && IsSingleJsonValue(reported.payload))
         {
-            if (MPI_OK == status)
+            size_t hash = std::hash<std::string>()(reported.payload);
+            bool changed = false;
+
+            std::lock_guard<std::mutex> lock(m_modulesManager.m_reportedVersionsMutex);
+            auto inserted = m_modulesManager.m_reportedVersions.insert(std::make_pair(std::make_pair(reported.componentName, reported.objectName), ModulesManager::ReportedObjectVersion{hash, 0, reportedRead, false}));
+            ModulesManager::ReportedObjectVersion& version = inserted.first->second;
+
+            if ((version.read > reportedRead) && (version.removed || (hash != version.hash)))
             {
-                OsConfigLogInfo(GetPlatformLog(), "MpiSetDesired(%.*s, %d) returned %d", payloadSizeBytes, payload, payloadSizeBytes, status);
+                // A read that started later already recorded another value, the value read here can be the older one. The version returned
+                // stays below the recorded change so that the value recorded comes with the next changes
+                if (full || (version.version > sinceVersion))
+                {
+                    reportedVersion = std::min(reportedVersion, version.version - 1);
+                    changed = true;
+                }
             }
             else
             {
-                OsConfigLogError(GetPlatformLog(), "MpiSetDesired(%.*s, %d) returned %d", payloadSizeBytes, payload, payloadSizeBytes, status);
-            }
-        }
-    }};
+                if (inserted.second || version.removed || (hash != version.hash))
+                {
+                    version.hash = hash;
+                    version.version = ++m_modulesManager.m_reportedVersion;
+                    version.removed = false;
+                }
 
-    if (nullptr == payload)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payload: %s", payload);
-        status = EINVAL;
-    }
-    else if (0 == payloadSizeBytes)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payloadSizeBytes: %d", payloadSizeBytes);
-        status = EINVAL;
-    }
-    else
-    {
-        rapidjson::Document document;
-        document.Parse(payload, payloadSizeBytes);
+                version.read = std::max(version.read, reportedRead);
+                changed = (version.version > sinceVersion);
+            }
 
-        if (document.HasParseError())
-        {
-            if (IsFullLoggingEnabled())
+            if (changed && !full)
             {
-                OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payload: %.*s", payloadSizeBytes, payload);
+                changedObjects.push_back(reported);
             }
-
-            status = EINVAL;
         }
-        else if (!document.IsObject())
+        else if (IsTimedOut(reported))
         {
-            if (IsFullLoggingEnabled())
-            {
-                OsConfigLogError(GetPlatformLog(), "MpiSetDesired invalid payload: %.*s", payloadSizeBytes, payload);
-            }
-
-            status = EINVAL;
+            timedOut.push_back(std::make_pair(reported.componentName, reported.objectName));
         }
-        else
+        else if ((MMI_OK != reported.status) && IsFullLoggingEnabled())
         {
-            status = SetDesiredPayload(document);
+            OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned %d", reported.componentName.c_str(), reported.objectName.c_str(), reported.status);
         }
-    }
 
-    return status;
-}
+        return MPI_OK;
+    });
 
-int MpiSession::SetDesiredPayload(rapidjson::Document& document)
-{
-    int status = MPI_OK;
+    if (MPI_OK != status)
+    {
+        return status;
+    }
 
-    for (auto& component : document.GetObject())
     {
-        if (component.value.IsObject())
+        std::lock_guard<std::mutex> lock(m_modulesManager.m_reportedVersionsMutex);
+
+        // The modules were unloaded during the read and the versions recorded before that are gone, the client has to start over
+        if (reportedBaseVersion != m_modulesManager.m_reportedBaseVersion)
+        {
+            full = true;
+            changedObjects.clear();
+        }
+
+        // An object that was read before and is not anymore (its module no longer returns it or MmiGet failed) gets a new version as removed,
+        // so that the clients that have it delete it. An object that timed out keeps its version, the clients keep its last value
+        for (auto& object : m_modulesManager.m_reportedVersions)
         {
-            std::string componentName = component.name.GetString();
-            std::shared_ptr<MmiSession> module;
+            ModulesManager::ReportedObjectVersion& version = object.second;
 
-            if (nullptr != (module = GetSession(componentName)))
+            if (!version.removed && (version.read < reportedRead) && (timedOut.end() == std::find(timedOut.begin(), timedOut.end(), object.first)))
             {
-                for (auto& object : component.value.GetObject())
-                {
-                    int moduleStatus = MMI_OK;
-                    std::string objectName = object.name.GetString();
+                version.version = ++m_modulesManager.m_reportedVersion;
+                version.read = reportedRead;
+                version.removed = true;
+            }
 
-                    rapidjson::StringBuffer buffer;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                    object.value.Accept(writer);
+            if (version.removed && !full && (version.version > sinceVersion))
+            {
+                removedObjects.push_back(object.first);
+            }
+        }
 
-                    moduleStatus = module->Set(componentName.c_str(), objectName.c_str(), (MMI_JSON_STRING)buffer.GetString(), buffer.GetSize());
+        reportedVersion = std::min(reportedVersion, m_modulesManager.m_reportedVersion);
+    }
 
-                    if ((moduleStatus != MMI_OK) && IsFullLoggingEnabled())
-                    {
-                        OsConfigLogError(GetPlatformLog(), "MmiSet(%s, %s, %s, %d) to %s returned %d", componentName.c_str(), objectName.c_str(), buffer.GetString(), static_cast<int>(buffer.GetSize()), module->GetInfo().name.c_str(), moduleStatus);
-                    }
-                }
-            }
-            else
+    try
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        std::string componentName;
+
+        writer.StartObject();
+        writer.Key("Reported");
+        writer.StartObject();
+
+        for (const ReportedObject& changed : changedObjects)
+        {
+            if (componentName != changed.componentName)
             {
-                status = EINVAL;
-                if (IsFullLoggingEnabled())
+                if (!componentName.empty())
                 {
-                    OsConfigLogError(GetPlatformLog(), "Unable to find module for component %s", componentName.c_str());
+                    writer.EndObject();
                 }
+
+                componentName = changed.componentName;
+                writer.Key(componentName.c_str(), static_cast<rapidjson::SizeType>(componentName.length()));
+                writer.StartObject();
             }
+
+            writer.Key(changed.objectName.c_str(), static_cast<rapidjson::SizeType>(changed.objectName.length()));
+            writer.RawValue(changed.payload.c_str(), changed.payload.length(), rapidjson::kObjectType);
         }
-        else
+
+        if (!componentName.empty())
         {
-            status = EINVAL;
-            if (IsFullLoggingEnabled())
-            {
-                OsConfigLogError(GetPlatformLog(), "Component value is not an object");
-            }
+            writer.EndObject();
         }
-    }
 
-    return status;
-}
+        writer.EndObject();
 
-int MpiSession::GetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes)
-{
-    int status = MPI_OK;
+        if (!timedOut.empty())
+        {
+            writer.Key(g_reportedTimedOut);
+            WriteObjectNames(writer, timedOut);
+        }
 
-    ScopeGuard sg{[&]()
-    {
-        if (IsFullLoggingEnabled())
+        if (!removedObjects.empty())
         {
-            if (MPI_OK == status)
-            {
-                OsConfigLogInfo(GetPlatformLog(), "MpiGetReported(%p, %p) returned %d", payload, payloadSizeBytes, status);
-            }
-            else
-            {
-                OsConfigLogError(GetPlatformLog(), "MpiGetReported(%p, %p) returned %d", payload, payloadSizeBytes, status);
-            }
+            writer.Key(g_reportedRemoved);
+            WriteObjectNames(writer, removedObjects);
         }
-    }};
 
-    if (nullptr == payload)
-    {
-        OsConfigLogError(GetPlatformLog(), "MpiGetReported invalid payload: %p", payload);
-        status = EINVAL;
+        writer.Key("Version");
+        writer.Uint64(reportedVersion);
+        writer.Key("Full");
+        writer.Bool(full);
+        writer.EndObject();
+
+        if (nullptr == (*payload = new (std::nothrow) char[buffer.GetSize()]))
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges unable to allocate %d bytes", static_cast<int>(buffer.GetSize()));
+            status = ENOMEM;
+        }
+        else
+        {
+            std::memcpy(*payload, buffer.GetString(), buffer.GetSize());
+            *payloadSizeBytes = static_cast<int>(buffer.GetSize());
+        }
     }
-    else if (nullptr == payloadSizeBytes)
+    catch (const std::exception& e)
     {
-        OsConfigLogError(GetPlatformLog(), "MpiGetReported invalid payloadSizeBytes: %p", payloadSizeBytes);
-        status = EINVAL;
+        OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges failed: %s", e.what());
+        status = ENOMEM;
     }
-    else
+
+    if (IsFullLoggingEnabled())
     {
-        *payload = nullptr;
-        *payloadSizeBytes = 0;
-        status = GetReportedPayload(payload, payloadSizeBytes);
+        OsConfigLogInfo(GetPlatformLog(), "MpiGetReportedChanges(%llu) returned %d changed and %d removed objects, version %llu: %d", sinceVersion,
+            static_cast<int>(changedObjects.size()), static_cast<int>(removedObjects.size()), reportedVersion, status);
     }
 
     return status;
 }
 
-int MpiSession::GetReportedPayload(MPI_JSON_STRING* payload, int* payloadSizeBytes)
+// Writes the reported configuration compact, one object at a time as each module answers, so that only one object is held in memory at a time.
+// The object payloads were already validated by CallMmiGet and go in as they are, without parsing them again
+int MpiSession::WriteReported(MPI_WRITE_CALLBACK writeCallback, void* context)
 {
     int status = MPI_OK;
-    rapidjson::Document document;
-    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
-    document.SetObject();
+    bool firstComponent = true;
+    std::vector<std::pair<std::string, std::string>> timedOut;
 
-    for (auto reported : m_modulesManager.m_reportedComponents)
+    try
     {
-        std::string componentName = reported.first;
-        std::vector<std::string> objectNames = reported.second;
-        std::shared_ptr<MmiSession> module = GetSession(componentName);
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        std::string componentName;
+        bool firstObject = true;
 
-        if ((nullptr != module) && !objectNames.empty())
+        buffer.Put('{');
+
+        status = ReadReported([&](const ReportedObject& reported) -> int
         {
-            rapidjson::Value component(rapidjson::kObjectType);
-            for (auto& objectName : objectNames)
+            int writeStatus = MPI_OK;
+
+            if (firstComponent || (reported.componentName != componentName))
             {
-                char* objectPayload = nullptr;
-                int objectPayloadSizeBytes = 0;
-                int moduleStatus = MMI_OK;
+                if (!firstComponent)
+                {
+                    buffer.Put('}');
+                    buffer.Put(',');
+                }
 
-                moduleStatus = module->Get(componentName.c_str(), objectName.c_str(), &objectPayload, &objectPayloadSizeBytes);
+                firstComponent = false;
+                firstObject = true;
+                componentName = reported.componentName;
 
-                if ((MMI_OK == moduleStatus) && (nullptr != objectPayload) && (0 < objectPayloadSizeBytes))
-                {
-                    std::string objectPayloadString(objectPayload, objectPayloadSizeBytes);
-                    rapidjson::Document objectDocument;
-                    objectDocument.Parse(objectPayloadString.c_str());
+                writer.Reset(buffer);
+                writer.String(componentName.c_str(), static_cast<rapidjson::SizeType>(componentName.length()));
+                buffer.Put(':');
+                buffer.Put('{');
+            }
 
-                    if (!objectDocument.HasParseError())
-                    {
-                        rapidjson::Value object(rapidjson::kObjectType);
-                        object.CopyFrom(objectDocument, allocator);
-                        component.AddMember(rapidjson::Value(objectName.c_str(), allocator), object, allocator);
-                    }
-                    else if (IsFullLoggingEnabled())
+            if ((MMI_OK == reported.status) && !reported.payload.empty())
+            {
+                if (IsSingleJsonValue(reported.payload))
+                {
+                    if (!firstObject)
                     {
-                        OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned invalid payload: %s", componentName.c_str(), objectName.c_str(), objectPayloadString.c_str());
+                        buffer.Put(',');
                     }
+
+                    firstObject = false;
+
+                    writer.Reset(buffer);
+                    writer.String(reported.objectName.c_str(), static_cast<rapidjson::SizeType>(reported.objectName.length()));
+                    buffer.Put(':');
+                    writer.Reset(buffer);
+                    writer.RawValue(reported.payload.c_str(), reported.payload.length(), rapidjson::kObjectType);
                 }
                 else if (IsFullLoggingEnabled())
                 {
-                    OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned %d", componentName.c_str(), objectName.c_str(), moduleStatus);
+                    OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned invalid payload: %s", reported.componentName.c_str(), reported.objectName.c_str(), reported.payload.c_str());
                 }
             }
-            document.AddMember(rapidjson::Value(componentName.c_str(), allocator), component, allocator);
-        }
-    }
+            else if (IsTimedOut(reported))
+            {
+                timedOut.push_back(std::make_pair(reported.componentName, reported.objectName));
+            }
+            else if (IsFullLoggingEnabled())
+            {
+                OsConfigLogError(GetPlatformLog(), "MmiGet(%s, %s) returned %d", reported.componentName.c_str(), reported.objectName.c_str(), reported.status);
+            }
 
-    try
-    {
-        rapidjson::StringBuffer buffer;
-        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-        writer.SetIndent(' ', 2);
-        document.Accept(writer);
+            if (0 < buffer.GetSize())
+            {
+                writeStatus = writeCallback(buffer.GetString(), static_cast<int>(buffer.GetSize()), context);
+            }
 
-        *payloadSizeBytes = buffer.GetSize();
-        *payload = new (std::nothrow) char[*payloadSizeBytes];
-        if (nullptr == *payload)
-        {
-            OsConfigLogError(GetPlatformLog(), "MpiGetReported unable to allocate %d bytes", *payloadSizeBytes);
-            status = ENOMEM;
-        }
-        else
+            buffer.Clear();
+            return writeStatus;
+        });
+
+        if (MPI_OK == status)
         {
-            std::fill(*payload, *payload + buffer.GetSize(), 0);
-            std::memcpy(*payload, buffer.GetString(), buffer.GetSize());
-            *payloadSizeBytes = buffer.GetSize();
+            if (!firstComponent)
+            {
+                buffer.Put('}');
+            }
+
+            if (!timedOut.empty())
+            {
+                if (!firstComponent)
+                {
+                    buffer.Put(',');
+                }
+
+                writer.Reset(buffer);
+                writer.String(g_reportedTimedOut);
+                buffer.Put(':');
+                writer.Reset(buffer);
+                WriteObjectNames(writer, timedOut);
+            }
+
+            buffer.Put('}');
+            status = writeCallback(buffer.GetString(), static_cast<int>(buffer.GetSize()), context);
         }
     }
     catch (const std::exception& e)
     {
-        OsConfigLogError(GetPlatformLog(), "Could not allocate payload: %s", e.what());
-        status = EINTR;
-
-        if (nullptr != *payload)
-        {
-            delete[] * payload;
-            *payload = nullptr;
-        }
-
-        if (nullptr != payloadSizeBytes)
-        {
-            *payloadSizeBytes = 0;
-        }
+        OsConfigLogError(GetPlatformLog(), "Could not serialize reported payload: %s", e.what());
+        status = ENOMEM;
     }
 
     return status;
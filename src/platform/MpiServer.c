@@ -4,33 +4,82 @@
 #include <PlatformCommon.h>
 #include <MpiServer.h>
 
-// 500 milliseconds
-#define MPI_WORKER_SLEEP 500
-
-#define MAX_CONTENTLENGTH_LENGTH 16
 #define MAX_ERROR_LENGTH 16
-#define MAX_QUEUED_CONNECTIONS 5
-#define MAX_REASONSTRING_LENGTH 32
-#define MAX_STATUS_CODE_LENGTH 3
+#define MAX_QUEUED_CONNECTIONS 64
+#define MAX_RESPONSE_HEADER_LENGTH 256
+#define MAX_CHUNK_SIZE_LINE_LENGTH 24
+#define MPI_STREAM_CHUNK_SIZE 16384
+#define MAX_MPI_CONNECTIONS 1024
+#define MAX_MPI_CHANNELS 16
+#define MAX_EPOLL_EVENTS 64
+
+#define MPI_WRITE_TIMEOUT_MS 5000
+#define MPI_CONNECTION_TIMEOUT_SECONDS 30
+#define MPI_KEEP_ALIVE_TIMEOUT_SECONDS 300
 
 static const char* g_socketPrefix = "/run/osconfig";
 static const char* g_mpiSocket = "/run/osconfig/mpid.sock";
+static const char* g_configFile = "/etc/osconfig/osconfig.json";
 
 static const char* g_clientName = "ClientName";
 static const char* g_maxPayloadSizeBytes = "MaxPayloadSizeBytes";
+static const char* g_reportedCacheBypass = "ReportedCacheBypass";
 static const char* g_clientSession = "ClientSession";
 static const char* g_componentName = "ComponentName";
 static const char* g_objectName = "ObjectName";
 static const char* g_payload = "Payload";
+static const char* g_objects = "Objects";
+static const char* g_status = "Status";
+static const char* g_sharedMemory = "SharedMemory";
+static const char* g_version = "Version";
+static const char* g_reapply = "Reapply";
 
 static int g_socketfd = -1;
 static struct sockaddr_un g_socketaddr = {0};
 static socklen_t g_socketlen = 0;
 
-static pthread_t g_mpiServerWorker = 0;
+static int g_epollfd = -1;
+static int g_wakeupfd = -1;
+
+static pthread_t g_mpiServerEventLoop = 0;
+static pthread_t* g_mpiServerWorkers = NULL;
+static int g_numMpiServerWorkers = 0;
+static bool g_eventLoopActive = false;
 static bool g_serverActive = false;
+static size_t g_maxContentLength = HTTP_DEFAULT_MAX_CONTENT_LENGTH;
+static bool g_sharedMemoryTransport = false;
 
-char g_mpiCall[MPI_CALL_MESSAGE_LENGTH] = {0};
+// A client connection, owned by the event loop while the request is received and by a worker while it is served.
+// A connection that negotiated a shared memory channel is owned by its own channel thread from then on
+typedef struct MPI_CONNECTION
+{
+    int socketHandle;
+    HTTP_PARSER request;
+    time_t lastActivity;
+    SHARED_MEMORY_CHANNEL* channel;
+    struct MPI_CONNECTION* next;
+} MPI_CONNECTION;
+
+// Connections receiving a request, only accessed from the event loop
+static MPI_CONNECTION* g_connections = NULL;
+static int g_numConnections = 0;
+
+// Connections with a complete request waiting for a free worker
+static MPI_CONNECTION* g_firstPendingConnection = NULL;
+static MPI_CONNECTION* g_lastPendingConnection = NULL;
+
+// Persistent connections handed back by the workers for the event loop to watch again
+static MPI_CONNECTION* g_returnedConnections = NULL;
+static pthread_mutex_t g_connectionsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_connectionsEnqueued = PTHREAD_COND_INITIALIZER;
+
+// Shared memory channels, each served by a detached thread that exits when its client disconnects or when g_stopChannelsfd is signaled
+static int g_numChannels = 0;
+static int g_stopChannelsfd = -1;
+static pthread_cond_t g_channelsClosed = PTHREAD_COND_INITIALIZER;
+
+// Per worker thread, so that a crash reports the MPI call that was in progress on the crashing thread
+__thread char g_mpiCall[MPI_CALL_MESSAGE_LENGTH] = {0};
 static const char g_mpiCallObjectTemplate[] = " during %s to %s.%s\n";
 static const char g_mpiCallModelTemplate[] = " during %s\n";
 
@@ -131,6 +180,31 @@ static int CallMpiSetDesired(MPI_HANDLE handle, const MPI_JSON_STRING payload, c
     return status;
 }
 
+static int CallMpiSetDesiredReapply(MPI_HANDLE handle, const MPI_JSON_STRING payload, const int payloadSize)
+{
+    int status = MPI_OK;
+
+    snprintf(g_mpiCall, sizeof(g_mpiCall), g_mpiCallModelTemplate, MPI_SET_DESIRED_URI);
+
+    status = MpiSetDesiredReapply((MPI_HANDLE)handle, payload, payloadSize);
+
+    if (IsFullLoggingEnabled())
+    {
+        if (MPI_OK == status)
+        {
+            OsConfigLogInfo(GetPlatformLog(), "MpiSetDesiredReapply request, session %p ('%s')", handle, (char*)handle);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiSetDesiredReapply request, session %p ('%s'), failed: %d", handle, (char*)handle, status);
+        }
+    }
+
+    memset(g_mpiCall, 0, sizeof(g_mpiCall));
+
+    return status;
+}
+
 static int CallMpiGetReported(MPI_HANDLE handle, MPI_JSON_STRING* payload, int* payloadSize)
 {
     int status = MPI_OK;
@@ -156,6 +230,81 @@ static int CallMpiGetReported(MPI_HANDLE handle, MPI_JSON_STRING* payload, int*
     return status;
 }
 
+static int CallMpiGetReportedStream(MPI_HANDLE handle, MPI_WRITE_CALLBACK writeCallback, void* context)
+{
+    int status = MPI_OK;
+
+    snprintf(g_mpiCall, sizeof(g_mpiCall), g_mpiCallModelTemplate, MPI_GET_REPORTED_STREAM_URI);
+
+    status = MpiGetReportedStream((MPI_HANDLE)handle, writeCallback, context);
+
+    if (IsFullLoggingEnabled())
+    {
+        if (MPI_OK == status)
+        {
+            OsConfigLogInfo(GetPlatformLog(), "MpiGetReportedStream request, session %p ('%s')", handle, (char*)handle);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiGetReportedStream request, session %p ('%s'), failed: %d", handle, (char*)handle, status);
+        }
+    }
+
+    memset(g_mpiCall, 0, sizeof(g_mpiCall));
+
+    return status;
+}
+
+static int CallMpiGetReportedChanges(MPI_HANDLE handle, const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSize)
+{
+    int status = MPI_OK;
+
+    snprintf(g_mpiCall, sizeof(g_mpiCall), g_mpiCallModelTemplate, MPI_GET_REPORTED_CHANGES_URI);
+
+    status = MpiGetReportedChanges((MPI_HANDLE)handle, sinceVersion, payload, payloadSize);
+
+    if (IsFullLoggingEnabled())
+    {
+        if (MPI_OK == status)
+        {
+            OsConfigLogInfo(GetPlatformLog(), "MpiGetReportedChanges(%llu) request, session %p ('%s')", sinceVersion, handle, (char*)handle);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "MpiGetReportedChanges(%llu) request, session %p ('%s'), failed: %d", sinceVersion, handle, (char*)handle, status);
+        }
+    }
+
+    memset(g_mpiCall, 0, sizeof(g_mpiCall));
+
+    return status;
+}
+
+static int CallMpiSetReportedCacheBypass(MPI_HANDLE handle, const int bypass)
+{
+    int status = MpiSetReportedCacheBypass((MPI_HANDLE)handle, bypass);
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "MpiSetReportedCacheBypass(%d) request, session %p ('%s'): %d", bypass, handle, (char*)handle, status);
+    }
+
+    return status;
+}
+
+static MPI_CALLS g_mpiCalls = {
+    CallMpiOpen,
+    CallMpiClose,
+    CallMpiSet,
+    CallMpiGet,
+    CallMpiSetDesired,
+    CallMpiGetReported,
+    CallMpiGetReportedStream,
+    CallMpiSetReportedCacheBypass,
+    CallMpiGetReportedChanges,
+    CallMpiSetDesiredReapply
+};
+
 HTTP_STATUS SetErrorResponse(const char* uri, int mpiStatus, char** response, int* responseSize)
 {
     int size = 0;
@@ -181,21 +330,329 @@ HTTP_STATUS SetErrorResponse(const char* uri, int mpiStatus, char** response, in
     return status;
 }
 
+// The result of one item of MpiSetMany or MpiGetMany. The names are spans of the request as they appear in it (already escaped),
+// the payload is the MpiGet response as the module returned it, both go into the response as they are
+typedef struct MPI_CALL_MANY_RESULT
+{
+    JSON_SPAN component;
+    JSON_SPAN object;
+    char* payload;
+    int payloadSize;
+    int status;
+} MPI_CALL_MANY_RESULT;
+
+// A payload written into the response as it is must not break the array around it
+static bool IsSingleJsonValue(const char* json, size_t length)
+{
+    size_t offset = 0;
+
+    if (0 != SkipJsonValue(json, length, &offset))
+    {
+        return false;
+    }
+
+    while ((offset < length) && isspace((unsigned char)json[offset]))
+    {
+        offset++;
+    }
+
+    return (offset == length);
+}
+
+static void HandleMpiCallManyItem(const char* uri, const char* client, JSON_Object* itemObject, JSON_SPAN item, MPI_CALLS handlers, MPI_CALL_MANY_RESULT* result)
+{
+    const char* component = NULL;
+    const char* object = NULL;
+    JSON_SPAN payload = {0};
+
+    if ((NULL == itemObject) ||
+        (NULL == (component = json_object_get_string(itemObject, g_componentName))) ||
+        (NULL == (object = json_object_get_string(itemObject, g_objectName))) ||
+        (0 != FindJsonObjectMember(item.data, item.length, g_componentName, &result->component)) ||
+        (0 != FindJsonObjectMember(item.data, item.length, g_objectName, &result->object)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: item without string '%s' and '%s'", uri, g_componentName, g_objectName);
+        memset(result, 0, sizeof(*result));
+        result->status = EINVAL;
+        return;
+    }
+
+    if (0 == strcmp(uri, MPI_SET_MANY_URI))
+    {
+        // The payload is handed over as it appears in the request body, like for MpiSet
+        if (0 != FindJsonObjectMember(item.data, item.length, g_payload, &payload))
+        {
+            OsConfigLogError(GetPlatformLog(), "%s(%s, %s): item without '%s'", uri, component, object, g_payload);
+            result->status = EINVAL;
+        }
+        else
+        {
+            result->status = handlers.mpiSet((MPI_HANDLE)client, component, object, (MPI_JSON_STRING)payload.data, (int)payload.length);
+        }
+    }
+    else if ((MPI_OK == (result->status = handlers.mpiGet((MPI_HANDLE)client, component, object, &result->payload, &result->payloadSize))) &&
+        (NULL != result->payload) && (result->payloadSize > 0) && !IsSingleJsonValue(result->payload, (size_t)result->payloadSize))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s(%s, %s): invalid JSON payload", uri, component, object);
+        result->status = EINVAL;
+    }
+
+    if ((MPI_OK != result->status) || (NULL == result->payload) || (result->payloadSize <= 0))
+    {
+        FREE_MEMORY(result->payload);
+        result->payloadSize = 0;
+    }
+
+    if ((MPI_OK != result->status) && IsFullLoggingEnabled())
+    {
+        OsConfigLogError(GetPlatformLog(), "%s(%s, %s): failed for client '%s' with %d", uri, component, object, client, result->status);
+    }
+}
+
+// Appends to the response at *length, only counts the length when the response is NULL
+static void AppendToResponse(char* response, size_t* length, const char* data, size_t size)
+{
+    if (NULL != response)
+    {
+        memcpy(response + *length, data, size);
+    }
+
+    *length += size;
+}
+
+static void AppendMemberToResponse(char* response, size_t* length, const char* name, const char* value, size_t valueSize)
+{
+    AppendToResponse(response, length, "\"", 1);
+    AppendToResponse(response, length, name, strlen(name));
+    AppendToResponse(response, length, "\":", 2);
+    AppendToResponse(response, length, value, valueSize);
+}
+
+// The results as a JSON array, [{"ComponentName": ..., "ObjectName": ..., "Payload": ..., "Status": n}, ...]
+static size_t WriteMpiCallManyResults(const MPI_CALL_MANY_RESULT* results, size_t numResults, char* response)
+{
+    char status[MAX_ERROR_LENGTH + 1] = {0};
+    size_t length = 0;
+    size_t i = 0;
+
+    AppendToResponse(response, &length, "[", 1);
+
+    for (i = 0; i < numResults; i++)
+    {
+        AppendToResponse(response, &length, (0 == i) ? "{" : ",{", (0 == i) ? 1 : 2);
+
+        if (NULL != results[i].component.data)
+        {
+            AppendMemberToResponse(response, &length, g_componentName, results[i].component.data, results[i].component.length);
+            AppendToResponse(response, &length, ",", 1);
+            AppendMemberToResponse(response, &length, g_objectName, results[i].object.data, results[i].object.length);
+            AppendToResponse(response, &length, ",", 1);
+        }
+
+        if (NULL != results[i].payload)
+        {
+            AppendMemberToResponse(response, &length, g_payload, results[i].payload, (size_t)results[i].payloadSize);
+            AppendToResponse(response, &length, ",", 1);
+        }
+
+        snprintf(status, sizeof(status), "%d", results[i].status);
+        AppendMemberToResponse(response, &length, g_status, status, strlen(status));
+        AppendToResponse(response, &length, "}", 1);
+    }
+
+    AppendToResponse(response, &length, "]", 1);
+
+    return length;
+}
+
+// Serves a batch of MpiGet or MpiSet calls in one request, the response has one result with its own status per requested item, in request order.
+// The payloads are found in the request body and written into the response as they are, without parsing and serializing them again
+static HTTP_STATUS HandleMpiCallMany(const char* uri, const char* client, const char* requestBody, JSON_Object* rootObject, char** response, int* responseSize, MPI_CALLS handlers)
+{
+    JSON_Array* itemsArray = NULL;
+    JSON_SPAN items = {0};
+    JSON_SPAN item = {0};
+    MPI_CALL_MANY_RESULT* results = NULL;
+    size_t numItems = 0;
+    size_t offset = 0;
+    size_t length = 0;
+    size_t i = 0;
+    HTTP_STATUS status = HTTP_OK;
+
+    if ((NULL == (itemsArray = json_object_get_array(rootObject, g_objects))) || (0 != FindJsonObjectMember(requestBody, strlen(requestBody), g_objects, &items)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' array from request body", uri, g_objects);
+        return HTTP_BAD_REQUEST;
+    }
+
+    numItems = json_array_get_count(itemsArray);
+
+    if ((numItems > 0) && (NULL == (results = (MPI_CALL_MANY_RESULT*)calloc(numItems, sizeof(MPI_CALL_MANY_RESULT)))))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to allocate memory for %u results", uri, (unsigned int)numItems);
+        return HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    for (i = 0; i < numItems; i++)
+    {
+        // The items of the parsed array and of the request body are the same, the body was parsed just before
+        if (0 != GetNextJsonArrayElement(items.data, items.length, &offset, &item))
+        {
+            memset(&item, 0, sizeof(item));
+        }
+
+        HandleMpiCallManyItem(uri, client, json_array_get_object(itemsArray, i), item, handlers, &results[i]);
+    }
+
+    length = WriteMpiCallManyResults(results, numItems, NULL);
+
+    if (NULL != (*response = (char*)malloc(length + 1)))
+    {
+        WriteMpiCallManyResults(results, numItems, *response);
+        (*response)[length] = 0;
+        *responseSize = (int)length;
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to allocate %u bytes for the response for %u items", uri, (unsigned int)length, (unsigned int)numItems);
+        status = HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    for (i = 0; i < numItems; i++)
+    {
+        FREE_MEMORY(results[i].payload);
+    }
+
+    FREE_MEMORY(results);
+
+    return status;
+}
+
+static bool IsJsonMemberName(const JSON_SPAN* name, const char* expected)
+{
+    return ((name->length == strlen(expected)) && (0 == strncmp(name->data, expected, name->length)));
+}
+
+// Copies the string value of a member found in the request body, logs and returns NULL when it is missing or not a string
+static char* CopyRequestString(const char* uri, const char* name, const JSON_SPAN* value)
+{
+    char* string = NULL;
+
+    if (NULL == value->data)
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' from request body", uri, name);
+    }
+    else if (NULL == (string = CopyJsonString(value)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: '%s' is not a string", uri, name);
+    }
+
+    return string;
+}
+
+// Serves MpiSet and MpiSetDesired, whose payload can be large, with one scan over the members of the request body instead of parsing it into
+// a document. The scan validates the whole body, the payload is handed over as it appears in it
+static HTTP_STATUS HandleMpiSetCall(const char* uri, const char* requestBody, char** response, int* responseSize, MPI_CALLS handlers)
+{
+    JSON_SPAN name = {0};
+    JSON_SPAN value = {0};
+    JSON_SPAN clientValue = {0};
+    JSON_SPAN componentValue = {0};
+    JSON_SPAN objectValue = {0};
+    JSON_SPAN payload = {0};
+    char* client = NULL;
+    char* component = NULL;
+    char* object = NULL;
+    bool setDesired = (0 == strcmp(uri, MPI_SET_DESIRED_URI));
+    bool reapply = false;
+    size_t length = strlen(requestBody);
+    size_t offset = 0;
+    int result = 0;
+    int mpiStatus = MPI_OK;
+    HTTP_STATUS status = HTTP_OK;
+
+    // The first of members with the same name is used
+    while (0 == (result = GetNextJsonObjectMember(requestBody, length, &offset, &name, &value)))
+    {
+        if (IsJsonMemberName(&name, g_clientSession) && (NULL == clientValue.data))
+        {
+            clientValue = value;
+        }
+        else if (IsJsonMemberName(&name, g_componentName) && (NULL == componentValue.data))
+        {
+            componentValue = value;
+        }
+        else if (IsJsonMemberName(&name, g_objectName) && (NULL == objectValue.data))
+        {
+            objectValue = value;
+        }
+        else if (IsJsonMemberName(&name, g_payload) && (NULL == payload.data))
+        {
+            payload = value;
+        }
+        else if (IsJsonMemberName(&name, g_reapply))
+        {
+            reapply = ((4 == value.length) && (0 == strncmp(value.data, "true", value.length)));
+        }
+    }
+
+    if (ENOENT != result)
+    {
+        OsConfigLogError(GetPlatformLog(), "HandleMpiCall(%s): failed to parse request body", uri);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (NULL == (client = CopyRequestString(uri, g_clientSession, &clientValue)))
+    {
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (!setDesired && ((NULL == (component = CopyRequestString(uri, g_componentName, &componentValue))) || (NULL == (object = CopyRequestString(uri, g_objectName, &objectValue)))))
+    {
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (NULL == payload.data)
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' from request body", uri, g_payload);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (setDesired)
+    {
+        // Optional, sets again also the objects whose desired value did not change since last set
+        if (MPI_OK != (mpiStatus = (reapply ? handlers.mpiSetDesiredReapply : handlers.mpiSetDesired)((MPI_HANDLE)client, (MPI_JSON_STRING)payload.data, (int)payload.length)))
+        {
+            OsConfigLogError(GetPlatformLog(), "%s: failed for client '%s' with %d (returning %d)", uri, client, mpiStatus, status);
+            status = SetErrorResponse(uri, mpiStatus, response, responseSize);
+        }
+    }
+    else if (MPI_OK != (mpiStatus = handlers.mpiSet((MPI_HANDLE)client, component, object, (MPI_JSON_STRING)payload.data, (int)payload.length)))
+    {
+        status = SetErrorResponse(uri, mpiStatus, response, responseSize);
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogError(GetPlatformLog(), "%s(%s, %s): failed for client '%s' with %d (returning %d)", uri, component, object, client, mpiStatus, status);
+        }
+    }
+
+    FREE_MEMORY(client);
+    FREE_MEMORY(component);
+    FREE_MEMORY(object);
+
+    return status;
+}
+
 HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** response, int* responseSize, MPI_CALLS handlers)
 {
     JSON_Value* rootValue = NULL;
     JSON_Value* clientValue = NULL;
     JSON_Value* componentValue = NULL;
     JSON_Value* objectValue = NULL;
-    JSON_Value* payloadValue = NULL;
     JSON_Value* maxPayloadSizeValue = NULL;
+    JSON_Value* versionValue = NULL;
     JSON_Object* rootObject = NULL;
     int mpiStatus = MPI_OK;
     char* uuid = NULL;
     const char* client = NULL;
     const char* component = NULL;
     const char* object = NULL;
-    const char* payload = NULL;
     int maxPayloadSizeBytes = 0;
     int estimatedSize = 0;
     const char* responseFormat = "\"%s\"";
@@ -221,6 +678,10 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
         OsConfigLogError(GetPlatformLog(), "HandleMpiCall(%s): called with invalid null response size", uri);
         status = HTTP_BAD_REQUEST;
     }
+    else if ((0 == strcmp(uri, MPI_SET_URI)) || (0 == strcmp(uri, MPI_SET_DESIRED_URI)))
+    {
+        status = HandleMpiSetCall(uri, requestBody, response, responseSize, handlers);
+    }
     else if (NULL == (rootValue = json_parse_string(requestBody)))
     {
         OsConfigLogError(GetPlatformLog(), "HandleMpiCall(%s): failed to parse request body", uri);
@@ -268,6 +729,13 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
             else
             {
                 uuid = (char*)handlers.mpiOpen(client, maxPayloadSizeBytes);
+
+                // Optional, for clients that always need reported values read from the modules
+                if ((NULL != uuid) && (NULL != handlers.mpiSetReportedCacheBypass) && (1 == json_object_get_boolean(rootObject, g_reportedCacheBypass)))
+                {
+                    handlers.mpiSetReportedCacheBypass((MPI_HANDLE)uuid, 1);
+                }
+
                 if (uuid)
                 {
                     estimatedSize = strlen(responseFormat) + strlen(uuid) + 1;
@@ -293,10 +761,11 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
             }
         }
         else if ((0 == strcmp(uri, MPI_CLOSE_URI)) ||
-            (0 == strcmp(uri, MPI_SET_URI)) ||
             (0 == strcmp(uri, MPI_GET_URI)) ||
-            (0 == strcmp(uri, MPI_SET_DESIRED_URI)) ||
-            (0 == strcmp(uri, MPI_GET_REPORTED_URI)))
+            (0 == strcmp(uri, MPI_GET_REPORTED_URI)) ||
+            (0 == strcmp(uri, MPI_GET_REPORTED_CHANGES_URI)) ||
+            (0 == strcmp(uri, MPI_SET_MANY_URI)) ||
+            (0 == strcmp(uri, MPI_GET_MANY_URI)))
         {
             if (NULL == (clientValue = json_object_get_value(rootObject, g_clientSession)))
             {
@@ -318,7 +787,7 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
                 handlers.mpiClose((MPI_HANDLE)client);
                 status = HTTP_OK;
             }
-            else if ((0 == strcmp(uri, MPI_SET_URI)) || (0 == strcmp(uri, MPI_GET_URI)))
+            else if (0 == strcmp(uri, MPI_GET_URI))
             {
                 if (NULL == (componentValue = json_object_get_value(rootObject, g_componentName)))
                 {
@@ -350,67 +819,40 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
                     OsConfigLogError(GetPlatformLog(), "%s: failed to get string from '%s'", uri, g_objectName);
                     status = HTTP_BAD_REQUEST;
                 }
-                else
+                else if (MPI_OK != (mpiStatus = handlers.mpiGet((MPI_HANDLE)client, component, object, response, responseSize)))
                 {
-                    if (0 == strcmp(uri, MPI_SET_URI))
-                    {
-                        if (NULL == (payloadValue = json_object_get_value(rootObject, g_payload)))
-                        {
-                            OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' from request body", uri, g_payload);
-                            status = HTTP_BAD_REQUEST;
-                        }
-                        else if (NULL == (payload = json_serialize_to_string(payloadValue)))
-                        {
-                            OsConfigLogError(GetPlatformLog(), "%s: failed to get payload string", uri);
-                            status = HTTP_BAD_REQUEST;
-                        }
-                        else
-                        {
-                            if (MPI_OK != (mpiStatus = handlers.mpiSet((MPI_HANDLE)client, component, object, (MPI_JSON_STRING)payload, strlen(payload))))
-                            {
-                                status = SetErrorResponse(uri, mpiStatus, response, responseSize);
-                                if (IsFullLoggingEnabled())
-                                {
-                                    OsConfigLogError(GetPlatformLog(), "%s(%s, %s): failed for client '%s' with %d (returning %d)", uri, component, object, client, mpiStatus, status);
-                                }
-                            }
-                        }
-                    }
-                    else if (MPI_OK != (mpiStatus = handlers.mpiGet((MPI_HANDLE)client, component, object, response, responseSize)))
+                    status = SetErrorResponse(uri, mpiStatus, response, responseSize);
+                    if (IsFullLoggingEnabled())
                     {
-                        status = SetErrorResponse(uri, mpiStatus, response, responseSize);
-                        if (IsFullLoggingEnabled())
-                        {
-                            OsConfigLogError(GetPlatformLog(), "%s(%s, %s): failed for client '%s' with %d (returning %d)", uri, component, object, client, mpiStatus, status);
-                        }
+                        OsConfigLogError(GetPlatformLog(), "%s(%s, %s): failed for client '%s' with %d (returning %d)", uri, component, object, client, mpiStatus, status);
                     }
                 }
             }
-            else if (0 == strcmp(uri, MPI_SET_DESIRED_URI))
+            else if (0 == strcmp(uri, MPI_GET_REPORTED_URI))
             {
-                if (NULL == (payloadValue = json_object_get_value(rootObject, g_payload)))
+                if (MPI_OK != (mpiStatus = handlers.mpiGetReported((MPI_HANDLE)client, response, responseSize)))
                 {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' from request body", uri, g_payload);
-                    status = HTTP_BAD_REQUEST;
+                    OsConfigLogError(GetPlatformLog(), "%s: failed for client '%s' with %d (returning %d)", uri, client, mpiStatus, status);
+                    status = SetErrorResponse(uri, mpiStatus, response, responseSize);
                 }
-                else if (NULL == (payload = json_serialize_to_string(payloadValue)))
+            }
+            else if (0 == strcmp(uri, MPI_GET_REPORTED_CHANGES_URI))
+            {
+                // Optional, without a version all reported objects are returned
+                if ((NULL != (versionValue = json_object_get_value(rootObject, g_version))) && ((JSONNumber != json_value_get_type(versionValue)) || (0 > json_value_get_number(versionValue))))
                 {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed to get payload string", uri);
+                    OsConfigLogError(GetPlatformLog(), "%s: '%s' is not a valid version", uri, g_version);
                     status = HTTP_BAD_REQUEST;
                 }
-                else if (MPI_OK != (mpiStatus = handlers.mpiSetDesired((MPI_HANDLE)client, (MPI_JSON_STRING)payload, strlen(payload))))
+                else if (MPI_OK != (mpiStatus = handlers.mpiGetReportedChanges((MPI_HANDLE)client, versionValue ? (unsigned long long)json_value_get_number(versionValue) : 0, response, responseSize)))
                 {
                     OsConfigLogError(GetPlatformLog(), "%s: failed for client '%s' with %d (returning %d)", uri, client, mpiStatus, status);
                     status = SetErrorResponse(uri, mpiStatus, response, responseSize);
                 }
             }
-            else if (0 == strcmp(uri, MPI_GET_REPORTED_URI))
+            else
             {
-                if (MPI_OK != (mpiStatus = handlers.mpiGetReported((MPI_HANDLE)client, response, responseSize)))
-                {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed for client '%s' with %d (returning %d)", uri, client, mpiStatus, status);
-                    status = SetErrorResponse(uri, mpiStatus, response, responseSize);
-                }
+                status = HandleMpiCallMany(uri, client, requestBody, rootObject, response, responseSize, handlers);
             }
         }
         else
@@ -425,158 +867,1121 @@ HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** respo
     return status;
 }
 
-static char* HttpReasonAsString(HTTP_STATUS statusCode)
+// Serves the calls whose response is handed to the write callback piece by piece, an error response is returned as usual
+HTTP_STATUS HandleMpiStreamCall(const char* uri, const char* requestBody, MPI_WRITE_CALLBACK writeCallback, void* context, char** response, int* responseSize, MPI_CALLS handlers)
 {
-    char* reason = NULL;
+    JSON_Value* rootValue = NULL;
+    JSON_Value* clientValue = NULL;
+    JSON_Object* rootObject = NULL;
+    const char* client = NULL;
+    int mpiStatus = MPI_OK;
+    HTTP_STATUS status = HTTP_OK;
 
-    if (NULL != (reason = (char*)malloc(MAX_REASONSTRING_LENGTH)))
+    if ((NULL == uri) || (NULL == requestBody) || (NULL == writeCallback) || (NULL == response) || (NULL == responseSize))
     {
-        switch (statusCode)
-        {
-            case HTTP_OK:
-                strcpy(reason, "OK");
-                break;
-            case HTTP_BAD_REQUEST:
-                strcpy(reason, "Bad Request");
-                break;
-            case HTTP_NOT_FOUND:
-                strcpy(reason, "Not Found");
-                break;
-            case HTTP_INTERNAL_SERVER_ERROR:
-                strcpy(reason, "Internal Server Error");
-                break;
-            default:
-                strcpy(reason, "Unknown");
-        }
+        OsConfigLogError(GetPlatformLog(), "HandleMpiStreamCall(%s): called with invalid arguments", uri ? uri : "-");
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (0 != strcmp(uri, MPI_GET_REPORTED_STREAM_URI))
+    {
+        OsConfigLogError(GetPlatformLog(), "HandleMpiStreamCall(%s): not a streamed call", uri);
+        status = HTTP_NOT_FOUND;
+    }
+    else if ((NULL == (rootValue = json_parse_string(requestBody))) || (NULL == (rootObject = json_value_get_object(rootValue))))
+    {
+        OsConfigLogError(GetPlatformLog(), "HandleMpiStreamCall(%s): failed to parse request body", uri);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (NULL == (clientValue = json_object_get_value(rootObject, g_clientSession)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to parse '%s' from request body", uri, g_clientSession);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (JSONString != json_value_get_type(clientValue))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: '%s' is not a string", uri, g_clientSession);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (NULL == (client = json_value_get_string(clientValue)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to get string from '%s'", uri, g_clientSession);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (MPI_OK != (mpiStatus = handlers.mpiGetReportedStream((MPI_HANDLE)client, writeCallback, context)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed for client '%s' with %d", uri, client, mpiStatus);
+        status = SetErrorResponse(uri, mpiStatus, response, responseSize);
     }
 
-    return reason;
+    json_value_free(rootValue);
+
+    return status;
 }
 
-static void* MpiServerWorker(void* arguments)
+static const char* HttpReasonAsString(HTTP_STATUS statusCode)
 {
-    const char* responseFormat = "HTTP/1.1 %d %s\r\nServer: OSConfig\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%.*s";
+    switch (statusCode)
+    {
+        case HTTP_OK:
+            return "OK";
+        case HTTP_BAD_REQUEST:
+            return "Bad Request";
+        case HTTP_NOT_FOUND:
+            return "Not Found";
+        case HTTP_REQUEST_HEADER_FIELDS_TOO_LARGE:
+            return "Request Header Fields Too Large";
+        case HTTP_INTERNAL_SERVER_ERROR:
+            return "Internal Server Error";
+        default:
+            return "Unknown";
+    }
+}
 
-    int socketHandle = -1;
-    char* uri = NULL;
-    int contentLength = 0;
-    char* requestBody = NULL;
-    HTTP_STATUS status = HTTP_OK;
-    char* httpReason = NULL;
-    char* responseBody = NULL;
-    int responseSize = 0;
-    char* buffer = NULL;
-    int estimatedSize = 0;
-    int actualSize = 0;
+static void ReleaseChannel(void)
+{
+    pthread_mutex_lock(&g_connectionsMutex);
+    g_numChannels -= 1;
+    pthread_cond_broadcast(&g_channelsClosed);
+    pthread_mutex_unlock(&g_connectionsMutex);
+}
+
+static void CloseConnection(MPI_CONNECTION* connection)
+{
+    bool hadChannel = false;
+
+    if (NULL == connection)
+    {
+        return;
+    }
+
+    if (0 != close(connection->socketHandle))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to close socket: path %s, handle '%d'", g_mpiSocket, connection->socketHandle);
+    }
+    else if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "Closed connection: path %s, handle '%d'", g_mpiSocket, connection->socketHandle);
+    }
+
+    if (NULL != connection->channel)
+    {
+        CloseSharedMemoryChannel(connection->channel);
+        FREE_MEMORY(connection->channel);
+        hadChannel = true;
+    }
+
+    FreeHttpParser(&connection->request);
+    FREE_MEMORY(connection);
+
+    if (hadChannel)
+    {
+        ReleaseChannel();
+    }
+}
+
+// Gathers all the buffers into as few socket writes as possible, resuming after partial writes, the buffers are consumed.
+// Descriptors passed along are attached to the first write, so that the client receives them with the start of the response
+static bool WriteToConnection(MPI_CONNECTION* connection, struct iovec* buffers, int numBuffers, const int* descriptors, int numDescriptors)
+{
+    union
+    {
+        char buffer[CMSG_SPACE(sizeof(int) * SHARED_MEMORY_CHANNEL_DESCRIPTORS)];
+        struct cmsghdr align;
+    } control;
+
+    struct pollfd pollDescriptor = {0};
+    struct msghdr message = {0};
+    struct cmsghdr* controlMessage = NULL;
     ssize_t bytes = 0;
 
-    MPI_CALLS mpiCalls = {
-        CallMpiOpen,
-        CallMpiClose,
-        CallMpiSet,
-        CallMpiGet,
-        CallMpiSetDesired,
-        CallMpiGetReported
-    };
+    pollDescriptor.fd = connection->socketHandle;
+    pollDescriptor.events = POLLOUT;
 
-    UNUSED(arguments);
+    message.msg_iov = buffers;
+    message.msg_iovlen = numBuffers;
 
-    while (g_serverActive)
+    if ((NULL != descriptors) && (numDescriptors > 0) && (numDescriptors <= SHARED_MEMORY_CHANNEL_DESCRIPTORS))
     {
-        status = HTTP_OK;
+        memset(&control, 0, sizeof(control));
+        message.msg_control = control.buffer;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * numDescriptors);
+
+        controlMessage = CMSG_FIRSTHDR(&message);
+        controlMessage->cmsg_level = SOL_SOCKET;
+        controlMessage->cmsg_type = SCM_RIGHTS;
+        controlMessage->cmsg_len = CMSG_LEN(sizeof(int) * numDescriptors);
+        memcpy(CMSG_DATA(controlMessage), descriptors, sizeof(int) * numDescriptors);
+    }
 
-        if (0 <= (socketHandle = accept(g_socketfd, (struct sockaddr*)&g_socketaddr, &g_socketlen)))
+    while (message.msg_iovlen > 0)
+    {
+        // Skips the buffers that are completely written
+        if (0 == message.msg_iov->iov_len)
+        {
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        else if (0 < (bytes = sendmsg(connection->socketHandle, &message, MSG_NOSIGNAL)))
         {
-            AreModulesLoadedAndLoadIfNot();
+            message.msg_control = NULL;
+            message.msg_controllen = 0;
 
-            if (IsFullLoggingEnabled())
+            while ((message.msg_iovlen > 0) && ((size_t)bytes >= message.msg_iov->iov_len))
             {
-                OsConfigLogInfo(GetPlatformLog(), "Accepted connection: path %s, handle '%d'", g_socketaddr.sun_path, socketHandle);
+                bytes -= message.msg_iov->iov_len;
+                message.msg_iov++;
+                message.msg_iovlen--;
             }
 
-            if (NULL == (uri = ReadUriFromSocket(socketHandle, GetPlatformLog())))
+            if (message.msg_iovlen > 0)
             {
-                OsConfigLogError(GetPlatformLog(), "Failed to read request URI %d", socketHandle);
-                status = HTTP_BAD_REQUEST;
+                message.msg_iov->iov_base = (char*)message.msg_iov->iov_base + bytes;
+                message.msg_iov->iov_len -= bytes;
             }
-
-            if ((contentLength = ReadHttpContentLengthFromSocket(socketHandle, GetPlatformLog())))
+        }
+        else if ((bytes < 0) && (EINTR == errno))
+        {
+            continue;
+        }
+        else if ((bytes < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+        {
+            // The client is not draining its socket, wait for it a bounded time instead of spinning
+            if (0 >= poll(&pollDescriptor, 1, MPI_WRITE_TIMEOUT_MS))
             {
-                if (NULL == (requestBody = (char*)malloc(contentLength + 1)))
-                {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed to allocate memory for HTTP body, Content-Length %d", uri, contentLength);
-                    status = HTTP_BAD_REQUEST;
-                }
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
 
-                memset(requestBody, 0, contentLength + 1);
+    return (0 == message.msg_iovlen);
+}
 
-                if (contentLength != (int)(bytes = read(socketHandle, requestBody, contentLength)))
-                {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed to read complete HTTP body, Content-Length %d, bytes read %d", uri, contentLength, (int)bytes);
-                    status = HTTP_BAD_REQUEST;
-                }
+static const char* g_connectionClose = "close";
+static const char* g_connectionKeepAlive = "keep-alive";
+
+// A response streamed with chunked transfer encoding, the small pieces written by the modules manager are coalesced into chunks
+typedef struct MPI_STREAM
+{
+    MPI_CONNECTION* connection;
+    bool keepAlive;
+    bool headerSent;
+    bool failed;
+    size_t bufferedSize;
+    char buffer[MPI_STREAM_CHUNK_SIZE];
+} MPI_STREAM;
+
+// Sends the response header when not sent yet, the buffered data and the given data as chunks, and the last chunk when asked
+static bool WriteStreamChunks(MPI_STREAM* stream, const char* data, size_t dataSize, bool lastChunk)
+{
+    const char* headerFormat = "HTTP/1.1 200 OK\r\nServer: OSConfig\r\nContent-Type: application/json\r\nConnection: %s\r\nTransfer-Encoding: chunked\r\n\r\n";
+    const char* chunkEnd = "\r\n";
+    const char* lastChunkLine = "0\r\n\r\n";
+
+    char header[MAX_RESPONSE_HEADER_LENGTH] = {0};
+    char bufferedSizeLine[MAX_CHUNK_SIZE_LINE_LENGTH] = {0};
+    char dataSizeLine[MAX_CHUNK_SIZE_LINE_LENGTH] = {0};
+    struct iovec buffers[8] = {{0}};
+    int numBuffers = 0;
+
+    if (stream->failed)
+    {
+        return false;
+    }
+
+    if (!stream->headerSent)
+    {
+        buffers[numBuffers].iov_base = header;
+        buffers[numBuffers++].iov_len = snprintf(header, sizeof(header), headerFormat, stream->keepAlive ? g_connectionKeepAlive : g_connectionClose);
+    }
+
+    if (stream->bufferedSize > 0)
+    {
+        buffers[numBuffers].iov_base = bufferedSizeLine;
+        buffers[numBuffers++].iov_len = snprintf(bufferedSizeLine, sizeof(bufferedSizeLine), "%zx\r\n", stream->bufferedSize);
+        buffers[numBuffers].iov_base = stream->buffer;
+        buffers[numBuffers++].iov_len = stream->bufferedSize;
+        buffers[numBuffers].iov_base = (void*)chunkEnd;
+        buffers[numBuffers++].iov_len = strlen(chunkEnd);
+    }
+
+    // Data that does not fit the buffer is sent as it came, without a copy
+    if (dataSize > 0)
+    {
+        buffers[numBuffers].iov_base = dataSizeLine;
+        buffers[numBuffers++].iov_len = snprintf(dataSizeLine, sizeof(dataSizeLine), "%zx\r\n", dataSize);
+        buffers[numBuffers].iov_base = (void*)data;
+        buffers[numBuffers++].iov_len = dataSize;
+        buffers[numBuffers].iov_base = (void*)chunkEnd;
+        buffers[numBuffers++].iov_len = strlen(chunkEnd);
+    }
+
+    if (lastChunk)
+    {
+        buffers[numBuffers].iov_base = (void*)lastChunkLine;
+        buffers[numBuffers++].iov_len = strlen(lastChunkLine);
+    }
+
+    stream->headerSent = true;
+    stream->bufferedSize = 0;
+
+    if ((numBuffers > 0) && (!WriteToConnection(stream->connection, buffers, numBuffers, NULL, 0)))
+    {
+        stream->failed = true;
+    }
+
+    return !stream->failed;
+}
+
+static int WriteToStream(const char* data, const int dataSizeBytes, void* context)
+{
+    MPI_STREAM* stream = (MPI_STREAM*)context;
+    size_t size = (dataSizeBytes > 0) ? (size_t)dataSizeBytes : 0;
+
+    if ((NULL == stream) || ((NULL == data) && (size > 0)))
+    {
+        return EINVAL;
+    }
+
+    if ((stream->bufferedSize + size) <= sizeof(stream->buffer))
+    {
+        memcpy(stream->buffer + stream->bufferedSize, data, size);
+        stream->bufferedSize += size;
+        return stream->failed ? ECONNRESET : MPI_OK;
+    }
+    else if (size >= sizeof(stream->buffer))
+    {
+        return WriteStreamChunks(stream, data, size, false) ? MPI_OK : ECONNRESET;
+    }
+    else if (WriteStreamChunks(stream, NULL, 0, false))
+    {
+        memcpy(stream->buffer, data, size);
+        stream->bufferedSize = size;
+        return MPI_OK;
+    }
+
+    return ECONNRESET;
+}
+
+static bool WriteResponse(MPI_CONNECTION* connection, const char* uri, HTTP_STATUS status, bool keepAlive, char* responseBody, int responseSize, const int* descriptors, int numDescriptors)
+{
+    const char* responseFormat = "HTTP/1.1 %d %s\r\nServer: OSConfig\r\nContent-Type: application/json\r\nConnection: %s\r\nContent-Length: %d\r\n\r\n";
+
+    char header[MAX_RESPONSE_HEADER_LENGTH] = {0};
+    int headerSize = 0;
+    struct iovec buffers[2] = {{0}};
+
+    if (NULL == responseBody)
+    {
+        responseSize = 0;
+    }
+
+    // Only the headers are formatted, the response body is sent as it came from the module, without a copy
+    headerSize = snprintf(header, sizeof(header), responseFormat, (int)status, HttpReasonAsString(status), keepAlive ? g_connectionKeepAlive : g_connectionClose, responseSize);
+
+    if ((headerSize <= 0) || (headerSize >= (int)sizeof(header)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to format HTTP response header (%d)", uri, headerSize);
+        return false;
+    }
+
+    buffers[0].iov_base = header;
+    buffers[0].iov_len = headerSize;
+    buffers[1].iov_base = responseBody;
+    buffers[1].iov_len = responseSize;
+
+    if (!WriteToConnection(connection, buffers, ARRAY_SIZE(buffers), descriptors, numDescriptors))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to write complete HTTP response of %d bytes", uri, headerSize + responseSize);
+        return false;
+    }
+
+    return true;
+}
+
+static bool IsSharedMemoryRequested(const char* requestBody, size_t requestSize)
+{
+    JSON_SPAN value = {0};
+
+    return ((NULL != requestBody) && (0 == FindJsonObjectMember(requestBody, requestSize, g_sharedMemory, &value)) && (4 == value.length) && (0 == strncmp(value.data, "true", value.length)));
+}
+
+// Creates the shared memory channel asked for with MpiOpen, returns the number of descriptors to hand over to the client (0 when declined)
+static int OfferSharedMemoryChannel(MPI_CONNECTION* connection, int* descriptors)
+{
+    SHARED_MEMORY_CHANNEL* channel = NULL;
+    bool reserved = false;
+
+    if ((!g_sharedMemoryTransport) || (NULL != connection->channel))
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_connectionsMutex);
+    if (g_serverActive && (g_numChannels < MAX_MPI_CHANNELS))
+    {
+        g_numChannels += 1;
+        reserved = true;
+    }
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    if (!reserved)
+    {
+        OsConfigLogInfo(GetPlatformLog(), "%s: shared memory channel declined for handle '%d', %d channels already open", MPI_OPEN_URI, connection->socketHandle, MAX_MPI_CHANNELS);
+        return 0;
+    }
+
+    // Requests are limited like on the socket, responses to what the client accepts on the socket
+    if ((NULL == (channel = (SHARED_MEMORY_CHANNEL*)calloc(1, sizeof(SHARED_MEMORY_CHANNEL)))) ||
+        (0 != CreateSharedMemoryChannel(channel, g_maxContentLength, HTTP_DEFAULT_MAX_CONTENT_LENGTH, GetPlatformLog())))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: failed to create shared memory channel for handle '%d'", MPI_OPEN_URI, connection->socketHandle);
+        FREE_MEMORY(channel);
+        ReleaseChannel();
+        return 0;
+    }
+
+    connection->channel = channel;
+
+    descriptors[0] = channel->memoryHandle;
+    descriptors[1] = channel->requestEvent;
+    descriptors[2] = channel->responseEvent;
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "%s: offering shared memory channel to handle '%d'", MPI_OPEN_URI, connection->socketHandle);
+    }
+
+    return SHARED_MEMORY_CHANNEL_DESCRIPTORS;
+}
+
+// Returns true when the connection stays open for more requests
+static bool HandleMpiRequest(MPI_CONNECTION* connection)
+{
+    const char* uri = connection->request.uri;
+    bool keepAlive = connection->request.keepAlive;
+    bool streamed = (0 == strcmp(uri, MPI_GET_REPORTED_STREAM_URI));
+    char* requestBody = NULL;
+    HTTP_STATUS status = HTTP_OK;
+    char* responseBody = NULL;
+    int responseSize = 0;
+    MPI_STREAM* stream = NULL;
+    int descriptors[SHARED_MEMORY_CHANNEL_DESCRIPTORS] = {0};
+    int numDescriptors = 0;
+
+    AreModulesLoadedAndLoadIfNot();
+
+    if (0 == strlen(uri))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to read request URI %d", connection->socketHandle);
+        status = HTTP_BAD_REQUEST;
+    }
+    else if (connection->request.chunked)
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: chunked request bodies are not supported", uri);
+        status = HTTP_BAD_REQUEST;
+    }
+
+    if (status == HTTP_OK)
+    {
+        requestBody = (connection->request.contentLength > 0) ? GetHttpBody(&connection->request) : NULL;
+
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogInfo(GetPlatformLog(), "%s: content-length %d, body, '%s'", uri, (int)connection->request.contentLength, requestBody);
+        }
+
+        if (!streamed)
+        {
+            status = HandleMpiCall(uri, requestBody, &responseBody, &responseSize, g_mpiCalls);
+
+            if ((HTTP_OK == status) && keepAlive && (0 == strcmp(uri, MPI_OPEN_URI)) && IsSharedMemoryRequested(requestBody, connection->request.contentLength))
+            {
+                numDescriptors = OfferSharedMemoryChannel(connection, descriptors);
             }
+        }
+        else if (NULL != (stream = (MPI_STREAM*)calloc(1, sizeof(MPI_STREAM))))
+        {
+            stream->connection = connection;
+            stream->keepAlive = keepAlive;
+
+            status = HandleMpiStreamCall(uri, requestBody, WriteToStream, stream, &responseBody, &responseSize, g_mpiCalls);
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "%s: failed to allocate memory for response stream", uri);
+            status = HTTP_INTERNAL_SERVER_ERROR;
+        }
+    }
+
+    // A malformed request leaves the connection in an unknown state, so it is not reused
+    keepAlive = keepAlive && (HTTP_BAD_REQUEST != status);
+
+    if ((NULL != stream) && (HTTP_OK == status))
+    {
+        if (!WriteStreamChunks(stream, NULL, 0, true))
+        {
+            OsConfigLogError(GetPlatformLog(), "%s: failed to write complete HTTP response stream", uri);
+            keepAlive = false;
+        }
+    }
+    else if ((NULL != stream) && stream->headerSent)
+    {
+        // The status was already sent, closing the connection before the last chunk tells the client that the response is incomplete
+        OsConfigLogError(GetPlatformLog(), "%s: response stream interrupted (%d)", uri, (int)status);
+        keepAlive = false;
+    }
+    else if (!WriteResponse(connection, uri, status, keepAlive, responseBody, responseSize, descriptors, numDescriptors))
+    {
+        keepAlive = false;
+    }
+
+    if (keepAlive)
+    {
+        // Keeps anything received after this request for the next one
+        ConsumeHttpMessage(&connection->request);
+        connection->lastActivity = time(NULL);
+    }
+
+    FREE_MEMORY(responseBody);
+    FREE_MEMORY(stream);
+
+    return keepAlive;
+}
+
+static bool EnqueueConnection(MPI_CONNECTION* connection)
+{
+    bool enqueued = false;
+
+    pthread_mutex_lock(&g_connectionsMutex);
+
+    if (g_serverActive)
+    {
+        connection->next = NULL;
+
+        if (NULL != g_lastPendingConnection)
+        {
+            g_lastPendingConnection->next = connection;
+        }
+        else
+        {
+            g_firstPendingConnection = connection;
+        }
+
+        g_lastPendingConnection = connection;
+        enqueued = true;
+
+        pthread_cond_signal(&g_connectionsEnqueued);
+    }
+
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    return enqueued;
+}
+
+static MPI_CONNECTION* DequeueConnection(void)
+{
+    MPI_CONNECTION* connection = NULL;
+
+    pthread_mutex_lock(&g_connectionsMutex);
+
+    while (g_serverActive && (NULL == g_firstPendingConnection))
+    {
+        pthread_cond_wait(&g_connectionsEnqueued, &g_connectionsMutex);
+    }
+
+    if (g_serverActive)
+    {
+        connection = g_firstPendingConnection;
+
+        if (NULL == (g_firstPendingConnection = connection->next))
+        {
+            g_lastPendingConnection = NULL;
+        }
+
+        connection->next = NULL;
+    }
+
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    return connection;
+}
+
+static void ReturnConnection(MPI_CONNECTION* connection)
+{
+    uint64_t wakeup = 1;
+    bool returned = false;
+
+    pthread_mutex_lock(&g_connectionsMutex);
+
+    if (g_serverActive)
+    {
+        connection->next = g_returnedConnections;
+        g_returnedConnections = connection;
+        returned = true;
+    }
+
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    if (returned)
+    {
+        UNUSED(write(g_wakeupfd, &wakeup, sizeof(wakeup)));
+    }
+    else
+    {
+        CloseConnection(connection);
+    }
+}
 
-            if (status == HTTP_OK)
+// Called with the error that the connection is dropped for, a client whose headers are too large is told so before the connection closes
+static void RejectConnection(MPI_CONNECTION* connection, int status)
+{
+    if (EMSGSIZE == status)
+    {
+        WriteResponse(connection, "", HTTP_REQUEST_HEADER_FIELDS_TOO_LARGE, false, NULL, 0, NULL, 0);
+    }
+
+    CloseConnection(connection);
+}
+
+// Returns 0 when the connection holds a complete request, EAGAIN while more data is expected, or an error when the connection must be dropped
+static int ReadFromConnection(MPI_CONNECTION* connection)
+{
+    size_t received = connection->request.received;
+    int status = ReadHttpMessageFromSocket(connection->socketHandle, &connection->request, GetPlatformLog());
+
+    if (connection->request.received != received)
+    {
+        connection->lastActivity = time(NULL);
+    }
+
+    return status;
+}
+
+// Returns false when the channel must be closed
+static bool HandleSharedMemoryRequest(MPI_CONNECTION* connection)
+{
+    char uri[HTTP_MAX_URI_LENGTH + 1] = {0};
+    char* requestBody = NULL;
+    size_t requestSize = 0;
+    char* responseBody = NULL;
+    int responseSize = 0;
+    HTTP_STATUS status = HTTP_OK;
+    int result = 0;
+
+    if (EAGAIN == (result = ReceiveSharedMemoryRequest(connection->channel, uri, &requestBody, &requestSize)))
+    {
+        return true;
+    }
+    else if (0 != result)
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to receive request from shared memory channel of handle '%d' (%d)", connection->socketHandle, result);
+        return false;
+    }
+
+    AreModulesLoadedAndLoadIfNot();
+
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "%s: shared memory request of %d bytes, body, '%s'", uri, (int)requestSize, requestBody);
+    }
+
+    // Streamed responses are only sent over the socket
+    if (0 == strcmp(uri, MPI_GET_REPORTED_STREAM_URI))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: not supported over shared memory", uri);
+        status = HTTP_NOT_FOUND;
+    }
+    else
+    {
+        status = HandleMpiCall(uri, requestBody, &responseBody, &responseSize, g_mpiCalls);
+    }
+
+    if (E2BIG == (result = PostSharedMemoryResponse(connection->channel, (int)status, responseBody, (responseSize > 0) ? (size_t)responseSize : 0)))
+    {
+        OsConfigLogError(GetPlatformLog(), "%s: response of %d bytes does not fit the shared memory channel of handle '%d'", uri, responseSize, connection->socketHandle);
+        result = PostSharedMemoryResponse(connection->channel, HTTP_INTERNAL_SERVER_ERROR, NULL, 0);
+    }
+
+    FREE_MEMORY(requestBody);
+    FREE_MEMORY(responseBody);
+
+    return (0 == result);
+}
+
+static void* MpiChannelWorker(void* arguments)
+{
+    MPI_CONNECTION* connection = (MPI_CONNECTION*)arguments;
+    struct pollfd descriptors[3] = {{0}};
+    bool active = true;
+    int status = 0;
+
+    descriptors[0].fd = connection->channel->requestEvent;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = connection->socketHandle;
+    descriptors[1].events = POLLIN;
+    descriptors[2].fd = g_stopChannelsfd;
+    descriptors[2].events = POLLIN;
+
+    while (active)
+    {
+        if (0 > poll(descriptors, ARRAY_SIZE(descriptors), -1))
+        {
+            active = (EINTR == errno);
+            continue;
+        }
+
+        if (0 != descriptors[2].revents)
+        {
+            break;
+        }
+
+        if (0 != descriptors[0].revents)
+        {
+            active = HandleSharedMemoryRequest(connection);
+        }
+
+        // Requests that do not fit the shared memory still come over the socket, the client closing the socket ends the channel
+        if (active && (0 != descriptors[1].revents))
+        {
+            if (0 == (status = ReadFromConnection(connection)))
             {
-                if (IsFullLoggingEnabled())
+                do
                 {
-                    OsConfigLogInfo(GetPlatformLog(), "%s: content-length %d, body, '%s'", uri, contentLength, requestBody);
-                }
-
-                status = HandleMpiCall(uri, requestBody, &responseBody, &responseSize, mpiCalls);
+                    active = HandleMpiRequest(connection);
+                } while (active && (0 == (status = ParseHttpMessage(&connection->request, GetPlatformLog()))));
             }
 
-            httpReason = HttpReasonAsString(status);
-            estimatedSize = strlen(responseFormat) + MAX_STATUS_CODE_LENGTH + strlen(httpReason) + MAX_CONTENTLENGTH_LENGTH + responseSize + 1;
+            active = active && (EAGAIN == status);
+        }
+    }
 
-            if (NULL != (buffer = (char*)malloc(estimatedSize)))
-            {
-                memset(buffer, 0, estimatedSize);
+    if (IsFullLoggingEnabled())
+    {
+        OsConfigLogInfo(GetPlatformLog(), "Closing shared memory channel of handle '%d'", connection->socketHandle);
+    }
 
-                snprintf(buffer, estimatedSize, responseFormat, (int)status, httpReason, responseSize, responseSize, (responseBody ? responseBody : ""));
-                actualSize = (int)strlen(buffer);
+    RejectConnection(connection, status);
 
-                bytes = write(socketHandle, buffer, actualSize);
+    return NULL;
+}
 
-                if (bytes != actualSize)
-                {
-                    OsConfigLogError(GetPlatformLog(), "%s: failed to write complete HTTP response, %d bytes of %d", uri, (int)bytes, actualSize);
-                }
+static void StartChannel(MPI_CONNECTION* connection)
+{
+    pthread_attr_t attributes;
+    pthread_t thread = 0;
+    bool started = false;
+
+    if (0 == pthread_attr_init(&attributes))
+    {
+        started = (0 == pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED)) && (0 == pthread_create(&thread, &attributes, MpiChannelWorker, connection));
+        pthread_attr_destroy(&attributes);
+    }
+
+    if (!started)
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to start shared memory channel thread for handle '%d'", connection->socketHandle);
+        CloseConnection(connection);
+    }
+}
+
+static void ServeConnection(MPI_CONNECTION* connection)
+{
+    bool keepAlive = false;
+    int status = 0;
+
+    // Requests pipelined behind the first one are served in order before the connection goes back to the event loop
+    do
+    {
+        keepAlive = HandleMpiRequest(connection);
+    } while (keepAlive && (0 == (status = ParseHttpMessage(&connection->request, GetPlatformLog()))));
+
+    if (keepAlive && (EAGAIN == status))
+    {
+        if (NULL != connection->channel)
+        {
+            StartChannel(connection);
+        }
+        else
+        {
+            ReturnConnection(connection);
+        }
+    }
+    else
+    {
+        RejectConnection(connection, keepAlive ? status : 0);
+    }
+}
+
+static void* MpiServerWorker(void* arguments)
+{
+    MPI_CONNECTION* connection = NULL;
+
+    UNUSED(arguments);
+
+    while (NULL != (connection = DequeueConnection()))
+    {
+        ServeConnection(connection);
+    }
+
+    return NULL;
+}
+
+static void RemoveConnection(MPI_CONNECTION* connection)
+{
+    MPI_CONNECTION** current = &g_connections;
+
+    while (NULL != *current)
+    {
+        if (connection == *current)
+        {
+            *current = connection->next;
+            connection->next = NULL;
+            g_numConnections -= 1;
+            break;
+        }
+
+        current = &((*current)->next);
+    }
+
+    epoll_ctl(g_epollfd, EPOLL_CTL_DEL, connection->socketHandle, NULL);
+}
+
+static bool WatchConnection(MPI_CONNECTION* connection)
+{
+    struct epoll_event event = {0};
+
+    event.events = EPOLLIN;
+    event.data.ptr = connection;
+
+    if (0 != epoll_ctl(g_epollfd, EPOLL_CTL_ADD, connection->socketHandle, &event))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to watch connection on socket '%s', handle '%d' (%d)", g_mpiSocket, connection->socketHandle, errno);
+        return false;
+    }
+
+    connection->next = g_connections;
+    g_connections = connection;
+    g_numConnections += 1;
+
+    return true;
+}
+
+static void AcceptConnections(void)
+{
+    MPI_CONNECTION* connection = NULL;
+    int socketHandle = -1;
+
+    while (0 <= (socketHandle = accept(g_socketfd, NULL, NULL)))
+    {
+        if (g_numConnections >= MAX_MPI_CONNECTIONS)
+        {
+            OsConfigLogError(GetPlatformLog(), "Too many connections on socket '%s' (%d), rejecting handle '%d'", g_mpiSocket, g_numConnections, socketHandle);
+            close(socketHandle);
+            continue;
+        }
+
+        if ((0 != fcntl(socketHandle, F_SETFL, fcntl(socketHandle, F_GETFL) | O_NONBLOCK)) ||
+            (NULL == (connection = (MPI_CONNECTION*)calloc(1, sizeof(MPI_CONNECTION)))))
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to set up connection on socket '%s', handle '%d'", g_mpiSocket, socketHandle);
+            close(socketHandle);
+            continue;
+        }
+
+        connection->socketHandle = socketHandle;
+        connection->lastActivity = time(NULL);
+        InitHttpParser(&connection->request, g_maxContentLength);
+
+        if (!WatchConnection(connection))
+        {
+            CloseConnection(connection);
+            continue;
+        }
+
+        if (IsFullLoggingEnabled())
+        {
+            OsConfigLogInfo(GetPlatformLog(), "Accepted connection: path %s, handle '%d'", g_mpiSocket, socketHandle);
+        }
+    }
+
+    if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to accept connection on socket '%s' (%d)", g_mpiSocket, errno);
+    }
+}
+
+static void WatchReturnedConnections(void)
+{
+    MPI_CONNECTION* connection = NULL;
+    MPI_CONNECTION* returned = NULL;
+
+    pthread_mutex_lock(&g_connectionsMutex);
+    returned = g_returnedConnections;
+    g_returnedConnections = NULL;
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    while (NULL != (connection = returned))
+    {
+        returned = connection->next;
+
+        if (!WatchConnection(connection))
+        {
+            CloseConnection(connection);
+        }
+    }
+}
+
+// Returns the milliseconds until the first of the remaining connections times out, -1 when there are none
+static int CloseIdleConnections(void)
+{
+    MPI_CONNECTION** current = &g_connections;
+    MPI_CONNECTION* connection = NULL;
+    time_t now = time(NULL);
+    time_t timeout = 0;
+    int remainingMilliseconds = 0;
+    int waitMilliseconds = -1;
+
+    while (NULL != (connection = *current))
+    {
+        // A connection between requests can stay idle longer than one stalled in the middle of a request
+        timeout = (0 == connection->request.received) ? MPI_KEEP_ALIVE_TIMEOUT_SECONDS : MPI_CONNECTION_TIMEOUT_SECONDS;
+
+        if ((now - connection->lastActivity) >= timeout)
+        {
+            if (connection->request.received > 0)
+            {
+                OsConfigLogError(GetPlatformLog(), "Closing connection on handle '%d' stalled for %d seconds with a partial request", connection->socketHandle, (int)(now - connection->lastActivity));
             }
-            else
+            else if (IsFullLoggingEnabled())
             {
-                OsConfigLogError(GetPlatformLog(), "%s: failed to allocate memory for HTTP response, %d bytes of %d", uri, 0, estimatedSize);
+                OsConfigLogInfo(GetPlatformLog(), "Closing connection on handle '%d' idle for %d seconds", connection->socketHandle, (int)(now - connection->lastActivity));
             }
 
-            if (0 != close(socketHandle))
+            *current = connection->next;
+            g_numConnections -= 1;
+            epoll_ctl(g_epollfd, EPOLL_CTL_DEL, connection->socketHandle, NULL);
+            CloseConnection(connection);
+        }
+        else
+        {
+            // A clock set back counts as no time gone by
+            remainingMilliseconds = (int)((now < connection->lastActivity) ? timeout : (timeout - (now - connection->lastActivity))) * 1000;
+
+            if ((0 > waitMilliseconds) || (remainingMilliseconds < waitMilliseconds))
             {
-                OsConfigLogError(GetPlatformLog(), "Failed to close socket: path %s, handle '%d'", g_socketaddr.sun_path, socketHandle);
+                waitMilliseconds = remainingMilliseconds;
             }
 
-            if (IsFullLoggingEnabled())
+            current = &(connection->next);
+        }
+    }
+
+    return waitMilliseconds;
+}
+
+static void* MpiServerEventLoop(void* arguments)
+{
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    MPI_CONNECTION* connection = NULL;
+    uint64_t wakeups = 0;
+    int timeoutMilliseconds = -1;
+    int numEvents = 0;
+    int status = 0;
+    int i = 0;
+
+    UNUSED(arguments);
+
+    while (g_serverActive)
+    {
+        // The loop wakes up when the first connection it watches is due to time out, without connections it sleeps until an event comes in
+        if (0 > (numEvents = epoll_wait(g_epollfd, events, MAX_EPOLL_EVENTS, timeoutMilliseconds)))
+        {
+            if (EINTR != errno)
             {
-                OsConfigLogInfo(GetPlatformLog(), "Closed connection: path %s, handle '%d'", g_socketaddr.sun_path, socketHandle);
+                OsConfigLogError(GetPlatformLog(), "Failed waiting for events on socket '%s' (%d)", g_mpiSocket, errno);
+                break;
             }
+            numEvents = 0;
+        }
 
-            contentLength = 0;
-            responseSize = 0;
-            actualSize = 0;
-            estimatedSize = 0;
+        for (i = 0; i < numEvents; i++)
+        {
+            if (&g_socketfd == events[i].data.ptr)
+            {
+                AcceptConnections();
+            }
+            else if (&g_wakeupfd == events[i].data.ptr)
+            {
+                UNUSED(read(g_wakeupfd, &wakeups, sizeof(wakeups)));
+                WatchReturnedConnections();
+            }
+            else
+            {
+                connection = (MPI_CONNECTION*)events[i].data.ptr;
 
-            FREE_MEMORY(requestBody);
-            FREE_MEMORY(responseBody);
-            FREE_MEMORY(httpReason);
-            FREE_MEMORY(buffer);
-            FREE_MEMORY(uri);
+                if (0 == (status = ReadFromConnection(connection)))
+                {
+                    RemoveConnection(connection);
 
-            SleepMilliseconds(MPI_WORKER_SLEEP);
+                    if (!EnqueueConnection(connection))
+                    {
+                        CloseConnection(connection);
+                    }
+                }
+                else if (EAGAIN != status)
+                {
+                    RemoveConnection(connection);
+                    RejectConnection(connection, status);
+                }
+            }
         }
+
+        timeoutMilliseconds = CloseIdleConnections();
     }
 
     return NULL;
 }
 
+static int WatchDescriptor(int descriptor, void* data)
+{
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = data;
+    return epoll_ctl(g_epollfd, EPOLL_CTL_ADD, descriptor, &event);
+}
+
+static void StartMpiServerWorkers(void)
+{
+    char* jsonConfiguration = LoadStringFromFile(g_configFile, false, GetPlatformLog());
+    int numWorkers = GetMpiServerWorkersFromJsonConfig(jsonConfiguration, GetPlatformLog());
+    int i = 0;
+
+    g_maxContentLength = (size_t)GetMaxHttpContentLengthFromJsonConfig(jsonConfiguration, GetPlatformLog());
+    g_sharedMemoryTransport = (1 == GetSharedMemoryTransportFromJsonConfig(jsonConfiguration, GetPlatformLog()));
+    FREE_MEMORY(jsonConfiguration);
+
+    if ((0 != fcntl(g_socketfd, F_SETFL, fcntl(g_socketfd, F_GETFL) | O_NONBLOCK)) ||
+        (0 > (g_epollfd = epoll_create1(EPOLL_CLOEXEC))) ||
+        (0 > (g_wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) ||
+        (0 > (g_stopChannelsfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) ||
+        (0 != WatchDescriptor(g_socketfd, &g_socketfd)) ||
+        (0 != WatchDescriptor(g_wakeupfd, &g_wakeupfd)))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to set up the event loop for socket '%s' (%d)", g_mpiSocket, errno);
+        return;
+    }
+
+    if (NULL == (g_mpiServerWorkers = (pthread_t*)calloc(numWorkers, sizeof(pthread_t))))
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to allocate %d MPI request workers", numWorkers);
+        return;
+    }
+
+    g_serverActive = true;
+
+    for (i = 0; i < numWorkers; i++)
+    {
+        if (0 == pthread_create(&g_mpiServerWorkers[g_numMpiServerWorkers], NULL, MpiServerWorker, NULL))
+        {
+            g_numMpiServerWorkers += 1;
+        }
+        else
+        {
+            OsConfigLogError(GetPlatformLog(), "Failed to start MPI request worker %d of %d", i + 1, numWorkers);
+        }
+    }
+
+    if ((g_numMpiServerWorkers > 0) && (0 == pthread_create(&g_mpiServerEventLoop, NULL, MpiServerEventLoop, NULL)))
+    {
+        g_eventLoopActive = true;
+        OsConfigLogInfo(GetPlatformLog(), "Serving MPI requests with %d workers", g_numMpiServerWorkers);
+    }
+    else
+    {
+        OsConfigLogError(GetPlatformLog(), "Failed to start the MPI server event loop");
+    }
+}
+
+static void StopMpiServerWorkers(void)
+{
+    MPI_CONNECTION* connection = NULL;
+    uint64_t wakeup = 1;
+    int i = 0;
+
+    pthread_mutex_lock(&g_connectionsMutex);
+    g_serverActive = false;
+    pthread_cond_broadcast(&g_connectionsEnqueued);
+    pthread_mutex_unlock(&g_connectionsMutex);
+
+    if (g_eventLoopActive)
+    {
+        UNUSED(write(g_wakeupfd, &wakeup, sizeof(wakeup)));
+        pthread_join(g_mpiServerEventLoop, NULL);
+        g_eventLoopActive = false;
+    }
+
+    for (i = 0; i < g_numMpiServerWorkers; i++)
+    {
+        pthread_join(g_mpiServerWorkers[i], NULL);
+    }
+
+    // The stop event is never read, so it stays signaled for every channel thread until all have closed their channels
+    if (0 <= g_stopChannelsfd)
+    {
+        UNUSED(write(g_stopChannelsfd, &wakeup, sizeof(wakeup)));
+
+        pthread_mutex_lock(&g_connectionsMutex);
+        while (g_numChannels > 0)
+        {
+            pthread_cond_wait(&g_channelsClosed, &g_connectionsMutex);
+        }
+        pthread_mutex_unlock(&g_connectionsMutex);
+
+        close(g_stopChannelsfd);
+        g_stopChannelsfd = -1;
+    }
+
+    g_numMpiServerWorkers = 0;
+    FREE_MEMORY(g_mpiServerWorkers);
+
+    // Drop connections still being received, waiting for a worker or idle between requests
+    while (NULL != (connection = g_connections))
+    {
+        g_connections = connection->next;
+        CloseConnection(connection);
+    }
+    g_numConnections = 0;
+
+    while (NULL != (connection = g_firstPendingConnection))
+    {
+        g_firstPendingConnection = connection->next;
+        CloseConnection(connection);
+    }
+    g_lastPendingConnection = NULL;
+
+    while (NULL != (connection = g_returnedConnections))
+    {
+        g_returnedConnections = connection->next;
+        CloseConnection(connection);
+    }
+
+    if (0 <= g_wakeupfd)
+    {
+        close(g_wakeupfd);
+        g_wakeupfd = -1;
+    }
+
+    if (0 <= g_epollfd)
+    {
+        close(g_epollfd);
+        g_epollfd = -1;
+    }
+}
+
 void MpiServerInitialize(void)
 {
     struct stat st;
@@ -609,8 +2014,7 @@ void MpiServerInitialize(void)
             {
                 OsConfigLogInfo(GetPlatformLog(), "Listening on socket '%s'", g_mpiSocket);
 
-                g_serverActive = true;
-                g_mpiServerWorker = pthread_create(&g_mpiServerWorker, NULL, MpiServerWorker, NULL);
+                StartMpiServerWorkers();
             }
             else
             {
@@ -630,11 +2034,10 @@ void MpiServerInitialize(void)
 
 void MpiServerShutdown(void)
 {
-    g_serverActive = false;
-    pthread_join(g_mpiServerWorker, NULL);
+    StopMpiServerWorkers();
 
     UnloadModules();
 
     close(g_socketfd);
     unlink(g_mpiSocket);
-}
\ No newline at end of file
+}
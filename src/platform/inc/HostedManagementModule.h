@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef HOSTEDMANAGEMENTMODULE_H
+#define HOSTEDMANAGEMENTMODULE_H
+
+// A module run in a host process of its own (osconfig-modulehost) instead of being loaded into the platform, so that a module that crashes
+// or hangs does not take the platform down with it. The MMI calls are sent to the host over a socket pair (see ModuleHostProtocol.h).
+// A host that exits, or that does not answer within the call timeout and is killed for it, fails the call in progress and is started again
+// with the sessions reopened on the next call
+class HostedManagementModule : public ManagementModule
+{
+public:
+    HostedManagementModule(const std::string path, const std::string hostPath);
+    ~HostedManagementModule();
+
+    int Load() override;
+
+    // -1 when the host is not running
+    pid_t GetHostPid();
+
+protected:
+    const std::string m_hostPath;
+    pid_t m_hostPid;
+    int m_hostSocket;
+
+    int StartHost();
+
+    // Closes the socket of the host and waits for it to exit, the host is killed when it does not exit right away or when kill is set
+    void StopHost(bool kill);
+
+    // Sends the request to the host and receives its response. When the host is gone or does not answer in time it is stopped,
+    // the sessions are suspended and EIO or ETIME is returned
+    int Call(const ModuleHostFrame& request, ModuleHostFrame& response);
+
+    void UnloadModule() override;
+    bool IsLoaded() const override;
+    void CheckLoaded() override;
+
+    int CallMmiGetInfo(const char* clientName, MMI_JSON_STRING* payload, int* payloadSizeBytes) override;
+    MMI_HANDLE CallMmiOpen(const char* clientName, unsigned int maxPayloadSizeBytes) override;
+    void CallMmiClose(MMI_HANDLE handle) override;
+    int CallMmiSet(MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes) override;
+    int CallMmiGet(MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING* payload, int* payloadSizeBytes) override;
+};
+
+#endif // HOSTEDMANAGEMENTMODULE_H
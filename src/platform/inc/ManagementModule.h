@@ -12,6 +12,46 @@ using Mmi_Set = int (*)(MMI_HANDLE, const char*, const char*, const MMI_JSON_STR
 using Mmi_Get = int (*)(MMI_HANDLE, const char*, const char*, MMI_JSON_STRING*, int*);
 using Mmi_Close = void (*)(MMI_HANDLE);
 
+class MmiSession;
+class MimValidator;
+
+// Runs the MMI calls into one module on a thread of its own, in the order they come in, so that a caller can stop waiting for a call
+// that does not return. The thread owns the calls it is given, and what they captured, until it has run them
+class MmiExecutor
+{
+public:
+    MmiExecutor();
+    ~MmiExecutor();
+
+    // Returns false when the call did not complete within the timeout, it still runs to completion later
+    bool Run(const std::function<void()>& call, std::chrono::milliseconds timeout);
+
+    // Queues the call without waiting for it
+    void Post(const std::function<void()>& call);
+
+    // True while a call is queued or running
+    bool IsBusy();
+
+private:
+    struct Calls
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::queue<std::function<void()>> queue;
+        unsigned long long queued = 0;
+        unsigned long long completed = 0;
+        bool stop = false;
+    };
+
+    std::shared_ptr<Calls> m_calls;
+    std::thread m_thread;
+
+    // Returns the number of the call, 0 when the executor thread could not be started
+    unsigned long long Queue(const std::function<void()>& call);
+
+    static void Execute(std::shared_ptr<Calls> calls);
+};
+
 class ManagementModule
 {
 public:
@@ -62,6 +102,9 @@ public:
         std::string projectUri;
         unsigned int userAccount;
 
+        // Seconds for which a reported value can be cached, by component name and then object name
+        std::map<std::string, std::map<std::string, unsigned int>> reportedCacheSeconds;
+
         static int Deserialize(const rapidjson::Value& object, Info& info);
     };
 
@@ -70,10 +113,45 @@ public:
     virtual ~ManagementModule();
 
     virtual int Load();
-    virtual void Unload();
+
+    // Waits for the call in progress into the module to return before unloading it
+    void Unload();
+
+    // Closes the MMI sessions of a module with a Short lifetime not called for idleSeconds and unloads it, the module is loaded
+    // again and its sessions reopened on the next call. Returns true if the module was unloaded
+    bool UnloadIfIdle(unsigned int idleSeconds);
 
     Info GetInfo() const;
 
+    // The MmiGetInfo payload that the info comes from
+    std::string GetInfoJson() const;
+
+    // 0 when the value of the object is not to be cached
+    unsigned int GetReportedCacheSeconds(const std::string& componentName, const std::string& objectName) const;
+
+    // Payloads are validated against the MIM models loaded into the validator, or against the generic MIM object schema without one
+    void SetMimValidator(std::shared_ptr<const MimValidator> mimValidator);
+
+    // With a timeout MmiSet and MmiGet run on the executor of the module and return ETIME when the module does not return in time.
+    // The module is then degraded: calls into it fail with ETIME right away until the call that timed out returns. 0 for no timeout
+    void SetCallTimeout(unsigned int milliseconds);
+    bool IsDegraded();
+
+    // The number of times the module was loaded again after being unloaded, a module loaded again has lost the state that was set into it
+    unsigned int GetReloads() const;
+
+    // How long the MMI call in progress into the module has been running, 0 when there is none
+    std::chrono::milliseconds GetCallDuration() const;
+
+    // Change in the resident memory of the process across the last load and the last unload of the module, in KB. Measured on the whole
+    // process, so other threads can add to it, and without the host process of a module run in one
+    long GetLoadedKilobytes() const;
+    long GetUnloadedKilobytes() const;
+
+    // Called with the info of the module, and with m_mmiMutex held, each time the module is loaded again after being unloaded. The module
+    // can come back as a different version implementing other components
+    void SetReloadCallback(const std::function<void(const Info&)>& callback);
+
 protected:
     const std::string m_modulePath;
 
@@ -89,12 +167,66 @@ protected:
     Mmi_Free m_mmiFree;
 
     Info m_info;
+    std::string m_infoJson;
+
+    std::shared_ptr<const MimValidator> m_mimValidator;
+
+    unsigned int m_callTimeoutMilliseconds;
+    MmiExecutor m_executor;
+
+    // Set when a call timed out, cleared by the first call after that call returned
+    std::atomic<bool> m_degraded;
+
+    // Serializes MMI calls into this module, calls into different modules can run in parallel
+    std::mutex m_mmiMutex;
+
+    // The MMI sessions open on this module and the time of the last call into it, guarded by m_mmiMutex
+    std::set<MmiSession*> m_mmiSessions;
+    std::chrono::steady_clock::time_point m_lastCallTime;
+
+    // Start of the MMI call in progress in steady clock ticks, 0 when there is none
+    std::atomic<std::chrono::steady_clock::rep> m_callStartTime;
+
+    // Set when the module was unloaded with sessions still open, it is loaded again on the next call
+    bool m_unloaded;
+    std::atomic<unsigned int> m_reloads;
+    std::function<void(const Info&)> m_reloadCallback;
+
+    std::atomic<long> m_loadedKilobytes;
+    std::atomic<long> m_unloadedKilobytes;
+
+    int Reload();
+
+    // Called with m_mmiMutex held
+    virtual void UnloadModule();
+
+    // Called with m_mmiMutex held around each MmiSet and MmiGet, for GetCallDuration
+    void SetCallInProgress(bool inProgress);
+
+    // Gets, checks and keeps the info of the module, once its MMI can be called
+    int LoadInfo();
+
+    // Called with m_mmiMutex held, marks the module unloaded and its open sessions to be reopened on the next call. The sessions are closed first
+    // unless they went away with the module
+    void SuspendSessions(bool close);
+
+    virtual bool IsLoaded() const;
+
+    // Called with m_mmiMutex held before each call, for a module that can go away by itself to suspend its sessions when it did
+    virtual void CheckLoaded();
+
+    bool IsValidPayload(const char* componentName, const char* objectName, const char* payload, int payloadSizeBytes) const;
+
+    int CallWithTimeout(const std::function<void()>& call, const std::string& function, const char* componentName, const char* objectName);
+    int CallMmiSetWithTimeout(MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes);
+    int CallMmiGetWithTimeout(MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING* payload, int* payloadSizeBytes);
 
     virtual int CallMmiGetInfo(const char* clientName, MMI_JSON_STRING* payload, int* payloadSizeBytes);
     virtual MMI_HANDLE CallMmiOpen(const char* componentName, unsigned int maxPayloadSizeBytes);
     virtual void CallMmiClose(MMI_HANDLE handle);
     virtual int CallMmiSet(MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes);
     virtual int CallMmiGet(MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING *payload, int *payloadSizeBytes);
+    virtual void CallMmiFree(MMI_JSON_STRING payload);
 
     friend class MmiSession;
 };
@@ -109,15 +241,28 @@ public:
     void Close();
 
     int Set(const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes);
-    int Get(const char* componentName, const char* objectName, MMI_JSON_STRING *payload, int *payloadSizeBytes);
+    // When given, started is called once the calls of other sessions into the module returned, right before this call is made
+    int Get(const char* componentName, const char* objectName, MMI_JSON_STRING *payload, int *payloadSizeBytes, const std::function<void()>& started = nullptr);
+    // Frees a payload returned by Get with the MmiFree of the module
+    void Free(MMI_JSON_STRING payload);
 
     ManagementModule::Info GetInfo();
+    unsigned int GetReportedCacheSeconds(const std::string& componentName, const std::string& objectName);
+    unsigned int GetReloads();
+    std::chrono::milliseconds GetCallDuration();
 private:
     const std::string m_clientName;
     const unsigned int m_maxPayloadSizeBytes;
     std::shared_ptr<ManagementModule> m_module;
 
     MMI_HANDLE m_mmiHandle;
+
+    // Set when the module was unloaded with this session open
+    bool m_reopen;
+
+    int Resume();
+
+    friend class ManagementModule;
 };
 
 #endif // MANAGEMENTMODULE_H
\ No newline at end of file
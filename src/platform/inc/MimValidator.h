@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef MIMVALIDATOR_H
+#define MIMVALIDATOR_H
+
+// Validates MIM object payloads against the type that the MIM models (see src/modules/mim) declare for each component and object.
+// The models are compiled once when loaded, payloads are then checked while they are parsed (SAX), without building a document
+class MimValidator
+{
+public:
+    struct Schema
+    {
+        enum Type
+        {
+            String,
+            Integer,
+            Boolean,
+            Array,
+            Object,
+            Map
+        };
+
+        Type type;
+
+        // The allowed values of an enum (string or integer), any value when empty
+        std::set<std::string> stringValues;
+        std::set<int64_t> integerValues;
+
+        // The elements of an array or the values of a map
+        std::shared_ptr<const Schema> element;
+
+        // The fields of an object
+        std::map<std::string, std::shared_ptr<const Schema>> fields;
+    };
+
+    // Loads all the MIM models (*.json) in a directory, returns the number of models loaded
+    int LoadModels(const std::string& directory);
+    int LoadModel(const char* modelJson, size_t modelJsonSizeBytes);
+
+    bool HasObject(const std::string& componentName, const std::string& objectName) const;
+
+    // Objects not declared in the loaded models are validated against the generic MIM object schema (see IsValidMimObjectPayload)
+    bool IsValid(const std::string& componentName, const std::string& objectName, const char* payload, int payloadSizeBytes) const;
+
+private:
+    std::map<std::string, std::map<std::string, std::shared_ptr<const Schema>>> m_objects;
+
+    static std::shared_ptr<const Schema> CompileSchema(const rapidjson::Value& schema);
+};
+
+#endif // MIMVALIDATOR_H
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef MODULEHOSTPROTOCOL_H
+#define MODULEHOSTPROTOCOL_H
+
+// The platform talks to each module host (osconfig-modulehost) over a socket pair. Each request gets one response, in order.
+// A frame is a 32-bit length followed by its fields, the first field of a request is the ModuleHostMessage.
+// Fields are 32-bit integers, or strings given as a 32-bit length (-1 for a null string) followed by the bytes of the string
+enum class ModuleHostMessage : int
+{
+    // (clientName) -> (status, payload)
+    GetInfo = 1,
+    // (clientName, maxPayloadSizeBytes) -> (session, 0 when MmiOpen failed)
+    Open = 2,
+    // (session) -> ()
+    Close = 3,
+    // (session, componentName, objectName, payload) -> (status)
+    Set = 4,
+    // (session, componentName, objectName) -> (status, payload)
+    Get = 5
+};
+
+class ModuleHostFrame
+{
+public:
+    void AddInteger(int value);
+    void AddString(const char* value, int length);
+    void AddString(const char* value);
+
+    // Fields are read in the order they were added, these return false when the frame has no such field left
+    bool GetInteger(int& value);
+    bool GetString(std::string& value, bool& isNull);
+    bool GetString(std::string& value);
+
+    // Return 0, EPIPE when the other end is gone, ETIME when the frame did not come (or could not be sent) within the timeout, or errno.
+    // A timeout of 0 waits for as long as it takes
+    int Send(int socket, unsigned int timeoutMilliseconds = 0) const;
+    int Receive(int socket, unsigned int timeoutMilliseconds = 0);
+
+private:
+    std::string m_data;
+    size_t m_position = 0;
+};
+
+#endif // MODULEHOSTPROTOCOL_H
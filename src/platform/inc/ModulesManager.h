@@ -4,26 +4,160 @@
 #ifndef MODULESMANAGER_H
 #define MODULESMANAGER_H
 
+// Runs the MMI calls that the modules manager makes for a request on threads that it owns. Tasks posted with the same key (the name of
+// a module) run one after the other in the order they were posted, tasks with different keys run at the same time. A thread is started
+// only when a task is ready and no thread is free, so a module that does not return holds on to one thread however often it is called
+class WorkerPool
+{
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    void Post(const std::string& key, const std::function<void()>& task);
+
+    // Waits for the tasks posted so far to complete
+    void Drain();
+
+private:
+    struct Tasks
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<std::string, std::queue<std::function<void()>>> queues;
+
+        // Keys with tasks queued and none running, in the order they became ready
+        std::queue<std::string> ready;
+        size_t pending = 0;
+        size_t idle = 0;
+        bool stop = false;
+    };
+
+    std::shared_ptr<Tasks> m_tasks;
+    std::vector<std::thread> m_threads;
+
+    // Runs ready tasks until stopped, or until none is ready when wait is not set
+    static void Work(std::shared_ptr<Tasks> tasks, bool wait);
+};
+
 class ModulesManager
 {
 public:
     ModulesManager();
     ~ModulesManager();
 
-    int LoadModules(std::string modulePath, std::string configJson);
+    // The module cache keeps the info of the module files, so that module versions superseded by newer ones are not loaded
+    int LoadModules(std::string modulePath, std::string configJson, std::string cachePath = "");
     void UnloadModules();
 
+    // Unloads the modules with a Short lifetime that were not called for idleSeconds, these load again on their next call
+    void UnloadIdleModules(unsigned int idleSeconds);
+
+    // Reported objects that a module does not return within this time are left out of the reported configuration, 0 for no limit
+    void SetReportedObjectTimeout(unsigned int milliseconds);
+
+    // The reported configuration is compact unless pretty printing is requested
+    void SetPrettyPrintReported(bool prettyPrint);
+
+    // MpiSetDesired applies the components of different modules at the same time, except for the components listed together in one of the groups.
+    // These are applied one after the other (in the order of the desired payload), for components that depend on each other
+    void SetParallelDesired(bool parallel, const std::vector<std::vector<std::string>>& sequentialComponents = {});
+
+    // MMI calls into a module that do not return within its timeout fail with ETIME (see ManagementModule::SetCallTimeout), 0 for no timeout.
+    // Modules not named in moduleMilliseconds get the default, applies to the modules loaded after this is set
+    void SetModuleCallTimeout(unsigned int milliseconds, const std::map<std::string, unsigned int>& moduleMilliseconds = {});
+
+    // With a host path each module is run in a host process of its own (see HostedManagementModule), empty to load the modules into this process.
+    // Applies to the modules loaded after this is set
+    void SetModuleHost(const std::string& hostPath);
+
 protected:
     std::map<std::string, std::vector<std::string>> m_reportedComponents;
-    std::map<std::string, std::string> m_moduleComponentName;
     std::map<std::string, std::shared_ptr<ManagementModule>> m_modules;
 
+    // Name of the module implementing each component, changes when a module reloaded on demand comes back with other components
+    std::map<std::string, std::string> m_moduleComponentName;
+    std::mutex m_moduleComponentNameMutex;
+    unsigned int m_reportedObjectTimeoutMilliseconds;
+    bool m_prettyPrintReported;
+    bool m_parallelDesired;
+    std::map<std::string, size_t> m_sequentialDesiredGroups;
+    unsigned int m_moduleCallTimeoutMilliseconds;
+    std::map<std::string, unsigned int> m_moduleCallTimeouts;
+    std::string m_moduleHostPath;
+
+    // Drained before the modules are unloaded, so that no call into a module is left running when it goes away
+    WorkerPool m_workers;
+
+    struct ReportedCacheEntry
+    {
+        std::string payload;
+        std::chrono::steady_clock::time_point expiryTime;
+    };
+
+    // Values of reported objects by component and object name, for as long as their module declared in MmiGetInfo (ReportedCacheSeconds).
+    // The generation changes each time values are dropped, so that a value read from a module before that is not cached after it
+    std::map<std::pair<std::string, std::string>, ReportedCacheEntry> m_reportedCache;
+    unsigned long long m_reportedCacheGeneration;
+    std::mutex m_reportedCacheMutex;
+
+    bool GetCachedReported(const std::string& componentName, const std::string& objectName, std::string& payload);
+    void CacheReported(const std::string& componentName, const std::string& objectName, const std::string& payload, unsigned int cacheSeconds, unsigned long long generation);
+    unsigned long long GetReportedCacheGeneration();
+    void InvalidateReportedCache(const std::string& componentName);
+
+    struct ReportedObjectVersion
+    {
+        size_t hash;
+        unsigned long long version;
+        unsigned long long read;
+        bool removed;
+    };
+
+    // Content hash of each reported object and the version at which it last changed, for MpiGetReportedChanges.
+    // Versions start from the time the platform started (in microseconds) and move past all of the current ones when the modules are unloaded,
+    // so a version handed out before either of these is older than the base version and gets the full reported configuration.
+    // Objects are read from the modules without the lock, each read is numbered so that a value read earlier does not replace a later one.
+    // An object no longer read stays in the map as removed (with the version at which it was removed) until the modules are unloaded
+    std::map<std::pair<std::string, std::string>, ReportedObjectVersion> m_reportedVersions;
+    unsigned long long m_reportedVersion;
+    unsigned long long m_reportedBaseVersion;
+    unsigned long long m_reportedReads;
+    std::mutex m_reportedVersionsMutex;
+
+    // Hash of the desired value last set successfully through MpiSetDesired for each component and object, unchanged values are not set again.
+    // Dropped for an object set with MpiSet and for all objects of a module that gets unloaded, since that module could have lost its state
+    std::map<std::pair<std::string, std::string>, size_t> m_desiredHashes;
+    std::map<std::string, unsigned int> m_desiredReloads;
+    std::mutex m_desiredHashesMutex;
+
+    bool IsDesiredUnchanged(const std::string& componentName, const std::string& objectName, size_t hash);
+    void SetDesiredHash(const std::string& componentName, const std::string& objectName, size_t hash);
+    void ForgetDesired(const std::string& componentName, const std::string& objectName = "");
+    void ForgetDesiredIfReloaded(const std::string& componentName, unsigned int reloads);
+
     int SetReportedObjects(const std::string& configJson);
+    std::shared_ptr<ManagementModule> CreateModule(const std::string& path);
     void RegisterModuleComponents(const std::string& moduleName, const std::vector<std::string>& components, bool replace = false);
+    void UpdateModuleComponents(const std::string& moduleName, const std::vector<std::string>& components);
+
+    // Keeps the components registered to the module up to date when it is loaded again after being unloaded
+    void FollowModuleReloads(const std::string& moduleName, std::shared_ptr<ManagementModule> module);
+
+    // Empty when no module implements the component
+    std::string GetModuleName(const std::string& componentName);
 
     friend class MpiSession;
 };
 
+struct ReportedObject
+{
+    std::string componentName;
+    std::string objectName;
+    std::shared_ptr<MmiSession> module;
+    int status = MMI_OK;
+    std::string payload;
+};
+
 class MpiSession
 {
 public:
@@ -32,25 +166,41 @@ public:
 
     char* GetUuid();
 
+    // Reads reported values from the modules even when cached
+    void SetReportedCacheBypass(bool bypass);
+
     int Open();
     void Close();
 
     int Set(const char* componentName, const char* objectName, const MPI_JSON_STRING payload, const int payloadSizeBytes);
     int Get(const char* componentName, const char* objectName, MPI_JSON_STRING* payload, int* payloadSizeBytes);
-    int SetDesired(const MPI_JSON_STRING payload, const int payloadSizeBytes);
+    // Objects whose desired value did not change since it was last set are skipped, unless reapply is requested
+    int SetDesired(const MPI_JSON_STRING payload, const int payloadSizeBytes, bool reapply = false);
     int GetReported(MPI_JSON_STRING* payload, int* payloadSizeBytes);
+    int GetReportedStream(MPI_WRITE_CALLBACK writeCallback, void* context);
+
+    // Returns the reported objects that changed after the given version together with the current version, {"Reported": {...}, "Version": n, "Full": false}.
+    // All objects are returned (with "Full" true) for version 0 or a version this platform did not hand out
+    int GetReportedChanges(const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSizeBytes);
 
 private:
     ModulesManager& m_modulesManager;
     std::string m_uuid;
     std::string m_clientName;
     unsigned int m_maxPayloadSizeBytes;
+    bool m_bypassReportedCache;
 
+    // Opened on first use of a component of each module, requests for the same session can be served by different threads
     std::map<std::string, std::shared_ptr<MmiSession>> m_mmiSessions;
+    std::mutex m_mmiSessionsMutex;
     std::shared_ptr<MmiSession> GetSession(const std::string& componentName);
 
-    int SetDesiredPayload(rapidjson::Document& document);
+    int SetDesiredPayload(const char* payload, const size_t payloadSizeBytes, bool reapply);
+    int SetDesiredPayloadInParallel(const char* payload, const size_t payloadSizeBytes, bool reapply);
+    int SetDesiredComponent(const std::string& componentName, const char* componentValue, const size_t componentValueSizeBytes, bool reapply);
     int GetReportedPayload(MPI_JSON_STRING* payload, int* payloadSizeBytes);
+    int ReadReported(const std::function<int(const ReportedObject&)>& consume);
+    int WriteReported(MPI_WRITE_CALLBACK writeCallback, void* context);
 };
 
 #endif // MODULESMANAGER_H
\ No newline at end of file
@@ -12,6 +12,9 @@ typedef void* MPI_HANDLE;
 // Not null terminated, UTF-8, JSON formatted string
 typedef char* MPI_JSON_STRING;
 
+// Receives consecutive pieces of a JSON payload that is streamed instead of returned whole, a non-zero return stops the stream
+typedef int(*MPI_WRITE_CALLBACK)(const char* data, const int dataSizeBytes, void* context);
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -36,10 +39,26 @@ int MpiSetDesired(
     MPI_HANDLE clientSession,
     const MPI_JSON_STRING payload,
     const int payloadSizeBytes);
+int MpiSetDesiredReapply(
+    MPI_HANDLE clientSession,
+    const MPI_JSON_STRING payload,
+    const int payloadSizeBytes);
 int MpiGetReported(
     MPI_HANDLE clientSession,
     MPI_JSON_STRING* payload,
     int* payloadSizeBytes);
+int MpiGetReportedStream(
+    MPI_HANDLE clientSession,
+    MPI_WRITE_CALLBACK writeCallback,
+    void* context);
+int MpiGetReportedChanges(
+    MPI_HANDLE clientSession,
+    const unsigned long long sinceVersion,
+    MPI_JSON_STRING* payload,
+    int* payloadSizeBytes);
+int MpiSetReportedCacheBypass(
+    MPI_HANDLE clientSession,
+    const int bypass);
 void MpiClose(MPI_HANDLE clientSession);
 
 void MpiFree(MPI_JSON_STRING payload);
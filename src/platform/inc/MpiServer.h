@@ -14,6 +14,10 @@
 #define MPI_GET_URI "MpiGet"
 #define MPI_SET_DESIRED_URI "MpiSetDesired"
 #define MPI_GET_REPORTED_URI "MpiGetReported"
+#define MPI_SET_MANY_URI "MpiSetMany"
+#define MPI_GET_MANY_URI "MpiGetMany"
+#define MPI_GET_REPORTED_STREAM_URI "MpiGetReportedStream"
+#define MPI_GET_REPORTED_CHANGES_URI "MpiGetReportedChanges"
 
 #ifdef __cplusplus
 extern "C"
@@ -25,6 +29,7 @@ typedef enum HTTP_STATUS
     HTTP_OK = 200,
     HTTP_BAD_REQUEST = 400,
     HTTP_NOT_FOUND = 404,
+    HTTP_REQUEST_HEADER_FIELDS_TOO_LARGE = 431,
     HTTP_INTERNAL_SERVER_ERROR = 500
 } HTTP_STATUS;
 
@@ -34,6 +39,9 @@ typedef int(*MpiSetCall)(MPI_HANDLE, const char*, const char*, MPI_JSON_STRING,
 typedef int(*MpiGetCall)(MPI_HANDLE, const char*, const char*, MPI_JSON_STRING*, int*);
 typedef int(*MpiSetDesiredCall)(MPI_HANDLE, const MPI_JSON_STRING, const int);
 typedef int(*MpiGetReportedCall)(MPI_HANDLE, MPI_JSON_STRING*, int*);
+typedef int(*MpiGetReportedStreamCall)(MPI_HANDLE, MPI_WRITE_CALLBACK, void*);
+typedef int(*MpiSetReportedCacheBypassCall)(MPI_HANDLE, const int);
+typedef int(*MpiGetReportedChangesCall)(MPI_HANDLE, const unsigned long long, MPI_JSON_STRING*, int*);
 
 typedef struct MPI_CALLS
 {
@@ -43,12 +51,17 @@ typedef struct MPI_CALLS
     MpiGetCall mpiGet;
     MpiSetDesiredCall mpiSetDesired;
     MpiGetReportedCall mpiGetReported;
+    MpiGetReportedStreamCall mpiGetReportedStream;
+    MpiSetReportedCacheBypassCall mpiSetReportedCacheBypass;
+    MpiGetReportedChangesCall mpiGetReportedChanges;
+    MpiSetDesiredCall mpiSetDesiredReapply;
 } MPI_CALLS;
 
 void MpiServerInitialize(void);
 void MpiServerShutdown(void);
 
 HTTP_STATUS HandleMpiCall(const char* uri, const char* requestBody, char** response, int* responseSize, MPI_CALLS handlers);
+HTTP_STATUS HandleMpiStreamCall(const char* uri, const char* requestBody, MPI_WRITE_CALLBACK writeCallback, void* context, char** response, int* responseSize, MPI_CALLS handlers);
 
 #ifdef __cplusplus
 }
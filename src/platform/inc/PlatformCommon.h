@@ -24,6 +24,13 @@
 #include <sys/wait.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <ctype.h>
 
 #include <CommonUtils.h>
 #include <Logging.h>
@@ -34,6 +41,7 @@
 
 #ifdef __cplusplus
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -45,6 +53,8 @@
 #include <condition_variable>
 #include <cstring>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <thread>
 #include <tuple>
 #include <dlfcn.h>
@@ -52,6 +62,7 @@
 #include <unordered_set>
 #include <sstream>
 #include <future>
+#include <random>
 #include <ctime>
 #include <chrono>
 
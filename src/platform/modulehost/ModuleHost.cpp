@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Hosts one module out of the platform process, so that a module that crashes or hangs takes down only its host (see HostedManagementModule).
+// The platform starts the host with the module to load and the descriptor of its end of a socket pair, then sends it the MMI calls as requests
+// (see ModuleHostProtocol.h). The host exits when the platform closes the socket, which also happens when the platform exits.
+//
+// Usage: osconfig-modulehost <module path> <socket descriptor>
+
+#include <PlatformCommon.h>
+#include <ManagementModule.h>
+#include <ModuleHostProtocol.h>
+
+// Each host logs to a file of its own, named after the module that it hosts, as the modules do
+static const std::string g_hostLogPrefix = "/var/log/osconfig_modulehost_";
+static const std::string g_hostLogExtension = ".log";
+static const std::string g_hostRolledLogExtension = ".bak";
+
+static OSCONFIG_LOG_HANDLE g_hostLog = NULL;
+
+OSCONFIG_LOG_HANDLE GetPlatformLog()
+{
+    return g_hostLog;
+}
+
+struct HostedModule
+{
+    void* handle = nullptr;
+    Mmi_GetInfo mmiGetInfo = nullptr;
+    Mmi_Open mmiOpen = nullptr;
+    Mmi_Close mmiClose = nullptr;
+    Mmi_Set mmiSet = nullptr;
+    Mmi_Get mmiGet = nullptr;
+    Mmi_Free mmiFree = nullptr;
+
+    // The open MMI sessions by the number that the platform knows them by
+    std::map<int, MMI_HANDLE> sessions;
+    int lastSession = 0;
+};
+
+static int LoadModule(const char* modulePath, HostedModule& module)
+{
+    if (nullptr == (module.handle = dlopen(modulePath, RTLD_LAZY)))
+    {
+        // Taken once, the log macro expands its arguments for the log file and for the console
+        const char* error = dlerror();
+        OsConfigLogError(GetPlatformLog(), "Failed to load module '%s' (%s)", modulePath, error);
+        return EINVAL;
+    }
+
+    module.mmiGetInfo = reinterpret_cast<Mmi_GetInfo>(dlsym(module.handle, "MmiGetInfo"));
+    module.mmiOpen = reinterpret_cast<Mmi_Open>(dlsym(module.handle, "MmiOpen"));
+    module.mmiClose = reinterpret_cast<Mmi_Close>(dlsym(module.handle, "MmiClose"));
+    module.mmiSet = reinterpret_cast<Mmi_Set>(dlsym(module.handle, "MmiSet"));
+    module.mmiGet = reinterpret_cast<Mmi_Get>(dlsym(module.handle, "MmiGet"));
+    module.mmiFree = reinterpret_cast<Mmi_Free>(dlsym(module.handle, "MmiFree"));
+
+    if ((nullptr == module.mmiGetInfo) || (nullptr == module.mmiOpen) || (nullptr == module.mmiClose) || (nullptr == module.mmiSet) || (nullptr == module.mmiGet) || (nullptr == module.mmiFree))
+    {
+        OsConfigLogError(GetPlatformLog(), "Module '%s' does not export all of the MMI", modulePath);
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+// The descriptors that the platform did not mark close-on-exec are not for the module to keep open
+static void CloseInheritedDescriptors(int socket)
+{
+    std::vector<int> descriptors;
+    DIR* directory = opendir("/proc/self/fd");
+    struct dirent* entry = nullptr;
+
+    if (nullptr == directory)
+    {
+        return;
+    }
+
+    while (nullptr != (entry = readdir(directory)))
+    {
+        int descriptor = atoi(entry->d_name);
+
+        if ((STDERR_FILENO < descriptor) && (socket != descriptor) && (dirfd(directory) != descriptor))
+        {
+            descriptors.push_back(descriptor);
+        }
+    }
+
+    closedir(directory);
+
+    for (int descriptor : descriptors)
+    {
+        close(descriptor);
+    }
+}
+
+static MMI_HANDLE FindSession(const HostedModule& module, int session)
+{
+    auto it = module.sessions.find(session);
+    return (it != module.sessions.end()) ? it->second : nullptr;
+}
+
+// Adds the status and payload of an MMI call that returns a payload to the response, and frees the payload
+static void AddPayload(const HostedModule& module, int status, MMI_JSON_STRING payload, int payloadSizeBytes, ModuleHostFrame& response)
+{
+    response.AddInteger(status);
+    response.AddString(payload, (MMI_OK == status) ? payloadSizeBytes : -1);
+
+    if (nullptr != payload)
+    {
+        module.mmiFree(payload);
+    }
+}
+
+// Returns false for a request that is not understood
+static bool HandleRequest(HostedModule& module, ModuleHostFrame& request, ModuleHostFrame& response)
+{
+    std::string clientName, componentName, objectName, payload;
+    int message = 0, session = 0, maxPayloadSizeBytes = 0, status = MMI_OK;
+    MMI_JSON_STRING result = nullptr;
+    int resultSizeBytes = 0;
+    MMI_HANDLE handle = nullptr;
+
+    if (!request.GetInteger(message))
+    {
+        return false;
+    }
+
+    switch (static_cast<ModuleHostMessage>(message))
+    {
+        case ModuleHostMessage::GetInfo:
+            if (!request.GetString(clientName))
+            {
+                return false;
+            }
+
+            status = module.mmiGetInfo(clientName.c_str(), &result, &resultSizeBytes);
+            AddPayload(module, status, result, resultSizeBytes, response);
+            break;
+
+        case ModuleHostMessage::Open:
+            if (!request.GetString(clientName) || !request.GetInteger(maxPayloadSizeBytes))
+            {
+                return false;
+            }
+
+            if (nullptr != (handle = module.mmiOpen(clientName.c_str(), static_cast<unsigned int>(maxPayloadSizeBytes))))
+            {
+                session = ++module.lastSession;
+                module.sessions[session] = handle;
+            }
+
+            response.AddInteger(session);
+            break;
+
+        case ModuleHostMessage::Close:
+            if (!request.GetInteger(session))
+            {
+                return false;
+            }
+
+            if (nullptr != (handle = FindSession(module, session)))
+            {
+                module.mmiClose(handle);
+                module.sessions.erase(session);
+            }
+            break;
+
+        case ModuleHostMessage::Set:
+            if (!request.GetInteger(session) || !request.GetString(componentName) || !request.GetString(objectName) || !request.GetString(payload))
+            {
+                return false;
+            }
+
+            response.AddInteger(module.mmiSet(FindSession(module, session), componentName.c_str(), objectName.c_str(), &payload[0], static_cast<int>(payload.length())));
+            break;
+
+        case ModuleHostMessage::Get:
+            if (!request.GetInteger(session) || !request.GetString(componentName) || !request.GetString(objectName))
+            {
+                return false;
+            }
+
+            status = module.mmiGet(FindSession(module, session), componentName.c_str(), objectName.c_str(), &result, &resultSizeBytes);
+            AddPayload(module, status, result, resultSizeBytes, response);
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+// The name of the module file without its directory and extension
+static std::string GetModuleFileName(const std::string& modulePath)
+{
+    std::string name = modulePath.substr(modulePath.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+int main(int argc, char* argv[])
+{
+    HostedModule module;
+    std::string logFile;
+    std::string rolledLogFile;
+    int socket = -1;
+    int status = 0;
+
+    if ((3 != argc) || (0 > (socket = atoi(argv[2]))))
+    {
+        printf("Usage: %s <module path> <socket descriptor>\n", argv[0]);
+        return EINVAL;
+    }
+
+    CloseInheritedDescriptors(socket);
+    fcntl(socket, F_SETFD, FD_CLOEXEC);
+
+    // The log keeps the file names, these stay valid until it is closed
+    logFile = g_hostLogPrefix + GetModuleFileName(argv[1]) + g_hostLogExtension;
+    rolledLogFile = g_hostLogPrefix + GetModuleFileName(argv[1]) + g_hostRolledLogExtension;
+    g_hostLog = OpenLog(logFile.c_str(), rolledLogFile.c_str());
+
+    if (0 != (status = LoadModule(argv[1], module)))
+    {
+        close(socket);
+        CloseLog(&g_hostLog);
+        return status;
+    }
+
+    while (true)
+    {
+        ModuleHostFrame request;
+        ModuleHostFrame response;
+
+        if (0 != (status = request.Receive(socket)))
+        {
+            // The platform closed the socket
+            status = (EPIPE == status) ? 0 : status;
+            break;
+        }
+
+        if (!HandleRequest(module, request, response))
+        {
+            OsConfigLogError(GetPlatformLog(), "Invalid request from the platform to the host of '%s'", argv[1]);
+            status = EPROTO;
+            break;
+        }
+
+        if (0 != (status = response.Send(socket)))
+        {
+            break;
+        }
+    }
+
+    for (auto& session : module.sessions)
+    {
+        module.mmiClose(session.second);
+    }
+
+    close(socket);
+    CloseLog(&g_hostLog);
+
+    return status;
+}
@@ -7,6 +7,8 @@
 #include <CommonTests.h>
 #include <PlatformCommon.h>
 #include <ManagementModule.h>
+#include <ModuleHostProtocol.h>
+#include <HostedManagementModule.h>
 #include <MockManagementModule.h>
 #include <ModulesManagerTests.h>
 #include <Mpi.h>
@@ -58,6 +60,79 @@ namespace Tests
         EXPECT_EQ(ManagementModule::Lifetime::Short, info.lifetime);
     }
 
+    TEST_F(ManagementModuleTests, LoadModuleAfterUnload)
+    {
+        ManagementModule module(TEST_VALID_MODULE_PATH_V2);
+        EXPECT_EQ(0, module.Load());
+        EXPECT_EQ(0, module.Load());
+
+        module.Unload();
+        EXPECT_EQ(0, module.Load());
+
+        ManagementModule::Info info = module.GetInfo();
+        EXPECT_STREQ("Valid Test Module", info.name.c_str());
+        EXPECT_STREQ("2.0.0.0", info.version.ToString().c_str());
+    }
+
+    TEST_F(ManagementModuleTests, UnloadIdleModule)
+    {
+        MMI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+        std::shared_ptr<ManagementModule> module = std::make_shared<ManagementModule>(TEST_VALID_MODULE_PATH_V2);
+        ASSERT_EQ(0, module->Load());
+
+        MmiSession mmiSession(module, m_defaultClient);
+        ASSERT_EQ(0, mmiSession.Open());
+
+        EXPECT_FALSE(module->UnloadIfIdle(60));
+        EXPECT_TRUE(module->UnloadIfIdle(0));
+        EXPECT_FALSE(module->UnloadIfIdle(0));
+
+        // The module is loaded again and the session reopened on the next call
+        EXPECT_EQ(MMI_OK, mmiSession.Get(TEST_MODULE_COMPONENT_1, TEST_OBJECT_STRING, &payload, &payloadSizeBytes));
+        EXPECT_EQ(TEST_OBJECT_STRING_PAYLOAD, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+
+        EXPECT_STREQ("2.0.0.0", module->GetInfo().version.ToString().c_str());
+        mmiSession.Close();
+    }
+
+    TEST_F(ManagementModuleTests, HostedModule)
+    {
+        MMI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+        siginfo_t exitInfo = {};
+        std::shared_ptr<HostedManagementModule> module = std::make_shared<HostedManagementModule>(TEST_VALID_MODULE_PATH_V2, TEST_MODULE_HOST_PATH);
+        ASSERT_EQ(0, module->Load());
+        EXPECT_STREQ("2.0.0.0", module->GetInfo().version.ToString().c_str());
+
+        MmiSession mmiSession(module, m_defaultClient);
+        ASSERT_EQ(0, mmiSession.Open());
+
+        EXPECT_EQ(MMI_OK, mmiSession.Set(TEST_MODULE_COMPONENT_1, TEST_OBJECT_STRING, (MMI_JSON_STRING)TEST_OBJECT_STRING_PAYLOAD, static_cast<int>(strlen(TEST_OBJECT_STRING_PAYLOAD))));
+        EXPECT_EQ(MMI_OK, mmiSession.Get(TEST_MODULE_COMPONENT_1, TEST_OBJECT_STRING, &payload, &payloadSizeBytes));
+        EXPECT_EQ(TEST_OBJECT_STRING_PAYLOAD, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+        payload = nullptr;
+
+        // The host of a module that crashed is started again with the next call, and the session reopened
+        pid_t hostPid = module->GetHostPid();
+        ASSERT_LT(0, hostPid);
+        ASSERT_EQ(0, kill(hostPid, SIGSEGV));
+        ASSERT_EQ(0, waitid(P_PID, hostPid, &exitInfo, WEXITED | WNOWAIT));
+
+        EXPECT_EQ(MMI_OK, mmiSession.Get(TEST_MODULE_COMPONENT_1, TEST_OBJECT_STRING, &payload, &payloadSizeBytes));
+        EXPECT_EQ(TEST_OBJECT_STRING_PAYLOAD, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+
+        EXPECT_NE(hostPid, module->GetHostPid());
+        EXPECT_EQ(1u, module->GetReloads());
+
+        mmiSession.Close();
+        module->Unload();
+        EXPECT_EQ(-1, module->GetHostPid());
+    }
+
     TEST_F(ManagementModuleTests, LoadModuleInvalidPath)
     {
         const std::string invalidPath = TEST_MODULE_DIR;
@@ -184,6 +259,80 @@ namespace Tests
 
     }
 
+    static std::mutex g_hangMutex;
+    static std::condition_variable g_hangChanged;
+    static bool g_hang = false;
+
+    // MmiGet of this module does not return while g_hang is set
+    class HangingModule : public ManagementModule
+    {
+    public:
+        HangingModule()
+        {
+            m_info.name = "Hanging Test Module";
+
+            m_mmiOpen = [](const char*, const unsigned int) -> MMI_HANDLE { return reinterpret_cast<MMI_HANDLE>(new int()); };
+            m_mmiClose = [](MMI_HANDLE handle) { delete reinterpret_cast<int*>(handle); };
+            m_mmiSet = [](MMI_HANDLE, const char*, const char*, const MMI_JSON_STRING, const int) -> int { return MMI_OK; };
+            m_mmiFree = [](MMI_JSON_STRING payload) { delete[] payload; };
+            m_mmiGet = [](MMI_HANDLE, const char*, const char*, MMI_JSON_STRING* payload, int* payloadSizeBytes) -> int
+            {
+                std::unique_lock<std::mutex> lock(g_hangMutex);
+                g_hangChanged.wait(lock, []() { return !g_hang; });
+
+                *payloadSizeBytes = strlen(TEST_OBJECT_STRING_PAYLOAD);
+                *payload = new char[*payloadSizeBytes];
+                std::memcpy(*payload, TEST_OBJECT_STRING_PAYLOAD, *payloadSizeBytes);
+
+                return MMI_OK;
+            };
+        }
+
+        static void Hang(bool hang)
+        {
+            std::lock_guard<std::mutex> lock(g_hangMutex);
+            g_hang = hang;
+            g_hangChanged.notify_all();
+        }
+    };
+
+    TEST_F(ManagementModuleTests, CallTimeout)
+    {
+        MMI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+        std::shared_ptr<HangingModule> module = std::make_shared<HangingModule>();
+        module->SetCallTimeout(100);
+
+        MmiSession mmiSession(module, m_defaultClient);
+        ASSERT_EQ(0, mmiSession.Open());
+
+        EXPECT_EQ(MMI_OK, mmiSession.Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(TEST_OBJECT_STRING_PAYLOAD, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+        EXPECT_FALSE(module->IsDegraded());
+
+        HangingModule::Hang(true);
+        EXPECT_EQ(ETIME, mmiSession.Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_TRUE(module->IsDegraded());
+
+        // Calls into a degraded module fail without being made
+        EXPECT_EQ(ETIME, mmiSession.Set(m_defaultComponent, m_defaultObject, (MMI_JSON_STRING)TEST_OBJECT_STRING_PAYLOAD, strlen(TEST_OBJECT_STRING_PAYLOAD)));
+        EXPECT_EQ(ETIME, mmiSession.Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+
+        HangingModule::Hang(false);
+        for (int i = 0; (i < 100) && module->IsDegraded(); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_FALSE(module->IsDegraded());
+
+        EXPECT_EQ(MMI_OK, mmiSession.Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(TEST_OBJECT_STRING_PAYLOAD, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+
+        mmiSession.Close();
+    }
+
     TEST(ManagementModuleVersionTests, Version)
     {
         ManagementModule::Version v1 = {1,0,0,0};
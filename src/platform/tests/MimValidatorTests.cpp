@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <gtest/gtest.h>
+
+#include <PlatformCommon.h>
+#include <MimValidator.h>
+
+namespace Tests
+{
+    class MimValidatorTests : public ::testing::Test
+    {
+    public:
+        MimValidator m_validator;
+
+        static const char m_model[];
+        static const char m_component[];
+
+        void SetUp() override;
+
+        bool IsValid(const char* objectName, const std::string& payload);
+    };
+
+    const char MimValidatorTests::m_component[] = "TestComponent";
+
+    const char MimValidatorTests::m_model[] = R"""({
+        "name": "TestModel",
+        "type": "mimModel",
+        "contents": [
+            {
+                "name": "TestComponent",
+                "type": "mimComponent",
+                "contents": [
+                    {
+                        "name": "string",
+                        "type": "mimObject",
+                        "desired": true,
+                        "schema": "string"
+                    },
+                    {
+                        "name": "integerEnum",
+                        "type": "mimObject",
+                        "desired": false,
+                        "schema": {
+                            "type": "enum",
+                            "valueSchema": "integer",
+                            "enumValues": [
+                                { "name": "none", "enumValue": 0 },
+                                { "name": "some", "enumValue": 1 }
+                            ]
+                        }
+                    },
+                    {
+                        "name": "stringEnum",
+                        "type": "mimObject",
+                        "desired": false,
+                        "schema": {
+                            "type": "enum",
+                            "valueSchema": "string",
+                            "enumValues": [
+                                { "name": "on", "enumValue": "on" },
+                                { "name": "off", "enumValue": "off" }
+                            ]
+                        }
+                    },
+                    {
+                        "name": "object",
+                        "type": "mimObject",
+                        "desired": true,
+                        "schema": {
+                            "type": "object",
+                            "fields": [
+                                { "name": "name", "schema": "string" },
+                                { "name": "enabled", "schema": "boolean" },
+                                { "name": "count", "schema": "integer" },
+                                { "name": "tags", "schema": { "type": "array", "elementSchema": "string" } },
+                                {
+                                    "name": "settings",
+                                    "schema": {
+                                        "type": "map",
+                                        "mapKey": { "name": "key", "schema": "string" },
+                                        "mapValue": { "name": "value", "schema": "integer" }
+                                    }
+                                }
+                            ]
+                        }
+                    },
+                    {
+                        "name": "objectArray",
+                        "type": "mimObject",
+                        "desired": false,
+                        "schema": {
+                            "type": "array",
+                            "elementSchema": {
+                                "fields": [
+                                    { "name": "id", "schema": "integer" },
+                                    { "name": "state", "schema": { "type": "enum", "valueSchema": "integer", "enumValues": [{ "name": "unknown", "enumValue": 0 }] } }
+                                ]
+                            }
+                        }
+                    },
+                    {
+                        "name": "unsupported",
+                        "type": "mimObject",
+                        "desired": false,
+                        "schema": "double"
+                    }
+                ]
+            }
+        ]
+    })""";
+
+    void MimValidatorTests::SetUp()
+    {
+        ASSERT_EQ(0, m_validator.LoadModel(m_model, strlen(m_model)));
+    }
+
+    bool MimValidatorTests::IsValid(const char* objectName, const std::string& payload)
+    {
+        return m_validator.IsValid(m_component, objectName, payload.c_str(), payload.length());
+    }
+
+    TEST_F(MimValidatorTests, LoadModel)
+    {
+        EXPECT_TRUE(m_validator.HasObject(m_component, "string"));
+        EXPECT_TRUE(m_validator.HasObject(m_component, "integerEnum"));
+        EXPECT_TRUE(m_validator.HasObject(m_component, "stringEnum"));
+        EXPECT_TRUE(m_validator.HasObject(m_component, "object"));
+        EXPECT_TRUE(m_validator.HasObject(m_component, "objectArray"));
+        EXPECT_FALSE(m_validator.HasObject(m_component, "unsupported"));
+        EXPECT_FALSE(m_validator.HasObject("UnknownComponent", "string"));
+
+        MimValidator validator;
+        const char invalidModel[] = R"""({"name": "InvalidModel"})""";
+        EXPECT_EQ(EINVAL, validator.LoadModel(invalidModel, strlen(invalidModel)));
+        EXPECT_EQ(0, validator.LoadModels("/this/directory/does/not/exist"));
+    }
+
+    TEST_F(MimValidatorTests, ValidPayloads)
+    {
+        EXPECT_TRUE(IsValid("string", R"""("value")"""));
+        EXPECT_TRUE(IsValid("integerEnum", "1"));
+        EXPECT_TRUE(IsValid("stringEnum", R"""("off")"""));
+        EXPECT_TRUE(IsValid("object", R"""({"name": "test", "enabled": true, "count": 3, "tags": ["a", "b"], "settings": {"a": 1, "b": null}})"""));
+        EXPECT_TRUE(IsValid("object", R"""({"name": "test"})"""));
+        EXPECT_TRUE(IsValid("object", R"""({})"""));
+        EXPECT_TRUE(IsValid("objectArray", R"""([{"id": 1, "state": 0}, {"id": 2}])"""));
+        EXPECT_TRUE(IsValid("objectArray", R"""([])"""));
+    }
+
+    TEST_F(MimValidatorTests, InvalidPayloads)
+    {
+        EXPECT_FALSE(IsValid("string", "1"));
+        EXPECT_FALSE(IsValid("string", "null"));
+        EXPECT_FALSE(IsValid("string", R"""("value" "value")"""));
+        EXPECT_FALSE(IsValid("integerEnum", "2"));
+        EXPECT_FALSE(IsValid("integerEnum", "1.0"));
+        EXPECT_FALSE(IsValid("integerEnum", R"""("1")"""));
+        EXPECT_FALSE(IsValid("stringEnum", R"""("maybe")"""));
+        EXPECT_FALSE(IsValid("object", R"""({"name": "test", "unknown": 1})"""));
+        EXPECT_FALSE(IsValid("object", R"""({"enabled": 1})"""));
+        EXPECT_FALSE(IsValid("object", R"""({"name": null})"""));
+        EXPECT_FALSE(IsValid("object", R"""({"tags": ["a", 1]})"""));
+        EXPECT_FALSE(IsValid("object", R"""({"settings": {"a": "1"}})"""));
+        EXPECT_FALSE(IsValid("object", R"""(["name"])"""));
+        EXPECT_FALSE(IsValid("objectArray", R"""([{"id": 1, "state": 1}])"""));
+        EXPECT_FALSE(IsValid("objectArray", R"""({"id": 1})"""));
+        EXPECT_FALSE(IsValid("objectArray", R"""([{"id": 1}, null])"""));
+        EXPECT_FALSE(IsValid("string", ""));
+        EXPECT_FALSE(IsValid("string", "invalid"));
+    }
+
+    TEST_F(MimValidatorTests, GenericPayloads)
+    {
+        // Objects not in the loaded models are validated against the generic MIM object schema
+        EXPECT_TRUE(IsValid("unsupported", R"""({"any": 1, "value": "a"})"""));
+        EXPECT_TRUE(m_validator.IsValid("UnknownComponent", "unknownObject", "[1, 2]", 6));
+        EXPECT_FALSE(m_validator.IsValid("UnknownComponent", "unknownObject", "[1, \"a\"]", 8));
+        EXPECT_FALSE(m_validator.IsValid("UnknownComponent", "unknownObject", "1.5", 3));
+    }
+} // namespace Tests
@@ -87,6 +87,9 @@ namespace Tests
                 delete[] payload;
             });
 
+        // The payloads returned by the mocked CallMmiGet belong to the tests, they are not freed unless a test expects it
+        EXPECT_CALL(*this, CallMmiFree(::testing::_)).Times(::testing::AnyNumber());
+
         MMI_JSON_STRING payload = nullptr;
         int payloadSizeBytes = 0;
 
@@ -133,4 +136,9 @@ namespace Tests
     {
         this->m_mmiFree = mmiFree;
     }
+
+    void MockManagementModule::SetReportedCacheSeconds(const std::string& componentName, const std::string& objectName, unsigned int seconds)
+    {
+        this->m_info.reportedCacheSeconds[componentName][objectName] = seconds;
+    }
 } // namespace Tests
\ No newline at end of file
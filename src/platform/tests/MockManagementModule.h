@@ -16,6 +16,7 @@ namespace Tests
 
         MOCK_METHOD(int, CallMmiSet, (MMI_HANDLE handle, const char* componentName, const char* objectName, const MMI_JSON_STRING payload, const int payloadSizeBytes), (override));
         MOCK_METHOD(int, CallMmiGet, (MMI_HANDLE handle, const char* componentName, const char* objectName, MMI_JSON_STRING* payload, int* payloadSizeBytes), (override));
+        MOCK_METHOD(void, CallMmiFree, (MMI_JSON_STRING payload), (override));
 
         void MmiGetInfo(Mmi_GetInfo mmiGetInfo);
         void MmiOpen(Mmi_Open mmiOpen);
@@ -23,6 +24,8 @@ namespace Tests
         void MmiSet(Mmi_Set mmiSet);
         void MmiGet(Mmi_Get mmiGet);
         void MmiFree(Mmi_Free mmiFree);
+
+        void SetReportedCacheSeconds(const std::string& componentName, const std::string& objectName, unsigned int seconds);
     };
 } // namespace Tests
 
@@ -18,10 +18,8 @@ namespace Tests
     {
         ManagementModule::Info info = module->GetInfo();
         m_modules[info.name] = module;
-        for (auto& component : info.components)
-        {
-            m_moduleComponentName[component] = info.name;
-        }
+        RegisterModuleComponents(info.name, info.components, true);
+        FollowModuleReloads(info.name, module);
     }
 
     void MockModulesManager::AddReportedObject(std::string componentName, std::string objectName)
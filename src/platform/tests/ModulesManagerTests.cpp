@@ -16,8 +16,10 @@
 
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::InSequence;
 using ::testing::Return;
 using ::testing::SetArgPointee;
+using ::testing::StartsWith;
 using ::testing::StrEq;
 using ::testing::StrictMock;
 
@@ -73,6 +75,32 @@ namespace Tests
         ASSERT_EQ(MPI_OK, m_mpiSession->Set(m_defaultComponent, m_defaultObject, m_defaultPayload, m_defaultPayloadSize));
     }
 
+    static int g_mmiOpenCount = 0;
+
+    TEST_F(ModuleManagerTests, MpiSessionOpensModuleOnFirstUse)
+    {
+        g_mmiOpenCount = 0;
+        m_mockModule->MmiOpen([](const char* clientName, const unsigned int maxPayloadSizeBytes) -> MMI_HANDLE
+            {
+                (void)clientName;
+                (void)maxPayloadSizeBytes;
+                return reinterpret_cast<MMI_HANDLE>(&(++g_mmiOpenCount));
+            });
+        m_mockModule->MmiClose([](MMI_HANDLE handle)
+            {
+                (void)handle;
+            });
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        ASSERT_EQ(0, mpiSession->Open());
+        EXPECT_EQ(0, g_mmiOpenCount);
+
+        EXPECT_CALL(*m_mockModule, CallMmiSet(_, m_defaultComponent, m_defaultObject, m_defaultPayload, m_defaultPayloadSize)).Times(2).WillRepeatedly(Return(MMI_OK));
+        EXPECT_EQ(MPI_OK, mpiSession->Set(m_defaultComponent, m_defaultObject, m_defaultPayload, m_defaultPayloadSize));
+        EXPECT_EQ(MPI_OK, mpiSession->Set(m_defaultComponent, m_defaultObject, m_defaultPayload, m_defaultPayloadSize));
+        EXPECT_EQ(1, g_mmiOpenCount);
+    }
+
     TEST_F(ModuleManagerTests, MpiSetInvalidComponentName)
     {
         ASSERT_EQ(EINVAL, m_mpiSession->Set(nullptr, m_defaultObject, m_defaultPayload, m_defaultPayloadSize));
@@ -101,6 +129,48 @@ namespace Tests
         EXPECT_EQ(strlen(expected), payloadSizeBytes);
     }
 
+    TEST_F(ModuleManagerTests, MpiGetCachedReported)
+    {
+        int payloadSizeBytes = 0;
+        MMI_JSON_STRING payload = nullptr;
+        char expected[] = "\"expected\"";
+
+        m_mockModule->SetReportedCacheSeconds(m_defaultComponent, m_defaultObject, 60);
+
+        // The second Get is served from the cache, until MmiSet to the same component invalidates it
+        EXPECT_CALL(*m_mockModule, CallMmiGet(_, StrEq(m_defaultComponent), StrEq(m_defaultObject), _, _)).Times(2).WillRepeatedly(DoAll(SetArgPointee<3>(expected), SetArgPointee<4>(strlen(expected)), Return(MMI_OK)));
+        EXPECT_CALL(*m_mockModule, CallMmiSet(_, StrEq(m_defaultComponent), StrEq(m_defaultObject), _, _)).Times(1).WillOnce(Return(MMI_OK));
+
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(expected, payload);
+
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_NE(expected, payload);
+        EXPECT_EQ(std::string(expected), std::string(payload, payloadSizeBytes));
+        delete[] payload;
+
+        EXPECT_EQ(MPI_OK, m_mpiSession->Set(m_defaultComponent, m_defaultObject, m_defaultPayload, m_defaultPayloadSize));
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(expected, payload);
+    }
+
+    TEST_F(ModuleManagerTests, MpiGetCachedReportedBypass)
+    {
+        int payloadSizeBytes = 0;
+        MMI_JSON_STRING payload = nullptr;
+        char expected[] = "\"expected\"";
+
+        m_mockModule->SetReportedCacheSeconds(m_defaultComponent, m_defaultObject, 60);
+        m_mpiSession->SetReportedCacheBypass(true);
+
+        EXPECT_CALL(*m_mockModule, CallMmiGet(_, StrEq(m_defaultComponent), StrEq(m_defaultObject), _, _)).Times(2).WillRepeatedly(DoAll(SetArgPointee<3>(expected), SetArgPointee<4>(strlen(expected)), Return(MMI_OK)));
+
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(expected, payload);
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get(m_defaultComponent, m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(expected, payload);
+    }
+
     TEST_F(ModuleManagerTests, MpiGetInvalidComponentName)
     {
         int payloadSizeBytes = 0;
@@ -137,6 +207,48 @@ namespace Tests
         EXPECT_EQ(nullptr, payload);
     }
 
+    // A mock module that comes back from being unloaded implementing other components
+    class ReloadedMockModule : public MockManagementModule
+    {
+    public:
+        std::vector<std::string> m_reloadedComponents;
+
+        ReloadedMockModule(std::string name, std::vector<std::string> components) : MockManagementModule(name, components) {}
+
+        void MarkUnloaded()
+        {
+            m_unloaded = true;
+        }
+
+        int Load() override
+        {
+            m_info.components = m_reloadedComponents;
+            return 0;
+        }
+    };
+
+    TEST_F(ModuleManagerTests, MpiGetAfterModuleReloadedWithOtherComponents)
+    {
+        int payloadSizeBytes = 0;
+        MMI_JSON_STRING payload = nullptr;
+        char expected[] = "\"expected\"";
+        auto module = std::make_shared<StrictMock<ReloadedMockModule>>("Reloaded_Module_Name", std::vector<std::string>({"Component_1", "Component_2"}));
+
+        m_mockModuleManager->Load(module);
+        module->m_reloadedComponents = {"Component_2", "Component_3"};
+        module->MarkUnloaded();
+
+        EXPECT_CALL(*module, CallMmiGet(_, StrEq("Component_2"), m_defaultObject, _, _)).Times(1).WillOnce(DoAll(SetArgPointee<3>(expected), SetArgPointee<4>(strlen(expected)), Return(MMI_OK)));
+        EXPECT_CALL(*module, CallMmiGet(_, StrEq("Component_3"), m_defaultObject, _, _)).Times(1).WillOnce(DoAll(SetArgPointee<3>(expected), SetArgPointee<4>(strlen(expected)), Return(MMI_OK)));
+
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get("Component_2", m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(1u, module->GetReloads());
+
+        // The component the module no longer implements is not routed to it, the new one is
+        EXPECT_NE(MPI_OK, m_mpiSession->Get("Component_1", m_defaultObject, &payload, &payloadSizeBytes));
+        EXPECT_EQ(MPI_OK, m_mpiSession->Get("Component_3", m_defaultObject, &payload, &payloadSizeBytes));
+    }
+
     TEST_F(ModuleManagerTests, MpiSetDesired)
     {
         const char componentName[] = "component";
@@ -155,10 +267,39 @@ namespace Tests
         std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
         EXPECT_EQ(0, mpiSession->Open());
 
-        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName), StrEq(value), strlen(value))).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName), StartsWith(value), strlen(value))).Times(1).WillOnce(Return(MMI_OK));
         ASSERT_EQ(MPI_OK, mpiSession->SetDesired(payload, strlen(payload)));
     }
 
+    TEST_F(ModuleManagerTests, MpiSetDesiredUnchanged)
+    {
+        const char componentName[] = "component";
+        char payload[] = R""""({"component": {"object_1": "value", "object_2": {"a": 1}}})"""";
+        char reformatted[] = R""""(
+            {
+                "component": {
+                    "object_1": "value",
+                    "object_2": { "a" : 1 }
+                }
+            })"""";
+        char changed[] = R""""({"component": {"object_1": "value", "object_2": {"a": 2}}})"""";
+
+        std::shared_ptr<MockManagementModule> mockModule = std::make_shared<MockManagementModule>("mockModule", std::vector<std::string>({componentName}));
+        m_mockModuleManager->Load(mockModule);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        // object_1 is set once and again when reapplied, object_2 once more when its value changes
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq("object_1"), _, _)).Times(2).WillRepeatedly(Return(MMI_OK));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq("object_2"), _, _)).Times(3).WillRepeatedly(Return(MMI_OK));
+
+        EXPECT_EQ(MPI_OK, mpiSession->SetDesired(payload, strlen(payload)));
+        EXPECT_EQ(MPI_OK, mpiSession->SetDesired(reformatted, strlen(reformatted)));
+        EXPECT_EQ(MPI_OK, mpiSession->SetDesired(changed, strlen(changed)));
+        EXPECT_EQ(MPI_OK, mpiSession->SetDesired(changed, strlen(changed), true));
+    }
+
     TEST_F(ModuleManagerTests, MpiSetDesiredMultipleComponents)
     {
         const char componentName_1[] = "component_1";
@@ -186,12 +327,82 @@ namespace Tests
         std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
         EXPECT_EQ(0, mpiSession->Open());
 
-        EXPECT_CALL(*mockModule_1, CallMmiSet(_, StrEq(componentName_1), StrEq(objectName_1), StrEq(value_1), strlen(value_1))).Times(1).WillOnce(Return(MMI_OK));
-        EXPECT_CALL(*mockModule_2, CallMmiSet(_, StrEq(componentName_2), StrEq(objectName_2), StrEq(value_2), strlen(value_2))).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule_1, CallMmiSet(_, StrEq(componentName_1), StrEq(objectName_1), StartsWith(value_1), strlen(value_1))).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule_2, CallMmiSet(_, StrEq(componentName_2), StrEq(objectName_2), StartsWith(value_2), strlen(value_2))).Times(1).WillOnce(Return(MMI_OK));
 
         ASSERT_EQ(MPI_OK, mpiSession->SetDesired(payload, strlen(payload)));
     }
 
+    TEST_F(ModuleManagerTests, MpiSetDesiredInParallel)
+    {
+        const char componentName_1[] = "component_1";
+        const char componentName_2[] = "component_2";
+        char payload[] = R""""(
+            {
+                "component_1": {
+                    "object_1": "value_1",
+                    "object_2": "value_2"
+                },
+                "component_2": {
+                    "object_1": "value_1"
+                },
+                "component_3": {
+                    "object_1": "value_1"
+                }
+            })"""";
+
+        std::shared_ptr<MockManagementModule> mockModule_1 = std::make_shared<MockManagementModule>("mockModule_1", std::vector<std::string>({componentName_1}));
+        std::shared_ptr<MockManagementModule> mockModule_2 = std::make_shared<MockManagementModule>("mockModule_2", std::vector<std::string>({componentName_2}));
+
+        m_mockModuleManager->Load(mockModule_1);
+        m_mockModuleManager->Load(mockModule_2);
+        m_mockModuleManager->SetParallelDesired(true, {{componentName_2, "component_4"}});
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        {
+            // The objects of a component are set in order
+            InSequence sequence;
+            EXPECT_CALL(*mockModule_1, CallMmiSet(_, StrEq(componentName_1), StrEq("object_1"), _, _)).Times(1).WillOnce(Return(MMI_OK));
+            EXPECT_CALL(*mockModule_1, CallMmiSet(_, StrEq(componentName_1), StrEq("object_2"), _, _)).Times(1).WillOnce(Return(MMI_OK));
+        }
+        EXPECT_CALL(*mockModule_2, CallMmiSet(_, StrEq(componentName_2), StrEq("object_1"), _, _)).Times(1).WillOnce(Return(MMI_OK));
+
+        // The component without a module fails the call as when the components are set in order, after the others are set
+        ASSERT_EQ(EINVAL, mpiSession->SetDesired(payload, strlen(payload)));
+    }
+
+    TEST_F(ModuleManagerTests, MpiSetDesiredFailedObjects)
+    {
+        const char componentName[] = "component";
+        char payload[] = R""""(
+            {
+                "component": {
+                    "object_1": "value_1",
+                    "object_2": "value_2",
+                    "object_3": "value_3"
+                }
+            })"""";
+
+        std::shared_ptr<MockManagementModule> mockModule = std::make_shared<MockManagementModule>("mockModule", std::vector<std::string>({componentName}));
+        m_mockModuleManager->Load(mockModule);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq("object_1"), _, _)).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq("object_2"), _, _)).Times(2).WillOnce(Return(EPERM)).WillOnce(Return(EIO));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq("object_3"), _, _)).Times(2).WillOnce(Return(ENOENT)).WillOnce(Return(MMI_OK));
+
+        // All objects are set, the status is that of the first one that failed
+        EXPECT_EQ(EPERM, mpiSession->SetDesired(payload, strlen(payload)));
+
+        // Only the objects that failed are set again, the same way when the components are applied in parallel
+        m_mockModuleManager->SetParallelDesired(true);
+        EXPECT_EQ(EIO, mpiSession->SetDesired(payload, strlen(payload)));
+    }
+
     TEST_F(ModuleManagerTests, MpiSetDesiredMultipleObjects)
     {
         const char componentName[] = "component";
@@ -213,8 +424,8 @@ namespace Tests
         std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
         EXPECT_EQ(0, mpiSession->Open());
 
-        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName_1), StrEq(value_1), strlen(value_1))).Times(1).WillOnce(Return(MMI_OK));
-        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName_2), StrEq(value_2), strlen(value_2))).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName_1), StartsWith(value_1), strlen(value_1))).Times(1).WillOnce(Return(MMI_OK));
+        EXPECT_CALL(*mockModule, CallMmiSet(_, StrEq(componentName), StrEq(objectName_2), StartsWith(value_2), strlen(value_2))).Times(1).WillOnce(Return(MMI_OK));
 
         EXPECT_EQ(MPI_OK, mpiSession->SetDesired(payload, strlen(payload)));
     }
@@ -237,6 +448,29 @@ namespace Tests
         EXPECT_EQ(EINVAL, m_mpiSession->SetDesired(invalid, strlen(invalid)));
     }
 
+    TEST_F(ModuleManagerTests, MpiSetDesiredInvalidJsonAfterValidComponent)
+    {
+        const char componentName[] = "component";
+        char invalid[] = R""""(
+            {
+                "component": {
+                    "object": "value"
+                },
+                "component_2": {
+                    "object": value
+                }
+            })"""";
+
+        std::shared_ptr<MockManagementModule> mockModule = std::make_shared<MockManagementModule>("mockModule", std::vector<std::string>({componentName}));
+        m_mockModuleManager->Load(mockModule);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_CALL(*mockModule, CallMmiSet(_, _, _, _, _)).Times(0);
+        EXPECT_EQ(EINVAL, mpiSession->SetDesired(invalid, strlen(invalid)));
+    }
+
     TEST_F(ModuleManagerTests, MpiGetReported)
     {
         const char componentName[] = "component";
@@ -261,12 +495,185 @@ namespace Tests
         EXPECT_EQ(0, mpiSession->Open());
 
         EXPECT_CALL(*mockModule, CallMmiGet(_, StrEq(componentName), StrEq(objectName), _, _)).Times(1).WillOnce(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)));
+        EXPECT_CALL(*mockModule, CallMmiFree(value)).Times(1);
         EXPECT_EQ(MPI_OK, mpiSession->GetReported(&payload, &payloadSizeBytes));
 
         std::string actual(payload, payloadSizeBytes);
         EXPECT_TRUE(JSON_EQ(expected, actual));
     }
 
+    TEST_F(ModuleManagerTests, MpiGetReportedPrettyPrint)
+    {
+        const char componentName[] = "component";
+        const char objectName[] = "object";
+        char value[] = "{ \"name\": \"value\" }";
+        const char compact[] = "{\"component\":{\"object\":{ \"name\": \"value\" }}}";
+
+        MPI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+
+        std::shared_ptr<MockManagementModule> mockModule = std::make_shared<MockManagementModule>("mockModule", std::vector<std::string>({componentName}));
+
+        m_mockModuleManager->Load(mockModule);
+        m_mockModuleManager->AddReportedObject(componentName, objectName);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_CALL(*mockModule, CallMmiGet(_, StrEq(componentName), StrEq(objectName), _, _)).Times(2).WillRepeatedly(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)));
+
+        // The module payload goes into the compact reported configuration as it is
+        EXPECT_EQ(MPI_OK, mpiSession->GetReported(&payload, &payloadSizeBytes));
+        EXPECT_EQ(compact, std::string(payload, payloadSizeBytes));
+        delete[] payload;
+
+        m_mockModuleManager->SetPrettyPrintReported(true);
+        EXPECT_EQ(MPI_OK, mpiSession->GetReported(&payload, &payloadSizeBytes));
+
+        std::string actual(payload, payloadSizeBytes);
+        EXPECT_NE(std::string::npos, actual.find('\n'));
+        EXPECT_TRUE(JSON_EQ(compact, actual));
+        delete[] payload;
+    }
+
+    TEST_F(ModuleManagerTests, MpiGetReportedChanges)
+    {
+        const char componentName[] = "component";
+        const char objectName[] = "object";
+        char value[] = "\"value\"";
+        char changedValue[] = "\"changed\"";
+
+        MPI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+        unsigned long long version = 0;
+        rapidjson::Document document;
+
+        std::shared_ptr<MockManagementModule> mockModule = std::make_shared<MockManagementModule>("mockModule", std::vector<std::string>({componentName}));
+
+        m_mockModuleManager->Load(mockModule);
+        m_mockModuleManager->AddReportedObject(componentName, objectName);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_CALL(*mockModule, CallMmiGet(_, StrEq(componentName), StrEq(objectName), _, _)).Times(6)
+            .WillOnce(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)))
+            .WillOnce(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)))
+            .WillOnce(DoAll(SetArgPointee<3>(changedValue), SetArgPointee<4>(strlen(changedValue)), Return(MMI_OK)))
+            .WillOnce(Return(EIO))
+            .WillOnce(Return(EIO))
+            .WillOnce(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)));
+
+        // Without a version the objects are recorded, but not returned: the client streams the full reported configuration instead
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(0, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_TRUE(document["Full"].GetBool());
+        EXPECT_EQ(0, document["Reported"].MemberCount());
+        EXPECT_FALSE(document.HasMember("TimedOut"));
+        version = document["Version"].GetUint64();
+        delete[] payload;
+
+        // Nothing changed
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(version, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_FALSE(document["Full"].GetBool());
+        EXPECT_EQ(0, document["Reported"].MemberCount());
+        EXPECT_EQ(version, document["Version"].GetUint64());
+        delete[] payload;
+
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(version, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_FALSE(document["Full"].GetBool());
+        EXPECT_STREQ("changed", document["Reported"][componentName][objectName].GetString());
+        EXPECT_FALSE(document.HasMember("Removed"));
+        EXPECT_LT(version, document["Version"].GetUint64());
+        version = document["Version"].GetUint64();
+        delete[] payload;
+
+        // An object that cannot be read anymore is removed once
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(version, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_EQ(0, document["Reported"].MemberCount());
+        ASSERT_TRUE(document.HasMember("Removed"));
+        ASSERT_EQ(1, document["Removed"].Size());
+        EXPECT_STREQ(componentName, document["Removed"][0u]["ComponentName"].GetString());
+        EXPECT_STREQ(objectName, document["Removed"][0u]["ObjectName"].GetString());
+        EXPECT_LT(version, document["Version"].GetUint64());
+        version = document["Version"].GetUint64();
+        delete[] payload;
+
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(version, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_FALSE(document.HasMember("Removed"));
+        EXPECT_EQ(version, document["Version"].GetUint64());
+        delete[] payload;
+
+        // And comes back as a change when it can be read again
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedChanges(version, &payload, &payloadSizeBytes));
+        document.Parse(payload, payloadSizeBytes);
+        ASSERT_FALSE(document.HasParseError());
+        EXPECT_STREQ("value", document["Reported"][componentName][objectName].GetString());
+        EXPECT_FALSE(document.HasMember("Removed"));
+        EXPECT_LT(version, document["Version"].GetUint64());
+        delete[] payload;
+    }
+
+    TEST_F(ModuleManagerTests, MpiGetReportedObjectTimeout)
+    {
+        const char fastComponentName[] = "fast_component";
+        const char slowComponentName[] = "slow_component";
+        const char objectName[] = "object";
+        static char value[] = "\"value\"";
+        char expected[] = R""""(
+            {
+                "fast_component": {
+                    "object": "value"
+                },
+                "slow_component": {},
+                "TimedOut": [{"ComponentName": "slow_component", "ObjectName": "object"}]
+            })"""";
+
+        MPI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+
+        std::shared_ptr<MockManagementModule> fastModule = std::make_shared<MockManagementModule>("fastModule", std::vector<std::string>({fastComponentName}));
+        std::shared_ptr<MockManagementModule> slowModule = std::make_shared<MockManagementModule>("slowModule", std::vector<std::string>({slowComponentName}));
+
+        m_mockModuleManager->Load(fastModule);
+        m_mockModuleManager->Load(slowModule);
+        m_mockModuleManager->AddReportedObject(fastComponentName, objectName);
+        m_mockModuleManager->AddReportedObject(slowComponentName, objectName);
+        m_mockModuleManager->SetReportedObjectTimeout(100);
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_CALL(*fastModule, CallMmiGet(_, StrEq(fastComponentName), StrEq(objectName), _, _)).Times(1).WillOnce(DoAll(SetArgPointee<3>(value), SetArgPointee<4>(strlen(value)), Return(MMI_OK)));
+        EXPECT_CALL(*slowModule, CallMmiGet(_, StrEq(slowComponentName), StrEq(objectName), _, _)).Times(1).WillOnce(::testing::Invoke([](MMI_HANDLE, const char*, const char*, MMI_JSON_STRING* objectPayload, int* objectPayloadSizeBytes) -> int
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                *objectPayload = value;
+                *objectPayloadSizeBytes = strlen(value);
+                return MMI_OK;
+            }));
+
+        auto startTime = std::chrono::steady_clock::now();
+        EXPECT_EQ(MPI_OK, mpiSession->GetReported(&payload, &payloadSizeBytes));
+        EXPECT_GT(std::chrono::milliseconds(400), std::chrono::steady_clock::now() - startTime);
+
+        std::string actual(payload, payloadSizeBytes);
+        EXPECT_TRUE(JSON_EQ(expected, actual));
+        delete[] payload;
+
+        // Closing the session waits for the slow module to return
+        mpiSession->Close();
+    }
+
     TEST_F(ModuleManagerTests, MpiGetReportedMultipleComponents)
     {
         const char componentName_1[] = "component_1";
@@ -342,6 +749,88 @@ namespace Tests
         EXPECT_TRUE(JSON_EQ(expected, actual));
     }
 
+    static int AppendToString(const char* data, const int dataSizeBytes, void* context)
+    {
+        static_cast<std::string*>(context)->append(data, dataSizeBytes);
+        return MPI_OK;
+    }
+
+    static int FailWrite(const char* data, const int dataSizeBytes, void* context)
+    {
+        UNUSED(data);
+        UNUSED(dataSizeBytes);
+        UNUSED(context);
+        return EIO;
+    }
+
+    TEST_F(ModuleManagerTests, MpiGetReportedStream)
+    {
+        const char componentName_1[] = "component_1";
+        const char componentName_2[] = "component_2";
+        const char objectName_1[] = "object_1";
+        const char objectName_2[] = "object_2";
+        const char objectName_3[] = "object_3";
+        char value_1[] = "\"value_1\"";
+        char value_2[] = "{\"setting\": [1, 2]}";
+        char invalid[] = "{invalid";
+        char expected[] = R""""(
+            {
+                "component_1": {
+                    "object_1": "value_1",
+                    "object_2": {"setting": [1, 2]}
+                },
+                "component_2": {}
+            })"""";
+
+        std::string actual;
+
+        std::shared_ptr<MockManagementModule> mockModule_1 = std::make_shared<MockManagementModule>("mockModule_1", std::vector<std::string>({componentName_1}));
+        std::shared_ptr<MockManagementModule> mockModule_2 = std::make_shared<MockManagementModule>("mockModule_2", std::vector<std::string>({componentName_2}));
+
+        m_mockModuleManager->Load(mockModule_1);
+        m_mockModuleManager->Load(mockModule_2);
+        m_mockModuleManager->AddReportedObject(componentName_1, objectName_1);
+        m_mockModuleManager->AddReportedObject(componentName_1, objectName_2);
+        m_mockModuleManager->AddReportedObject(componentName_2, objectName_3);
+
+        EXPECT_CALL(*mockModule_1, CallMmiGet(_, StrEq(componentName_1), StrEq(objectName_1), _, _)).Times(2).WillRepeatedly(DoAll(SetArgPointee<3>(value_1), SetArgPointee<4>(strlen(value_1)), Return(MMI_OK)));
+        // The modules are read in parallel, so the objects after the first can be read before the failed write stops the stream
+        EXPECT_CALL(*mockModule_1, CallMmiGet(_, StrEq(componentName_1), StrEq(objectName_2), _, _)).Times(::testing::Between(1, 2)).WillRepeatedly(DoAll(SetArgPointee<3>(value_2), SetArgPointee<4>(strlen(value_2)), Return(MMI_OK)));
+        EXPECT_CALL(*mockModule_2, CallMmiGet(_, StrEq(componentName_2), StrEq(objectName_3), _, _)).Times(::testing::Between(1, 2)).WillRepeatedly(DoAll(SetArgPointee<3>(invalid), SetArgPointee<4>(strlen(invalid)), Return(MMI_OK)));
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*m_mockModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+        EXPECT_EQ(MPI_OK, mpiSession->GetReportedStream(AppendToString, &actual));
+        EXPECT_TRUE(JSON_EQ(expected, actual));
+
+        // A failed write stops the stream at the first object
+        EXPECT_EQ(EIO, mpiSession->GetReportedStream(FailWrite, nullptr));
+        EXPECT_EQ(EINVAL, mpiSession->GetReportedStream(nullptr, nullptr));
+    }
+
+    TEST_F(ModuleManagerTests, WorkerPool)
+    {
+        WorkerPool workers;
+        std::mutex mutex;
+        std::vector<int> order;
+        std::atomic<int> others(0);
+
+        for (int i = 0; i < 10; i++)
+        {
+            workers.Post("module_1", [&, i]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(i); });
+            workers.Post("module_2", [&]() { others++; });
+        }
+
+        // The tasks of a key run in the order they were posted
+        workers.Drain();
+        ASSERT_EQ(10u, order.size());
+        for (int i = 0; i < 10; i++)
+        {
+            EXPECT_EQ(i, order[i]);
+        }
+        EXPECT_EQ(10, others);
+    }
+
     TEST_F(ModuleManagerTests, MpiGetReportedInvalidPayload)
     {
         int payloadSizeBytes = 0;
@@ -410,6 +899,32 @@ namespace Tests
         EXPECT_TRUE(JSON_EQ(TEST_MULTIPLE_OBJECT_PAYLOAD, actual));
     }
 
+    TEST_F(ModuleManagerTests, LoadModulesWithCache)
+    {
+        MPI_JSON_STRING payload = nullptr;
+        int payloadSizeBytes = 0;
+        struct stat cacheStat = {};
+
+        remove(TEST_MODULE_CACHE);
+        ASSERT_EQ(MPI_OK, m_mockModuleManager->LoadModules(TEST_MODULE_DIR, TEST_CONFIG_JSON_SINGLE_REPORTED, TEST_MODULE_CACHE));
+        ASSERT_EQ(0, stat(TEST_MODULE_CACHE, &cacheStat));
+
+        // Loaded again from the cache, only the newest version of the test module is loaded
+        std::shared_ptr<MockModulesManager> cachedModuleManager = std::make_shared<MockModulesManager>();
+        ASSERT_EQ(MPI_OK, cachedModuleManager->LoadModules(TEST_MODULE_DIR, TEST_CONFIG_JSON_SINGLE_REPORTED, TEST_MODULE_CACHE));
+
+        std::shared_ptr<MpiSession> mpiSession = std::make_shared<MpiSession>(*cachedModuleManager, m_defaultClient);
+        EXPECT_EQ(0, mpiSession->Open());
+
+        EXPECT_EQ(MPI_OK, mpiSession->SetDesired((MPI_JSON_STRING)TEST_SINGLE_OBJECT_PAYLOAD, strlen(TEST_SINGLE_OBJECT_PAYLOAD)));
+        EXPECT_EQ(MPI_OK, mpiSession->GetReported(&payload, &payloadSizeBytes));
+
+        std::string actual(payload, payloadSizeBytes);
+        EXPECT_TRUE(JSON_EQ(TEST_SINGLE_OBJECT_PAYLOAD, actual));
+
+        remove(TEST_MODULE_CACHE);
+    }
+
     TEST_F(ModuleManagerTests, LoadModulesInvalidDirectory)
     {
         ASSERT_EQ(ENOENT, m_mockModuleManager->LoadModules("/invalid/path", TEST_CONFIG_JSON_NONE_REPORTED));
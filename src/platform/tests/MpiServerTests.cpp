@@ -18,6 +18,7 @@ namespace Tests
     static const char* g_errorObject = "Error_Object";
     static const char* g_mockHandle = "Mock_Client_Handle";
     static const char* g_mockPayload = "\"MockPayload\"";
+    static std::string g_lastSetPayload;
 
     static MPI_HANDLE MockCallMpiOpen(const char* clientName, const unsigned int maxPayloadSizeBytes)
     {
@@ -46,8 +47,8 @@ namespace Tests
     static int MockCallMpiSet(MPI_HANDLE handle, const char* componentName, const char* objectName, MPI_JSON_STRING payload, const int payloadSize)
     {
         UNUSED(handle);
-        UNUSED(payload);
-        UNUSED(payloadSize);
+
+        g_lastSetPayload.assign(payload, payloadSize);
 
         return ((0 == strcmp(componentName, g_errorComponent)) && (0 == strcmp(objectName, g_errorObject))) ? -1 : MPI_OK;
     }
@@ -75,9 +76,16 @@ namespace Tests
     static int MockCallMpiSetDesired(MPI_HANDLE handle, const MPI_JSON_STRING payload, const int payloadSize)
     {
         UNUSED(handle);
-        UNUSED(payloadSize);
 
-        return (0 == strcmp(payload, g_mockPayload)) ? MPI_OK : -1;
+        return (((int)strlen(g_mockPayload) == payloadSize) && (0 == strncmp(payload, g_mockPayload, payloadSize))) ? MPI_OK : -1;
+    }
+
+    static bool g_desiredReapplied = false;
+
+    static int MockCallMpiSetDesiredReapply(MPI_HANDLE handle, const MPI_JSON_STRING payload, const int payloadSize)
+    {
+        g_desiredReapplied = true;
+        return MockCallMpiSetDesired(handle, payload, payloadSize);
     }
 
     static int MockCallMpiGetReported(MPI_HANDLE handle, MPI_JSON_STRING* payload, int* payloadSize)
@@ -93,6 +101,64 @@ namespace Tests
         return MPI_OK;
     }
 
+    static int MockCallMpiGetReportedStream(MPI_HANDLE handle, MPI_WRITE_CALLBACK writeCallback, void* context)
+    {
+        int status = MPI_OK;
+
+        if (0 == strcmp((const char*)handle, g_errorClientName))
+        {
+            return -1;
+        }
+
+        // The payload is written in two pieces
+        if (MPI_OK == (status = writeCallback(g_mockPayload, 1, context)))
+        {
+            status = writeCallback(g_mockPayload + 1, strlen(g_mockPayload) - 1, context);
+        }
+
+        return status;
+    }
+
+    static unsigned long long g_reportedChangesVersion = 0;
+
+    static int MockCallMpiGetReportedChanges(MPI_HANDLE handle, const unsigned long long sinceVersion, MPI_JSON_STRING* payload, int* payloadSize)
+    {
+        UNUSED(handle);
+
+        g_reportedChangesVersion = sinceVersion;
+
+        *payload = new (std::nothrow) char[strlen(g_mockPayload) + 1];
+        if (*payload != nullptr)
+        {
+            strcpy(*payload, g_mockPayload);
+            *payloadSize = strlen(g_mockPayload);
+        }
+        return MPI_OK;
+    }
+
+    static int g_reportedCacheBypass = 0;
+
+    static int MockCallMpiSetReportedCacheBypass(MPI_HANDLE handle, const int bypass)
+    {
+        UNUSED(handle);
+        g_reportedCacheBypass = bypass;
+        return MPI_OK;
+    }
+
+    static int WriteToString(const char* data, const int dataSizeBytes, void* context)
+    {
+        static_cast<std::string*>(context)->append(data, dataSizeBytes);
+        return MPI_OK;
+    }
+
+    static int FailWrite(const char* data, const int dataSizeBytes, void* context)
+    {
+        UNUSED(data);
+        UNUSED(dataSizeBytes);
+        UNUSED(context);
+        return ECONNRESET;
+    }
+
     static const MPI_CALLS g_mpiCalls =
     {
         MockCallMpiOpen,
@@ -100,7 +166,11 @@ namespace Tests
         MockCallMpiSet,
         MockCallMpiGet,
         MockCallMpiSetDesired,
-        MockCallMpiGetReported
+        MockCallMpiGetReported,
+        MockCallMpiGetReportedStream,
+        MockCallMpiSetReportedCacheBypass,
+        MockCallMpiGetReportedChanges,
+        MockCallMpiSetDesiredReapply
     };
 
     TEST_F(MpiServerTests, HandleMpiRequestInvalidRequest)
@@ -165,6 +235,13 @@ namespace Tests
         EXPECT_STREQ(expectedHandle.c_str(), response);
         EXPECT_EQ(expectedHandle.length(), responseSize);
         FREE_MEMORY(response);
+        EXPECT_EQ(0, g_reportedCacheBypass);
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_OPEN_URI, "{\"ClientName\": \"Valid_Client\", \"MaxPayloadSizeBytes\": 0, \"ReportedCacheBypass\": true}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(expectedHandle.c_str(), response);
+        EXPECT_EQ(1, g_reportedCacheBypass);
+        FREE_MEMORY(response);
+        g_reportedCacheBypass = 0;
     }
 
     TEST_F(MpiServerTests, MpiCloseRequestInvalidRequestBody)
@@ -195,7 +272,9 @@ namespace Tests
             "{\"ClientSession\": \"\", \"ObjectName\": \"\", \"Payload\": {}}",
             "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"ObjectName\": 123, \"Payload\": {}}",
             "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"Payload\": {}}",
-            "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"ObjectName\": \"\"}"
+            "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"ObjectName\": \"\"}",
+            "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": {}",
+            "{\"ClientSession\": \"\", \"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": {}, \"Extra\": [}"
         };
 
         for (auto request : requests)
@@ -271,6 +350,50 @@ namespace Tests
         }
     }
 
+    TEST_F(MpiServerTests, MpiSetManyRequestInvalidRequestBody)
+    {
+        std::vector<std::string> requests = {
+            "{\"ClientSession\": 123, \"Objects\": []}",
+            "{\"ClientSession\": \"Valid_Client\"}",
+            "{\"ClientSession\": \"Valid_Client\", \"Objects\": {}}",
+            "{\"Objects\": []}",
+            "{}"
+        };
+
+        for (auto request : requests)
+        {
+            char* response = nullptr;
+            int responseSize = 0;
+
+            EXPECT_EQ(HTTP_BAD_REQUEST, HandleMpiCall(MPI_SET_MANY_URI, request.c_str(), &response, &responseSize, g_mpiCalls));
+            EXPECT_EQ(nullptr, response);
+            EXPECT_EQ(0, responseSize);
+            FREE_MEMORY(response);
+        }
+    }
+
+    TEST_F(MpiServerTests, MpiGetManyRequestInvalidRequestBody)
+    {
+        std::vector<std::string> requests = {
+            "{\"ClientSession\": 123, \"Objects\": []}",
+            "{\"ClientSession\": \"Valid_Client\"}",
+            "{\"ClientSession\": \"Valid_Client\", \"Objects\": \"MockPayload\"}",
+            "{\"Objects\": []}",
+            "{}"
+        };
+
+        for (auto request : requests)
+        {
+            char* response = nullptr;
+            int responseSize = 0;
+
+            EXPECT_EQ(HTTP_BAD_REQUEST, HandleMpiCall(MPI_GET_MANY_URI, request.c_str(), &response, &responseSize, g_mpiCalls));
+            EXPECT_EQ(nullptr, response);
+            EXPECT_EQ(0, responseSize);
+            FREE_MEMORY(response);
+        }
+    }
+
     TEST_F(MpiServerTests, MpiCloseRequest)
     {
         char* response = nullptr;
@@ -294,12 +417,33 @@ namespace Tests
         responseSize = 0;
         FREE_MEMORY(response);
 
+        // The names are decoded from the request body like any JSON string
+        EXPECT_EQ(HTTP_INTERNAL_SERVER_ERROR, HandleMpiCall(MPI_SET_URI, "{\"ClientSession\": \"Valid_Client\", \"ComponentName\": \"Error\\u005fComponent\", \"ObjectName\": \"Error_Object\", \"Payload\": {}}", &response, &responseSize, g_mpiCalls));
+
+        responseSize = 0;
+        FREE_MEMORY(response);
+
         EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_URI, "{\"ClientSession\": \"Valid_Client\", \"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": {}}", &response, &responseSize, g_mpiCalls));
         EXPECT_EQ(nullptr, response);
         EXPECT_EQ(0, responseSize);
         FREE_MEMORY(response);
     }
 
+    TEST_F(MpiServerTests, MpiSetRequestPayloadAsIs)
+    {
+        char* response = nullptr;
+        int responseSize = 0;
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_URI, "{\"ClientSession\": \"Valid_Client\", \"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": { \"a\" : [1, 2.5e3, \"\\u00e9}\"] } , \"Extra\": null}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ("{ \"a\" : [1, 2.5e3, \"\\u00e9}\"] }", g_lastSetPayload.c_str());
+        EXPECT_EQ(nullptr, response);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_URI, "{\"ClientSession\": \"Valid_Client\", \"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": \"value\"}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ("\"value\"", g_lastSetPayload.c_str());
+        FREE_MEMORY(response);
+    }
+
     TEST_F(MpiServerTests, MpiGetRequest)
     {
         char* response = nullptr;
@@ -333,7 +477,14 @@ namespace Tests
         EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_DESIRED_URI, "{\"ClientSession\": \"Valid_Client\", \"Payload\": \"MockPayload\"}", &response, &responseSize, g_mpiCalls));
         EXPECT_EQ(nullptr, response);
         EXPECT_EQ(0, responseSize);
+        EXPECT_FALSE(g_desiredReapplied);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_DESIRED_URI, "{\"ClientSession\": \"Valid_Client\", \"Payload\": \"MockPayload\", \"Reapply\": true}", &response, &responseSize, g_mpiCalls));
+        EXPECT_EQ(nullptr, response);
+        EXPECT_TRUE(g_desiredReapplied);
         FREE_MEMORY(response);
+        g_desiredReapplied = false;
     }
 
     TEST_F(MpiServerTests, MpiGetReportedRequest)
@@ -346,4 +497,114 @@ namespace Tests
         EXPECT_EQ(strlen(g_mockPayload), responseSize);
         FREE_MEMORY(response);
     }
+
+    TEST_F(MpiServerTests, MpiGetReportedChangesRequest)
+    {
+        char* response = nullptr;
+        int responseSize = 0;
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_GET_REPORTED_CHANGES_URI, "{\"ClientSession\": \"Valid_Client\", \"Version\": 1760000000000042}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(g_mockPayload, response);
+        EXPECT_EQ(1760000000000042ULL, g_reportedChangesVersion);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_GET_REPORTED_CHANGES_URI, "{\"ClientSession\": \"Valid_Client\"}", &response, &responseSize, g_mpiCalls));
+        EXPECT_EQ(0ULL, g_reportedChangesVersion);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_BAD_REQUEST, HandleMpiCall(MPI_GET_REPORTED_CHANGES_URI, "{\"ClientSession\": \"Valid_Client\", \"Version\": \"1\"}", &response, &responseSize, g_mpiCalls));
+        EXPECT_EQ(nullptr, response);
+    }
+
+    TEST_F(MpiServerTests, MpiSetManyRequest)
+    {
+        const char* expected = "[{\"ComponentName\":\"\",\"ObjectName\":\"\",\"Status\":0},"
+            "{\"ComponentName\":\"Error_Component\",\"ObjectName\":\"Error_Object\",\"Status\":-1},"
+            "{\"ComponentName\":\"\",\"ObjectName\":\"\",\"Status\":22},"
+            "{\"Status\":22}]";
+        char* response = nullptr;
+        int responseSize = 0;
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_MANY_URI, "{\"ClientSession\": \"Valid_Client\", \"Objects\": ["
+            "{\"ComponentName\": \"\", \"ObjectName\": \"\", \"Payload\": {}},"
+            "{\"ComponentName\": \"Error_Component\", \"ObjectName\": \"Error_Object\", \"Payload\": {}},"
+            "{\"ComponentName\": \"\", \"ObjectName\": \"\"},"
+            "{\"ObjectName\": \"\", \"Payload\": {}}]}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(expected, response);
+        EXPECT_EQ(strlen(expected), responseSize);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_SET_MANY_URI, "{\"ClientSession\": \"Valid_Client\", \"Objects\": []}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ("[]", response);
+        EXPECT_EQ(strlen("[]"), responseSize);
+        FREE_MEMORY(response);
+    }
+
+    TEST_F(MpiServerTests, MpiGetManyRequest)
+    {
+        const char* expected = "[{\"ComponentName\":\"\",\"ObjectName\":\"\",\"Payload\":\"MockPayload\",\"Status\":0},"
+            "{\"ComponentName\":\"Error_Component\",\"ObjectName\":\"Error_Object\",\"Status\":-1},"
+            "{\"ComponentName\":\"Quoted \\\"Component\\\"\",\"ObjectName\":\"\\u0041\",\"Payload\":\"MockPayload\",\"Status\":0},"
+            "{\"Status\":22}]";
+        char* response = nullptr;
+        int responseSize = 0;
+
+        // The names are written into the response as they appear in the request
+        EXPECT_EQ(HTTP_OK, HandleMpiCall(MPI_GET_MANY_URI, "{\"ClientSession\": \"Valid_Client\", \"Objects\": ["
+            "{\"ComponentName\": \"\", \"ObjectName\": \"\"},"
+            "{\"ComponentName\": \"Error_Component\", \"ObjectName\": \"Error_Object\"},"
+            "{\"ObjectName\": \"\\u0041\", \"ComponentName\": \"Quoted \\\"Component\\\"\"},"
+            "123]}", &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(expected, response);
+        EXPECT_EQ(strlen(expected), responseSize);
+        FREE_MEMORY(response);
+    }
+
+    TEST_F(MpiServerTests, MpiGetReportedStreamRequestInvalidRequestBody)
+    {
+        std::vector<std::string> requests = {
+            "{\"ClientSession\": 123}",
+            "[]",
+            "{}"
+        };
+
+        for (auto request : requests)
+        {
+            std::string streamed;
+            char* response = nullptr;
+            int responseSize = 0;
+
+            EXPECT_EQ(HTTP_BAD_REQUEST, HandleMpiStreamCall(MPI_GET_REPORTED_STREAM_URI, request.c_str(), WriteToString, &streamed, &response, &responseSize, g_mpiCalls));
+            EXPECT_EQ(nullptr, response);
+            EXPECT_EQ(0, responseSize);
+            EXPECT_TRUE(streamed.empty());
+            FREE_MEMORY(response);
+        }
+    }
+
+    TEST_F(MpiServerTests, MpiGetReportedStreamRequest)
+    {
+        std::string streamed;
+        char* response = nullptr;
+        int responseSize = 0;
+
+        EXPECT_EQ(HTTP_OK, HandleMpiStreamCall(MPI_GET_REPORTED_STREAM_URI, "{\"ClientSession\": \"Valid_Client\"}", WriteToString, &streamed, &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(g_mockPayload, streamed.c_str());
+        EXPECT_EQ(nullptr, response);
+        EXPECT_EQ(0, responseSize);
+
+        streamed.clear();
+
+        EXPECT_EQ(HTTP_INTERNAL_SERVER_ERROR, HandleMpiStreamCall(MPI_GET_REPORTED_STREAM_URI, "{\"ClientSession\": \"Error_Client\"}", WriteToString, &streamed, &response, &responseSize, g_mpiCalls));
+        EXPECT_TRUE(streamed.empty());
+        EXPECT_STREQ("\"-1\"", response);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_INTERNAL_SERVER_ERROR, HandleMpiStreamCall(MPI_GET_REPORTED_STREAM_URI, "{\"ClientSession\": \"Valid_Client\"}", FailWrite, nullptr, &response, &responseSize, g_mpiCalls));
+        EXPECT_STREQ(("\"" + std::to_string(ECONNRESET) + "\"").c_str(), response);
+        FREE_MEMORY(response);
+
+        EXPECT_EQ(HTTP_NOT_FOUND, HandleMpiStreamCall(MPI_GET_REPORTED_URI, "{\"ClientSession\": \"Valid_Client\"}", WriteToString, &streamed, &response, &responseSize, g_mpiCalls));
+        EXPECT_EQ(nullptr, response);
+    }
 }
\ No newline at end of file
@@ -154,4 +154,17 @@ namespace Tests
         ASSERT_EQ(nullptr, payload);
         ASSERT_EQ(0, payloadSizeBytes);
     }
+
+    static int IgnoreWrite(const char* data, const int dataSizeBytes, void* context)
+    {
+        UNUSED(data);
+        UNUSED(dataSizeBytes);
+        UNUSED(context);
+        return MPI_OK;
+    }
+
+    TEST_F(MpiTests, MpiGetReportedStreamInvalidHandle)
+    {
+        ASSERT_EQ(EINVAL, MpiGetReportedStream(nullptr, IgnoreWrite, nullptr));
+    }
 }
\ No newline at end of file